@@ -60,6 +60,18 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    struct vlc_executor_thread *worker;
+};
+
+/**
+ * Priority of a submitted runnable.
+ */
+enum vlc_executor_priority
+{
+    /** Run after the runnables already queued */
+    VLC_EXECUTOR_PRIORITY_NORMAL,
+    /** Run before the normal priority runnables already queued */
+    VLC_EXECUTOR_PRIORITY_HIGH,
 };
 
 /**
@@ -71,6 +83,26 @@ struct vlc_runnable {
 VLC_API vlc_executor_t *
 vlc_executor_New(unsigned max_threads);
 
+/**
+ * Create a new work-stealing executor.
+ *
+ * Unlike vlc_executor_New(), each thread has its own queue of runnables, so
+ * that submitting and taking tasks do not contend on a single lock. Runnables
+ * are distributed among the thread queues, and an idle thread steals
+ * runnables from the other queues.
+ *
+ * A runnable submitted from an executor thread is queued to this same
+ * thread.
+ *
+ * All the threads are started on creation. The executor is used with the
+ * same functions as the one returned by vlc_executor_New().
+ *
+ * \param threads the number of threads used to execute runnables
+ * \return a pointer to a new executor, or NULL if an error occurred
+ */
+VLC_API vlc_executor_t *
+vlc_executor_NewWorkStealing(unsigned threads);
+
 /**
  * Delete an executor.
  *
@@ -145,6 +177,26 @@ vlc_executor_Delete(vlc_executor_t *executor);
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution, with scheduling hints.
+ *
+ * This is equivalent to vlc_executor_Submit(), except that the runnable may
+ * be queued before the normal priority ones.
+ *
+ * With a work-stealing executor, the affinity selects the thread queue (modulo
+ * the number of threads) the runnable is submitted to. This is only a hint:
+ * the runnable may still be stolen by another idle thread. It is ignored by
+ * other executors.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ * \param priority the priority of the task
+ * \param affinity the preferred thread index, or -1 for any
+ */
+VLC_API void
+vlc_executor_SubmitExt(vlc_executor_t *executor, struct vlc_runnable *runnable,
+                       enum vlc_executor_priority priority, int affinity);
+
 /**
  * Cancel a runnable previously submitted.
  *
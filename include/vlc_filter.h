@@ -397,6 +397,37 @@ VLC_API void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 # define filter_DelProxyCallbacks(a, b, c) \
     filter_DelProxyCallbacks(VLC_OBJECT(a), b, c)
 
+/**
+ * Callback processing a horizontal slice of a picture.
+ *
+ * \param filter the filter running the slices
+ * \param opaque the data passed to vlc_filter_RunSlices()
+ * \param first the first line of the slice
+ * \param end the line following the last line of the slice
+ */
+typedef void (*vlc_filter_slice_cb)(filter_t *filter, void *opaque,
+                                    unsigned first, unsigned end);
+
+/**
+ * Processes the lines of a picture by slices on the video filter threads.
+ *
+ * The lines [0, lines) are split in horizontal bands, each processed by one
+ * call of the callback, possibly in parallel from different threads. The
+ * slices start on a multiple of 16 lines, so that the subsampled chroma
+ * planes are split on the same boundaries. The calling thread runs slices
+ * too, and this function returns once all of them are done.
+ *
+ * Small pictures, or the "filter-threads" option set to 1, run as a single
+ * slice from the calling thread.
+ *
+ * \param filter the filter
+ * \param lines the number of lines to process (usually the luma height)
+ * \param cb the callback processing one slice
+ * \param opaque data passed to the callback
+ */
+VLC_API void vlc_filter_RunSlices(filter_t *filter, unsigned lines,
+                                  vlc_filter_slice_cb cb, void *opaque);
+
 typedef filter_t vlc_blender_t;
 
 /**
@@ -187,6 +187,27 @@ VLC_API vlc_frame_t *vlc_frame_New(const struct vlc_frame_callbacks *cbs,
  */
 VLC_API vlc_frame_t *vlc_frame_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
+/**
+ * Frame cache statistics.
+ *
+ * Small frames allocated with vlc_frame_Alloc() are recycled through
+ * per-thread caches, bounded by the "frame-cache" option.
+ */
+struct vlc_frame_cache_stats
+{
+    uint64_t hits; /**< allocations served from a cache */
+    uint64_t misses; /**< cacheable allocations served by the system */
+    size_t cached_bytes; /**< bytes currently held by all caches */
+    size_t high_water; /**< largest amount of bytes held by one cache */
+};
+
+/**
+ * Gets the frame cache statistics of the whole process.
+ *
+ * @param stats structure to fill [OUT]
+ */
+VLC_API void vlc_frame_cache_GetStats(struct vlc_frame_cache_stats *stats);
+
 VLC_API vlc_frame_t *vlc_frame_TryRealloc(vlc_frame_t *, ssize_t pre, size_t body) VLC_USED;
 
 /**
@@ -884,6 +905,88 @@ static inline size_t vlc_fifo_Count (vlc_fifo_t *fifo)
     return depth;
 }
 
+/**
+ * @}
+ * \defgroup frame_spsc_fifo Single-producer single-consumer frame FIFO
+ * Lock-free frame queue functions
+ *
+ * This is a variant of the frame FIFO for the common case where exactly one
+ * thread queues frames and exactly one (other) thread dequeues them.
+ * Neither side ever takes a lock, and the consumer is only woken up if it
+ * actually went to sleep waiting for frames.
+ * @{
+ */
+
+typedef struct vlc_spsc_fifo_t vlc_spsc_fifo_t;
+
+/**
+ * Creates a single-producer single-consumer FIFO queue of frames.
+ *
+ * The created queue must be deleted with vlc_spsc_fifo_Delete().
+ *
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API vlc_spsc_fifo_t *vlc_spsc_fifo_New(void) VLC_USED VLC_MALLOC;
+
+/**
+ * Deletes a FIFO created by vlc_spsc_fifo_New().
+ *
+ * @note Any queued frames are also deleted.
+ * @warning Neither the producer nor the consumer may be using the FIFO when
+ * this function is called.
+ */
+VLC_API void vlc_spsc_fifo_Delete(vlc_spsc_fifo_t *);
+
+/**
+ * Queues frames at the end of a FIFO.
+ *
+ * This function must only be called from the producer thread.
+ *
+ * @param fifo queue
+ * @param frame head of a frame list to queue (may be NULL)
+ * @retval VLC_SUCCESS on success
+ * @retval VLC_ENOMEM if the queue could not grow: the frames that could not
+ * be queued are released
+ */
+VLC_API int vlc_spsc_fifo_Put(vlc_spsc_fifo_t *fifo, vlc_frame_t *frame);
+
+/**
+ * Marks the end of the stream.
+ *
+ * Wakes the consumer up, and makes vlc_spsc_fifo_Get() return NULL once the
+ * queue is empty. This function must only be called from the producer thread
+ * and no frames may be queued afterwards.
+ */
+VLC_API void vlc_spsc_fifo_Close(vlc_spsc_fifo_t *);
+
+/**
+ * Dequeues the first frame from the FIFO, if any.
+ *
+ * This function must only be called from the consumer thread.
+ *
+ * @return the first frame or NULL if the FIFO is empty
+ */
+VLC_API vlc_frame_t *vlc_spsc_fifo_Pop(vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Dequeues all frames from the FIFO.
+ *
+ * This function must only be called from the consumer thread.
+ *
+ * @return a chain of frames, or NULL if the FIFO is empty
+ */
+VLC_API vlc_frame_t *vlc_spsc_fifo_PopAll(vlc_spsc_fifo_t *) VLC_USED;
+
+/**
+ * Dequeues the first frame from the FIFO, waiting for one if necessary.
+ *
+ * This function must only be called from the consumer thread.
+ * Unlike vlc_fifo_Get(), this function is not a cancellation point.
+ *
+ * @return the first frame, or NULL if the FIFO is empty and closed
+ */
+VLC_API vlc_frame_t *vlc_spsc_fifo_Get(vlc_spsc_fifo_t *) VLC_USED;
+
 /** @} */
 
 /** @} */
@@ -223,12 +223,17 @@ struct subpicture_region_rendered
     picture_t       *p_picture;          /**< picture comprising this region */
     vout_display_place_t place;     /**< visible area in display coordinates */
     int             i_alpha;                               /**< transparency */
+    bool            b_unchanged; /**< same picture, crop, place and alpha as
+                                      in the previous render of the SPU, the
+                                      one of serial i_serial - 1 */
 };
 
 struct vlc_render_subpicture
 {
     struct VLC_VECTOR(struct subpicture_region_rendered *) regions; /**< list of regions to render */
     int64_t      i_order;                    /** an increasing unique number */
+    uint64_t     i_serial;  /**< serial of the render, incremented by each
+                                 spu_Render() call, even without output */
 };
 
 typedef struct vlc_render_subpicture vlc_render_subpicture;
@@ -292,6 +292,48 @@ static inline void vlc_tracer_TracePCR( struct vlc_tracer *tracer, const char *t
                              VLC_TRACE_END);
 }
 
+/**
+ * Trace the beginning of a processing span of a stream unit
+ *
+ * Spans are identified by their type, stream id, name and timestamp, so
+ * that the beginning and the end can be emitted from different threads,
+ * and so that the same frame can be followed through each stage.
+ *
+ * \param tracer tracer emitting the span
+ * \param type stage type (for example "DEMUX", "DEC" or "RENDER")
+ * \param id stream identifier
+ * \param span name of the span
+ * \param pts timestamp of the traced stream unit
+ */
+static inline void vlc_tracer_TraceSpanBegin(struct vlc_tracer *tracer,
+                                             const char *type, const char *id,
+                                             const char *span, vlc_tick_t pts)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type),
+                             VLC_TRACE("id", id),
+                             VLC_TRACE("span", span),
+                             VLC_TRACE("phase", "begin"),
+                             VLC_TRACE_TICK_NS("pts", pts),
+                             VLC_TRACE_END);
+}
+
+/**
+ * Trace the end of a processing span of a stream unit
+ *
+ * \see vlc_tracer_TraceSpanBegin()
+ */
+static inline void vlc_tracer_TraceSpanEnd(struct vlc_tracer *tracer,
+                                           const char *type, const char *id,
+                                           const char *span, vlc_tick_t pts)
+{
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", type),
+                             VLC_TRACE("id", id),
+                             VLC_TRACE("span", span),
+                             VLC_TRACE("phase", "end"),
+                             VLC_TRACE_TICK_NS("pts", pts),
+                             VLC_TRACE_END);
+}
+
 /**
  * @}
  */
@@ -44,6 +44,10 @@
 #   include <linux/magic.h>
 #endif
 
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
+
 #if defined( _WIN32 )
 #   include <io.h>
 #   include <ctype.h>
@@ -54,6 +58,7 @@
 #include <vlc_common.h>
 #include "fs.h"
 #include <vlc_access.h>
+#include <vlc_block.h>
 #include <vlc_interrupt.h>
 #ifdef _WIN32
 # include <vlc_charset.h>
@@ -66,8 +71,16 @@ typedef struct
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    bool b_mmap; /* false once mapping failed */
+    uint64_t offset; /* read offset in block mode */
+    uint64_t page_mask;
+#endif
 } access_sys_t;
 
+/* Size of the memory mappings handed out in block mode */
+#define MMAP_SIZE (1 << 22)
+
 #if !defined (_WIN32) && !defined (__OS2__)
 static bool IsRemote (int fd)
 {
@@ -167,6 +180,10 @@ static bool IsRemote (const char *path)
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
 static int FileControl (stream_t *, int, va_list);
 
 /*****************************************************************************
@@ -270,6 +287,23 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Hand out mappings of the page cache instead of copying it. Remote
+         * file systems and devices are read as usual. */
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            p_sys->b_mmap = true;
+            p_sys->offset = 0;
+            p_sys->page_mask = sysconf (_SC_PAGESIZE) - 1;
+            posix_fadvise (fd, 0, MMAP_SIZE, POSIX_FADV_WILLNEED);
+            posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            msg_Dbg (p_access, "using memory mapped block reads");
+        }
 #endif
     }
     else
@@ -292,7 +326,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_read == NULL && p_access->pf_block == NULL)
     {
         DirClose (p_this);
         return;
@@ -326,6 +360,87 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct stat st;
+
+    /* The file may still be growing */
+    if (fstat (p_sys->fd, &st))
+    {
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+    if ((uint64_t)st.st_size <= p_sys->offset)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    uint64_t left = st.st_size - p_sys->offset;
+    size_t length = (left < MMAP_SIZE) ? left : MMAP_SIZE;
+    block_t *block;
+
+    if (p_sys->b_mmap)
+    {
+        /* Mappings must start on a page boundary */
+        uint64_t start = p_sys->offset & ~p_sys->page_mask;
+        size_t skip = p_sys->offset - start;
+        void *addr = mmap (NULL, skip + length, PROT_READ, MAP_SHARED,
+                           p_sys->fd, start);
+        if (addr != MAP_FAILED)
+        {
+            posix_madvise (addr, skip + length, POSIX_MADV_SEQUENTIAL);
+            /* Read the next mapping ahead */
+            posix_fadvise (p_sys->fd, p_sys->offset + length, MMAP_SIZE,
+                           POSIX_FADV_WILLNEED);
+
+            block = block_mmap_Alloc (addr, skip + length);
+            if (unlikely(block == NULL))
+                return NULL;
+            block->p_buffer += skip;
+            block->i_buffer -= skip;
+            p_sys->offset += length;
+            return block;
+        }
+
+        /* Not every file system supports memory mapping */
+        msg_Warn (p_access, "cannot map file: %s", vlc_strerror_c(errno));
+        p_sys->b_mmap = false;
+    }
+
+    block = block_Alloc (length);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    ssize_t val = pread (p_sys->fd, block->p_buffer, length, p_sys->offset);
+    if (val <= 0)
+    {
+        if (val < 0)
+            msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        block_Release (block);
+        *eof = true;
+        return NULL;
+    }
+
+    block->i_buffer = val;
+    p_sys->offset += val;
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    sys->offset = i_pos;
+    posix_fadvise (sys->fd, i_pos, MMAP_SIZE, POSIX_FADV_WILLNEED);
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -37,6 +37,10 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+    add_bool("file-mmap", false, N_("Map local files in memory"),
+             N_("Read local files through memory mappings instead of "
+                "copying their content. This saves a copy with high bitrate "
+                "files, but the files must not be truncated while playing."))
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
@@ -23,10 +23,13 @@
 #endif
 
 #include <assert.h>
+#include <errno.h>
 #include <vlc_common.h>
+#include <vlc_threads.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
 #include <vlc_url.h>
+#include <vlc_strings.h>
 #include "transport.h"
 #include "conn.h"
 #include "connmgr.h"
@@ -96,29 +99,133 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/* Connections kept per manager, for concurrent requests on HTTP/1 */
+#define VLC_HTTP_MGR_MAX_CONNS 8
+
+struct vlc_http_mgr_conn
+{
+    struct vlc_http_conn *conn;
+    char *host; /**< Server the connection was established to */
+    unsigned port;
+    bool http2;
+    unsigned users; /**< Threads opening a stream on the connection */
+    bool removed; /**< Released by the last user */
+};
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
+    vlc_mutex_t lock; /**< Protects the fields below */
+    bool https; /**< Whether the connections are secure */
+    size_t count;
+    struct vlc_http_mgr_conn *conns[VLC_HTTP_MGR_MAX_CONNS]; /**< Oldest first */
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static void vlc_http_mgr_conn_destroy(struct vlc_http_mgr_conn *entry)
+{
+    vlc_http_conn_release(entry->conn);
+    free(entry->host);
+    free(entry);
+}
+
+static void vlc_http_mgr_release(struct vlc_http_mgr *mgr, size_t i)
+{
+    vlc_mutex_assert(&mgr->lock);
+    assert(i < mgr->count);
+
+    struct vlc_http_mgr_conn *entry = mgr->conns[i];
+
+    mgr->count--;
+    memmove(&mgr->conns[i], &mgr->conns[i + 1],
+            (mgr->count - i) * sizeof (mgr->conns[0]));
+
+    if (entry->users > 0)
+        entry->removed = true; /* Released by vlc_http_mgr_put() */
+    else
+        vlc_http_mgr_conn_destroy(entry);
+}
+
+/* Releases a connection, unless another thread already did */
+static void vlc_http_mgr_remove(struct vlc_http_mgr *mgr,
+                                struct vlc_http_conn *conn)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    vlc_mutex_assert(&mgr->lock);
+
+    for (size_t i = 0; i < mgr->count; i++)
+        if (mgr->conns[i]->conn == conn)
+        {
+            vlc_http_mgr_release(mgr, i);
+            break;
+        }
 }
 
-static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
-                                 struct vlc_http_conn *conn)
+/* Ends the use of a connection picked by vlc_http_mgr_reuse() */
+static void vlc_http_mgr_put(struct vlc_http_mgr *mgr,
+                             struct vlc_http_mgr_conn *entry)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
+    vlc_mutex_assert(&mgr->lock);
+    assert(entry->users > 0);
 
-    vlc_http_conn_release(conn);
+    if (--entry->users == 0 && entry->removed)
+        vlc_http_mgr_conn_destroy(entry);
+}
+
+static void vlc_http_mgr_add(struct vlc_http_mgr *mgr,
+                             struct vlc_http_conn *conn, const char *host,
+                             unsigned port, bool https, bool http2)
+{
+    vlc_mutex_assert(&mgr->lock);
+
+    struct vlc_http_mgr_conn *entry = malloc(sizeof (*entry));
+    char *name = strdup(host);
+    if (unlikely(entry == NULL || name == NULL))
+    {   /* Cannot be reused, but pending streams keep it alive */
+        free(name);
+        free(entry);
+        vlc_http_conn_release(conn);
+        return;
+    }
+
+    if (mgr->count == VLC_HTTP_MGR_MAX_CONNS)
+        vlc_http_mgr_release(mgr, 0); /* Busy ones close after their stream */
+
+    entry->conn = conn;
+    entry->host = name;
+    entry->port = port;
+    entry->http2 = http2;
+    entry->users = 0;
+    entry->removed = false;
+    mgr->conns[mgr->count++] = entry;
+    mgr->https = https;
+}
+
+/* Finds a connection to the server, other than the tried ones */
+static struct vlc_http_mgr_conn *
+vlc_http_mgr_find(struct vlc_http_mgr *mgr, const char *host, unsigned port,
+                  struct vlc_http_mgr_conn *const *tried, size_t n)
+{
+    vlc_mutex_assert(&mgr->lock);
+
+    for (size_t i = 0; i < mgr->count; i++)
+    {
+        struct vlc_http_mgr_conn *entry = mgr->conns[i];
+
+        if (entry->port != port || vlc_ascii_strcasecmp(entry->host, host))
+            continue;
+        /* Another thread is issuing its request on that HTTP/1 connection */
+        if (!entry->http2 && entry->users > 0)
+            continue;
+
+        size_t j = 0;
+        while (j < n && tried[j] != entry)
+            j++;
+        if (j == n)
+            return entry;
+    }
+    return NULL;
 }
 
 static
@@ -127,19 +234,51 @@ struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    struct vlc_http_mgr_conn *tried[VLC_HTTP_MGR_MAX_CONNS];
+    struct vlc_http_conn *conn = NULL;
+    struct vlc_http_stream *stream = NULL;
+    size_t n = 0;
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    while (stream == NULL && n < ARRAY_SIZE(tried))
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+        struct vlc_http_mgr_conn *entry = vlc_http_mgr_find(mgr, host, port,
+                                                            tried, n);
+        if (entry == NULL)
+            break;
+
+        tried[n++] = entry;
+        entry->users++;
+        conn = entry->conn;
+        vlc_mutex_unlock(&mgr->lock);
+
+        /* Sending the request can block: the other threads can use the
+         * other connections, or multiplex their HTTP/2 streams on the same
+         * one in the mean time. */
+        stream = vlc_http_stream_open(conn, req, payload);
+        /* A busy HTTP/1 connection is skipped: another one is tried, or
+         * established and added to the manager. */
+        bool dead = stream == NULL && (entry->http2 || errno != EBUSY);
+
+        vlc_mutex_lock(&mgr->lock);
+        if (dead) /* Get rid of closing, reset or failed connection */
+            vlc_http_mgr_remove(mgr, conn);
+        vlc_http_mgr_put(mgr, entry);
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
+
+    /* The manager is not locked while waiting for the response either. The
+     * pending stream keeps the connection alive, even if it is evicted. */
+    if (stream == NULL)
+        return NULL;
+
+    struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+    if (m != NULL)
+        return m;
+
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_mgr_remove(mgr, conn);
+    vlc_mutex_unlock(&mgr->lock);
     return NULL;
 }
 
@@ -151,15 +290,23 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    if (mgr->count > 0 && !mgr->https)
+    {
+        vlc_mutex_unlock(&mgr->lock);
         return NULL; /* switch from HTTP to HTTPS not implemented */
+    }
 
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
         if (mgr->creds == NULL)
+        {
+            vlc_mutex_unlock(&mgr->lock);
             return NULL;
+        }
     }
+    vlc_mutex_unlock(&mgr->lock);
 
     if (idempotent)
     {   /* If the request is idempotent, try to reuse an existing connection.
@@ -206,11 +353,27 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    /* Issue the request on the new connection before other threads can
+     * see it, so that it cannot be taken over in between. */
+    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
+    if (stream == NULL)
+    {
+        vlc_http_conn_release(conn);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_mgr_add(mgr, conn, host, port, true, http2);
+    vlc_mutex_unlock(&mgr->lock);
 
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    struct vlc_http_msg *resp = vlc_http_msg_get_initial(stream);
+    if (resp == NULL)
+    {
+        vlc_mutex_lock(&mgr->lock);
+        vlc_http_mgr_remove(mgr, conn);
+        vlc_mutex_unlock(&mgr->lock);
+    }
+    return resp;
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,7 +381,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
+    vlc_mutex_lock(&mgr->lock);
+    bool https = mgr->count > 0 && mgr->https;
+    vlc_mutex_unlock(&mgr->lock);
+    if (https)
         return NULL; /* switch from HTTPS to HTTP not implemented */
 
     if (idempotent)
@@ -263,10 +429,9 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    vlc_mutex_lock(&mgr->lock);
+    vlc_http_mgr_add(mgr, conn, host, port, false, false);
+    vlc_mutex_unlock(&mgr->lock);
     return resp;
 }
 
@@ -298,14 +463,18 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
-    mgr->conn = NULL;
+    vlc_mutex_init(&mgr->lock);
+    mgr->https = false;
+    mgr->count = 0;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    vlc_mutex_lock(&mgr->lock);
+    while (mgr->count > 0)
+        vlc_http_mgr_release(mgr, mgr->count - 1);
+    vlc_mutex_unlock(&mgr->lock);
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
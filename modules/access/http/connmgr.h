@@ -40,6 +40,10 @@ struct vlc_http_cookie_jar_t;
  * establishing a new one. If successful, the initial HTTP response header is
  * returned.
  *
+ * A connection manager can be shared by several threads. Concurrent
+ * requests to a server are multiplexed on an HTTP/2 connection, or sent on
+ * as many HTTP/1 connections, which are kept for later requests.
+ *
  * @param mgr HTTP connection manager
  * @param https whether to use HTTPS (true) or unencrypted HTTP (false)
  * @param host name of authoritative HTTP server to send the request to
@@ -0,0 +1,285 @@
+/*****************************************************************************
+ * connmgr_test.c: HTTP connection manager test
+ *****************************************************************************
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifndef SOCK_CLOEXEC
+# define SOCK_CLOEXEC 0
+# define accept4(a,b,c,d) accept(a,b,c)
+#endif
+#ifdef _WIN32
+# include <winsock2.h>
+#else
+# include <netinet/in.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#include "connmgr.h"
+#include "message.h"
+
+const char vlc_module_name[] = "test_http_connmgr";
+
+#define MAX_CONNS 32
+
+static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+static vlc_thread_t conn_threads[MAX_CONNS];
+static int conn_fds[MAX_CONNS];
+static unsigned connection_count = 0;
+
+/* Serves keep-alive requests until the client closes the connection */
+static void *conn_thread(void *data)
+{
+    int fd = *(int *)data;
+    char buf[1024];
+    size_t buflen = 0;
+
+    for (;;)
+    {
+        char *end = strnstr(buf, "\r\n\r\n", buflen);
+        if (end == NULL)
+        {
+            ssize_t val = recv(fd, buf + buflen, sizeof (buf) - buflen, 0);
+            if (val <= 0)
+                break;
+            buflen += val;
+            continue;
+        }
+
+        bool close = !strncmp(buf, "GET /close HTTP/1.1\r\n", 21);
+        assert(close || !strncmp(buf, "GET /test HTTP/1.1\r\n", 20));
+
+        /* Drop the request */
+        end += 4;
+        buflen -= end - buf;
+        memmove(buf, end, buflen);
+
+        const char *resp = close ? "HTTP/1.1 200 OK\r\nConnection: close\r\n"
+                                   "Content-Length: 5\r\n\r\nhello"
+                                 : "HTTP/1.1 200 OK\r\n"
+                                   "Content-Length: 5\r\n\r\nhello";
+        ssize_t val = write(fd, resp, strlen(resp));
+        assert((size_t)val == strlen(resp));
+        if (close)
+            break;
+    }
+    return NULL;
+}
+
+static void *server_thread(void *data)
+{
+    int *lfd = data;
+
+    for (;;)
+    {
+        int cfd = accept4(*lfd, NULL, NULL, SOCK_CLOEXEC);
+        if (cfd == -1)
+            continue;
+
+        int canc = vlc_savecancel();
+        vlc_mutex_lock(&lock);
+        assert(connection_count < MAX_CONNS);
+        conn_fds[connection_count] = cfd;
+        if (vlc_clone(&conn_threads[connection_count], conn_thread,
+                      &conn_fds[connection_count]))
+            assert(!"Thread error");
+        connection_count++;
+        vlc_mutex_unlock(&lock);
+        vlc_restorecancel(canc);
+    }
+    vlc_assert_unreachable();
+}
+
+static unsigned get_connection_count(void)
+{
+    vlc_mutex_lock(&lock);
+    unsigned count = connection_count;
+    vlc_mutex_unlock(&lock);
+    return count;
+}
+
+static int server_socket(unsigned *port)
+{
+    int fd = socket(PF_INET6, SOCK_STREAM|SOCK_CLOEXEC, IPPROTO_TCP);
+    if (fd == -1)
+        return -1;
+
+    vlc_sockaddr addr = {
+        .sin6.sin6_family = AF_INET6,
+#ifdef HAVE_SA_LEN
+        .sin6.sin6_len = sizeof (addr),
+#endif
+        .sin6.sin6_addr = in6addr_loopback,
+    };
+    socklen_t addrlen = sizeof (addr.sin6);
+
+    if (bind(fd, &addr.sa, addrlen)
+     || getsockname(fd, &addr.sa, &addrlen))
+    {
+        vlc_close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin6.sin6_port);
+    return fd;
+}
+
+static struct vlc_http_mgr *mgr;
+static char authority[32];
+static unsigned port;
+
+/* Sends a request, and returns the response before reading its body */
+static struct vlc_http_msg *request_path(const char *path)
+{
+    struct vlc_http_msg *req = vlc_http_req_create("GET", "http", authority,
+                                                   path);
+    assert(req != NULL);
+
+    struct vlc_http_msg *resp = vlc_http_mgr_request(mgr, false, "::1", port,
+                                                     req, true, false);
+    vlc_http_msg_destroy(req);
+    assert(resp != NULL);
+    resp = vlc_http_msg_get_final(resp);
+    assert(resp != NULL);
+    assert(vlc_http_msg_get_status(resp) == 200);
+    return resp;
+}
+
+static struct vlc_http_msg *request(void)
+{
+    return request_path("/test");
+}
+
+static void finish(struct vlc_http_msg *resp)
+{
+    block_t *block = vlc_http_msg_read(resp);
+
+    assert(block != NULL);
+    assert(block->i_buffer == 5);
+    assert(!memcmp(block->p_buffer, "hello", 5));
+    block_Release(block);
+    assert(vlc_http_msg_read(resp) == NULL);
+    vlc_http_msg_destroy(resp);
+}
+
+static void *request_thread(void *data)
+{
+    (void) data;
+    for (unsigned i = 0; i < 20; i++)
+        finish(request());
+    return NULL;
+}
+
+int main(void)
+{
+    unsetenv("http_proxy");
+
+    int *lfd = malloc(sizeof (int));
+    assert(lfd != NULL);
+    *lfd = server_socket(&port);
+    if (*lfd == -1)
+        return 77;
+
+    if (listen(*lfd, 255))
+    {
+        vlc_close(*lfd);
+        return 77;
+    }
+
+    snprintf(authority, sizeof (authority), "[::1]:%u", port);
+
+    vlc_thread_t th;
+    if (vlc_clone(&th, server_thread, lfd))
+        assert(!"Thread error");
+
+    struct vlc_object_t obj = { .logger = NULL };
+    mgr = vlc_http_mgr_create(&obj, NULL);
+    assert(mgr != NULL);
+
+    /* Sequential requests share one connection */
+    for (unsigned i = 0; i < 3; i++)
+        finish(request());
+    assert(get_connection_count() == 1);
+
+    /* A busy HTTP/1 connection is not reused: a second one is opened */
+    struct vlc_http_msg *a = request();
+    struct vlc_http_msg *b = request();
+    assert(get_connection_count() == 2);
+    finish(a);
+    finish(b);
+
+    /* Both connections were kept for later concurrent requests */
+    for (unsigned i = 0; i < 3; i++)
+    {
+        a = request();
+        b = request();
+        finish(b);
+        finish(a);
+    }
+    assert(get_connection_count() == 2);
+
+    /* Closed connections are dropped: the two kept ones serve the first
+     * requests, then each request needs a new connection */
+    for (unsigned i = 0; i < 10; i++)
+        finish(request_path("/close"));
+    assert(get_connection_count() == 2 + 8);
+    for (unsigned i = 0; i < 3; i++)
+        finish(request());
+    assert(get_connection_count() == 2 + 8 + 1);
+
+    /* Concurrent requests from several threads */
+    vlc_thread_t threads[3];
+    for (size_t i = 0; i < ARRAY_SIZE(threads); i++)
+        if (vlc_clone(&threads[i], request_thread, NULL))
+            assert(!"Thread error");
+    for (size_t i = 0; i < ARRAY_SIZE(threads); i++)
+        vlc_join(threads[i], NULL);
+    assert(get_connection_count() <= 11 + ARRAY_SIZE(threads));
+
+    vlc_http_mgr_destroy(mgr);
+
+    vlc_cancel(th);
+    vlc_join(th, NULL);
+
+    /* The connections were closed by the manager */
+    for (unsigned i = 0; i < connection_count; i++)
+    {
+        vlc_join(conn_threads[i], NULL);
+        vlc_close(conn_fds[i]);
+    }
+    vlc_close(*lfd);
+    free(lfd);
+    return 0;
+}
@@ -37,6 +37,9 @@
 #define MSG_TRUNC 0
 #endif
 
+/* Datagrams received per system call, at most */
+#define BATCH 32
+
 struct vlc_dgram_sock
 {
     int fd;
@@ -78,6 +81,54 @@ static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+static int vlc_datagram_RecvBatch(struct vlc_dtls *dgs,
+                                  struct vlc_dtls_msg *msgs, unsigned count,
+                                  uint32_t *restrict drops)
+{
+    struct mmsghdr mmsgs[BATCH];
+    struct iovec iovecs[BATCH];
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof (uint32_t))];
+    } cmsgs[BATCH];
+    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
+
+    if (count > BATCH)
+        count = BATCH;
+
+    memset(mmsgs, 0, count * sizeof (*mmsgs));
+    for (unsigned i = 0; i < count; i++) {
+        iovecs[i].iov_base = msgs[i].buf;
+        iovecs[i].iov_len = msgs[i].size;
+        mmsgs[i].msg_hdr.msg_iov = &iovecs[i];
+        mmsgs[i].msg_hdr.msg_iovlen = 1;
+        mmsgs[i].msg_hdr.msg_control = cmsgs[i].buf;
+        mmsgs[i].msg_hdr.msg_controllen = sizeof (cmsgs[i].buf);
+    }
+
+    /* The first datagram is waited for, as with recvmsg() */
+    int ret = recvmmsg(fd, mmsgs, count, MSG_WAITFORONE, NULL);
+
+    for (int i = 0; i < ret; i++) {
+        struct msghdr *msg = &mmsgs[i].msg_hdr;
+
+        msgs[i].len = mmsgs[i].msg_len;
+        msgs[i].truncated = (msg->msg_flags & MSG_TRUNC) != 0;
+#ifdef SO_RXQ_OVFL
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(msg, cmsg))
+            if (cmsg->cmsg_level == SOL_SOCKET
+             && cmsg->cmsg_type == SO_RXQ_OVFL)
+                memcpy(drops, CMSG_DATA(cmsg), sizeof (*drops));
+#else
+        (void) drops;
+#endif
+    }
+    return ret;
+}
+#endif
+
 static ssize_t vlc_datagram_Send(struct vlc_dtls *dgs,
                                  const struct iovec *iov, unsigned iovlen)
 {
@@ -95,6 +146,11 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_GetPollFD,
     vlc_datagram_Recv,
     vlc_datagram_Send,
+#ifdef HAVE_RECVMMSG
+    vlc_datagram_RecvBatch,
+#else
+    NULL,
+#endif
 };
 
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
@@ -104,6 +160,10 @@ struct vlc_dtls *vlc_datagram_CreateFD(int fd)
     if (likely(s != NULL)) {
         s->fd = fd;
         s->s.ops = &vlc_datagram_ops;
+#if defined(HAVE_RECVMMSG) && defined(SO_RXQ_OVFL)
+        /* Optional: count the datagrams dropped by the kernel */
+        setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int));
+#endif
     }
 
     return &s->s;
@@ -146,6 +206,7 @@ static const struct vlc_dtls_operations vlc_dccp_ops = {
     vlc_datagram_GetPollFD,
     vlc_dccp_Recv,
     vlc_datagram_Send,
+    NULL,
 };
 
 struct vlc_dtls *vlc_dccp_CreateFD(int fd)
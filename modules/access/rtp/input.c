@@ -97,6 +97,18 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+/* Received datagrams per batch, at most */
+#define RTP_BATCH 32
+
+static void rtp_release_blocks (void *data)
+{
+    block_t **blocks = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (blocks[i] != NULL)
+            block_Release (blocks[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -105,9 +117,16 @@ void *rtp_dgram_thread (void *opaque)
     rtp_sys_t *sys = opaque;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     struct vlc_dtls *rtp_sock = sys->input_sys.rtp_sock;
+    /* Preallocated blocks the datagrams are received into */
+    block_t *blocks[RTP_BATCH] = { NULL };
+    struct vlc_dtls_msg msgs[RTP_BATCH];
 
     vlc_thread_set_name("vlc-rtp");
+    sys->input_sys.packets = 0;
+    sys->input_sys.syscalls = 0;
+    sys->input_sys.drops = 0;
 
+    vlc_cleanup_push (rtp_release_blocks, blocks);
     for (;;)
     {
         struct pollfd ufd[1];
@@ -125,23 +144,54 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
-                break; /* we are totallly screwed */
+            unsigned count = 0;
 
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
-                    vlc_error (sys->logger, "packet truncated (MRU was %zu)",
-                            block->i_buffer);
-                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            while (count < RTP_BATCH)
+            {
+                if (blocks[count] == NULL)
+                {
+                    blocks[count] = block_Alloc(DEFAULT_MRU);
+                    if (unlikely(blocks[count] == NULL))
+                        break;
                 }
-                else
-                    block->i_buffer = len;
+                msgs[count].buf = blocks[count]->p_buffer;
+                msgs[count].size = blocks[count]->i_buffer;
+                count++;
+            }
+            if (unlikely(count == 0))
+                break; /* we are totallly screwed */
 
-                rtp_process (sys->logger, &sys->input_sys, sys->session, block);
+            uint32_t drops = sys->input_sys.drops;
+            int val = vlc_dtls_RecvBatch(rtp_sock, msgs, count, &drops);
+            if (val >= 0) {
+                sys->input_sys.syscalls++;
+                sys->input_sys.packets += val;
+                if (drops != sys->input_sys.drops)
+                    vlc_warning (sys->logger, "%"PRIu32" RTP packet(s) "
+                                 "dropped by the kernel",
+                                 drops - sys->input_sys.drops);
+                sys->input_sys.drops = drops;
+
+                for (int i = 0; i < val; i++) {
+                    block_t *block = blocks[i];
+
+                    blocks[i] = NULL;
+                    if (msgs[i].truncated) {
+                        vlc_error (sys->logger, "packet truncated (MRU was %zu)",
+                                block->i_buffer);
+                        block->i_flags |= BLOCK_FLAG_CORRUPTED;
+                    }
+                    else
+                        block->i_buffer = msgs[i].len;
+
+                    rtp_process (sys->logger, &sys->input_sys, sys->session,
+                                 block);
+                }
+                /* Keep the unused blocks at the beginning of the ring */
+                for (unsigned i = val; i < count; i++) {
+                    blocks[i - val] = blocks[i];
+                    blocks[i] = NULL;
+                }
             }
             else
             {
@@ -149,7 +199,6 @@ void *rtp_dgram_thread (void *opaque)
                     break; /* connection terminated */
                 vlc_warning (sys->logger, "RTP network error: %s",
                           vlc_strerror_c(errno));
-                block_Release (block);
             }
 
             n--;
@@ -160,5 +209,7 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+    rtp_release_blocks (blocks);
     return NULL;
 }
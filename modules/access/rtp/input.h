@@ -28,6 +28,10 @@ typedef struct
 #endif
     struct vlc_dtls *rtp_sock;
     struct vlc_dtls *rtcp_sock;
+    /* Receive statistics, owned by the RTP thread */
+    uint64_t packets;
+    uint64_t syscalls;
+    uint32_t drops; /* datagrams dropped by the kernel */
 } rtp_input_sys_t;
 
 /* Global data */
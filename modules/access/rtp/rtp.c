@@ -270,6 +270,11 @@ static void Close (vlc_object_t *obj)
 
     vlc_cancel(p_sys->thread);
     vlc_join(p_sys->thread, NULL);
+    if (p_sys->input_sys.syscalls > 0)
+        msg_Dbg(obj, "received %"PRIu64" packets in %"PRIu64" system calls "
+                "(%.1f per call), %"PRIu32" dropped", p_sys->input_sys.packets,
+                p_sys->input_sys.syscalls, (double)p_sys->input_sys.packets
+                / p_sys->input_sys.syscalls, p_sys->input_sys.drops);
 #ifdef HAVE_SRTP
     if (p_sys->input_sys.srtp)
         srtp_destroy (p_sys->input_sys.srtp);
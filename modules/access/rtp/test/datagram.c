@@ -0,0 +1,155 @@
+/*****************************************************************************
+ * datagram.c: RTP datagram socket receive test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * RTP packets of varying sizes are sent to the loopback interface in bursts
+ * of BURST packets, and received in batches as the RTP input thread does.
+ * Every packet must be received whole, in order and not flagged truncated.
+ * Then a packet larger than the receive buffer must be flagged truncated.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_network.h>
+#include "../vlc_dtls.h"
+
+#define MRU    (1500 - 28) /* as the RTP input */
+#define BURST  48 /* more than one batch */
+#define ROUNDS 100
+
+static size_t Size(unsigned seq)
+{
+    return 12 + (seq * 97) % (MRU - 12 + 1);
+}
+
+static void Fill(uint8_t *buf, unsigned seq, size_t size)
+{
+    memset(buf, 0, 12);
+    buf[0] = 0x80; /* RTP version 2 */
+    buf[1] = 33; /* MPEG-TS */
+    SetWBE(buf + 2, seq);
+    for (size_t i = 12; i < size; i++)
+        buf[i] = seq + i;
+}
+
+int main(void)
+{
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrlen = sizeof (addr);
+
+    int rx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (rx == -1)
+        return 77;
+    if (bind(rx, (struct sockaddr *)&addr, sizeof (addr))
+     || getsockname(rx, (struct sockaddr *)&addr, &addrlen))
+    {
+        net_Close(rx);
+        return 77;
+    }
+
+    int tx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    assert(tx != -1);
+    int val = connect(tx, (struct sockaddr *)&addr, sizeof (addr));
+    assert(val == 0);
+
+    struct vlc_dtls *sock = vlc_datagram_CreateFD(rx);
+    assert(sock != NULL);
+
+    static uint8_t bufs[BURST][MRU];
+    uint8_t expected[MRU + 512];
+    struct vlc_dtls_msg msgs[BURST];
+    uint32_t drops = 0;
+    unsigned seq = 0, syscalls = 0;
+
+    for (unsigned round = 0; round < ROUNDS; round++)
+    {
+        for (unsigned i = 0; i < BURST; i++)
+        {
+            const size_t size = Size(seq + i);
+
+            Fill(expected, seq + i, size);
+            ssize_t len = send(tx, expected, size, 0);
+            assert((size_t)len == size);
+        }
+
+        for (unsigned left = BURST; left > 0;)
+        {
+            for (unsigned i = 0; i < left; i++)
+            {
+                msgs[i].buf = bufs[i];
+                msgs[i].size = MRU;
+            }
+
+            int count = vlc_dtls_RecvBatch(sock, msgs, left, &drops);
+            assert(count > 0 && (unsigned)count <= left);
+            syscalls++;
+
+            for (int i = 0; i < count; i++, seq++)
+            {
+                const size_t size = Size(seq);
+
+                Fill(expected, seq, size);
+                assert(!msgs[i].truncated);
+                assert(msgs[i].len == size);
+                assert(memcmp(msgs[i].buf, expected, size) == 0);
+            }
+            left -= count;
+        }
+    }
+
+    assert(drops == 0);
+#ifdef HAVE_RECVMMSG
+    /* The packets of a burst are queued before the first receive call */
+    assert(syscalls < seq);
+#else
+    assert(syscalls == seq);
+#endif
+
+    /* A packet larger than the buffer */
+    Fill(expected, seq, sizeof (expected));
+    ssize_t len = send(tx, expected, sizeof (expected), 0);
+    assert((size_t)len == sizeof (expected));
+
+    msgs[0].buf = bufs[0];
+    msgs[0].size = MRU;
+    val = vlc_dtls_RecvBatch(sock, msgs, 1, &drops);
+    assert(val == 1);
+    assert(msgs[0].truncated);
+    assert(msgs[0].len == MRU);
+    assert(memcmp(msgs[0].buf, expected, MRU) == 0);
+
+    vlc_dtls_Close(sock);
+    net_Close(tx);
+    return 0;
+}
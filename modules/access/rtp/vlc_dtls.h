@@ -23,6 +23,16 @@
 
 struct iovec;
 
+/**
+ * Datagram of a batched receive
+ */
+struct vlc_dtls_msg {
+    void *buf; /**< buffer to receive the datagram into */
+    size_t size; /**< size of the buffer */
+    size_t len; /**< received length */
+    bool truncated; /**< whether the datagram was larger than the buffer */
+};
+
 /**
  * Datagram socket
  */
@@ -37,6 +47,9 @@ struct vlc_dtls_operations {
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
                      bool *restrict truncated);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
+    /* optional */
+    int (*readmmsg)(struct vlc_dtls *, struct vlc_dtls_msg *msgs,
+                    unsigned count, uint32_t *restrict drops);
 };
 
 static inline void vlc_dtls_Close(struct vlc_dtls *dgs)
@@ -57,6 +70,29 @@ static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
     return dgs->ops->readv(dgs, &iov, 1, truncated);
 }
 
+/**
+ * Receives up to count datagrams, in a single system call if the socket
+ * supports it.
+ *
+ * \param drops updated with the number of datagrams dropped by the kernel
+ * since the socket was created, if known
+ * \return the number of received datagrams (at least one), or -1 on error
+ */
+static inline int vlc_dtls_RecvBatch(struct vlc_dtls *dgs,
+                                     struct vlc_dtls_msg *msgs, unsigned count,
+                                     uint32_t *restrict drops)
+{
+    if (dgs->ops->readmmsg != NULL)
+        return dgs->ops->readmmsg(dgs, msgs, count, drops);
+
+    ssize_t len = vlc_dtls_Recv(dgs, msgs[0].buf, msgs[0].size,
+                                &msgs[0].truncated);
+    if (len < 0)
+        return -1;
+    msgs[0].len = len;
+    return 1;
+}
+
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
                                    size_t len)
 {
@@ -53,13 +53,37 @@
  */
 #define MRU 65507u
 
+#ifdef HAVE_RECVMMSG
+/* Datagrams received per system call. Each of them gets a buffer of the
+ * MRU, so that no datagram is ever truncated. */
+#define BATCH 16
+
+union udp_cmsg
+{
+    struct cmsghdr align;
+    char buf[CMSG_SPACE(sizeof (uint32_t))];
+};
+#endif
+
 typedef struct {
     int fd;
     int timeout;
 
     size_t length;
     char *offset;
+#ifdef HAVE_RECVMMSG
+    unsigned count; /* datagrams of the last batch */
+    unsigned index; /* next datagram of the last batch */
+    uint32_t drops; /* kernel drop counter */
+    uint64_t datagrams;
+    uint64_t syscalls;
+    char *bufs; /* BATCH buffers of MRU bytes */
+    struct mmsghdr msgs[BATCH];
+    struct iovec iovecs[BATCH];
+    union udp_cmsg cmsgs[BATCH];
+#else
     char buf[MRU];
+#endif
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -83,6 +107,117 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_RECVMMSG
+/* Checks a received message for truncation and kernel drops */
+static void ParseMsg(stream_t *access, struct msghdr *msg, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (msg->msg_flags & MSG_TRUNC)
+        msg_Err(access, "%zu bytes packet truncated (MRU was %u)", len, MRU);
+
+#ifdef SO_RXQ_OVFL
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+        {
+            uint32_t drops;
+
+            memcpy(&drops, CMSG_DATA(cmsg), sizeof (drops));
+            if (drops != sys->drops)
+                msg_Warn(access, "%"PRIu32" datagram(s) dropped by the kernel",
+                         drops - sys->drops);
+            sys->drops = drops;
+        }
+    }
+#endif
+    sys->datagrams++;
+}
+
+/* Receives a batch of datagrams, after poll() */
+static int RecvBatch(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    for (unsigned i = 0; i < BATCH; i++) {
+        struct msghdr *msg = &sys->msgs[i].msg_hdr;
+
+        /* the kernel updates these */
+        msg->msg_control = sys->cmsgs[i].buf;
+        msg->msg_controllen = sizeof (sys->cmsgs[i].buf);
+        msg->msg_flags = 0;
+    }
+
+    int val = recvmmsg(sys->fd, sys->msgs, BATCH, MSG_DONTWAIT, NULL);
+    if (val <= 0)
+        return -1;
+
+    sys->syscalls++;
+    for (int i = 0; i < val; i++)
+        ParseMsg(access, &sys->msgs[i].msg_hdr, sys->msgs[i].msg_len);
+    sys->count = val;
+    sys->index = 0;
+    return 0;
+}
+
+/* Copies as many received datagrams as fit */
+static size_t Copy(access_sys_t *sys, char *buf, size_t len)
+{
+    size_t copied = 0;
+
+    while (len > 0) {
+        if (sys->length == 0) {
+            if (sys->index >= sys->count)
+                break;
+
+            unsigned i = sys->index++;
+            sys->offset = sys->iovecs[i].iov_base;
+            sys->length = __MIN(sys->msgs[i].msg_len, MRU);
+            continue;
+        }
+
+        size_t copy = __MIN(len, sys->length);
+
+        memcpy(buf + copied, sys->offset, copy);
+        sys->offset += copy;
+        sys->length -= copy;
+        copied += copy;
+        len -= copy;
+    }
+    return copied;
+}
+
+static ssize_t Read(stream_t *access, void *buf, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+    size_t val = Copy(sys, buf, len);
+
+    if (val > 0)
+        return val;
+
+    struct pollfd ufd[1];
+
+    ufd[0].fd = sys->fd;
+    ufd[0].events = POLLIN;
+
+    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+        case 0:
+            msg_Err(access, "receive time-out");
+            return 0;
+        case -1:
+            return -1;
+    }
+
+    if (RecvBatch(access))
+        return -1;
+
+    val = Copy(sys, buf, len);
+    if (val == 0) /* empty (0 bytes) payloads do *not* mean EOF here */
+        return -1;
+    return val;
+}
+#else
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
@@ -131,6 +266,7 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
 
     return val;
 }
+#endif
 
 /*****************************************************************************
  * Open: open the socket
@@ -217,6 +353,31 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->count = sys->index = 0;
+    sys->drops = 0;
+    sys->datagrams = sys->syscalls = 0;
+    sys->bufs = malloc( BATCH * MRU );
+    if( unlikely(sys->bufs == NULL) )
+    {
+        net_Close( sys->fd );
+        return VLC_ENOMEM;
+    }
+    for( unsigned i = 0; i < BATCH; i++ )
+    {
+        sys->iovecs[i].iov_base = sys->bufs + i * MRU;
+        sys->iovecs[i].iov_len = MRU;
+        memset( &sys->msgs[i], 0, sizeof( sys->msgs[i] ) );
+        sys->msgs[i].msg_hdr.msg_iov = &sys->iovecs[i];
+        sys->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    /* Optional: count the kernel drops */
+# ifdef SO_RXQ_OVFL
+    setsockopt( sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int) );
+# endif
+#endif
+
     return VLC_SUCCESS;
 }
 
@@ -228,6 +389,14 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    if( sys->syscalls > 0 )
+        msg_Dbg( p_access, "received %"PRIu64" datagrams in %"PRIu64
+                 " system calls (%.1f per call), %"PRIu32" dropped",
+                 sys->datagrams, sys->syscalls,
+                 (double)sys->datagrams / sys->syscalls, sys->drops );
+    free( sys->bufs );
+#endif
     net_Close( sys->fd );
 }
 
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * mixer_avx2.h: helpers to mix interleaved float channels with AVX2
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#include <vlc_cpu.h>
+
+/* The channels of 8 frames are mixed at once, each in one vector */
+#define MIXER_AVX2_FRAMES 8
+
+/**
+ * Returns the offsets of the samples of 8 frames with the given number of
+ * channels, to gather one channel with Mixer_Load_AVX2().
+ */
+VLC_AVX2
+static inline __m256i Mixer_Offsets_AVX2( unsigned i_channels )
+{
+    return _mm256_mullo_epi32( _mm256_set1_epi32( i_channels ),
+                               _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+}
+
+/**
+ * Loads one channel of 8 interleaved frames.
+ */
+VLC_AVX2
+static inline __m256 Mixer_Load_AVX2( const float *p_src, unsigned i_channel,
+                                      __m256i offsets )
+{
+    return _mm256_i32gather_ps( p_src + i_channel, offsets, sizeof (float) );
+}
+
+/**
+ * Interleaves the channels of 8 frames.
+ */
+VLC_AVX2
+static inline void Mixer_Store_AVX2( float *p_dst, const __m256 *p_ch,
+                                     unsigned i_channels )
+{
+    switch( i_channels )
+    {
+        case 1:
+            _mm256_storeu_ps( p_dst, p_ch[0] );
+            break;
+        case 2:
+        {
+            /* frames 0, 1, 4, 5 and 2, 3, 6, 7 */
+            const __m256 lo = _mm256_unpacklo_ps( p_ch[0], p_ch[1] );
+            const __m256 hi = _mm256_unpackhi_ps( p_ch[0], p_ch[1] );
+            _mm256_storeu_ps( p_dst, _mm256_permute2f128_ps( lo, hi, 0x20 ) );
+            _mm256_storeu_ps( p_dst + 8, _mm256_permute2f128_ps( lo, hi, 0x31 ) );
+            break;
+        }
+        case 4:
+        {
+            const __m256 t0 = _mm256_unpacklo_ps( p_ch[0], p_ch[1] );
+            const __m256 t1 = _mm256_unpackhi_ps( p_ch[0], p_ch[1] );
+            const __m256 t2 = _mm256_unpacklo_ps( p_ch[2], p_ch[3] );
+            const __m256 t3 = _mm256_unpackhi_ps( p_ch[2], p_ch[3] );
+            /* frames 0 and 4, 1 and 5, 2 and 6, 3 and 7 */
+            const __m256 f0 = _mm256_shuffle_ps( t0, t2, 0x44 );
+            const __m256 f1 = _mm256_shuffle_ps( t0, t2, 0xEE );
+            const __m256 f2 = _mm256_shuffle_ps( t1, t3, 0x44 );
+            const __m256 f3 = _mm256_shuffle_ps( t1, t3, 0xEE );
+            _mm256_storeu_ps( p_dst,      _mm256_permute2f128_ps( f0, f1, 0x20 ) );
+            _mm256_storeu_ps( p_dst + 8,  _mm256_permute2f128_ps( f2, f3, 0x20 ) );
+            _mm256_storeu_ps( p_dst + 16, _mm256_permute2f128_ps( f0, f1, 0x31 ) );
+            _mm256_storeu_ps( p_dst + 24, _mm256_permute2f128_ps( f2, f3, 0x31 ) );
+            break;
+        }
+        default:
+        {
+            float buffer[AOUT_CHAN_MAX][MIXER_AVX2_FRAMES];
+
+            assert( i_channels <= AOUT_CHAN_MAX );
+            for( unsigned c = 0; c < i_channels; c++ )
+                _mm256_storeu_ps( buffer[c], p_ch[c] );
+            for( unsigned i = 0; i < MIXER_AVX2_FRAMES; i++ )
+                for( unsigned c = 0; c < i_channels; c++ )
+                    *(p_dst++) = buffer[c][i];
+            break;
+        }
+    }
+}
+#endif
@@ -37,6 +37,8 @@
 #include <vlc_block.h>
 #include <assert.h>
 
+#include "mixer_avx2.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -222,8 +224,105 @@ DEFINE_REMAP( FL64, double   )
 
 #undef DEFINE_REMAP
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* Remaps 8 frames, adding the input channels in the same order as the C
+ * version, so that the output is identical */
+VLC_AVX2
+static inline void RemapFramesFL32_avx2( const filter_sys_t *p_sys,
+                                         const float *p_src, float *p_dest,
+                                         __m256i offsets,
+                                         unsigned i_nb_in_channels,
+                                         unsigned i_nb_out_channels,
+                                         bool b_add )
+{
+    __m256 out[AOUT_CHAN_MAX];
+
+    for( unsigned out_ch = 0; out_ch < i_nb_out_channels; out_ch++ )
+        out[out_ch] = _mm256_setzero_ps();
+
+    for( uint8_t in_ch = 0; in_ch < i_nb_in_channels; in_ch++ )
+    {
+        int8_t out_ch = p_sys->map_ch[ in_ch ];
+        if (out_ch < 0) continue;
+
+        __m256 v = Mixer_Load_AVX2( p_src, in_ch, offsets );
+        if( !b_add )
+            out[ out_ch ] = v;
+        else
+        {
+            if( p_sys->b_normalize )
+                v = _mm256_div_ps( v,
+                        _mm256_set1_ps( p_sys->nb_in_ch[ out_ch ] ) );
+            out[ out_ch ] = _mm256_add_ps( out[ out_ch ], v );
+        }
+    }
+    Mixer_Store_AVX2( p_dest, out, i_nb_out_channels );
+}
+
+VLC_AVX2
+static inline void RemapFL32_avx2( filter_t *p_filter,
+                                   const void *p_srcorig, void *p_destorig,
+                                   int i_nb_samples,
+                                   unsigned i_nb_in_channels,
+                                   unsigned i_nb_out_channels, bool b_add )
+{
+    const filter_sys_t *p_sys = p_filter->p_sys;
+    const float *p_src = p_srcorig;
+    float *p_dest = p_destorig;
+    const __m256i offsets = Mixer_Offsets_AVX2( i_nb_in_channels );
+
+    for( ; i_nb_samples >= MIXER_AVX2_FRAMES; i_nb_samples -= MIXER_AVX2_FRAMES )
+    {
+        RemapFramesFL32_avx2( p_sys, p_src, p_dest, offsets, i_nb_in_channels,
+                              i_nb_out_channels, b_add );
+        p_src  += MIXER_AVX2_FRAMES * i_nb_in_channels;
+        p_dest += MIXER_AVX2_FRAMES * i_nb_out_channels;
+    }
+
+    if( i_nb_samples > 0 )
+    {
+        /* Remap the last frames from and to padded buffers */
+        float src[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX] = { 0 };
+        float dst[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX];
+
+        memcpy( src, p_src, i_nb_samples * i_nb_in_channels * sizeof (float) );
+        RemapFramesFL32_avx2( p_sys, src, dst, offsets, i_nb_in_channels,
+                              i_nb_out_channels, b_add );
+        memcpy( p_dest, dst, i_nb_samples * i_nb_out_channels * sizeof (float) );
+    }
+}
+
+VLC_AVX2
+static void RemapCopyFL32_avx2( filter_t *p_filter,
+                                const void *p_srcorig, void *p_destorig,
+                                int i_nb_samples,
+                                unsigned i_nb_in_channels,
+                                unsigned i_nb_out_channels )
+{
+    RemapFL32_avx2( p_filter, p_srcorig, p_destorig, i_nb_samples,
+                    i_nb_in_channels, i_nb_out_channels, false );
+}
+
+VLC_AVX2
+static void RemapAddFL32_avx2( filter_t *p_filter,
+                               const void *p_srcorig, void *p_destorig,
+                               int i_nb_samples,
+                               unsigned i_nb_in_channels,
+                               unsigned i_nb_out_channels )
+{
+    RemapFL32_avx2( p_filter, p_srcorig, p_destorig, i_nb_samples,
+                    i_nb_in_channels, i_nb_out_channels, true );
+}
+#endif
+
 static inline remap_fun_t GetRemapFun( audio_format_t *p_format, bool b_add )
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if( p_format->i_format == VLC_CODEC_FL32 && p_format->i_channels <= AOUT_CHAN_MAX
+     && vlc_CPU_AVX2() )
+        return b_add ? RemapAddFL32_avx2 : RemapCopyFL32_avx2;
+#endif
+
     if( b_add )
     {
         switch( p_format->i_format )
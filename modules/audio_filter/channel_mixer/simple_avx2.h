@@ -0,0 +1,213 @@
+/*****************************************************************************
+ * simple_avx2.h : simple channel mixer plug-in using AVX2
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+#include <assert.h>
+#include <vlc_cpu.h>
+
+#include "mixer_avx2.h"
+
+/* The mixes compute the same operations, in the same order, as the C
+ * versions, for each frame in a vector lane. */
+
+#define ADD(a, b)  _mm256_add_ps( a, b )
+#define MUL(a, k)  _mm256_mul_ps( a, _mm256_set1_ps( k ) )
+#define DIV(a, k)  _mm256_div_ps( a, _mm256_set1_ps( k ) )
+
+VLC_AVX2 static inline void Mix_7_x_to_2_0_avx2( __m256 *d, const __m256 *s )
+{
+    const __m256 ctr = MUL( s[6], 0.7071f );
+    d[0] = ADD( ADD( ADD( ctr, s[0] ), DIV( s[2], 4 ) ), DIV( s[4], 4 ) );
+    d[1] = ADD( ADD( ADD( ctr, s[1] ), DIV( s[3], 4 ) ), DIV( s[5], 4 ) );
+}
+
+VLC_AVX2 static inline void Mix_6_1_to_2_0_avx2( __m256 *d, const __m256 *s )
+{
+    const __m256 ctr = MUL( ADD( s[2], s[5] ), 0.7071f );
+    d[0] = ADD( ADD( s[0], s[3] ), ctr );
+    d[1] = ADD( ADD( s[1], s[4] ), ctr );
+}
+
+VLC_AVX2 static inline void Mix_5_x_to_2_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( s[0], MUL( ADD( s[4], s[2] ), 0.7071f ) );
+    d[1] = ADD( s[1], MUL( ADD( s[4], s[3] ), 0.7071f ) );
+}
+
+VLC_AVX2 static inline void Mix_4_0_to_2_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( ADD( s[2], s[3] ), MUL( s[0], 0.5f ) );
+    d[1] = ADD( ADD( s[2], s[3] ), MUL( s[1], 0.5f ) );
+}
+
+VLC_AVX2 static inline void Mix_3_x_to_2_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( s[2], MUL( s[0], 0.5f ) );
+    d[1] = ADD( s[2], MUL( s[1], 0.5f ) );
+}
+
+VLC_AVX2 static inline void Mix_7_x_to_1_0_avx2( __m256 *d, const __m256 *s )
+{
+    __m256 v = ADD( s[6], DIV( s[0], 4 ) );
+    v = ADD( v, DIV( s[1], 4 ) );
+    v = ADD( v, DIV( s[2], 8 ) );
+    v = ADD( v, DIV( s[3], 8 ) );
+    v = ADD( v, DIV( s[4], 8 ) );
+    d[0] = ADD( v, DIV( s[5], 8 ) );
+}
+
+VLC_AVX2 static inline void Mix_5_x_to_1_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( ADD( MUL( ADD( s[0], s[1] ), 0.7071f ), s[4] ),
+                MUL( ADD( s[2], s[3] ), 0.5f ) );
+}
+
+VLC_AVX2 static inline void Mix_4_0_to_1_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( ADD( ADD( s[2], s[3] ), DIV( s[0], 4 ) ), DIV( s[1], 4 ) );
+}
+
+VLC_AVX2 static inline void Mix_3_x_to_1_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( ADD( s[2], DIV( s[0], 4 ) ), DIV( s[1], 4 ) );
+}
+
+VLC_AVX2 static inline void Mix_2_x_to_1_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( DIV( s[0], 2 ), DIV( s[1], 2 ) );
+}
+
+VLC_AVX2 static inline void Mix_7_x_to_4_0_avx2( __m256 *d, const __m256 *s )
+{
+    d[0] = ADD( ADD( s[6], MUL( s[0], 0.5f ) ), DIV( s[2], 6 ) );
+    d[1] = ADD( ADD( s[6], MUL( s[1], 0.5f ) ), DIV( s[3], 6 ) );
+    d[2] = ADD( DIV( s[2], 6 ), s[4] );
+    d[3] = ADD( DIV( s[3], 6 ), s[5] );
+}
+
+VLC_AVX2 static inline void Mix_5_x_to_4_0_avx2( __m256 *d, const __m256 *s )
+{
+    const __m256 ctr = MUL( s[4], 0.7071f );
+    d[0] = ADD( s[0], ctr );
+    d[1] = ADD( s[1], ctr );
+    d[2] = s[2];
+    d[3] = s[3];
+}
+
+#undef DIV
+#undef MUL
+#undef ADD
+
+typedef void (*mix_avx2_t)( __m256 *, const __m256 * );
+
+VLC_AVX2
+static inline void MixFrames_avx2( float *p_dest, const float *p_src,
+                                   __m256i offsets, unsigned i_src_nb,
+                                   unsigned i_dest_nb, mix_avx2_t mix )
+{
+    __m256 src[AOUT_CHAN_MAX], dst[AOUT_CHAN_MAX];
+
+    for( unsigned c = 0; c < i_src_nb; c++ )
+        src[c] = Mixer_Load_AVX2( p_src, c, offsets );
+    mix( dst, src );
+    Mixer_Store_AVX2( p_dest, dst, i_dest_nb );
+}
+
+/**
+ * Mixes the first i_src_nb channels of frames of i_stride channels.
+ */
+VLC_AVX2
+static inline void DoWork_avx2( const block_t *p_in_buf, block_t *p_out_buf,
+                                unsigned i_stride, unsigned i_src_nb,
+                                unsigned i_dest_nb, mix_avx2_t mix )
+{
+    const float *p_src = (const float *)p_in_buf->p_buffer;
+    float *p_dest = (float *)p_out_buf->p_buffer;
+    const __m256i offsets = Mixer_Offsets_AVX2( i_stride );
+    size_t i_frames = p_in_buf->i_nb_samples;
+
+    for( ; i_frames >= MIXER_AVX2_FRAMES; i_frames -= MIXER_AVX2_FRAMES )
+    {
+        MixFrames_avx2( p_dest, p_src, offsets, i_src_nb, i_dest_nb, mix );
+        p_src += MIXER_AVX2_FRAMES * i_stride;
+        p_dest += MIXER_AVX2_FRAMES * i_dest_nb;
+    }
+
+    if( i_frames > 0 )
+    {
+        /* Mix the last frames from and to padded buffers */
+        float src[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX] = { 0 };
+        float dst[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX];
+
+        assert( i_stride <= AOUT_CHAN_MAX && i_dest_nb <= AOUT_CHAN_MAX );
+        memcpy( src, p_src, i_frames * i_stride * sizeof (float) );
+        MixFrames_avx2( dst, src, offsets, i_src_nb, i_dest_nb, mix );
+        memcpy( p_dest, dst, i_frames * i_dest_nb * sizeof (float) );
+    }
+}
+
+#define HAS_LFE(filter) \
+    (((filter)->fmt_in.audio.i_physical_channels & AOUT_CHAN_LFE) != 0)
+
+#define AVX2_WRAPPER(in, out, src_nb, dest_nb, stride)                           \
+    VLC_AVX2 static void DoWork_##in##_to_##out##_avx2( filter_t *p_filter,      \
+                                                        block_t *p_in_buf,       \
+                                                        block_t *p_out_buf )     \
+    {                                                                            \
+        DoWork_avx2( p_in_buf, p_out_buf, stride, src_nb, dest_nb,               \
+                     Mix_##in##_to_##out##_avx2 );                               \
+        VLC_UNUSED(p_filter);                                                    \
+    }                                                                            \
+    static inline void (*GET_WORK_##in##_to_##out##_avx2())(filter_t*, block_t*, block_t*) \
+    {                                                                            \
+        return vlc_CPU_AVX2() ? DoWork_##in##_to_##out##_avx2 : DoWork_##in##_to_##out; \
+    }
+
+AVX2_WRAPPER(7_x,2_0, 7, 2, 7 + HAS_LFE(p_filter))
+AVX2_WRAPPER(6_1,2_0, 6, 2, 7)
+AVX2_WRAPPER(5_x,2_0, 5, 2, 5 + HAS_LFE(p_filter))
+AVX2_WRAPPER(4_0,2_0, 4, 2, 4)
+AVX2_WRAPPER(3_x,2_0, 3, 2, 3 + HAS_LFE(p_filter))
+AVX2_WRAPPER(7_x,1_0, 7, 1, 7 + HAS_LFE(p_filter))
+AVX2_WRAPPER(5_x,1_0, 5, 1, 5 + HAS_LFE(p_filter))
+AVX2_WRAPPER(4_0,1_0, 4, 1, 4)
+AVX2_WRAPPER(3_x,1_0, 3, 1, 3 + HAS_LFE(p_filter))
+AVX2_WRAPPER(2_x,1_0, 2, 1, 2)
+AVX2_WRAPPER(7_x,4_0, 7, 4, 7 + HAS_LFE(p_filter))
+AVX2_WRAPPER(5_x,4_0, 5, 4, 5 + HAS_LFE(p_filter))
+
+#undef AVX2_WRAPPER
+#undef HAS_LFE
+
+/* The following conversions may pass the LFE channel through, so they stay
+ * on the C code */
+
+#define C_WRAPPER(in, out) \
+    static inline void (*GET_WORK_##in##_to_##out##_avx2())(filter_t*, block_t*, block_t*) \
+    { \
+        return DoWork_##in##_to_##out; \
+    }
+
+C_WRAPPER(7_x,5_x)
+C_WRAPPER(6_1,5_x)
+
+#undef C_WRAPPER
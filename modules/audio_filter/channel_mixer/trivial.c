@@ -35,6 +35,8 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 
+#include "mixer_avx2.h"
+
 static int Create( vlc_object_t * );
 
 vlc_module_begin ()
@@ -49,6 +51,51 @@ typedef struct
     int channel_map[AOUT_CHAN_MAX];
 } filter_sys_t;
 
+#ifdef HAVE_AVX2_INTRINSICS
+VLC_AVX2
+static inline void MixFrames_avx2( const int *channel_map, const float *p_src,
+                                   float *p_dest, __m256i offsets,
+                                   unsigned i_output_nb )
+{
+    __m256 ch[AOUT_CHAN_MAX];
+
+    for( unsigned j = 0; j < i_output_nb; j++ )
+        ch[j] = channel_map[j] == -1 ? _mm256_setzero_ps()
+              : Mixer_Load_AVX2( p_src, channel_map[j], offsets );
+    Mixer_Store_AVX2( p_dest, ch, i_output_nb );
+}
+
+/**
+ * Maps the channels of 8 frames at once. All the input frames of a block are
+ * read before the output frames are written, so that it works in place when
+ * downmixing.
+ */
+VLC_AVX2
+static void Mix_avx2( const int *channel_map, const float *p_src,
+                      float *p_dest, size_t i_nb_samples,
+                      unsigned i_input_nb, unsigned i_output_nb )
+{
+    const __m256i offsets = Mixer_Offsets_AVX2( i_input_nb );
+
+    for( ; i_nb_samples >= MIXER_AVX2_FRAMES; i_nb_samples -= MIXER_AVX2_FRAMES )
+    {
+        MixFrames_avx2( channel_map, p_src, p_dest, offsets, i_output_nb );
+        p_src += MIXER_AVX2_FRAMES * i_input_nb;
+        p_dest += MIXER_AVX2_FRAMES * i_output_nb;
+    }
+
+    if( i_nb_samples > 0 )
+    {
+        float src[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX] = { 0 };
+        float dst[MIXER_AVX2_FRAMES * AOUT_CHAN_MAX];
+
+        memcpy( src, p_src, i_nb_samples * i_input_nb * sizeof (float) );
+        MixFrames_avx2( channel_map, src, dst, offsets, i_output_nb );
+        memcpy( p_dest, dst, i_nb_samples * i_output_nb * sizeof (float) );
+    }
+}
+#endif
+
 /**
  * Trivially upmixes
  */
@@ -78,6 +125,16 @@ static block_t *Upmix( filter_t *p_filter, block_t *p_in_buf )
     const float *p_src = (float *)p_in_buf->p_buffer;
     const int *channel_map = p_sys->channel_map;
 
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+    {
+        Mix_avx2( channel_map, p_src, p_dest, p_in_buf->i_nb_samples,
+                  i_input_nb, i_output_nb );
+        block_Release( p_in_buf );
+        return p_out_buf;
+    }
+#endif
+
     for( size_t i = 0; i < p_in_buf->i_nb_samples; i++ )
     {
         for( unsigned j = 0; j < i_output_nb; j++ )
@@ -106,6 +163,17 @@ static block_t *Downmix( filter_t *p_filter, block_t *p_buf )
     float *p_dest = (float *)p_buf->p_buffer;
     const float *p_src = p_dest;
     const int *channel_map = p_sys->channel_map;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+    {
+        Mix_avx2( channel_map, p_src, p_dest, p_buf->i_nb_samples,
+                  i_input_nb, i_output_nb );
+        p_buf->i_buffer = p_buf->i_buffer * i_output_nb / i_input_nb;
+        return p_buf;
+    }
+#endif
+
     /* Use an extra buffer to avoid overlapping */
     float buffer[i_output_nb];
 
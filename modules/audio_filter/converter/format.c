@@ -38,6 +38,10 @@
 #include <vlc_aout.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Module descriptor
@@ -250,12 +254,46 @@ static block_t *Fl32toU8(filter_t *filter, block_t *b)
     return b;
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* Walken's trick below, clamping the float bits in integer lanes. It can
+ * work in place, as each vector is read before the output is written. */
+VLC_AVX2
+static size_t Fl32toS16_AVX2(int16_t *dst, const float *src, size_t count)
+{
+    const __m256 bias = _mm256_set1_ps(384.f);
+    const __m256i min = _mm256_set1_epi32(0x43bf8000);
+    const __m256i max = _mm256_set1_epi32(0x43c07fff);
+    const __m256i zero = _mm256_set1_epi32(0x43c00000);
+    size_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        __m256i a = _mm256_castps_si256(_mm256_add_ps(_mm256_loadu_ps(&src[i]), bias));
+        __m256i b = _mm256_castps_si256(_mm256_add_ps(_mm256_loadu_ps(&src[i + 8]), bias));
+        a = _mm256_sub_epi32(_mm256_min_epi32(_mm256_max_epi32(a, min), max), zero);
+        b = _mm256_sub_epi32(_mm256_min_epi32(_mm256_max_epi32(b, min), max), zero);
+        /* packing works within 128-bit lanes: restore the sample order */
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i *)&dst[i], v);
+    }
+    return i;
+}
+#endif
+
 static block_t *Fl32toS16(filter_t *filter, block_t *b)
 {
     VLC_UNUSED(filter);
     float   *src = (float *)b->p_buffer;
     int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
+    size_t count = b->i_buffer / 4;
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2()) {
+        size_t done = Fl32toS16_AVX2(dst, src, count);
+        src += done;
+        dst += done;
+        count -= done;
+    }
+#endif
+    for (size_t i = count; i--;) {
 #if 0
         /* Slow version. */
         if (*src >= 1.0) *dst = 32767;
@@ -32,11 +32,14 @@
 #include <vlc_aout.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_cpu.h>
 
 #include <stdatomic.h>
 #include <string.h> /* for memset */
 #include <limits.h> /* form INT_MIN */
 
+#include "scaletempo_kernels.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -128,6 +131,10 @@ typedef struct
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    /* kernels */
+    float   (*corr)( const float *, const float *, unsigned );
+    void    (*blend)( float *, const float *, const float *, const float *,
+                      unsigned );
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
@@ -145,23 +152,19 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     float best_corr = INT_MIN;
     unsigned best_off = 0;
     unsigned i, off;
+    unsigned n = p->samples_overlap - p->samples_per_frame;
 
     pw  = p->table_window;
     po  = p->buf_overlap;
     po += p->samples_per_frame;
     ppc = p->buf_pre_corr;
-    for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
+    for( i = 0; i < n; i++ ) {
       *ppc++ = *pw++ * *po++;
     }
 
     search_start = (float *)p->buf_queue + p->samples_per_frame;
     for( off = 0; off < p->frames_search; off++ ) {
-      float corr = 0;
-      float *ps = search_start;
-      ppc = p->buf_pre_corr;
-      for( i = p->samples_per_frame; i < p->samples_overlap; i++ ) {
-        corr += *ppc++ * *ps++;
-      }
+      float corr = p->corr( p->buf_pre_corr, search_start, n );
       if( corr > best_corr ) {
         best_corr = corr;
         best_off  = off;
@@ -180,14 +183,8 @@ static void output_overlap_float( filter_t        *p_filter,
                                   unsigned         bytes_off )
 {
     filter_sys_t *p = p_filter->p_sys;
-    float *pout = buf_out;
-    float *pb   = p->table_blend;
-    float *po   = p->buf_overlap;
-    float *pin  = (float *)( p->buf_queue + bytes_off );
-    unsigned i;
-    for( i = 0; i < p->samples_overlap; i++ ) {
-        *pout++ = *po - *pb++ * ( *po - *pin++ ); po++;
-    }
+    p->blend( buf_out, p->buf_overlap, p->table_blend,
+              (float *)( p->buf_queue + bytes_off ), p->samples_overlap );
 }
 
 /*****************************************************************************
@@ -417,6 +414,30 @@ static int Open( vlc_object_t *p_this )
              p_sys->bytes_per_sample,
              "fl32" );
 
+    p_sys->corr  = corr_c;
+    p_sys->blend = blend_c;
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if( vlc_CPU_SSE2() )
+    {
+        p_sys->corr  = corr_sse2;
+        p_sys->blend = blend_sse2;
+    }
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->corr  = corr_avx2;
+        p_sys->blend = blend_avx2;
+    }
+#endif
+#ifdef __ARM_NEON
+    if( vlc_CPU_ARM_NEON() )
+    {
+        p_sys->corr  = corr_neon;
+        p_sys->blend = blend_neon;
+    }
+#endif
+
     p_sys->ms_stride       = var_InheritInteger( p_this, "scaletempo-stride" );
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
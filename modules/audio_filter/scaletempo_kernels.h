@@ -0,0 +1,148 @@
+/*****************************************************************************
+ * scaletempo_kernels.h: cross correlation and overlap blending of scaletempo
+ *****************************************************************************
+ * Copyright © 2008-2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SCALETEMPO_KERNELS_H
+#define VLC_SCALETEMPO_KERNELS_H
+
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+#endif
+
+/* The SIMD versions must match the C ones, but for the rounding of the sums:
+ * the dot product is accumulated in a different order */
+static float corr_c( const float *ppc, const float *ps, unsigned n )
+{
+    float corr = 0;
+    for( unsigned i = 0; i < n; i++ )
+        corr += ppc[i] * ps[i];
+    return corr;
+}
+
+static void blend_c( float *pout, const float *po, const float *pb,
+                     const float *pin, unsigned n )
+{
+    for( unsigned i = 0; i < n; i++ )
+        pout[i] = po[i] - pb[i] * ( po[i] - pin[i] );
+}
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+static float corr_sse2( const float *ppc, const float *ps, unsigned n )
+{
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+    unsigned i = 0;
+    for( ; i + 8 <= n; i += 8 ) {
+        sum0 = _mm_add_ps( sum0, _mm_mul_ps( _mm_loadu_ps( ppc + i ),
+                                             _mm_loadu_ps( ps + i ) ) );
+        sum1 = _mm_add_ps( sum1, _mm_mul_ps( _mm_loadu_ps( ppc + i + 4 ),
+                                             _mm_loadu_ps( ps + i + 4 ) ) );
+    }
+    sum0 = _mm_add_ps( sum0, sum1 );
+    sum0 = _mm_add_ps( sum0, _mm_movehl_ps( sum0, sum0 ) );
+    sum0 = _mm_add_ss( sum0, _mm_shuffle_ps( sum0, sum0, 1 ) );
+    return _mm_cvtss_f32( sum0 ) + corr_c( ppc + i, ps + i, n - i );
+}
+
+static void blend_sse2( float *pout, const float *po, const float *pb,
+                        const float *pin, unsigned n )
+{
+    unsigned i = 0;
+    for( ; i + 4 <= n; i += 4 ) {
+        __m128 o = _mm_loadu_ps( po + i );
+        __m128 d = _mm_sub_ps( o, _mm_loadu_ps( pin + i ) );
+        _mm_storeu_ps( pout + i,
+                       _mm_sub_ps( o, _mm_mul_ps( _mm_loadu_ps( pb + i ), d ) ) );
+    }
+    blend_c( pout + i, po + i, pb + i, pin + i, n - i );
+}
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+VLC_AVX2
+static float corr_avx2( const float *ppc, const float *ps, unsigned n )
+{
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+    unsigned i = 0;
+    for( ; i + 16 <= n; i += 16 ) {
+        sum0 = _mm256_add_ps( sum0, _mm256_mul_ps( _mm256_loadu_ps( ppc + i ),
+                                                   _mm256_loadu_ps( ps + i ) ) );
+        sum1 = _mm256_add_ps( sum1, _mm256_mul_ps( _mm256_loadu_ps( ppc + i + 8 ),
+                                                   _mm256_loadu_ps( ps + i + 8 ) ) );
+    }
+    sum0 = _mm256_add_ps( sum0, sum1 );
+    __m128 sum = _mm_add_ps( _mm256_castps256_ps128( sum0 ),
+                             _mm256_extractf128_ps( sum0, 1 ) );
+    sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+    sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+    return _mm_cvtss_f32( sum ) + corr_c( ppc + i, ps + i, n - i );
+}
+
+VLC_AVX2
+static void blend_avx2( float *pout, const float *po, const float *pb,
+                        const float *pin, unsigned n )
+{
+    unsigned i = 0;
+    for( ; i + 8 <= n; i += 8 ) {
+        __m256 o = _mm256_loadu_ps( po + i );
+        __m256 d = _mm256_sub_ps( o, _mm256_loadu_ps( pin + i ) );
+        _mm256_storeu_ps( pout + i, _mm256_sub_ps( o,
+                          _mm256_mul_ps( _mm256_loadu_ps( pb + i ), d ) ) );
+    }
+    blend_c( pout + i, po + i, pb + i, pin + i, n - i );
+}
+#endif
+
+#ifdef __ARM_NEON
+static float corr_neon( const float *ppc, const float *ps, unsigned n )
+{
+    float32x4_t sum0 = vdupq_n_f32( 0.f ), sum1 = vdupq_n_f32( 0.f );
+    unsigned i = 0;
+    for( ; i + 8 <= n; i += 8 ) {
+        sum0 = vmlaq_f32( sum0, vld1q_f32( ppc + i ), vld1q_f32( ps + i ) );
+        sum1 = vmlaq_f32( sum1, vld1q_f32( ppc + i + 4 ),
+                          vld1q_f32( ps + i + 4 ) );
+    }
+    sum0 = vaddq_f32( sum0, sum1 );
+    float32x2_t sum = vadd_f32( vget_low_f32( sum0 ), vget_high_f32( sum0 ) );
+    sum = vpadd_f32( sum, sum );
+    return vget_lane_f32( sum, 0 ) + corr_c( ppc + i, ps + i, n - i );
+}
+
+static void blend_neon( float *pout, const float *po, const float *pb,
+                        const float *pin, unsigned n )
+{
+    unsigned i = 0;
+    for( ; i + 4 <= n; i += 4 ) {
+        float32x4_t o = vld1q_f32( po + i );
+        float32x4_t d = vsubq_f32( o, vld1q_f32( pin + i ) );
+        vst1q_f32( pout + i, vmlsq_f32( o, vld1q_f32( pb + i ), d ) );
+    }
+    blend_c( pout + i, po + i, pb + i, pin + i, n - i );
+}
+#endif
+
+#endif
@@ -33,6 +33,10 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
+#include <vlc_cpu.h>
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
 
 /*****************************************************************************
  * Local prototypes
@@ -79,6 +83,57 @@ static void FilterFL64( audio_volume_t *p_volume, block_t *p_buffer,
     (void) p_volume;
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+VLC_AVX
+static void FilterFL32_AVX( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    if( f_multiplier == 1.f )
+        return; /* nothing to do */
+
+    float *p = (float *)p_buffer->p_buffer;
+    size_t i_count = p_buffer->i_buffer / sizeof(*p);
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+
+    for( ; i_count >= 32; i_count -= 32, p += 32 )
+    {
+        _mm256_storeu_ps( p,      _mm256_mul_ps( _mm256_loadu_ps( p ), mult ) );
+        _mm256_storeu_ps( p + 8,  _mm256_mul_ps( _mm256_loadu_ps( p + 8 ), mult ) );
+        _mm256_storeu_ps( p + 16, _mm256_mul_ps( _mm256_loadu_ps( p + 16 ), mult ) );
+        _mm256_storeu_ps( p + 24, _mm256_mul_ps( _mm256_loadu_ps( p + 24 ), mult ) );
+    }
+    for( ; i_count > 0; i_count-- )
+        *(p++) *= f_multiplier;
+
+    (void) p_volume;
+}
+
+VLC_AVX
+static void FilterFL64_AVX( audio_volume_t *p_volume, block_t *p_buffer,
+                            float f_multiplier )
+{
+    double *p = (double *)p_buffer->p_buffer;
+    size_t i_count = p_buffer->i_buffer / sizeof(*p);
+    double mult = f_multiplier;
+    if( mult == 1. )
+        return; /* nothing to do */
+
+    const __m256d vmult = _mm256_set1_pd( mult );
+
+    for( ; i_count >= 16; i_count -= 16, p += 16 )
+    {
+        _mm256_storeu_pd( p,      _mm256_mul_pd( _mm256_loadu_pd( p ), vmult ) );
+        _mm256_storeu_pd( p + 4,  _mm256_mul_pd( _mm256_loadu_pd( p + 4 ), vmult ) );
+        _mm256_storeu_pd( p + 8,  _mm256_mul_pd( _mm256_loadu_pd( p + 8 ), vmult ) );
+        _mm256_storeu_pd( p + 12, _mm256_mul_pd( _mm256_loadu_pd( p + 12 ), vmult ) );
+    }
+    for( ; i_count > 0; i_count-- )
+        *(p++) *= mult;
+
+    (void) p_volume;
+}
+#endif
+
 /**
  * Initializes the mixer
  */
@@ -90,9 +145,17 @@ static int Create( vlc_object_t *p_this )
     {
         case VLC_CODEC_FL32:
             p_volume->amplify = FilterFL32;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( vlc_CPU_AVX() )
+                p_volume->amplify = FilterFL32_AVX;
+#endif
             break;
         case VLC_CODEC_FL64:
             p_volume->amplify = FilterFL64;
+#ifdef HAVE_AVX2_INTRINSICS
+            if( vlc_CPU_AVX() )
+                p_volume->amplify = FilterFL64_AVX;
+#endif
             break;
         default:
             return -1;
@@ -941,6 +941,7 @@ AbstractBufferingLogic *PlaylistManager::createBufferingLogic() const
         v = var_InheritInteger(p_demux, "adaptive-maxbuffer");
         if(v)
             bl->setUserMaxBuffering(VLC_TICK_FROM_MS(v));
+        bl->setUserPrefetch(var_InheritInteger(p_demux, "adaptive-prefetch"));
     }
     return bl;
 }
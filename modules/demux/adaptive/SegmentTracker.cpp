@@ -250,7 +250,7 @@ bool SegmentTracker::ChunkEntry::isValid() const
 }
 
 SegmentTracker::ChunkEntry
-SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
+SegmentTracker::prepareChunk(BaseRepresentation *switchrep, Position pos) const
 {
     if(!adaptationSet)
         return ChunkEntry();
@@ -265,13 +265,13 @@ SegmentTracker::prepareChunk(bool switch_allowed, Position pos) const
     else /* continuing, or seek */
     {
         if(!adaptationSet->isSegmentAligned() || !pos.init_sent || !pos.index_sent)
-            switch_allowed = false;
+            switchrep = nullptr;
 
-        if(switch_allowed)
+        if(switchrep)
         {
             Position temp;
-            temp.rep = logic->getNextRepresentation(adaptationSet, pos.rep);
-            if(temp.rep && temp.rep != pos.rep)
+            temp.rep = switchrep;
+            if(temp.rep != pos.rep)
             {
                 /* Convert our segment number if we need to */
                 temp.number = temp.rep->translateSegmentNumber(pos.number, pos.rep);
@@ -344,14 +344,60 @@ void SegmentTracker::resetChunksSequence()
     }
 }
 
+void SegmentTracker::prefetchChunks()
+{
+    const unsigned prefetch = bufferingLogic ? bufferingLogic->getPrefetch() : 0;
+    const bool b_live = adaptationSet->getPlaylist()->isLive();
+
+    Position pos = next;
+    if(!chunkssequence.empty())
+    {
+        pos = chunkssequence.back().pos;
+        ++pos;
+    }
+
+    /* Creating the chunks starts their download. Only prefetch media
+     * segments of the current representation that are already available */
+    while(chunkssequence.size() < prefetch)
+    {
+        if(!pos.isValid() || !pos.init_sent || !pos.index_sent)
+            break;
+
+        if(b_live && (pos.number == 0 || pos.rep->getMinAheadTime(pos.number - 1) == 0))
+            break;
+
+        ChunkEntry chunk = prepareChunk(nullptr, pos);
+        if(!chunk.isValid() || chunk.pos.rep != pos.rep ||
+           chunk.pos.number != pos.number)
+        {
+            delete chunk.chunk;
+            break;
+        }
+
+        chunkssequence.push_back(chunk);
+        ++pos;
+    }
+}
+
 ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
 {
     if(!adaptationSet || !next.isValid())
         return nullptr;
 
+    /* The logic is asked once per chunk. Prefetched chunks are dropped if
+     * it now selects another representation */
+    BaseRepresentation *switchrep = nullptr;
+    if(switch_allowed && adaptationSet->isSegmentAligned() &&
+       next.init_sent && next.index_sent)
+        switchrep = logic->getNextRepresentation(adaptationSet, next.rep);
+
+    if(switchrep && !chunkssequence.empty() &&
+       switchrep != chunkssequence.front().pos.rep)
+        resetChunksSequence();
+
     if(chunkssequence.empty())
     {
-        ChunkEntry chunk = prepareChunk(switch_allowed, next);
+        ChunkEntry chunk = prepareChunk(switchrep, next);
         chunkssequence.push_back(chunk);
     }
 
@@ -436,7 +482,10 @@ ChunkInterface * SegmentTracker::getNextChunk(bool switch_allowed)
                                chunk.starttime, chunk.duration, chunk.displaytime));
 
     if(!b_gap)
+    {
         ++next;
+        prefetchChunks();
+    }
 
     return returnedChunk;
 }
@@ -256,7 +256,8 @@ namespace adaptive
                     vlc_tick_t duration;
             };
             std::list<ChunkEntry> chunkssequence;
-            ChunkEntry prepareChunk(bool switch_allowed, Position pos) const;
+            ChunkEntry prepareChunk(BaseRepresentation *switchrep, Position pos) const;
+            void prefetchChunks();
             void resetChunksSequence();
             void setAdaptationLogic(AbstractAdaptationLogic *);
             void notify(const TrackerEvent &) const;
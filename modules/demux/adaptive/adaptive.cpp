@@ -84,6 +84,14 @@ static void Close   (vlc_object_t *);
 #define ADAPT_LOWLATENCY_TEXT N_("Low latency")
 #define ADAPT_LOWLATENCY_LONGTEXT N_("Overrides low latency parameters")
 
+#define ADAPT_MAXDOWNLOADS_TEXT N_("Concurrent segment downloads")
+#define ADAPT_MAXDOWNLOADS_LONGTEXT N_("Maximum number of segments downloaded " \
+    "at the same time, for all streams")
+
+#define ADAPT_PREFETCH_TEXT N_("Segments prefetched")
+#define ADAPT_PREFETCH_LONGTEXT N_("Number of next segments requested ahead " \
+    "for each stream")
+
 static const AbstractAdaptationLogic::LogicType pi_logics[] = {
                                 AbstractAdaptationLogic::LogicType::Default,
                                 AbstractAdaptationLogic::LogicType::Predictive,
@@ -143,6 +151,12 @@ vlc_module_begin ()
                      ADAPT_MAXBUFFER_TEXT, nullptr )
         add_integer( "adaptive-lowlatency", -1, ADAPT_LOWLATENCY_TEXT, ADAPT_LOWLATENCY_LONGTEXT )
             change_integer_list(rgi_latency, ppsz_latency)
+        add_integer( "adaptive-maxdownloads", 4,
+                     ADAPT_MAXDOWNLOADS_TEXT, ADAPT_MAXDOWNLOADS_LONGTEXT )
+            change_integer_range( 1, 16 )
+        add_integer( "adaptive-prefetch", 1,
+                     ADAPT_PREFETCH_TEXT, ADAPT_PREFETCH_LONGTEXT )
+            change_integer_range( 0, 8 )
         set_callbacks( Open, Close )
 vlc_module_end ()
 
@@ -29,22 +29,21 @@
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned maxdownloads_)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
-    cancel_current = false;
+    maxdownloads = maxdownloads_ ? maxdownloads_ : 1;
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread, static_cast<void *>(this)))
+    while(thread_handles.size() < maxdownloads)
     {
-        return false;
+        vlc_thread_t th;
+        if(vlc_clone(&th, downloaderThread, static_cast<void *>(this)))
+            return !thread_handles.empty();
+        thread_handles.push_back(th);
     }
-    thread_handle_valid = true;
     return true;
 }
 
@@ -52,15 +51,15 @@ Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(vlc_thread_t th : thread_handles)
+        vlc_join(th, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -74,9 +73,9 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (current.count(source))
     {
-        cancel_current = true;
+        cancelled.insert(source);
         updated_cond.wait(lock);
     }
 
@@ -95,13 +94,23 @@ void * Downloader::downloaderThread(void *opaque)
     return nullptr;
 }
 
+HTTPChunkBufferedSource * Downloader::getNextSource() const
+{
+    /* Oldest scheduled chunk not already downloaded by another thread */
+    for(HTTPChunkBufferedSource *source : chunks)
+        if(!current.count(source))
+            return source;
+    return nullptr;
+}
+
 void Downloader::Run()
 {
     while(1)
     {
         lock.lock();
 
-        while(chunks.empty() && !killed)
+        HTTPChunkBufferedSource *source;
+        while(!(source = getNextSource()) && !killed)
             wait_cond.wait(lock);
 
         if(killed)
@@ -110,18 +119,18 @@ void Downloader::Run()
             break;
         }
 
-        current = chunks.front();
+        current.insert(source);
         lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone() || cancel_current)
+        current.erase(source);
+        const bool b_cancelled = cancelled.erase(source);
+        if(source->isDone() || b_cancelled)
         {
-            chunks.pop_front();
-            current->release();
+            chunks.remove(source);
+            source->release();
         }
-        cancel_current = false;
-        current = nullptr;
-        updated_cond.signal();
+        updated_cond.broadcast();
         lock.unlock();
     }
 }
@@ -26,6 +26,8 @@
 #include <vlc_threads.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <set>
+#include <vector>
 
 namespace adaptive
 {
@@ -36,7 +38,7 @@ namespace adaptive
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 Downloader(Downloader&&) = delete;
                 Downloader& operator=(const Downloader&) = delete;
@@ -49,15 +51,16 @@ namespace adaptive
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                HTTPChunkBufferedSource * getNextSource() const;
+                std::vector<vlc_thread_t> thread_handles;
+                unsigned     maxdownloads;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
-                bool         cancel_current;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::set<HTTPChunkBufferedSource *> current;
+                std::set<HTTPChunkBufferedSource *> cancelled;
         };
 
     }
@@ -88,17 +88,15 @@ const ConnectionParams & AbstractConnection::getRedirection() const
 class adaptive::http::LibVLCHTTPSource : public adaptive::BlockStreamInterface
 {
      public:
-        LibVLCHTTPSource(vlc_object_t *p_object_, struct vlc_http_cookie_jar_t *jar)
+        LibVLCHTTPSource(vlc_object_t *p_object_, struct vlc_http_mgr *http_mgr_)
         {
             p_object = p_object_;
-            http_mgr = vlc_http_mgr_create(p_object, jar);
+            http_mgr = http_mgr_;
             http_res = nullptr;
             totalRead = 0;
         }
         virtual ~LibVLCHTTPSource()
         {
-            if(http_mgr)
-                vlc_http_mgr_destroy(http_mgr);
         }
         block_t *readNextBlock() override
         {
@@ -187,7 +185,7 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::BlockStreamInterface
         vlc_object_t *p_object;
         static const struct vlc_http_resource_cbs callbacks;
         size_t totalRead;
-        struct vlc_http_mgr *http_mgr;
+        struct vlc_http_mgr *http_mgr; /* owned by the connection factory */
         BytesRange range;
         struct vlc_http_resource *http_res;
         std::optional<std::string> username;
@@ -236,7 +234,8 @@ class adaptive::http::LibVLCHTTPSource : public adaptive::BlockStreamInterface
             tpl->source = this;
             this->range = range;
             this->lastparams = params;
-            if (vlc_http_res_init(&tpl->resource, &this->callbacks, http_mgr,
+            if (vlc_http_res_init(&tpl->resource, &this->callbacks,
+                                  http_mgr,
                                   params.getUrl().c_str(),
                                   ua.empty() ? nullptr : ua.c_str(),
                                   ref.empty() ? nullptr : ref.c_str()))
@@ -348,10 +347,11 @@ const struct vlc_http_resource_cbs LibVLCHTTPSource::callbacks =
     LibVLCHTTPSource::validateresponse_handler,
 };
 
-LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_, AuthStorage *auth)
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           struct vlc_http_mgr *http_mgr)
     : AbstractConnection( p_object_ )
 {
-    source = new adaptive::http::LibVLCHTTPSource(p_object_, auth->getJar());
+    source = new adaptive::http::LibVLCHTTPSource(p_object_, http_mgr);
     sourceStream = new ChunksSourceStream(p_object, source);
     stream = nullptr;
     char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
@@ -600,13 +600,36 @@ LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( AuthStorage *auth )
     authStorage = auth;
 }
 
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    for(auto &it : sharedmgrs)
+        vlc_http_mgr_destroy(it.second);
+}
+
 AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
                                                                   const ConnectionParams &params)
 {
     if((params.getScheme() != "http" && params.getScheme() != "https") ||
        params.getHostname().empty())
         return nullptr;
-    return new LibVLCHTTPConnection(p_object, authStorage);
+
+    /* A manager only holds either HTTP or HTTPS connections */
+    struct vlc_http_mgr *shared_mgr;
+    const std::string origin = params.getScheme() + "://" +
+                               params.getHostname() + ":" +
+                               std::to_string(params.getPort());
+    auto it = sharedmgrs.find(origin);
+    if(it != sharedmgrs.end())
+    {
+        shared_mgr = it->second;
+    }
+    else
+    {
+        shared_mgr = vlc_http_mgr_create(p_object, authStorage->getJar());
+        if(shared_mgr)
+            sharedmgrs.insert(std::make_pair(origin, shared_mgr));
+    }
+    return new LibVLCHTTPConnection(p_object, shared_mgr);
 }
 
 StreamUrlConnectionFactory::StreamUrlConnectionFactory()
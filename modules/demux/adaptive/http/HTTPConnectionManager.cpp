@@ -42,6 +42,7 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = nullptr;
+    vlc_mutex_init(&rateLock);
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
@@ -52,6 +53,8 @@ AbstractConnectionManager::~AbstractConnectionManager()
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size,
                                                    vlc_tick_t time, vlc_tick_t latency)
 {
+    /* Segments can be downloaded from several threads */
+    vlc_mutex_locker locker(&rateLock);
     if(rateObserver)
     {
         BwDebug(msg_Dbg(p_object,
@@ -64,6 +67,7 @@ void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid,
 
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
+    vlc_mutex_locker locker(&rateLock);
     rateObserver = obs;
 }
 
@@ -72,12 +76,13 @@ void AbstractConnectionManager::deleteSource(AbstractChunkSource *source)
     delete source;
 }
 
-HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
+HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_,
+                                                 unsigned maxdownloads)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new Downloader();
+    downloader = new Downloader(maxdownloads);
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
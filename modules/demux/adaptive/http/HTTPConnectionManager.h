@@ -75,12 +75,14 @@ namespace adaptive
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                vlc_mutex_t                                         rateLock;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
         {
             public:
-                HTTPConnectionManager           (vlc_object_t *p_object);
+                HTTPConnectionManager           (vlc_object_t *p_object,
+                                                 unsigned maxdownloads = 1);
                 virtual ~HTTPConnectionManager  ();
 
                 void    closeAllConnections ()  override;
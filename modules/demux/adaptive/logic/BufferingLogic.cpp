@@ -46,6 +46,7 @@ AbstractBufferingLogic::AbstractBufferingLogic()
     userMinBuffering = 0;
     userMaxBuffering = 0;
     userLiveDelay = 0;
+    userPrefetch = 0;
 }
 
 void AbstractBufferingLogic::setLowDelay(bool b)
@@ -68,6 +69,16 @@ void AbstractBufferingLogic::setUserLiveDelay(vlc_tick_t v)
     userLiveDelay = v;
 }
 
+void AbstractBufferingLogic::setUserPrefetch(unsigned v)
+{
+    userPrefetch = v;
+}
+
+unsigned AbstractBufferingLogic::getPrefetch() const
+{
+    return userPrefetch;
+}
+
 /* Try to never buffer up to really end */
 /* Enforce no overlap for demuxers segments 3.0.0 */
 /* FIXME: check duration instead ? */
@@ -114,7 +114,7 @@ class DummyChunkSource : public AbstractChunkSource
 class DummyConnectionManager : public AbstractConnectionManager
 {
     public:
-        DummyConnectionManager() : AbstractConnectionManager(nullptr) {}
+        DummyConnectionManager() : AbstractConnectionManager(nullptr), sources(0) {}
         virtual ~DummyConnectionManager() = default;
         void closeAllConnections () override {}
         AbstractConnection * getConnection(ConnectionParams &) override { return nullptr; }
@@ -123,6 +123,7 @@ class DummyConnectionManager : public AbstractConnectionManager
                                         const BytesRange &br) override
         {
             DummyChunkSource *d;
+            ++sources;
             auto it = data.find(uri);
             if(it == data.end())
                 d = new DummyChunkSource(t, br, std::vector<uint8_t>(), uri);
@@ -135,6 +136,7 @@ class DummyConnectionManager : public AbstractConnectionManager
         void cancel(AbstractChunkSource *) override {}
 
         std::map<std::string, std::vector<uint8_t>> data;
+        unsigned sources;
 };
 
 using mapentry = std::pair<std::string, std::vector<uint8_t>>;
@@ -276,7 +278,8 @@ static BaseAdaptationSet *CreatePlaylistPeriodAdaptationSet()
 static int SegmentTracker_check_formats(BaseAdaptationSet *adaptSet,
                                         DummyLogic *,
                                         SegmentTracker *tracker,
-                                        SegmentTrackerListener &events)
+                                        SegmentTrackerListener &events,
+                                        DummyConnectionManager *)
 {
     const stime_t START = 1337;
     Timescale timescale(100);
@@ -369,7 +372,8 @@ static int SegmentTracker_check_formats(BaseAdaptationSet *adaptSet,
 static int SegmentTracker_check_seeks(BaseAdaptationSet *adaptSet,
                                       DummyLogic *,
                                       SegmentTracker *tracker,
-                                      SegmentTrackerListener &events)
+                                      SegmentTrackerListener &events,
+                                      DummyConnectionManager *)
 {
     const stime_t START = 1337;
     Timescale timescale(100);
@@ -466,7 +470,8 @@ static int SegmentTracker_check_seeks(BaseAdaptationSet *adaptSet,
 static int SegmentTracker_check_switches(BaseAdaptationSet *adaptSet,
                                          DummyLogic *logic,
                                          SegmentTracker *tracker,
-                                         SegmentTrackerListener &events)
+                                         SegmentTrackerListener &events,
+                                         DummyConnectionManager *)
 {
     const stime_t START = 1337;
     Timescale timescale(100);
@@ -647,7 +652,8 @@ static int SegmentTracker_check_switches(BaseAdaptationSet *adaptSet,
 static int SegmentTracker_check_HLSseeks(BaseAdaptationSet *adaptSet,
                                          DummyLogic *logic,
                                          SegmentTracker *tracker,
-                                         SegmentTrackerListener &events)
+                                         SegmentTrackerListener &events,
+                                         DummyConnectionManager *)
 {
     const stime_t START = 1337;
     Timescale timescale(100);
@@ -731,9 +737,75 @@ static int SegmentTracker_check_HLSseeks(BaseAdaptationSet *adaptSet,
     return 0;
 }
 
+/****** check segments prefetching ******/
+static unsigned PREFETCH = 2;
+
+static int SegmentTracker_check_prefetch(BaseAdaptationSet *adaptSet,
+                                         DummyLogic *,
+                                         SegmentTracker *tracker,
+                                         SegmentTrackerListener &events,
+                                         DummyConnectionManager *connManager)
+{
+    const stime_t START = 1337;
+    Timescale timescale(100);
+
+    ChunkInterface *currentChunk = nullptr;
+    try
+    {
+        DummyRepresentation *rep0 = new DummyRepresentation(adaptSet);
+        adaptSet->addRepresentation(rep0);
+        rep0->setID(ID("0"));
+
+        SegmentList *segmentList = nullptr;
+        try
+        {
+            segmentList = new SegmentList(rep0);
+            segmentList->addAttribute(new TimescaleAttr(timescale));
+            for(int i=0; i<5; i++)
+            {
+                Segment *seg = new Segment(rep0);
+                seg->setSequenceNumber(123 + i);
+                seg->setDiscontinuitySequenceNumber(456);
+                seg->startTime = START + 100 * i;
+                seg->duration = 100;
+                seg->setSourceUrl("sample/aac");
+                segmentList->addSegment(seg);
+            }
+        } catch (...) {
+            delete segmentList;
+            std::rethrow_exception(std::current_exception());
+        }
+        rep0->addAttribute(segmentList);
+
+        /* next segments are requested with the current one */
+        Expect(tracker->setStartPosition() == true);
+        for(int i=0; i<5; i++)
+        {
+            events.reset();
+            currentChunk = tracker->getNextChunk(true);
+            Expect(currentChunk);
+            Expect(events.occured(TrackerEvent::Type::SegmentGap) == false);
+            Expect(events.segmentchanged.starttime == timescale.ToTime(START + 100 * i) + VLC_TICK_0);
+            Expect(connManager->sources == std::min(i + 1 + PREFETCH, 5u));
+            delete currentChunk;
+            currentChunk = nullptr;
+        }
+
+        currentChunk = tracker->getNextChunk(true);
+        Expect(currentChunk == nullptr);
+        Expect(connManager->sources == 5);
+
+    } catch( ... ) {
+        delete currentChunk;
+        return 1;
+    }
+
+    return 0;
+}
+
 typedef decltype(SegmentTracker_check_formats) testfunc;
 
-static int Prepare_test(testfunc func)
+static int Prepare_test(testfunc func, unsigned prefetch = 0)
 {
     DummyConnectionManager *connManager = nullptr;
     try
@@ -747,6 +819,7 @@ static int Prepare_test(testfunc func)
 
     SharedResources sharedRes(nullptr, nullptr, connManager);
     DefaultBufferingLogic bufLogic;
+    bufLogic.setUserPrefetch(prefetch);
     SynchronizationReferences syncRefs;
 
     BaseAdaptationSet *adaptSet = CreatePlaylistPeriodAdaptationSet();
@@ -770,7 +843,7 @@ static int Prepare_test(testfunc func)
     SegmentTrackerListener events;
     tracker->registerListener(&events);
 
-    int ret = func(adaptSet, logic, tracker, events);
+    int ret = func(adaptSet, logic, tracker, events, connManager);
 
     delete tracker;
     delete logic;
@@ -786,5 +859,11 @@ int SegmentTracker_test()
         Prepare_test(SegmentTracker_check_seeks) ||
         Prepare_test(SegmentTracker_check_switches) ||
         Prepare_test(SegmentTracker_check_HLSseeks) ||
+        /* prefetching must not change the chunks sequence */
+        Prepare_test(SegmentTracker_check_formats, PREFETCH) ||
+        Prepare_test(SegmentTracker_check_seeks, PREFETCH) ||
+        Prepare_test(SegmentTracker_check_switches, PREFETCH) ||
+        Prepare_test(SegmentTracker_check_HLSseeks, PREFETCH) ||
+        Prepare_test(SegmentTracker_check_prefetch, PREFETCH) ||
         0;
 }
@@ -0,0 +1,171 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/HTTPConnectionManager.h"
+#include "../../http/HTTPConnection.hpp"
+#include "../../http/Chunk.h"
+#include "../../ID.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+#include <vlc_threads.h>
+
+#include <cstring>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::http;
+
+#define LATENCY      VLC_TICK_FROM_MS(20)
+#define SLOW_LATENCY (8 * LATENCY)
+#define SEGMENT_SIZE (2 * HTTPChunkSource::CHUNK_SIZE)
+#define SEGMENTS     4
+
+/* Stands for an HTTP server on a high latency link */
+class LatencyConnection : public AbstractConnection
+{
+    public:
+        LatencyConnection() : AbstractConnection(nullptr) {}
+        virtual ~LatencyConnection() = default;
+
+        bool canReuse(const ConnectionParams &) const override
+        {
+            return available;
+        }
+
+        RequestStatus request(const std::string &path,
+                              const BytesRange &) override
+        {
+            const vlc_tick_t latency = path.find("slow") != std::string::npos
+                                     ? SLOW_LATENCY : LATENCY;
+            vlc_tick_sleep(latency);
+            contentLength = SEGMENT_SIZE;
+            bytesRead = 0;
+            return RequestStatus::Success;
+        }
+
+        ssize_t read(void *p_buffer, size_t len) override
+        {
+            if(len > contentLength - bytesRead)
+                len = contentLength - bytesRead;
+            std::memset(p_buffer, 0x47, len);
+            bytesRead += len;
+            return len;
+        }
+
+        void setUsed(bool b) override
+        {
+            available = !b;
+        }
+};
+
+class LatencyConnectionFactory : public AbstractConnectionFactory
+{
+    public:
+        AbstractConnection * createConnection(vlc_object_t *,
+                                              const ConnectionParams &) override
+        {
+            return new LatencyConnection();
+        }
+};
+
+struct StreamReader
+{
+    std::vector<HTTPChunk *> chunks;
+    vlc_tick_t start;
+    vlc_tick_t buffered[SEGMENTS]; /* time each segment was fully available */
+};
+
+static void *Read(void *data)
+{
+    StreamReader *reader = static_cast<StreamReader *>(data);
+
+    for(size_t i = 0; i < reader->chunks.size(); i++)
+    {
+        block_t *block = reader->chunks[i]->read(SEGMENT_SIZE);
+        reader->buffered[i] = vlc_tick_now() - reader->start;
+        if(block)
+            block_Release(block);
+    }
+    return nullptr;
+}
+
+/* Returns the number of segments available once the slow one is */
+static unsigned Buffering(unsigned maxdownloads)
+{
+    HTTPConnectionManager manager(nullptr, maxdownloads);
+    manager.addFactory(new LatencyConnectionFactory());
+
+    /* the first video segment is slow to come */
+    StreamReader readers[2];
+    const vlc_tick_t start = vlc_tick_now();
+    for(unsigned i = 0; i < SEGMENTS; i++)
+    {
+        for(unsigned j = 0; j < 2; j++)
+        {
+            std::string url = std::string("http://localhost/") +
+                              (j ? "video" : "audio") + std::to_string(i) +
+                              ((j && !i) ? "slow" : "");
+            readers[j].chunks.push_back(new HTTPChunk(url, &manager, ID(url),
+                                                      ChunkType::Segment,
+                                                      BytesRange()));
+            readers[j].start = start;
+        }
+    }
+
+    vlc_thread_t threads[2];
+    for(unsigned j = 0; j < 2; j++)
+        Expect(vlc_clone(&threads[j], Read, &readers[j]) == 0);
+    for(unsigned j = 0; j < 2; j++)
+        vlc_join(threads[j], nullptr);
+
+    /* segments read right after the slow one were already downloaded */
+    const vlc_tick_t slow = readers[1].buffered[0];
+    unsigned count = 0;
+    for(unsigned j = 0; j < 2; j++)
+    {
+        for(unsigned i = 0; i < SEGMENTS; i++)
+            if(readers[j].buffered[i] <= slow + LATENCY / 2)
+                count++;
+        for(HTTPChunk *chunk : readers[j].chunks)
+            delete chunk;
+    }
+
+    return count;
+}
+
+int Downloader_test()
+{
+    try
+    {
+        const unsigned sequential = Buffering(1);
+        const unsigned parallel = Buffering(4);
+        /* the slow segment does not hold the other downloads back */
+        Expect(parallel > sequential);
+    } catch (...) {
+        return 1;
+    }
+
+    return 0;
+}
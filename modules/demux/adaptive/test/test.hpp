@@ -49,5 +49,6 @@ int CommandsQueue_test();
 int BufferingLogic_test();
 int FakeEsOut_test();
 int SegmentTracker_test();
+int Downloader_test();
 
 #endif
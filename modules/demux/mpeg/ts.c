@@ -39,7 +39,9 @@
 #include "ts_streams.h"
 #include "ts_streams_private.h"
 #include "ts_packet.h"
+#include "ts_chunk.h"
 #include "ts_pes.h"
+#include "ts_workers.h"
 #include "ts_psi.h"
 #include "ts_si.h"
 #include "ts_psip.h"
@@ -132,6 +134,18 @@ static const char *const ts_standards_list[] =
 static const char *const ts_standards_list_text[] =
   { N_("Auto"), "MPEG", "DVB", "ARIB", "ATSC", "T-DMB" };
 
+#define READ_BATCH_TEXT N_("Packets per read")
+#define READ_BATCH_LONGTEXT N_( \
+    "Number of TS packets fetched from the stream at once and demuxed " \
+    "without further copy. 0 selects automatically (batching on local " \
+    "seekable inputs only), 1 reads packets one by one." )
+
+#define THREADS_TEXT N_("PES threads")
+#define THREADS_LONGTEXT N_( \
+    "Number of threads gathering the PES packets and sending them to the " \
+    "elementary streams, each program being handled by one of them. " \
+    "0 does all the demuxing in the input thread." )
+
 #define STANDARD_TEXT N_("Digital TV Standard")
 #define STANDARD_LONGTEXT N_( "Selects mode for digital TV standard. " \
                               "This feature affects EPG information and subtitles." )
@@ -164,6 +178,10 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL )
+    add_integer_with_range( "ts-read-batch", 0, 0, TS_CHUNK_MAX_PACKETS,
+                            READ_BATCH_TEXT, READ_BATCH_LONGTEXT )
+    add_integer_with_range( "ts-threads", 0, 0, TS_WORKERS_MAX,
+                            THREADS_TEXT, THREADS_LONGTEXT )
 
     set_capability( "demux", 10 )
     set_callbacks( Open, Close )
@@ -187,9 +205,14 @@ static void UpdatePIDScrambledState( demux_t *p_demux, ts_pid_t *p_pid, bool );
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int * );
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
+static bool GatherPESPacket( demux_t *p_demux, const ts_workers_packet_t * );
+static void SyncProgramWorkers( demux_t *p_demux, const ts_pmt_t * );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, vlc_tick_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void FlushPendingTSPackets( demux_sys_t *p_sys );
+static uint64_t TsStreamTell( demux_sys_t *p_sys );
+static int TsStreamSeek( demux_sys_t *p_sys, uint64_t i_pos );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, vlc_tick_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, ts_90khz_t );
@@ -529,11 +552,31 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    /* Reading ahead would delay live streams packets, only batch on
+     * local inputs unless explicitly requested */
+    p_sys->chunk.i_packets = var_InheritInteger( p_demux, "ts-read-batch" );
+    if( p_sys->chunk.i_packets == 0 )
+        p_sys->chunk.i_packets = ( p_sys->b_canfastseek && !p_sys->b_lowdelay )
+                               ? 4 * p_sys->i_ts_read : 1;
+    p_sys->chunk.p_pending = NULL;
+    p_sys->chunk.i_pending = 0;
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
         p_sys->es_creation = CREATE_ES;
 
+    int64_t i_workers = var_InheritInteger( p_demux, "ts-threads" );
+    if( i_workers > 0 && !p_demux->b_preparsing )
+    {
+        i_workers = __MIN( i_workers, TS_WORKERS_MAX );
+        p_sys->p_workers = ts_workers_New( p_demux, i_workers, GatherPESPacket );
+        if( p_sys->p_workers )
+            msg_Dbg( p_demux, "gathering PES on %"PRId64" threads", i_workers );
+        else
+            msg_Warn( p_demux, "cannot create the PES threads" );
+    }
+
     /* Preparse time */
     if( p_demux->b_preparsing && p_sys->b_canseek )
     {
@@ -559,6 +602,11 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->p_workers )
+        ts_workers_Delete( p_sys->p_workers );
+
+    FlushPendingTSPackets( p_sys );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -640,6 +688,8 @@ static int Demux( demux_t *p_demux )
         block_t     *p_pkt;
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
+            if( p_sys->p_workers )
+                ts_workers_Drain( p_sys->p_workers );
             return VLC_DEMUXER_EOF;
         }
 
@@ -686,6 +736,8 @@ static int Demux( demux_t *p_demux )
         if( !SCRAMBLED(*p_pid) != !(p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED) &&
             ( p_pkt->p_buffer[1] & 0x40 ) ) /* update on payload start */
         {
+            if( p_sys->p_workers )
+                ts_workers_Drain( p_sys->p_workers );
             UpdatePIDScrambledState( p_demux, p_pid, p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED );
         }
 
@@ -717,6 +769,8 @@ static int Demux( demux_t *p_demux )
             if( p_sys->es_creation == DELAY_ES ) /* No longer delay ES since that pid's program sends data */
             {
                 msg_Dbg( p_demux, "Creating delayed ES" );
+                if( p_sys->p_workers )
+                    ts_workers_Drain( p_sys->p_workers );
                 AddAndCreateES( p_demux, p_pid, true );
                 UpdatePESFilters( p_demux, p_sys->seltype == PROGRAM_ALL );
             }
@@ -905,6 +959,10 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     const ts_pmt_t *p_pmt = NULL;
     const ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
 
+    /* The PES threads must be idle before the controls touch the state */
+    if( p_sys->p_workers )
+        ts_workers_Drain( p_sys->p_workers );
+
     for( int i=0; i<p_pat->programs.i_size && !p_pmt; i++ )
     {
         if( p_pat->programs.p_elems[i]->u.p_pmt->b_selected )
@@ -957,7 +1015,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( vlc_stream_GetSize( p_sys->stream, &u64 ) == VLC_SUCCESS )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TsStreamTell( p_sys );
             *pf = (double)offset / (double)u64;
             return VLC_SUCCESS;
         }
@@ -1003,7 +1061,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         }
 
         if( vlc_stream_GetSize( p_sys->stream, &u64 ) == VLC_SUCCESS &&
-            vlc_stream_Seek( p_sys->stream, (uint64_t)(u64 * f) ) == VLC_SUCCESS )
+            TsStreamSeek( p_sys, (uint64_t)(u64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1153,9 +1211,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        FlushPendingTSPackets( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        FlushPendingTSPackets( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1833,15 +1893,55 @@ static bool CheckAndResync( demux_t *p_demux )
     return true;
 }
 
+static void FlushPendingTSPackets( demux_sys_t *p_sys )
+{
+    block_ChainRelease( p_sys->chunk.p_pending );
+    p_sys->chunk.p_pending = NULL;
+    p_sys->chunk.i_pending = 0;
+}
+
+/* Stream position of the next packet to demux, not counting read ahead */
+static uint64_t TsStreamTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) -
+           (uint64_t) p_sys->chunk.i_pending * p_sys->i_packet_size;
+}
+
+static int TsStreamSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    FlushPendingTSPackets( p_sys );
+    return vlc_stream_Seek( p_sys->stream, i_pos );
+}
+
 static block_t* ReadTSPacket( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    if( !CheckAndResync( p_demux) )
-        return NULL;
-
     block_t     *p_pkt;
 
+    if( p_sys->chunk.p_pending == NULL )
+    {
+        if( !CheckAndResync( p_demux) )
+            return NULL;
+
+        if( p_sys->chunk.i_packets > 1 )
+            p_sys->chunk.p_pending = ts_chunk_Read( p_sys->stream,
+                                                    p_sys->i_packet_size,
+                                                    p_sys->i_packet_header_size,
+                                                    p_sys->chunk.i_packets,
+                                                    &p_sys->chunk.i_pending );
+    }
+
+    /* Hand out the next packet of the current chunk */
+    if( p_sys->chunk.p_pending )
+    {
+        p_pkt = p_sys->chunk.p_pending;
+        p_sys->chunk.p_pending = p_pkt->p_next;
+        p_sys->chunk.i_pending--;
+        p_pkt->p_next = NULL;
+        return p_pkt;
+    }
+
     /* Get a new TS packet */
     if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
     {
@@ -1972,7 +2072,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_seektime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return TsStreamSeek( p_sys, 0 );
 
     uint64_t i_stream_size;
     if( vlc_stream_GetSize( p_sys->stream, &i_stream_size ) != VLC_SUCCESS )
@@ -1981,7 +2081,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
 
     /* Find the time position by using binary search algorithm. */
     uint64_t i_head_pos = 0;
@@ -1997,7 +2097,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( TsStreamSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -2011,7 +2111,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = TsStreamTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -2059,7 +2159,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, vlc_tick_t i_see
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+        if( TsStreamSeek( p_sys, i_initial_pos ) != VLC_SUCCESS )
             msg_Err( p_demux, "Can't seek back to %" PRIu64, i_initial_pos );
         return VLC_EGENERIC;
     }
@@ -2137,7 +2237,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
                         if( b_end )
                         {
                             p_pmt->i_last_dts = FROM_SCALE(i_pcr);
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == VLC_TICK_INVALID )
@@ -2165,7 +2265,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     uint64_t i_stream_size;
     if( vlc_stream_GetSize( p_sys->stream, &i_stream_size ) != VLC_SUCCESS )
       return VLC_EGENERIC;
@@ -2183,7 +2283,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         if( i_pos > i_stream_size - p_sys->i_packet_size )
           break;
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count =  ProbeChunk( p_demux, i_program, false, &b_found );
@@ -2195,7 +2295,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2204,7 +2304,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = TsStreamTell( p_sys );
     uint64_t i_stream_size;
     if( vlc_stream_GetSize( p_sys->stream, &i_stream_size ) != VLC_SUCCESS )
       return VLC_EGENERIC;
@@ -2226,7 +2326,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         if( i_pos % p_sys->i_packet_size != i_sync_align_offset )
             i_pos = i_pos - (i_pos % p_sys->i_packet_size) + i_sync_align_offset;
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( TsStreamSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count = ProbeChunk( p_demux, i_program, true, &b_found );
@@ -2238,7 +2338,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( TsStreamSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2294,7 +2394,7 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, vlc_tick_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, i_pcr );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TsStreamTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
             {
@@ -2304,7 +2404,7 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, vlc_tick_t i_pcr )
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TsStreamTell( p_sys );
             }
         }
     }
@@ -2426,6 +2526,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, ts_90khz_t i_pcr )
             if( PIDReferencedByProgram( p_pmt, pid->i_pid ) ) /* PCR shall be on pid itself */
             {
                 /* ? update PCR for the whole group program ? */
+                SyncProgramWorkers( p_demux, p_pmt );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
             }
         }
@@ -2435,6 +2536,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, ts_90khz_t i_pcr )
             if( p_pmt->i_pid_pcr == pid->i_pid ) /* If that program references current pid as PCR */
             {
                 /* We've found a target group for update */
+                SyncProgramWorkers( p_demux, p_pmt );
                 PCRCheckDTS( p_demux, p_pmt, FROM_SCALE(i_pcr) );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
             }
@@ -2660,26 +2762,82 @@ static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pk
     return p_pkt;
 }
 
-static bool GatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+static bool GatherPESPacket( demux_t *p_demux, const ts_workers_packet_t *p_packet )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
     ts_pes_parse_callback cb = { .p_obj = VLC_OBJECT(p_demux),
-                                 .priv = p_pid,
+                                 .priv = p_packet->p_pid,
                                  .pf_parse = PESDataChainHandle };
+
+    return ts_pes_Gather( &cb, p_packet->p_pid->u.p_stream,
+                          p_packet->p_pkt, p_packet->b_unit_start,
+                          p_packet->b_valid_scrambling,
+                          p_packet->i_append_pcr );
+}
+
+static bool GatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
     const bool b_unit_start = p_pkt->p_buffer[1]&0x40;
 
     p_pkt->p_buffer += i_skip; /* point to PES */
     p_pkt->i_buffer -= i_skip;
 
     const ts_es_t *p_es = p_pid->u.p_stream->p_es;
-    ts_90khz_t i_append_pcr = ( p_es && p_es->p_program && p_es->p_program->pcr.i_current != VLC_TICK_INVALID )
-                                  ? TO_SCALE(p_es->p_program->pcr.i_current)
-                                  : TS_90KHZ_INVALID;
-
-    return ts_pes_Gather( &cb, p_pid->u.p_stream,
-                          p_pkt, b_unit_start,
-                          p_sys->b_valid_scrambling,
-                          i_append_pcr );
+    const ts_pmt_t *p_pmt = p_es ? p_es->p_program : NULL;
+    const ts_workers_packet_t packet = {
+        .p_pid = p_pid,
+        .p_pkt = p_pkt,
+        .b_unit_start = b_unit_start,
+        .b_valid_scrambling = p_sys->b_valid_scrambling,
+        .i_append_pcr = ( p_pmt && p_pmt->pcr.i_current != VLC_TICK_INVALID )
+                      ? TO_SCALE(p_pmt->pcr.i_current)
+                      : TS_90KHZ_INVALID,
+    };
+
+    if( p_sys->p_workers )
+    {
+        /* Once the PCR of the program is set up, its PES only modify their
+         * stream and program states: gather them on the program thread */
+        if( p_pmt && p_pmt->pcr.b_fix_done && !p_pmt->pcr.b_disable )
+        {
+            ts_workers_Push( p_sys->p_workers, p_pmt->i_number, &packet );
+            return false;
+        }
+        ts_workers_Drain( p_sys->p_workers );
+    }
+
+    return GatherPESPacket( p_demux, &packet );
+}
+
+/* Waits for the threads gathering PES of that program, before its PCR
+ * changes */
+static void SyncProgramWorkers( demux_t *p_demux, const ts_pmt_t *p_pmt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->p_workers )
+        return;
+
+    /* The first PCR is fixed up from the queued blocks of every program */
+    if( p_pmt->pcr.i_current == VLC_TICK_INVALID )
+    {
+        ts_workers_Drain( p_sys->p_workers );
+        return;
+    }
+
+    ts_workers_Sync( p_sys->p_workers, p_pmt->i_number );
+
+    /* Streams shared with other programs are gathered on their threads */
+    for( int i = 0; i < p_pmt->e_streams.i_size; i++ )
+    {
+        const ts_pid_t *p_pid = p_pmt->e_streams.p_elems[i];
+        if( p_pid->type != TYPE_STREAM || !p_pid->u.p_stream->p_es )
+            continue;
+
+        const ts_pmt_t *p_other = p_pid->u.p_stream->p_es->p_program;
+        if( p_other && p_other != p_pmt )
+            ts_workers_Sync( p_sys->p_workers, p_other->i_number );
+    }
 }
 
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
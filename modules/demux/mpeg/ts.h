@@ -26,6 +26,7 @@
     typedef struct arib_instance_t arib_instance_t;
 #endif
 typedef struct csa_t csa_t;
+typedef struct ts_workers_t ts_workers_t;
 
 #define TS_USER_PMT_NUMBER (0)
 
@@ -66,6 +67,17 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* Batched packets reading */
+    struct
+    {
+        unsigned i_packets; /* max packets per stream read, <= 1 disables */
+        block_t *p_pending; /* packets already read, not yet demuxed */
+        unsigned i_pending;
+    } chunk;
+
+    /* PES gathering threads, NULL when done by the demux */
+    ts_workers_t *p_workers;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * ts_chunk.c: Transport Stream batched packets reading
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+#include <vlc_atomic.h>
+
+#include "ts_chunk.h"
+
+#include <assert.h>
+
+typedef struct ts_chunk_t ts_chunk_t;
+
+typedef struct
+{
+    block_t     self;
+    ts_chunk_t *p_chunk;
+} ts_chunk_packet_t;
+
+struct ts_chunk_t
+{
+    atomic_uint       i_refs;
+    block_t          *p_data;
+    ts_chunk_packet_t packets[];
+};
+
+static void ts_chunk_packet_Release( block_t *p_pkt )
+{
+    ts_chunk_packet_t *p = container_of( p_pkt, ts_chunk_packet_t, self );
+    ts_chunk_t *p_chunk = p->p_chunk;
+
+    /* Last packet view gone, release the shared buffer */
+    if( atomic_fetch_sub_explicit( &p_chunk->i_refs, 1,
+                                   memory_order_acq_rel ) == 1 )
+    {
+        block_Release( p_chunk->p_data );
+        free( p_chunk );
+    }
+}
+
+static const struct vlc_block_callbacks ts_chunk_packet_cbs =
+{
+    ts_chunk_packet_Release,
+};
+
+block_t * ts_chunk_Read( stream_t *s, unsigned i_packet_size,
+                         unsigned i_header_size, unsigned i_max_packets,
+                         unsigned *pi_count )
+{
+    assert( i_packet_size > i_header_size );
+
+    if( i_max_packets > TS_CHUNK_MAX_PACKETS )
+        i_max_packets = TS_CHUNK_MAX_PACKETS;
+
+    const uint8_t *p_peek;
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek,
+                                      (size_t) i_packet_size * i_max_packets );
+    if( i_peek < (ssize_t) i_packet_size )
+        return NULL;
+
+    /* Only take the packets up to the first sync loss */
+    const unsigned i_avail = i_peek / i_packet_size;
+    unsigned i_count = 0;
+    while( i_count < i_avail &&
+           p_peek[i_count * i_packet_size + i_header_size] == 0x47 )
+        i_count++;
+    if( i_count == 0 )
+        return NULL;
+
+    ts_chunk_t *p_chunk = malloc( sizeof(*p_chunk) +
+                                  sizeof(p_chunk->packets[0]) * i_count );
+    if( unlikely(p_chunk == NULL) )
+        return NULL;
+
+    block_t *p_data = vlc_stream_Block( s, (size_t) i_packet_size * i_count );
+    if( p_data == NULL || p_data->i_buffer < i_packet_size )
+    {
+        if( p_data )
+            block_Release( p_data );
+        free( p_chunk );
+        return NULL;
+    }
+    i_count = p_data->i_buffer / i_packet_size;
+
+    p_chunk->p_data = p_data;
+    atomic_init( &p_chunk->i_refs, i_count );
+
+    block_t *p_first = NULL;
+    block_t **pp_last = &p_first;
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        ts_chunk_packet_t *p = &p_chunk->packets[i];
+        p->p_chunk = p_chunk;
+        block_Init( &p->self, &ts_chunk_packet_cbs,
+                    &p_data->p_buffer[i * i_packet_size], i_packet_size );
+        /* Skip header (BluRay streams), see ReadTSPacket */
+        p->self.p_buffer += i_header_size;
+        p->self.i_buffer -= i_header_size;
+        *pp_last = &p->self;
+        pp_last = &p->self.p_next;
+    }
+
+    *pi_count = i_count;
+    return p_first;
+}
+
+block_t * ts_chunk_Unread( block_t *p_packets, unsigned i_packet_size,
+                           unsigned i_header_size )
+{
+    size_t i_size = 0;
+    for( block_t *p = p_packets; p; p = p->p_next )
+        i_size += i_packet_size;
+
+    block_t *p_raw = i_size ? block_Alloc( i_size ) : NULL;
+    if( p_raw )
+    {
+        uint8_t *p_dst = p_raw->p_buffer;
+        /* The skipped header is still in front of each packet */
+        for( block_t *p = p_packets; p; p = p->p_next )
+        {
+            memcpy( p_dst, p->p_buffer - i_header_size, i_packet_size );
+            p_dst += i_packet_size;
+        }
+    }
+
+    block_ChainRelease( p_packets );
+    return p_raw;
+}
@@ -0,0 +1,57 @@
+/*****************************************************************************
+ * ts_chunk.h: Transport Stream batched packets reading
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_CHUNK_H
+#define VLC_TS_CHUNK_H
+
+#define TS_CHUNK_MAX_PACKETS 1024
+
+/**
+ * Reads up to i_max_packets synchronized TS packets at once.
+ *
+ * The packets are read with a single stream read into a single buffer,
+ * and returned as a chain of blocks, one per packet, pointing into that
+ * shared buffer (with the i_header_size prefix already skipped).
+ * The buffer is freed once every packet block has been released.
+ *
+ * Reading stops at the first packet with a missing sync byte, so that
+ * the caller can resync from there.
+ *
+ * @param pi_count set to the number of packets in the returned chain
+ * @return a chain of packets, or NULL if no complete synchronized packet
+ * could be read.
+ */
+block_t * ts_chunk_Read( stream_t *s, unsigned i_packet_size,
+                         unsigned i_header_size, unsigned i_max_packets,
+                         unsigned *pi_count );
+
+/**
+ * Turns back packets returned by ts_chunk_Read() into raw stream data.
+ *
+ * The packets, headers included, are copied into a single block, in
+ * order, so that they can be fed again to a stream reader. The packets
+ * are released.
+ *
+ * @return the raw packets data, or NULL if there was no packet or on
+ * allocation failure.
+ */
+block_t * ts_chunk_Unread( block_t *p_packets, unsigned i_packet_size,
+                           unsigned i_header_size );
+
+#endif
@@ -41,6 +41,7 @@
 #include "ts_pid.h"
 #include "ts_streams_private.h"
 #include "ts.h"
+#include "ts_workers.h"
 
 #include "ts_strings.h"
 
@@ -60,6 +61,7 @@
 
 #include "../../access/dtv/en50221_capmt.h"
 #include "ts_streamwrapper.h"
+#include "ts_chunk.h"
 
 #include <assert.h>
 
@@ -104,6 +106,10 @@ static void PATCallBack( void *data, dvbpsi_pat_t *p_dvbpsipat )
 
     msg_Dbg( p_demux, "PATCallBack called" );
 
+    /* Programs and streams are about to change under the PES threads */
+    if( p_sys->p_workers )
+        ts_workers_Drain( p_sys->p_workers );
+
     if(unlikely( GetPID(p_sys, 0)->type != TYPE_PAT ))
     {
         msg_Warn( p_demux, "PATCallBack called on invalid pid" );
@@ -1864,6 +1870,9 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
 
     msg_Dbg( p_demux, "PMTCallBack called for program %d", p_dvbpsipmt->i_program_number );
 
+    if( p_sys->p_workers )
+        ts_workers_Drain( p_sys->p_workers );
+
     if (unlikely(GetPID(p_sys, 0)->type != TYPE_PAT))
     {
         assert(GetPID(p_sys, 0)->type == TYPE_PAT);
@@ -2127,6 +2136,22 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
                 vlc_stream_Delete( wrapper );
                 p_sys->stream = p_demux->s;
             }
+            else
+            {
+                /* Packets read ahead are still scrambled: feed them again
+                 * through the descrambler */
+                if( p_sys->chunk.p_pending )
+                {
+                    ts_stream_wrapper_Prepend( wrapper,
+                        ts_chunk_Unread( p_sys->chunk.p_pending,
+                                         p_sys->i_packet_size,
+                                         p_sys->i_packet_header_size ) );
+                    p_sys->chunk.p_pending = NULL;
+                    p_sys->chunk.i_pending = 0;
+                }
+                /* Don't read ahead of the descrambler */
+                p_sys->chunk.i_packets = 1;
+            }
         }
     }
 
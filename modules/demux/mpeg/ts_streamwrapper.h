@@ -18,43 +18,91 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+#include <assert.h>
+
+typedef struct
+{
+    stream_t *demuxstream;
+    block_t *p_prefix; /* data already read from demuxstream, served first */
+} ts_stream_wrapper_sys_t;
 
 static int ts_stream_wrapper_Control(stream_t *s, int i_query, va_list va)
 {
-    stream_t *demuxstream = s->p_sys;
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    stream_t *demuxstream = p_sys->demuxstream;
     return demuxstream->pf_control(demuxstream, i_query, va);
 }
 
 static ssize_t ts_stream_wrapper_Read(stream_t *s, void *buf, size_t len)
 {
-    stream_t *demuxstream = s->p_sys;
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    if(p_sys->p_prefix)
+    {
+        block_t *p_prefix = p_sys->p_prefix;
+        if(len > p_prefix->i_buffer)
+            len = p_prefix->i_buffer;
+        if(buf)
+            memcpy(buf, p_prefix->p_buffer, len);
+        p_prefix->p_buffer += len;
+        p_prefix->i_buffer -= len;
+        if(p_prefix->i_buffer == 0)
+        {
+            block_Release(p_prefix);
+            p_sys->p_prefix = NULL;
+        }
+        return len;
+    }
+    stream_t *demuxstream = p_sys->demuxstream;
     return demuxstream->pf_read(demuxstream, buf, len);
 }
 
 static block_t * ts_stream_wrapper_ReadBlock(stream_t *s, bool *restrict eof)
 {
-    stream_t *demuxstream = s->p_sys;
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    if(p_sys->p_prefix)
+    {
+        block_t *p_prefix = p_sys->p_prefix;
+        p_sys->p_prefix = NULL;
+        return p_prefix;
+    }
+    stream_t *demuxstream = p_sys->demuxstream;
     return demuxstream->pf_block(demuxstream, eof);
 }
 
 static int ts_stream_wrapper_Seek(stream_t *s, uint64_t pos)
 {
-    stream_t *demuxstream = s->p_sys;
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    if(p_sys->p_prefix)
+    {
+        block_Release(p_sys->p_prefix);
+        p_sys->p_prefix = NULL;
+    }
+    stream_t *demuxstream = p_sys->demuxstream;
     return demuxstream->pf_seek(demuxstream, pos);
 }
 
 static void ts_stream_wrapper_Destroy(stream_t *s)
 {
-    VLC_UNUSED(s);
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    if(p_sys->p_prefix)
+        block_Release(p_sys->p_prefix);
+    free(p_sys);
 }
 
 static stream_t * ts_stream_wrapper_New(stream_t *demuxstream)
 {
+    ts_stream_wrapper_sys_t *p_sys = malloc(sizeof(*p_sys));
+    if(!p_sys)
+        return NULL;
     stream_t *s = vlc_stream_CommonNew(VLC_OBJECT(demuxstream),
                                        ts_stream_wrapper_Destroy);
     if(s)
     {
-        s->p_sys = demuxstream;
+        p_sys->demuxstream = demuxstream;
+        p_sys->p_prefix = NULL;
+        s->p_sys = p_sys;
         s->s = s;
         if(demuxstream->pf_read)
             s->pf_read = ts_stream_wrapper_Read;
@@ -65,5 +113,15 @@ static stream_t * ts_stream_wrapper_New(stream_t *demuxstream)
         if(demuxstream->pf_block)
             s->pf_block = ts_stream_wrapper_ReadBlock;
     }
+    else
+        free(p_sys);
     return s;
 }
+
+/* Data already read from the demux stream, to be read again first */
+static void ts_stream_wrapper_Prepend(stream_t *s, block_t *p_data)
+{
+    ts_stream_wrapper_sys_t *p_sys = s->p_sys;
+    assert(p_sys->p_prefix == NULL);
+    p_sys->p_prefix = p_data;
+}
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * ts_workers.c: Transport Stream PES gathering threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+
+#include "ts_workers.h"
+
+#include <assert.h>
+
+#define TS_WORKER_QUEUE_SIZE 1024
+
+typedef struct
+{
+    ts_workers_t *p_workers;
+    vlc_thread_t  thread;
+
+    vlc_mutex_t   lock;
+    vlc_cond_t    wait;     /* signaled on new packets or stop */
+    vlc_cond_t    done;     /* signaled on processed packets */
+    bool          b_stop;
+
+    /* Packets ring, written by the demux thread only */
+    ts_workers_packet_t queue[TS_WORKER_QUEUE_SIZE];
+    unsigned      i_first;
+    unsigned      i_count;  /* including the packet being processed */
+} ts_worker_t;
+
+struct ts_workers_t
+{
+    demux_t                   *p_demux;
+    ts_workers_gather_callback pf_gather;
+    unsigned                   i_count;
+    ts_worker_t               *p_workers;
+};
+
+static void *ts_worker_Run( void *p_data )
+{
+    vlc_thread_set_name( "vlc-ts-worker" );
+
+    ts_worker_t *p_worker = p_data;
+    ts_workers_t *p_workers = p_worker->p_workers;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( p_worker->i_count == 0 && !p_worker->b_stop )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+        if( p_worker->i_count == 0 )
+            break;
+
+        /* The slot is not reused until the packet is counted as processed */
+        const ts_workers_packet_t *p_packet = &p_worker->queue[p_worker->i_first];
+        vlc_mutex_unlock( &p_worker->lock );
+
+        p_workers->pf_gather( p_workers->p_demux, p_packet );
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->i_first = (p_worker->i_first + 1) % TS_WORKER_QUEUE_SIZE;
+        p_worker->i_count--;
+        vlc_cond_signal( &p_worker->done );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return NULL;
+}
+
+ts_workers_t * ts_workers_New( demux_t *p_demux, unsigned i_count,
+                               ts_workers_gather_callback pf_gather )
+{
+    assert( i_count > 0 && i_count <= TS_WORKERS_MAX );
+
+    ts_workers_t *p_workers = malloc( sizeof(*p_workers) );
+    if( unlikely(p_workers == NULL) )
+        return NULL;
+
+    p_workers->p_workers = malloc( sizeof(*p_workers->p_workers) * i_count );
+    if( unlikely(p_workers->p_workers == NULL) )
+    {
+        free( p_workers );
+        return NULL;
+    }
+    p_workers->p_demux = p_demux;
+    p_workers->pf_gather = pf_gather;
+    p_workers->i_count = 0;
+
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        ts_worker_t *p_worker = &p_workers->p_workers[i];
+
+        p_worker->p_workers = p_workers;
+        vlc_mutex_init( &p_worker->lock );
+        vlc_cond_init( &p_worker->wait );
+        vlc_cond_init( &p_worker->done );
+        p_worker->b_stop = false;
+        p_worker->i_first = 0;
+        p_worker->i_count = 0;
+
+        if( vlc_clone( &p_worker->thread, ts_worker_Run, p_worker ) )
+        {
+            ts_workers_Delete( p_workers );
+            return NULL;
+        }
+        p_workers->i_count++;
+    }
+
+    return p_workers;
+}
+
+void ts_workers_Delete( ts_workers_t *p_workers )
+{
+    for( unsigned i = 0; i < p_workers->i_count; i++ )
+    {
+        ts_worker_t *p_worker = &p_workers->p_workers[i];
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->b_stop = true;
+        vlc_cond_signal( &p_worker->wait );
+        vlc_mutex_unlock( &p_worker->lock );
+
+        vlc_join( p_worker->thread, NULL );
+    }
+    free( p_workers->p_workers );
+    free( p_workers );
+}
+
+void ts_workers_Push( ts_workers_t *p_workers, unsigned i_key,
+                      const ts_workers_packet_t *p_packet )
+{
+    ts_worker_t *p_worker = &p_workers->p_workers[i_key % p_workers->i_count];
+
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_count == TS_WORKER_QUEUE_SIZE )
+        vlc_cond_wait( &p_worker->done, &p_worker->lock );
+
+    p_worker->queue[(p_worker->i_first + p_worker->i_count) % TS_WORKER_QUEUE_SIZE] = *p_packet;
+    p_worker->i_count++;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+static void ts_worker_Sync( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_count > 0 )
+        vlc_cond_wait( &p_worker->done, &p_worker->lock );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+void ts_workers_Sync( ts_workers_t *p_workers, unsigned i_key )
+{
+    ts_worker_Sync( &p_workers->p_workers[i_key % p_workers->i_count] );
+}
+
+void ts_workers_Drain( ts_workers_t *p_workers )
+{
+    for( unsigned i = 0; i < p_workers->i_count; i++ )
+        ts_worker_Sync( &p_workers->p_workers[i] );
+}
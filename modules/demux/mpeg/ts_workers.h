@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * ts_workers.h: Transport Stream PES gathering threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_WORKERS_H
+#define VLC_TS_WORKERS_H
+
+#include "ts_pid_fwd.h"
+#include "timestamps.h"
+
+#define TS_WORKERS_MAX 32
+
+typedef struct ts_workers_t ts_workers_t;
+
+typedef struct
+{
+    ts_pid_t   *p_pid;
+    block_t    *p_pkt;      /* PES payload of the TS packet */
+    bool        b_unit_start;
+    bool        b_valid_scrambling;
+    ts_90khz_t  i_append_pcr;
+} ts_workers_packet_t;
+
+typedef bool (*ts_workers_gather_callback)( demux_t *, const ts_workers_packet_t * );
+
+/**
+ * Creates i_count threads gathering the PES packets with pf_gather.
+ */
+ts_workers_t * ts_workers_New( demux_t *p_demux, unsigned i_count,
+                               ts_workers_gather_callback pf_gather );
+
+/**
+ * Processes the queued packets and joins the threads.
+ */
+void ts_workers_Delete( ts_workers_t * );
+
+/**
+ * Queues a packet on the thread selected by i_key.
+ *
+ * The packets pushed with the same key are processed in order, by the same
+ * thread. It waits if that thread is too late.
+ */
+void ts_workers_Push( ts_workers_t *, unsigned i_key,
+                      const ts_workers_packet_t *p_packet );
+
+/**
+ * Waits until the packets pushed with i_key, and any other packet of the
+ * same thread, have been processed.
+ */
+void ts_workers_Sync( ts_workers_t *, unsigned i_key );
+
+/**
+ * Waits until every pushed packet has been processed.
+ */
+void ts_workers_Drain( ts_workers_t * );
+
+#endif
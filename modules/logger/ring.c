@@ -0,0 +1,444 @@
+/*****************************************************************************
+ * ring.c: binary ring buffer tracer plugin
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Traces are stored as fixed-size binary records in a ring buffer owned by
+ * the tracing thread, so that tracing never locks nor formats anything.
+ * The ring of an exited thread is taken over by the next new thread, so that
+ * short-lived threads do not each leave a ring behind.
+ * The most recent records of every thread are converted to the Chrome trace
+ * event JSON format (also read by Perfetto) when the tracer is destroyed.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_plugin.h>
+#include <vlc_fs.h>
+#include <vlc_charset.h>
+#include <vlc_tracer.h>
+#include <vlc_atomic.h>
+#include <vlc_list.h>
+
+#include <errno.h>
+#include <math.h>
+#include <assert.h>
+
+#define RING_FILENAME "vlc-trace.json"
+
+#define RING_ENTRIES    6
+#define RING_KEY_SIZE   16
+#define RING_VALUE_SIZE 24
+
+struct ring_record
+{
+    unsigned long thread_id; /* the ring owner may have changed since */
+    int64_t ts; /* ns */
+    uint8_t count;
+    uint8_t types[RING_ENTRIES];
+    char keys[RING_ENTRIES][RING_KEY_SIZE];
+    union
+    {
+        int64_t integer;
+        uint64_t uinteger;
+        double double_;
+        char string[RING_VALUE_SIZE];
+    } values[RING_ENTRIES];
+};
+
+typedef struct
+{
+    vlc_mutex_t lock; /* protects the list and the owners of the rings */
+    struct vlc_list rings;
+    vlc_threadvar_t key; /* ring of the thread, released on thread exit */
+    size_t size;
+    char *path;
+    unsigned long id;
+} vlc_tracer_sys_t;
+
+struct ring
+{
+    vlc_tracer_sys_t *sys;
+    unsigned long thread_id;
+    bool exited; /* the owner thread is gone, the ring can be taken over */
+    atomic_size_t head; /* total number of records written */
+    struct vlc_list node;
+    struct ring_record records[];
+};
+
+static atomic_ulong next_id = 1;
+
+static thread_local struct
+{
+    unsigned long id; /* tracer the ring belongs to */
+    struct ring *ring;
+} current;
+
+/* Copies a string, truncated on an UTF-8 character boundary */
+static void RingCopyString(char *dst, const char *src, size_t size)
+{
+    size_t len = strnlen(src, size);
+
+    if (len == size)
+    {
+        len = size - 1;
+        while (len > 0 && (src[len] & 0xC0) == 0x80)
+            len--;
+    }
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+static struct ring *RingGet(vlc_tracer_sys_t *sys)
+{
+    if (likely(current.id == sys->id))
+        return current.ring;
+
+    unsigned long thread_id = vlc_thread_id();
+    struct ring *ring;
+
+    vlc_mutex_lock(&sys->lock);
+    /* This thread may have traced with another tracer in between */
+    vlc_list_foreach(ring, &sys->rings, node)
+        if (ring->thread_id == thread_id && !ring->exited)
+            goto out;
+
+    /* Take over the ring of an exited thread, keeping its last records */
+    vlc_list_foreach(ring, &sys->rings, node)
+        if (ring->exited)
+        {
+            ring->exited = false;
+            goto found;
+        }
+
+    ring = malloc(sizeof (*ring) + sys->size * sizeof (ring->records[0]));
+    if (ring == NULL)
+        goto out;
+    ring->sys = sys;
+    ring->exited = false;
+    atomic_init(&ring->head, 0);
+    vlc_list_append(&ring->node, &sys->rings);
+found:
+    ring->thread_id = thread_id;
+    vlc_threadvar_set(sys->key, ring);
+out:
+    vlc_mutex_unlock(&sys->lock);
+
+    if (ring != NULL)
+    {
+        current.id = sys->id;
+        current.ring = ring;
+    }
+    return ring;
+}
+
+static void RingRelease(void *data)
+{
+    struct ring *ring = data;
+    vlc_tracer_sys_t *sys = ring->sys;
+
+    vlc_mutex_lock(&sys->lock);
+    ring->exited = true;
+    vlc_mutex_unlock(&sys->lock);
+}
+
+static void TraceRing(void *opaque, vlc_tick_t ts,
+                      const struct vlc_tracer_trace *trace)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    struct ring *ring = RingGet(sys);
+    if (unlikely(ring == NULL))
+        return;
+
+    /* Only this thread writes to the ring */
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    struct ring_record *rec = &ring->records[head % sys->size];
+    const struct vlc_tracer_entry *entry = trace->entries;
+    unsigned i;
+
+    rec->thread_id = ring->thread_id;
+    rec->ts = NS_FROM_VLC_TICK(ts);
+    for (i = 0; i < RING_ENTRIES && entry->key != NULL; i++, entry++)
+    {
+        rec->types[i] = entry->type;
+        RingCopyString(rec->keys[i], entry->key, RING_KEY_SIZE);
+
+        switch (entry->type)
+        {
+            case VLC_TRACER_UINT:
+                rec->values[i].uinteger = entry->value.uinteger;
+                break;
+            case VLC_TRACER_INT:
+                rec->values[i].integer = entry->value.integer;
+                break;
+            case VLC_TRACER_DOUBLE:
+                rec->values[i].double_ = entry->value.double_;
+                break;
+            case VLC_TRACER_STRING:
+                RingCopyString(rec->values[i].string,
+                               entry->value.string ? entry->value.string : "",
+                               RING_VALUE_SIZE);
+                break;
+            default:
+                vlc_assert_unreachable();
+        }
+    }
+    rec->count = i;
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+static void JsonPrintString(FILE *stream, const char *str)
+{
+    fputc('\"', stream);
+    for (; *str != '\0'; str++)
+    {
+        unsigned char c = *str;
+
+        if (c == '\"' || c == '\\')
+            fprintf(stream, "\\%c", c);
+        else if (c <= 0x1F || c == 0x7F)
+            fprintf(stream, "\\u%04x", c);
+        else
+            fputc(c, stream);
+    }
+    fputc('\"', stream);
+}
+
+static const char *RecordGetString(const struct ring_record *rec,
+                                   const char *key)
+{
+    for (unsigned i = 0; i < rec->count; i++)
+        if (rec->types[i] == VLC_TRACER_STRING && !strcmp(rec->keys[i], key))
+            return rec->values[i].string;
+    return NULL;
+}
+
+static const char *RecordGetNumber(const struct ring_record *rec,
+                                   const char *key, char *buf, size_t size)
+{
+    for (unsigned i = 0; i < rec->count; i++)
+    {
+        if (strcmp(rec->keys[i], key))
+            continue;
+        if (rec->types[i] == VLC_TRACER_UINT)
+            snprintf(buf, size, "%"PRIu64, rec->values[i].uinteger);
+        else if (rec->types[i] == VLC_TRACER_INT)
+            snprintf(buf, size, "%"PRId64, rec->values[i].integer);
+        else
+            continue;
+        return buf;
+    }
+    return NULL;
+}
+
+static void ExportRecord(FILE *stream, const struct ring_record *rec)
+{
+    const char *name = RecordGetString(rec, "event");
+    const char *cat = RecordGetString(rec, "type");
+    const char *span = RecordGetString(rec, "span");
+    const char *phase = RecordGetString(rec, "phase");
+    const char *ph = "i";
+
+    /* Spans begin and end on any thread: export them as async events,
+     * matched by stream id and timestamp */
+    if (span != NULL && phase != NULL)
+    {
+        if (!strcmp(phase, "begin"))
+            ph = "b";
+        else if (!strcmp(phase, "end"))
+            ph = "e";
+    }
+
+    if (ph[0] != 'i')
+        name = span;
+    else if (name == NULL)
+        name = cat != NULL ? cat : "trace";
+
+    fputs("{\"name\":", stream);
+    JsonPrintString(stream, name);
+    if (cat != NULL)
+    {
+        fputs(",\"cat\":", stream);
+        JsonPrintString(stream, cat);
+    }
+    if (ph[0] != 'i')
+    {
+        char buf[24], key[RING_VALUE_SIZE + sizeof (buf) + 1];
+        const char *id = RecordGetString(rec, "id");
+        const char *pts = RecordGetNumber(rec, "pts", buf, sizeof (buf));
+
+        snprintf(key, sizeof (key), "%s/%s", id != NULL ? id : "",
+                 pts != NULL ? pts : "");
+        fputs(",\"id\":", stream);
+        JsonPrintString(stream, key);
+        fprintf(stream, ",\"ph\":\"%s\"", ph);
+    }
+    else
+        fputs(",\"ph\":\"i\",\"s\":\"t\"", stream);
+    vlc_fprintf_c(stream, ",\"ts\":%.3f,\"pid\":1,\"tid\":%lu,\"args\":{",
+                  rec->ts / 1000., rec->thread_id);
+
+    for (unsigned i = 0; i < rec->count; i++)
+    {
+        if (i > 0)
+            fputc(',', stream);
+        JsonPrintString(stream, rec->keys[i]);
+        fputc(':', stream);
+        switch (rec->types[i])
+        {
+            case VLC_TRACER_UINT:
+                fprintf(stream, "%"PRIu64, rec->values[i].uinteger);
+                break;
+            case VLC_TRACER_INT:
+                fprintf(stream, "%"PRId64, rec->values[i].integer);
+                break;
+            case VLC_TRACER_DOUBLE:
+                if (isfinite(rec->values[i].double_))
+                    vlc_fprintf_c(stream, "%.17g", rec->values[i].double_);
+                else
+                    fputs("null", stream);
+                break;
+            case VLC_TRACER_STRING:
+                JsonPrintString(stream, rec->values[i].string);
+                break;
+        }
+    }
+    fputs("}}", stream);
+}
+
+/* Converts the rings content into Chrome trace event JSON */
+static void ExportChrome(vlc_tracer_sys_t *sys, FILE *stream)
+{
+    bool first = true;
+    struct ring *ring;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", stream);
+    vlc_list_foreach(ring, &sys->rings, node)
+    {
+        size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        size_t start = head > sys->size ? head - sys->size : 0;
+
+        for (size_t i = start; i < head; i++)
+        {
+            if (!first)
+                fputs(",\n", stream);
+            first = false;
+            ExportRecord(stream, &ring->records[i % sys->size]);
+        }
+    }
+    fputs("\n]}\n", stream);
+}
+
+static void Close(void *opaque)
+{
+    vlc_tracer_sys_t *sys = opaque;
+    const char *path = sys->path != NULL ? sys->path : RING_FILENAME;
+
+    FILE *stream = vlc_fopen(path, "wt");
+    if (stream != NULL)
+    {
+        ExportChrome(sys, stream);
+        fclose(stream);
+    }
+
+    vlc_threadvar_delete(&sys->key);
+
+    struct ring *ring;
+    vlc_list_foreach(ring, &sys->rings, node)
+        free(ring);
+
+    free(sys->path);
+    free(sys);
+}
+
+static const struct vlc_tracer_operations ring_ops =
+{
+    TraceRing,
+    Close
+};
+
+static const struct vlc_tracer_operations *Open(vlc_object_t *obj,
+                                               void **restrict sysp)
+{
+    vlc_tracer_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    sys->size = var_InheritInteger(obj, "ring-tracer-size");
+    sys->path = var_InheritString(obj, "ring-tracer-file");
+    if (sys->size == 0)
+    {
+        free(sys->path);
+        free(sys);
+        return NULL;
+    }
+
+    /* Check that the output can be written now rather than on exit */
+    const char *path = sys->path != NULL ? sys->path : RING_FILENAME;
+    FILE *stream = vlc_fopen(path, "wt");
+    if (stream == NULL)
+    {
+        msg_Err(obj, "error opening trace file `%s': %s", path,
+                vlc_strerror_c(errno));
+        free(sys->path);
+        free(sys);
+        return NULL;
+    }
+    fclose(stream);
+
+    if (vlc_threadvar_create(&sys->key, RingRelease))
+    {
+        free(sys->path);
+        free(sys);
+        return NULL;
+    }
+    msg_Dbg(obj, "tracing to `%s'", path);
+
+    vlc_mutex_init(&sys->lock);
+    vlc_list_init(&sys->rings);
+    /* Rings of previous tracers must not be reused, even if the new tracer
+     * is allocated at the same address */
+    sys->id = atomic_fetch_add_explicit(&next_id, 1, memory_order_relaxed);
+
+    *sysp = sys;
+    return &ring_ops;
+}
+
+#define FILE_TEXT N_("Trace filename")
+#define FILE_LONGTEXT N_("Chrome trace event file written when exiting.")
+#define SIZE_TEXT N_("Trace buffer size")
+#define SIZE_LONGTEXT N_("Number of traces kept for each thread. " \
+    "Each trace takes about 270 bytes.")
+
+vlc_module_begin()
+    set_shortname(N_("Ring tracer"))
+    set_description(N_("Ring buffer tracer"))
+    set_subcategory(SUBCAT_ADVANCED_MISC)
+    set_capability("tracer", 0)
+    set_callback(Open)
+
+    add_savefile("ring-tracer-file", NULL, FILE_TEXT, FILE_LONGTEXT)
+    add_integer("ring-tracer-size", 8192, SIZE_TEXT, SIZE_LONGTEXT)
+        change_integer_range(1, 1 << 16)
+vlc_module_end()
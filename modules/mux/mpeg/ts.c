@@ -41,6 +41,7 @@
 #include <vlc_block.h>
 #include <vlc_rand.h>
 #include <vlc_charset.h>
+#include <vlc_vector.h>
 
 #include <vlc_iso_lang.h>
 
@@ -276,12 +277,6 @@ static inline void BufferChainAppend( sout_buffer_chain_t *c, block_t *b )
     block_ChainLastAppend( &c->pp_last, b );
 }
 
-static void BufferChainAppendCallback( void *opaque, block_t *b )
-{
-    sout_buffer_chain_t *c = opaque;
-    BufferChainAppend(c, b);
-}
-
 static inline block_t *BufferChainGet( sout_buffer_chain_t *c )
 {
     block_t *b = c->p_first;
@@ -296,17 +291,29 @@ static inline block_t *BufferChainGet( sout_buffer_chain_t *c )
     return b;
 }
 
-static inline block_t *BufferChainPeek( sout_buffer_chain_t *c )
-{
-    return c->p_first;
-}
-
 static inline void BufferChainClean( sout_buffer_chain_t *c )
 {
     block_ChainRelease(c->p_first);
     BufferChainInit( c );
 }
 
+/* A TS packet being muxed. The packets are only copied into the output
+ * blocks once dated, so that these can hold many packets each. */
+typedef struct
+{
+    uint8_t    p_buffer[188];
+    uint32_t   i_flags;
+    vlc_tick_t i_dts;
+} ts_packet_t;
+
+typedef struct VLC_VECTOR(ts_packet_t) ts_packets_t;
+
+/* Number of packets per output block: 1316 bytes fit in an Ethernet frame
+ * (or less with a smaller MTU), and 65424 bytes make large enough writes
+ * for files */
+#define TS_PACKETS_PER_DATAGRAM 7
+#define TS_PACKETS_PER_WRITE    348
+
 typedef struct
 {
     sout_buffer_chain_t chain_pes;
@@ -362,6 +369,9 @@ typedef struct
 
     vlc_tick_t      i_pcr;  /* last PCR emitted */
 
+    ts_packets_t    packets; /* of the current PCR interval */
+    int             i_packets_per_block;
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -454,15 +464,15 @@ static int Mux      ( sout_mux_t * );
 
 static block_t *FixPES( block_fifo_t *p_fifo );
 static block_t *Add_ADTS( block_t *, const es_format_t * );
-static int TSSchedule   ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static int TSSchedule   ( sout_mux_t *p_mux, int i_first, int i_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static int TSDate       ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static int TSDate       ( sout_mux_t *p_mux, int i_first, int i_count,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
-static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
+static void GetPAT( sout_mux_t *p_mux );
+static void GetPMT( sout_mux_t *p_mux );
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static ts_packet_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts );
 
 static void csaSetup( vlc_object_t *p_this )
 {
@@ -708,6 +718,18 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    vlc_vector_init( &p_sys->packets );
+    if( p_mux->p_access->psz_access != NULL &&
+        !strcmp( p_mux->p_access->psz_access, "file" ) )
+        p_sys->i_packets_per_block = TS_PACKETS_PER_WRITE;
+    else
+    {
+        int64_t i_mtu = var_InheritInteger( p_mux, "mtu" );
+
+        p_sys->i_packets_per_block = VLC_CLIP( i_mtu / 188, 1,
+                                               TS_PACKETS_PER_DATAGRAM );
+    }
+
     p_mux->p_sys        = p_sys;
 
     csaSetup( p_this );
@@ -745,6 +767,7 @@ static void Close( vlc_object_t * p_this )
         free( p_sys->sdt.desc[i].psz_provider );
     }
 
+    vlc_vector_destroy( &p_sys->packets );
     free( p_sys );
 }
 
@@ -998,16 +1021,36 @@ static void DelStream( sout_mux_t *p_mux, sout_input_t *p_input )
     p_sys->i_pmt_version_number %= 32;
 }
 
-static void SetHeader( sout_buffer_chain_t *c,
-                        int depth )
+static ts_packet_t *PacketNew( ts_packets_t *packets )
+{
+    if( !vlc_vector_reserve( packets, packets->size + 1 ) )
+        return NULL;
+
+    ts_packet_t *p_ts = &packets->data[packets->size++];
+    p_ts->i_flags = 0;
+    p_ts->i_dts = VLC_TICK_INVALID;
+    return p_ts;
+}
+
+static void PacketAppendCallback( void *opaque, block_t *b )
 {
-    block_t *p_ts = BufferChainPeek( c );
-    while( depth > 0 )
+    ts_packets_t *packets = opaque;
+
+    while( b != NULL )
     {
-        p_ts = p_ts->p_next;
-        depth--;
+        block_t *p_next = b->p_next;
+        ts_packet_t *p_ts = PacketNew( packets );
+
+        assert( b->i_buffer == 188 );
+        if( likely(p_ts != NULL) )
+        {
+            memcpy( p_ts->p_buffer, b->p_buffer, 188 );
+            p_ts->i_flags = b->i_flags;
+            p_ts->i_dts = b->i_dts;
+        }
+        block_Release( b );
+        b = p_next;
     }
-    p_ts->i_flags |= BLOCK_FLAG_HEADER;
 }
 
 static block_t *Pack_Opus(block_t *p_data)
@@ -1157,7 +1200,7 @@ static int MuxStreams( sout_mux_t *p_mux )
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
     sout_input_sys_t *p_pcr_stream = (sout_input_sys_t*)p_sys->p_pcr_input->p_sys;
 
-    sout_buffer_chain_t chain_ts;
+    ts_packets_t *packets = &p_sys->packets;
     vlc_tick_t i_shaping_delay = p_pcr_stream->state.b_key_frame
         ? p_pcr_stream->state.i_pes_length
         : p_sys->i_shaping_delay;
@@ -1446,13 +1489,13 @@ static int MuxStreams( sout_mux_t *p_mux )
     i_packet_count += (8 * i_pcr_length / p_sys->i_pcr_delay + 175) / 176;
 
     /* 3: mux PES into TS */
-    BufferChainInit( &chain_ts );
+    packets->size = 0;
     /* append PAT/PMT  -> FIXME with big pcr delay it won't have enough pat/pmt */
     bool pat_was_previous = true; //This is to prevent unnecessary double PAT/PMT insertions
-    GetPAT( p_mux, &chain_ts );
-    GetPMT( p_mux, &chain_ts );
+    GetPAT( p_mux );
+    GetPMT( p_mux );
     int i_packet_pos = 0;
-    i_packet_count += chain_ts.i_depth;
+    i_packet_count += packets->size;
     /* msg_Dbg( p_mux, "estimated pck=%d", i_packet_count ); */
 
     const vlc_tick_t i_pcr_dts = p_pcr_stream->state.i_pes_dts;
@@ -1497,7 +1540,9 @@ static int MuxStreams( sout_mux_t *p_mux )
         }
 
         /* Build the TS packet */
-        block_t *p_ts = TSNew( p_mux, p_stream, b_pcr );
+        ts_packet_t *p_ts = TSNew( p_mux, p_stream, b_pcr );
+        if( unlikely(p_ts == NULL) )
+            return VLC_ENOMEM;
         if( p_stream->ts.b_scramble )
             p_ts->i_flags |= BLOCK_FLAG_SCRAMBLED;
 
@@ -1512,23 +1557,26 @@ static int MuxStreams( sout_mux_t *p_mux )
         {
             if( likely( !pat_was_previous ) )
             {
-                int startcount = chain_ts.i_depth;
-                GetPAT( p_mux, &chain_ts );
-                GetPMT( p_mux, &chain_ts );
-                SetHeader( &chain_ts, startcount );
-                i_packet_count += (chain_ts.i_depth - startcount );
+                /* Move the packet after the new PAT/PMT */
+                ts_packet_t ts = *p_ts;
+                size_t startcount = --packets->size;
+                GetPAT( p_mux );
+                GetPMT( p_mux );
+                p_ts = PacketNew( packets );
+                if( unlikely(p_ts == NULL) )
+                    return VLC_ENOMEM;
+                *p_ts = ts;
+                packets->data[startcount].i_flags |= BLOCK_FLAG_HEADER;
+                i_packet_count += packets->size - 1 - startcount;
             } else {
-                SetHeader( &chain_ts, 0); //We just inserted pat/pmt,so just flag it instead of adding new one
+                packets->data[0].i_flags |= BLOCK_FLAG_HEADER; //We just inserted pat/pmt,so just flag it instead of adding new one
             }
         }
         pat_was_previous = false;
-
-        /* */
-        BufferChainAppend( &chain_ts, p_ts );
     }
 
     /* 4: date and send */
-    return TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    return TSSchedule( p_mux, 0, packets->size, i_pcr_length, i_pcr_dts );
 }
 
 /*****************************************************************************
@@ -1661,95 +1709,90 @@ static block_t *Add_ADTS( block_t *p_data, const es_format_t *p_fmt )
     return p_new_block;
 }
 
-static int TSSchedule( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+static int TSSchedule( sout_mux_t *p_mux, int i_first, int i_count,
                        vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    sout_buffer_chain_t new_chain;
-    int i_packet_count = p_chain_ts->i_depth;
-
-    BufferChainInit( &new_chain );
+    const ts_packet_t *packets = &p_sys->packets.data[i_first];
 
     if ( unlikely(i_pcr_length <= 0) )
     {
-        i_pcr_length = i_packet_count;
+        i_pcr_length = i_count;
     }
 
-    for (int i = 0; i < i_packet_count; i++ )
+    for (int i = 0; i < i_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
-        vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
-
-        BufferChainAppend( &new_chain, p_ts );
+        const ts_packet_t *p_ts = &packets[i];
+        vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_count;
 
         if (!p_ts->i_dts || p_ts->i_dts + p_sys->i_dts_delay * 2/3 >= i_new_dts)
             continue;
 
         vlc_tick_t i_max_diff = i_new_dts - p_ts->i_dts;
         vlc_tick_t i_cut_dts = p_ts->i_dts;
+        int i_cut = i + 1;
 
-        while( (p_ts = BufferChainPeek( p_chain_ts )) )
+        for( ; i_cut < i_count; i_cut++ )
         {
-            i_new_dts = i_pcr_dts + i_pcr_length * i++ / i_packet_count;
+            p_ts = &packets[i_cut];
+            i_new_dts = i_pcr_dts + i_pcr_length * (i_cut - 1) / i_count;
             if( p_ts->i_dts >= i_pcr_dts &&
                 i_new_dts - p_ts->i_dts >= i_max_diff )
                break;
-            p_ts = BufferChainGet( p_chain_ts );
-            BufferChainAppend( &new_chain, p_ts );
             i_max_diff = i_new_dts - p_ts->i_dts;
             i_cut_dts = p_ts->i_dts;
         }
-        msg_Dbg( p_mux, "adjusting rate at %"PRId64"/%"PRId64" (%zu/%zu)",
-                 i_cut_dts - i_pcr_dts, i_pcr_length, new_chain.i_depth,
-                 p_chain_ts->i_depth );
-        int status = VLC_SUCCESS;
-        if( new_chain.i_depth )
-        {
-            status = TSDate( p_mux, &new_chain, i_cut_dts - i_pcr_dts,
+        msg_Dbg( p_mux, "adjusting rate at %"PRId64"/%"PRId64" (%d/%d)",
+                 i_cut_dts - i_pcr_dts, i_pcr_length, i_cut,
+                 i_count - i_cut );
+        int status = TSDate( p_mux, i_first, i_cut, i_cut_dts - i_pcr_dts,
                              i_pcr_dts );
-        }
-        if( p_chain_ts->i_depth && status == VLC_SUCCESS )
+        if( i_cut < i_count && status == VLC_SUCCESS )
         {
-            status = TSSchedule( p_mux, p_chain_ts,
+            status = TSSchedule( p_mux, i_first + i_cut, i_count - i_cut,
                                  i_pcr_dts + i_pcr_length - i_cut_dts,
                                  i_cut_dts );
         }
         return status;
     }
 
-    if ( new_chain.i_depth )
-        return TSDate( p_mux, &new_chain, i_pcr_length, i_pcr_dts );
+    if ( i_count > 0 )
+        return TSDate( p_mux, i_first, i_count, i_pcr_length, i_pcr_dts );
     return VLC_SUCCESS;
 }
 
-static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+/* Dates the packets, and copies them into blocks of i_packets_per_block
+ * packets. A packet flagged as header always starts a new block, so that
+ * the segmenters can still cut there. */
+static int TSDate( sout_mux_t *p_mux, int i_first, int i_count,
                    vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
 {
     sout_mux_sys_t  *p_sys = p_mux->p_sys;
-    int i_packet_count = p_chain_ts->i_depth;
+    ts_packet_t *packets = &p_sys->packets.data[i_first];
+    const size_t i_block_size = p_sys->i_packets_per_block * 188;
 
     if ( unlikely(i_pcr_length / 1000 <= 0) )
     {
         /* This shouldn't happen, but happens in some rare heavy load
          * and packet losses conditions. */
-        i_pcr_length = i_packet_count;
+        i_pcr_length = i_count;
     }
 
-    /* msg_Dbg( p_mux, "real pck=%d", i_packet_count ); */
+    /* msg_Dbg( p_mux, "real pck=%d", i_count ); */
     block_t *p_list = NULL;
     block_t **pp_last = &p_list;
-    for (int i = 0; i < i_packet_count; i++ )
+    block_t *p_out = NULL;
+    for (int i = 0; i < i_count; i++ )
     {
-        block_t *p_ts = BufferChainGet( p_chain_ts );
-        vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_packet_count;
+        ts_packet_t *p_ts = &packets[i];
+        vlc_tick_t i_new_dts = i_pcr_dts + i_pcr_length * i / i_count;
 
-        p_ts->i_dts    = i_new_dts;
-        p_ts->i_length = i_pcr_length / i_packet_count;
+        p_ts->i_dts = i_new_dts;
 
         if( p_ts->i_flags & BLOCK_FLAG_FOR_PCR )
         {
             /* msg_Dbg( p_mux, "pcr=%lld ms", p_ts->i_dts / 1000 ); */
-            TSSetPCR( p_ts, p_ts->i_dts - p_sys->first_dts );
+            TSSetPCR( p_ts->p_buffer, p_ts->i_dts - p_sys->first_dts );
         }
         if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
         {
@@ -1758,21 +1801,44 @@ static int TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
             vlc_mutex_unlock( &p_sys->csa_lock );
         }
 
-        /* latency */
-        p_ts->i_dts += p_sys->i_shaping_delay * 3 / 2;
+        if( p_out != NULL && ( p_out->i_buffer == i_block_size ||
+                               (p_ts->i_flags & BLOCK_FLAG_HEADER) ) )
+        {
+            block_ChainLastAppend( &pp_last, p_out );
+            p_out = NULL;
+        }
+        if( p_out == NULL )
+        {
+            p_out = block_Alloc( i_block_size );
+            if( unlikely(p_out == NULL) )
+            {
+                block_ChainRelease( p_list );
+                return VLC_ENOMEM;
+            }
+            p_out->i_buffer = 0;
+            p_out->i_flags = p_ts->i_flags & BLOCK_FLAG_HEADER;
+            /* latency */
+            p_out->i_dts = i_new_dts + p_sys->i_shaping_delay * 3 / 2;
+            p_out->i_length = 0;
+        }
 
-        block_ChainLastAppend( &pp_last, p_ts );
+        memcpy( &p_out->p_buffer[p_out->i_buffer], p_ts->p_buffer, 188 );
+        p_out->i_buffer += 188;
+        p_out->i_length += i_pcr_length / i_count;
     }
+    if( p_out != NULL )
+        block_ChainLastAppend( &pp_last, p_out );
+
     ssize_t written = 0;
     if ( p_list != NULL )
         written = sout_AccessOutWrite( p_mux->p_access, p_list );
     return ( written == -1 ) ? VLC_EGENERIC : VLC_SUCCESS;
 }
 
-static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
-                       bool b_pcr )
+static ts_packet_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
+                           bool b_pcr )
 {
-    VLC_UNUSED(p_mux);
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
     block_t *p_pes = p_stream->state.chain_pes.p_first;
 
     bool b_new_pes = false;
@@ -1792,7 +1858,9 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
         b_adaptation_field = true;
     }
 
-    block_t *p_ts = block_Alloc( 188 );
+    ts_packet_t *p_ts = PacketNew( &p_sys->packets );
+    if( unlikely(p_ts == NULL) )
+        return NULL;
 
     if (b_new_pes && !(p_pes->i_flags & BLOCK_FLAG_NO_KEYFRAME) && p_pes->i_flags & BLOCK_FLAG_TYPE_I)
     {
@@ -1872,31 +1940,31 @@ static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
     return p_ts;
 }
 
-static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
+static void TSSetPCR( uint8_t *p_ts, vlc_tick_t i_dts )
 {
     ts_90khz_t i_pcr = TO_SCALE_NZ(i_dts);
 
-    p_ts->p_buffer[6]  = ( i_pcr >> 25 )&0xff;
-    p_ts->p_buffer[7]  = ( i_pcr >> 17 )&0xff;
-    p_ts->p_buffer[8]  = ( i_pcr >> 9  )&0xff;
-    p_ts->p_buffer[9]  = ( i_pcr >> 1  )&0xff;
-    p_ts->p_buffer[10] = ( i_pcr << 7  )&0x80;
-    p_ts->p_buffer[10] |= 0x7e;
-    p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
+    p_ts[6]  = ( i_pcr >> 25 )&0xff;
+    p_ts[7]  = ( i_pcr >> 17 )&0xff;
+    p_ts[8]  = ( i_pcr >> 9  )&0xff;
+    p_ts[9]  = ( i_pcr >> 1  )&0xff;
+    p_ts[10] = ( i_pcr << 7  )&0x80;
+    p_ts[10] |= 0x7e;
+    p_ts[11] = 0; /* we don't set PCR extension */
 }
 
-void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+void GetPAT( sout_mux_t *p_mux )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
 
     BuildPAT( p_sys->p_dvbpsi,
-              c, BufferChainAppendCallback,
+              &p_sys->packets, PacketAppendCallback,
               p_sys->i_tsid, p_sys->i_pat_version_number,
               &p_sys->pat,
               p_sys->i_num_pmt, p_sys->pmt, p_sys->i_pmt_program_number );
 }
 
-static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
+static void GetPMT( sout_mux_t *p_mux )
 {
     sout_mux_sys_t *p_sys = p_mux->p_sys;
     pes_mapped_stream_t mapped[p_mux->i_nb_inputs];
@@ -1918,7 +1986,7 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
     }
 
     BuildPMT( p_sys->p_dvbpsi, VLC_OBJECT(p_mux), p_sys->standard,
-              c, BufferChainAppendCallback,
+              &p_sys->packets, PacketAppendCallback,
               p_sys->i_tsid, p_sys->i_pmt_version_number,
               ((sout_input_sys_t *)p_sys->p_pcr_input->p_sys)->ts.i_pid,
               &p_sys->sdt,
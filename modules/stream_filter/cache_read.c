@@ -495,6 +495,12 @@ static int Open(vlc_object_t *obj)
     if (s->s->pf_read == NULL && s->s->pf_block == NULL)
         return VLC_EGENERIC;
 
+    /* Memory mapped file blocks are already in memory: caching them would
+     * only add a copy. The file access only lacks pf_read in that mode. */
+    if (s->s->pf_read == NULL && s->s->psz_filepath != NULL
+     && var_InheritBool(s, "file-mmap"))
+        return VLC_EGENERIC;
+
     stream_sys_t *sys = malloc(sizeof (*sys));
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
@@ -301,6 +301,7 @@ typedef struct
     uint8_t   proto;
     bool      rtcp_mux;
     bool      b_latm;
+    bool      b_ts;
 
     /* in case we do TS/PS over rtp */
     sout_mux_t        *p_mux;
@@ -534,6 +535,7 @@ static int Open( vlc_object_t *p_this )
             return VLC_EGENERIC;
         }
 
+        p_sys->b_ts = !strncasecmp( psz, "ts", 2 );
         p_sys->p_grab = GrabberCreate( p_stream );
         p_sys->p_mux = sout_MuxNew( p_sys->p_grab, psz );
         free( psz );
@@ -1647,6 +1649,10 @@ static ssize_t AccessOutGrabberWriteBuffer( sout_stream_t *p_stream,
     size_t          i_max   = id->i_mtu - 12;
     bool            b_dis   = (p_buffer->i_flags & BLOCK_FLAG_DISCONTINUITY);
 
+    /* The payload is a whole number of TS packets, RFC2250 2.1 */
+    if( p_sys->b_ts )
+        i_max = __MAX( i_max - i_max % 188, 188 );
+
     size_t i_packet = ( p_buffer->i_buffer + i_max - 1 ) / i_max;
 
     while( i_data > 0 )
@@ -1664,7 +1670,7 @@ static ssize_t AccessOutGrabberWriteBuffer( sout_stream_t *p_stream,
         if( p_sys->packet == NULL )
         {
             /* allocate a new packet */
-            p_sys->packet = block_Alloc( id->i_mtu );
+            p_sys->packet = block_Alloc( 12 + i_max );
             /* m-bit is discontinuity for MPEG1/2 PS and TS, RFC2250 2.1 */
             rtp_packetize_common( id, p_sys->packet, b_dis, i_dts );
             p_sys->packet->i_buffer = 12;
@@ -1674,8 +1680,7 @@ static ssize_t AccessOutGrabberWriteBuffer( sout_stream_t *p_stream,
             b_dis = false;
         }
 
-        i_size = __MIN( i_data,
-                        (unsigned)(id->i_mtu - p_sys->packet->i_buffer) );
+        i_size = __MIN( i_data, 12 + i_max - p_sys->packet->i_buffer );
 
         memcpy( &p_sys->packet->p_buffer[p_sys->packet->i_buffer],
                 p_data, i_size );
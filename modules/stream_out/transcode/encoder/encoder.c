@@ -50,7 +50,7 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
         if( p_enc->p_encoder->fmt_in.i_cat == VIDEO_ES )
         {
             transcode_encoder_video_stop( p_enc );
-            block_ChainRelease( p_enc->p_buffers );
+            vlc_spsc_fifo_Delete( p_enc->p_buffers );
 
             picture_fifo_Delete( p_enc->pp_pics );
         }
@@ -99,8 +99,13 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
     {
         case VIDEO_ES:
             p_enc->pp_pics = picture_fifo_New();
-            if( !p_enc->pp_pics )
+            p_enc->p_buffers = vlc_spsc_fifo_New();
+            if( !p_enc->pp_pics || !p_enc->p_buffers )
             {
+                if( p_enc->pp_pics )
+                    picture_fifo_Delete( p_enc->pp_pics );
+                if( p_enc->p_buffers )
+                    vlc_spsc_fifo_Delete( p_enc->p_buffers );
                 es_format_Clean( &p_enc->p_encoder->fmt_in );
                 es_format_Clean( &p_enc->p_encoder->fmt_out );
                 vlc_object_delete(p_enc->p_encoder);
@@ -173,11 +178,7 @@ block_t * transcode_encoder_encode( transcode_encoder_t *p_enc, void *in )
 
 block_t * transcode_encoder_get_output_async( transcode_encoder_t *p_enc )
 {
-    vlc_mutex_lock( &p_enc->lock_out );
-    block_t *p_data = p_enc->p_buffers;
-    p_enc->p_buffers = NULL;
-    vlc_mutex_unlock( &p_enc->lock_out );
-    return p_data;
+    return vlc_spsc_fifo_PopAll( p_enc->p_buffers );
 }
 
 void transcode_encoder_close( transcode_encoder_t *p_enc )
@@ -28,8 +28,8 @@ struct transcode_encoder_t
     vlc_sem_t       picture_pool_has_room;
     vlc_cond_t      cond;
 
-    /* output buffers */
-    block_t         *p_buffers;
+    /* output buffers, from the encoder thread */
+    vlc_spsc_fifo_t *p_buffers;
     bool b_threaded;
 };
 
@@ -324,9 +324,8 @@ static void* EncoderThread( void *obj )
             vlc_mutex_unlock( &p_enc->lock_out );
             p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
             picture_Release( p_pic );
+            vlc_spsc_fifo_Put( p_enc->p_buffers, p_block );
             vlc_mutex_lock( &p_enc->lock_out );
-
-            block_ChainAppend( &p_enc->p_buffers, p_block );
         }
 
         if( p_enc->b_abort )
@@ -339,13 +338,13 @@ static void* EncoderThread( void *obj )
         vlc_sem_post( &p_enc->picture_pool_has_room );
         p_block = vlc_encoder_EncodeVideo( p_enc->p_encoder, p_pic );
         picture_Release( p_pic );
-        block_ChainAppend( &p_enc->p_buffers, p_block );
+        vlc_spsc_fifo_Put( p_enc->p_buffers, p_block );
     }
 
     /*Now flush encoder*/
     do {
         p_block = vlc_encoder_EncodeVideo(p_enc->p_encoder, NULL );
-        block_ChainAppend( &p_enc->p_buffers, p_block );
+        vlc_spsc_fifo_Put( p_enc->p_buffers, p_block );
     } while( p_block );
 
     vlc_mutex_unlock( &p_enc->lock_out );
@@ -414,7 +413,6 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
 
     vlc_sem_init( &p_enc->picture_pool_has_room, p_cfg->video.threads.pool_size );
     vlc_cond_init( &p_enc->cond );
-    p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
 
     if( p_cfg->video.threads.i_count > 0 )
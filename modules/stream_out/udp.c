@@ -29,17 +29,47 @@
 #ifdef HAVE_ARPA_INET_H
 #include <arpa/inet.h>
 #endif
+#ifdef HAVE_SENDMMSG
+#include <netinet/udp.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_configuration.h>
 #include <vlc_block.h>
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
+#include <vlc_threads.h>
 
 #include <vlc_network.h>
 #include <vlc_memstream.h>
 #include "sdp_helper.h"
 
+/* Datagrams sent per system call, at most */
+#define BATCH 64
+/* Blocks gathered per datagram, at most */
+#define GATHER 16
+/* Datagrams due within this time of each other are sent together */
+#define PACE_QUANTUM VLC_TICK_FROM_MS(1)
+
+#if defined(UDP_SEGMENT) && defined(HAVE_SENDMMSG)
+/* Segments of a GSO datagram, at most (UDP_MAX_SEGMENTS of Linux 4.18) */
+# define GSO_SEGMENTS 64
+#endif
+
+struct udp_batch
+{
+    unsigned count; /* messages */
+    unsigned iovlen;
+    unsigned datagrams;
+    struct {
+        unsigned iov; /* first iovec */
+        unsigned iovlen;
+        size_t len;
+        size_t segment; /* GSO segment size, 0 if a single datagram */
+    } msg[BATCH];
+    struct iovec iov[BATCH * GATHER];
+};
+
 struct sout_stream_udp
 {
     sout_access_out_t *access;
@@ -47,6 +77,22 @@ struct sout_stream_udp
     session_descriptor_t *sap;
     int fd;
     uint_fast16_t mtu;
+    bool gso;
+    uint64_t datagrams;
+    uint64_t syscalls;
+    struct udp_batch batch;
+
+    /* Pacing thread, if caching > 0 */
+    vlc_tick_t caching;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    vlc_cond_t space;
+    block_t *queue;
+    block_t **queue_last;
+    vlc_tick_t queue_dts; /* last queued date */
+    vlc_tick_t sent_dts; /* last sent date */
+    bool stop;
 };
 
 static void *
@@ -144,52 +190,330 @@ static int Control(sout_stream_t *stream, int query, va_list args)
     return VLC_SUCCESS;
 }
 
-static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+/* Gathers the blocks of one datagram, up to the MTU */
+static block_t *Gather(struct sout_stream_udp *sys, block_t *block,
+                       struct iovec *iov, unsigned *restrict iovlen,
+                       size_t *restrict len)
+{
+    size_t tosend = 0;
+    unsigned n = 0;
+
+    do {
+        if (n >= GATHER)
+            break;
+        if (block->i_buffer + tosend > sys->mtu && likely(n > 0))
+            break;
+
+        iov[n].iov_base = block->p_buffer;
+        iov[n].iov_len = block->i_buffer;
+        n++;
+        tosend += block->i_buffer;
+        block = block->p_next;
+    } while (block != NULL);
+
+    *iovlen = n;
+    *len = tosend;
+    return block;
+}
+
+#if !defined(HAVE_SENDMMSG) || defined(GSO_SEGMENTS)
+static void SendMsg(sout_access_out_t *access, const struct iovec *iov,
+                    unsigned iovlen)
 {
     struct sout_stream_udp *sys = access->p_sys;
+    struct msghdr hdr = {
+        .msg_iov = (struct iovec *)iov,
+        .msg_iovlen = iovlen,
+    };
+
+    if (sendmsg(sys->fd, &hdr, 0) < 0)
+        msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+    sys->syscalls++;
+}
+#endif
+
+#ifdef GSO_SEGMENTS
+/* Sends a GSO message as separate datagrams */
+static void SendSegments(sout_access_out_t *access, const struct iovec *iov,
+                         unsigned iovlen, size_t segment)
+{
+    unsigned first = 0;
+    size_t len = 0;
+
+    /* The blocks of a datagram are never split */
+    for (unsigned i = 0; i < iovlen; i++) {
+        len += iov[i].iov_len;
+        if (len >= segment || i == iovlen - 1) {
+            SendMsg(access, &iov[first], i + 1 - first);
+            first = i + 1;
+            len = 0;
+        }
+    }
+}
+#endif
+
+static void SendBatch(sout_access_out_t *access)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    struct udp_batch *batch = &sys->batch;
+    unsigned i = 0;
+
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[BATCH];
+# ifdef GSO_SEGMENTS
+    union {
+        struct cmsghdr align;
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+    } cmsgs[BATCH];
+# endif
+
+    memset(msgs, 0, batch->count * sizeof (*msgs));
+    for (unsigned j = 0; j < batch->count; j++) {
+        struct msghdr *hdr = &msgs[j].msg_hdr;
+
+        hdr->msg_iov = &batch->iov[batch->msg[j].iov];
+        hdr->msg_iovlen = batch->msg[j].iovlen;
+# ifdef GSO_SEGMENTS
+        if (batch->msg[j].segment > 0) {
+            uint16_t size = batch->msg[j].segment;
+
+            hdr->msg_control = cmsgs[j].buf;
+            hdr->msg_controllen = sizeof (cmsgs[j].buf);
+
+            struct cmsghdr *c = CMSG_FIRSTHDR(hdr);
+            c->cmsg_level = IPPROTO_UDP;
+            c->cmsg_type = UDP_SEGMENT;
+            c->cmsg_len = CMSG_LEN(sizeof (size));
+            memcpy(CMSG_DATA(c), &size, sizeof (size));
+        }
+# endif
+    }
+
+    while (i < batch->count) {
+        int val = sendmmsg(sys->fd, &msgs[i], batch->count - i, 0);
+
+        sys->syscalls++;
+        if (val > 0) {
+            i += val;
+            continue;
+        }
+
+        /* The message at i failed */
+# ifdef GSO_SEGMENTS
+        if (batch->msg[i].segment > 0 && (errno == EIO || errno == EINVAL)) {
+            /* The output interface cannot segment, e.g. without checksum
+             * offloading: send the datagrams one by one from now on. */
+            msg_Warn(access, "UDP segmentation offload disabled: %s",
+                     vlc_strerror_c(errno));
+            sys->gso = false;
+            SendSegments(access, &batch->iov[batch->msg[i].iov],
+                         batch->msg[i].iovlen, batch->msg[i].segment);
+        }
+        else
+# endif
+            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
+        i++;
+    }
+#else
+    for (; i < batch->count; i++)
+        SendMsg(access, &batch->iov[batch->msg[i].iov], batch->msg[i].iovlen);
+#endif
+
+    sys->datagrams += batch->datagrams;
+    batch->count = batch->iovlen = batch->datagrams = 0;
+}
+
+/* Adds one datagram to the batch, sending the batch first if full */
+static void Queue(sout_access_out_t *access, const struct iovec *iov,
+                  unsigned iovlen, size_t len)
+{
+    struct sout_stream_udp *sys = access->p_sys;
+    struct udp_batch *batch = &sys->batch;
+
+#ifdef GSO_SEGMENTS
+    /* Append to the previous message as a GSO segment: all the segments
+     * must have the same size, but the last one may be shorter. */
+    if (sys->gso && batch->count > 0) {
+        unsigned i = batch->count - 1;
+        size_t segment = batch->msg[i].segment ? batch->msg[i].segment
+                                               : batch->msg[i].len;
+        unsigned segments = (batch->msg[i].len + segment - 1) / segment;
+
+        if (batch->msg[i].len % segment == 0 && len <= segment
+         && segments < GSO_SEGMENTS
+         && batch->msg[i].len + len <= UINT16_MAX - 8 - 40
+         && batch->msg[i].iov + batch->msg[i].iovlen == batch->iovlen
+         && batch->iovlen + iovlen <= ARRAY_SIZE(batch->iov)) {
+            memcpy(&batch->iov[batch->iovlen], iov, iovlen * sizeof (*iov));
+            batch->iovlen += iovlen;
+            batch->msg[i].iovlen += iovlen;
+            batch->msg[i].len += len;
+            batch->msg[i].segment = segment;
+            batch->datagrams++;
+            return;
+        }
+    }
+#endif
+
+    if (batch->count >= BATCH
+     || batch->iovlen + iovlen > ARRAY_SIZE(batch->iov))
+        SendBatch(access);
+
+    unsigned i = batch->count++;
+
+    batch->msg[i].iov = batch->iovlen;
+    batch->msg[i].iovlen = iovlen;
+    batch->msg[i].len = len;
+    batch->msg[i].segment = 0;
+    memcpy(&batch->iov[batch->iovlen], iov, iovlen * sizeof (*iov));
+    batch->iovlen += iovlen;
+    batch->datagrams++;
+}
+
+static void ReleaseChain(block_t *block, const block_t *end)
+{
+    while (block != end) {
+        block_t *next = block->p_next;
+
+        block_Release(block);
+        block = next;
+    }
+}
+
+/* Sends a chain of blocks, in datagrams of up to the MTU */
+static ssize_t SendChain(sout_access_out_t *access, block_t *block)
+{
     ssize_t total = 0;
+    block_t *first = block;
 
     while (block != NULL) {
-        struct iovec iov[16];
-        block_t *unsent = block;
-        unsigned iovlen = 0;
-        size_t tosend = 0;
-
-        /* Count how many blocks to gather */
-        do {
-            if (iovlen >= ARRAY_SIZE(iov))
-                break;
-            if (unsent->i_buffer + tosend > sys->mtu && likely(iovlen > 0))
-                break;
-
-            iov[iovlen].iov_base = unsent->p_buffer;
-            iov[iovlen].iov_len = unsent->i_buffer;
-            iovlen++;
-            tosend += unsent->i_buffer;
-            unsent = unsent->p_next;
-        } while (unsent != NULL);
-
-        /* Send */
-        struct msghdr hdr = { .msg_iov = iov, .msg_iovlen = iovlen };
-        ssize_t val = sendmsg(sys->fd, &hdr, 0);
-
-        if (val < 0)
-            msg_Err(access, "send error: %s", vlc_strerror_c(errno));
-        else
-            total += val;
+        struct iovec iov[GATHER];
+        unsigned iovlen;
+        size_t len;
+
+        block = Gather(access->p_sys, block, iov, &iovlen, &len);
+        Queue(access, iov, iovlen, len);
+        total += len;
+    }
+    SendBatch(access);
+    ReleaseChain(first, NULL);
+    return total;
+}
 
-        /* Free */
-        do {
-            block_t *next = block->p_next;
+static ssize_t AccessOutWrite(sout_access_out_t *access, block_t *block)
+{
+    struct sout_stream_udp *sys = access->p_sys;
 
-            block_Release(block);
-            block = next;
-        } while (block != unsent);
+    if (sys->caching <= 0)
+        return SendChain(access, block);
+
+    ssize_t total = 0;
+    vlc_tick_t dts = VLC_TICK_INVALID;
+
+    for (block_t *b = block; b != NULL; b = b->p_next) {
+        total += b->i_buffer;
+        if (b->i_dts != VLC_TICK_INVALID)
+            dts = b->i_dts;
     }
 
+    vlc_mutex_lock(&sys->lock);
+    *sys->queue_last = block;
+    while (*sys->queue_last != NULL)
+        sys->queue_last = &(*sys->queue_last)->p_next;
+    if (dts != VLC_TICK_INVALID)
+        sys->queue_dts = dts;
+    vlc_cond_signal(&sys->wait);
+
+    /* Do not get further ahead of the output than the caching, plus a
+     * margin for the mux output bursts */
+    while (!sys->stop && sys->sent_dts != VLC_TICK_INVALID
+        && sys->queue_dts - sys->sent_dts > sys->caching + VLC_TICK_FROM_SEC(1))
+        vlc_cond_wait(&sys->space, &sys->lock);
+    vlc_mutex_unlock(&sys->lock);
+
     return total;
 }
 
+/**
+ * Pacing thread: sends the datagrams at the dates of their first block,
+ * delayed by the caching. The TS muxer dates its packets by interpolating
+ * the PCR, so that the output rate follows the stream rate smoothly,
+ * instead of the bursts of the mux output.
+ */
+static void *Thread(void *data)
+{
+    sout_access_out_t *access = data;
+    struct sout_stream_udp *sys = access->p_sys;
+    vlc_tick_t offset = VLC_TICK_INVALID; /* from the dates to the clock */
+
+    vlc_thread_set_name("vlc-udp-out");
+
+    vlc_mutex_lock(&sys->lock);
+    for (;;) {
+        while (sys->queue == NULL && !sys->stop)
+            vlc_cond_wait(&sys->wait, &sys->lock);
+        if (sys->queue == NULL)
+            break;
+
+        block_t *block = sys->queue;
+        block_t *pending = block; /* blocks of the batch, not sent yet */
+
+        sys->queue = NULL;
+        sys->queue_last = &sys->queue;
+
+        while (block != NULL) {
+            struct iovec iov[GATHER];
+            unsigned iovlen;
+            size_t len;
+            vlc_tick_t dts = block->i_dts;
+            vlc_tick_t now = vlc_tick_now();
+            vlc_tick_t deadline = now;
+
+            if (dts != VLC_TICK_INVALID) {
+                /* Resynchronize at start, and after a discontinuity or
+                 * a stall longer than the caching */
+                if (offset == VLC_TICK_INVALID
+                 || dts + offset < now - sys->caching
+                 || dts + offset > now + 2 * sys->caching
+                                   + VLC_TICK_FROM_SEC(1)) {
+                    if (offset != VLC_TICK_INVALID)
+                        msg_Dbg(access, "resynchronizing output pacing");
+                    offset = now + sys->caching - dts;
+                }
+                deadline = dts + offset;
+            }
+
+            if (deadline > now + PACE_QUANTUM) {
+                /* Send the batch before waiting for a later datagram */
+                if (pending != block) {
+                    vlc_mutex_unlock(&sys->lock);
+                    SendBatch(access);
+                    ReleaseChain(pending, block);
+                    pending = block;
+                    vlc_mutex_lock(&sys->lock);
+                }
+                while (vlc_cond_timedwait(&sys->wait, &sys->lock,
+                                          deadline) == 0);
+            }
+            if (dts != VLC_TICK_INVALID)
+                sys->sent_dts = dts;
+            vlc_cond_signal(&sys->space);
+            vlc_mutex_unlock(&sys->lock);
+
+            block = Gather(sys, block, iov, &iovlen, &len);
+            Queue(access, iov, iovlen, len);
+            vlc_mutex_lock(&sys->lock);
+        }
+
+        vlc_mutex_unlock(&sys->lock);
+        SendBatch(access);
+        ReleaseChain(pending, NULL);
+        vlc_mutex_lock(&sys->lock);
+    }
+    vlc_mutex_unlock(&sys->lock);
+    return NULL;
+}
+
 static void Close(sout_stream_t *stream)
 {
     struct sout_stream_udp *sys = stream->p_sys;
@@ -198,6 +522,20 @@ static void Close(sout_stream_t *stream)
         sout_AnnounceUnRegister(stream, sys->sap);
 
     sout_MuxDelete(sys->mux);
+    if (sys->caching > 0) {
+        /* The thread sends the queued datagrams at their dates: at most
+         * the caching and the burst margin of AccessOutWrite */
+        vlc_mutex_lock(&sys->lock);
+        sys->stop = true;
+        vlc_cond_signal(&sys->wait);
+        vlc_cond_signal(&sys->space);
+        vlc_mutex_unlock(&sys->lock);
+        vlc_join(sys->thread, NULL);
+    }
+    if (sys->syscalls > 0)
+        msg_Dbg(stream, "sent %"PRIu64" datagrams in %"PRIu64" system calls "
+                "(%.1f per call)", sys->datagrams, sys->syscalls,
+                (double)sys->datagrams / sys->syscalls);
     sout_AccessOutDelete(sys->access);
     net_Close(sys->fd);
     free(sys);
@@ -213,7 +551,7 @@ static const struct sout_stream_operations ops = {
 };
 
 static const char *const chain_options[] = {
-    "avformat", "dst", "sap", "name", "description", NULL
+    "avformat", "dst", "sap", "name", "description", "caching", NULL
 };
 
 #define DEFAULT_PORT 1234
@@ -311,6 +649,24 @@ static int Open(vlc_object_t *obj)
     sys->access = access;
     sys->fd = fd;
     sys->mtu = var_InheritInteger(stream, "mtu");
+    sys->datagrams = sys->syscalls = 0;
+    sys->batch.count = sys->batch.iovlen = sys->batch.datagrams = 0;
+#ifdef GSO_SEGMENTS
+    /* Only checks that the kernel supports UDP segmentation offload */
+    sys->gso = setsockopt(fd, IPPROTO_UDP, UDP_SEGMENT,
+                          &(int){ 0 }, sizeof (int)) == 0;
+#else
+    sys->gso = false;
+#endif
+    sys->caching = VLC_TICK_FROM_MS(var_GetInteger(stream,
+                                                   SOUT_CFG_PREFIX "caching"));
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queue_dts = sys->sent_dts = VLC_TICK_INVALID;
+    sys->stop = false;
+    vlc_mutex_init(&sys->lock);
+    vlc_cond_init(&sys->wait);
+    vlc_cond_init(&sys->space);
 
     sout_mux_t *mux = sout_MuxNew(access, muxmod);
     if (mux == NULL) {
@@ -319,6 +675,13 @@ static int Open(vlc_object_t *obj)
     }
     sys->mux = mux;
 
+    if (sys->caching > 0
+     && vlc_clone(&sys->thread, Thread, access)) {
+        sout_MuxDelete(mux);
+        ret = VLC_ENOMEM;
+        goto error;
+    }
+
     if (var_GetBool(stream, SOUT_CFG_PREFIX "sap"))
         sys->sap = CreateSDP(VLC_OBJECT(stream), fd);
     else
@@ -341,6 +704,11 @@ error:
 #define DEST_TEXT N_("Destination")
 #define DEST_LONGTEXT N_( \
     "Destination address and port (colon-separated) for the stream.")
+#define CACHING_TEXT N_("Pacing delay (ms)")
+#define CACHING_LONGTEXT N_( \
+    "The datagrams are sent by a dedicated thread, paced by the timestamps " \
+    "of the muxer with this delay. Set to 0 to send them as soon as they " \
+    "are muxed.")
 #define SAP_TEXT N_("SAP announcement")
 #define SAP_LONGTEXT N_("Announce this stream as a session with SAP.")
 #define NAME_TEXT N_("SAP name")
@@ -359,6 +727,9 @@ vlc_module_begin()
 
     add_bool(SOUT_CFG_PREFIX "avformat", false, AVF_TEXT, AVF_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "dst", "", DEST_TEXT, DEST_LONGTEXT)
+    add_integer(SOUT_CFG_PREFIX "caching", 0, CACHING_TEXT,
+                CACHING_LONGTEXT)
+        change_integer_range(0, 10000)
     add_bool(SOUT_CFG_PREFIX "sap", false, SAP_TEXT, SAP_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "name", "", NAME_TEXT, NAME_LONGTEXT)
     add_string(SOUT_CFG_PREFIX "description", "", DESC_TEXT, DESC_LONGTEXT)
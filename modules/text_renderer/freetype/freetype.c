@@ -86,7 +86,8 @@ static void Destroy( filter_t * );
 #define SHADOW_ANGLE_TEXT N_("Shadow angle")
 #define SHADOW_DISTANCE_TEXT N_("Shadow distance")
 #define CACHE_SIZE_TEXT N_("Cache size")
-#define CACHE_SIZE_LONGTEXT N_("Cache size in kBytes")
+#define CACHE_SIZE_LONGTEXT N_("Total size in kBytes of the font, glyph " \
+                              "and text shaping caches")
 
 #define TEXT_DIRECTION_TEXT N_("Text direction")
 #define TEXT_DIRECTION_LONGTEXT N_("Paragraph base direction for the Unicode bi-directional algorithm.")
@@ -1199,11 +1200,25 @@ static int Create( filter_t *p_filter )
         p_sys->p_stroker = NULL;
     }
 
+    /* A quarter of the cache size goes to the shaped runs, the rest to the
+     * font and glyph caches */
+    size_t i_cache_size =
+        (size_t) var_InheritInteger( p_filter, "freetype-cache-size" ) << 10;
+#ifdef HAVE_HARFBUZZ
+    const size_t i_runs_size = i_cache_size / 4;
+    i_cache_size -= i_runs_size;
+#endif
     p_sys->ftcache = vlc_ftcache_New( VLC_OBJECT(p_filter), p_sys->p_library,
-                            var_InheritInteger( p_filter, "freetype-cache-size" ) );
+                                      i_cache_size );
     if( !p_sys->ftcache )
         goto error;
 
+#ifdef HAVE_HARFBUZZ
+    p_sys->shaped_runs = NewShapedRunsCache( i_runs_size );
+    if( !p_sys->shaped_runs )
+        goto error;
+#endif
+
     p_sys->i_scale = 100;
 
     /* default style to apply to incomplete segments styles */
@@ -1270,6 +1285,14 @@ static void Destroy( filter_t *p_filter )
         DumpFamilies( p_sys->fs );
 #endif
 
+#ifdef HAVE_HARFBUZZ
+    if( p_sys->shaped_runs )
+    {
+        vlc_lru_DumpStats( p_sys->shaped_runs, VLC_OBJECT(p_filter), "shaped runs" );
+        vlc_lru_Release( p_sys->shaped_runs );
+    }
+#endif
+
     if( p_sys->ftcache )
         vlc_ftcache_Delete( p_sys->ftcache );
 
@@ -46,6 +46,8 @@ struct vlc_ftcache_t
     FTC_CMapCache     charmap_cache;
     /* Derived glyph cache */
     vlc_lru *         glyphs_lrucache;
+    /* Rasterised glyph cache */
+    vlc_lru *         bitmaps_lrucache;
     /* current face properties */
     FT_Long           style_flags;
 };
@@ -196,10 +198,25 @@ static void FreeFaceID( void *p_faceid, void *p_obj )
     free(faceid);
 }
 
+static void LRUBitmapRelease( void *priv, void *v )
+{
+    VLC_UNUSED(priv);
+    FT_Done_Glyph( (FT_Glyph) v );
+}
+
 void vlc_ftcache_Delete( vlc_ftcache_t *ftcache )
 {
     if( ftcache->glyphs_lrucache )
+    {
+        vlc_lru_DumpStats( ftcache->glyphs_lrucache, ftcache->obj, "outlined glyphs" );
         vlc_lru_Release( ftcache->glyphs_lrucache );
+    }
+
+    if( ftcache->bitmaps_lrucache )
+    {
+        vlc_lru_DumpStats( ftcache->bitmaps_lrucache, ftcache->obj, "glyph bitmaps" );
+        vlc_lru_Release( ftcache->bitmaps_lrucache );
+    }
 
     if( ftcache->cachemanager )
         FTC_Manager_Done( ftcache->cachemanager );
@@ -211,7 +228,7 @@ void vlc_ftcache_Delete( vlc_ftcache_t *ftcache )
 }
 
 vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *obj, FT_Library p_library,
-                                 unsigned maxkb )
+                                 size_t maxsize )
 {
     vlc_ftcache_t *ftcache = calloc(1, sizeof(*ftcache));
     if(!ftcache)
@@ -222,9 +239,14 @@ vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *obj, FT_Library p_library,
     vlc_dictionary_init( &ftcache->face_ids, 50 );
 
     ftcache->glyphs_lrucache = vlc_lru_New( 128, LRUGlyphRefRelease, ftcache );
-
-    if(!ftcache->glyphs_lrucache ||
-       FTC_Manager_New( p_library, 4, 8, maxkb << 10,
+    /* Half of the size for the rendered bitmaps */
+    const size_t bitmapssize = maxsize / 2;
+    ftcache->bitmaps_lrucache = vlc_lru_New( 4096, LRUBitmapRelease, ftcache );
+    if( ftcache->bitmaps_lrucache )
+        vlc_lru_SetMaxSize( ftcache->bitmaps_lrucache, bitmapssize );
+
+    if(!ftcache->glyphs_lrucache || !ftcache->bitmaps_lrucache ||
+       FTC_Manager_New( p_library, 4, 8, maxsize - bitmapssize,
                         RequestFace, ftcache, &ftcache->cachemanager ) ||
        FTC_ImageCache_New( ftcache->cachemanager, &ftcache->image_cache ) ||
        FTC_CMapCache_New( ftcache->cachemanager, &ftcache->charmap_cache ))
@@ -273,7 +295,7 @@ vlc_ftcache_GetCustomGlyph( vlc_ftcache_t *ftcache, const char *psz_key )
 static vlc_ftcache_custom_glyph_ref_t
 vlc_ftcache_AddCustomGlyph( vlc_ftcache_t *ftcache, const char *psz_key, FT_Glyph glyph )
 {
-    assert(!vlc_lru_Get( ftcache->glyphs_lrucache, psz_key ));
+    assert(!vlc_lru_HasKey( ftcache->glyphs_lrucache, psz_key ));
     vlc_ftcache_custom_glyph_ref_t ref = malloc( sizeof(*ref) );
     if( ref )
     {
@@ -340,3 +362,55 @@ FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id
     free( psz_key );
     return glyph;
 }
+
+int vlc_ftcache_GetGlyphBitmap( vlc_ftcache_t *ftcache, const vlc_face_id_t *faceid,
+                                FT_UInt index, const vlc_ftcache_metrics_t *metrics,
+                                int flags, int radius,
+                                FT_Glyph *p_glyph, const FT_Vector *origin )
+{
+    if( (*p_glyph)->format != FT_GLYPH_FORMAT_OUTLINE )
+        return FT_Glyph_To_Bitmap( p_glyph, FT_RENDER_MODE_NORMAL, origin, 0 );
+
+    /* The rendering only depends on the subpixel part of the origin,
+     * whole pixels just offset the bitmap */
+    FT_Vector subpixel = { .x = origin->x & 63, .y = origin->y & 63 };
+    const FT_Int x = (origin->x - subpixel.x) / 64;
+    const FT_Int y = (origin->y - subpixel.y) / 64;
+
+    char *psz_key;
+    if( asprintf( &psz_key, "%s#%d#%u,%d,%d,%x,%d,%ld,%ld",
+                  faceid->psz_filename, faceid->idx, index,
+                  metrics->width_px, metrics->height_px, flags, radius,
+                  subpixel.x, subpixel.y ) < 0 )
+        return FT_Glyph_To_Bitmap( p_glyph, FT_RENDER_MODE_NORMAL, origin, 0 );
+
+    FT_Glyph bitmap = NULL;
+    FT_Glyph cached = vlc_lru_Get( ftcache->bitmaps_lrucache, psz_key );
+    if( cached )
+    {
+        if( FT_Glyph_Copy( cached, &bitmap ) )
+            bitmap = NULL;
+    }
+    else
+    {
+        bitmap = *p_glyph;
+        if( FT_Glyph_To_Bitmap( &bitmap, FT_RENDER_MODE_NORMAL, &subpixel, 0 ) )
+            bitmap = NULL;
+        else if( !FT_Glyph_Copy( bitmap, &cached ) )
+        {
+            const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph)cached)->bitmap;
+            vlc_lru_InsertSized( ftcache->bitmaps_lrucache, psz_key, cached,
+                                 sizeof(FT_BitmapGlyphRec) +
+                                 (size_t) abs( p_bitmap->pitch ) * p_bitmap->rows );
+        }
+    }
+    free( psz_key );
+
+    if( !bitmap )
+        return -1;
+
+    ((FT_BitmapGlyph)bitmap)->left += x;
+    ((FT_BitmapGlyph)bitmap)->top += y;
+    *p_glyph = bitmap;
+    return 0;
+}
@@ -36,7 +36,8 @@ typedef struct
 
 } vlc_face_id_t;
 
-vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *, FT_Library, unsigned );
+/* The size, in bytes, is shared by the FreeType cache and the bitmaps */
+vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *, FT_Library, size_t );
 void vlc_ftcache_Delete( vlc_ftcache_t * );
 
 /* Glyphs managed by the cache. Always use vlc_ftcache_Init/Release */
@@ -85,6 +86,15 @@ FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id
 void vlc_ftcache_Custom_Glyph_Init( vlc_ftcache_custom_glyph_t * );
 void vlc_ftcache_Custom_Glyph_Release( vlc_ftcache_custom_glyph_t * );
 
+/* Rasterised glyphs cache.
+ * Behaves as FT_Glyph_To_Bitmap( glyph, FT_RENDER_MODE_NORMAL, origin, 0 ),
+ * caching the bitmaps of outline glyphs per subpixel origin. The flags and
+ * radius identify the modifications applied to the source glyph. */
+int vlc_ftcache_GetGlyphBitmap( vlc_ftcache_t *, const vlc_face_id_t *faceid,
+                                FT_UInt index, const vlc_ftcache_metrics_t *,
+                                int flags, int radius,
+                                FT_Glyph *, const FT_Vector *origin );
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@ struct vlc_lru_entry
 {
     char *psz_key;
     void *value;
+    size_t size;
     struct vlc_list node;
 };
 
@@ -38,9 +39,13 @@ struct vlc_lru
     void (*releaseValue)(void *, void *);
     void *priv;
     unsigned max;
+    size_t maxsize;
+    size_t size;
     vlc_dictionary_t dict;
     struct vlc_list list;
     struct vlc_lru_entry *last;
+    uint64_t hits;
+    uint64_t misses;
 };
 
 static void vlc_lru_releaseentry( void *value, void *priv )
@@ -61,14 +66,23 @@ vlc_lru * vlc_lru_New( unsigned max,
     {
         lru->priv = priv;
         lru->max = max;
+        lru->maxsize = SIZE_MAX;
+        lru->size = 0;
         vlc_dictionary_init( &lru->dict, max );
         vlc_list_init( &lru->list );
         lru->releaseValue = releaseValue;
         lru->last = NULL;
+        lru->hits = 0;
+        lru->misses = 0;
     }
     return lru;
 }
 
+void vlc_lru_SetMaxSize( vlc_lru *lru, size_t maxsize )
+{
+    lru->maxsize = maxsize;
+}
+
 void vlc_lru_Release( vlc_lru *lru )
 {
     vlc_dictionary_clear( &lru->dict, vlc_lru_releaseentry, lru );
@@ -94,12 +108,25 @@ void * vlc_lru_Get( vlc_lru *lru, const char *psz_key )
             vlc_list_remove( &entry->node );
             vlc_list_add_after( &entry->node, &lru->list );
         }
+        lru->hits++;
         return entry->value;
     }
+    lru->misses++;
     return NULL;
 }
 
-void vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value )
+static void vlc_lru_RemoveLast( vlc_lru *lru )
+{
+    struct vlc_lru_entry *toremove = lru->last;
+    lru->last = vlc_list_entry(toremove->node.prev, struct vlc_lru_entry, node);
+    vlc_list_remove(&toremove->node);
+    vlc_dictionary_remove_value_for_key(&lru->dict, toremove->psz_key, NULL, NULL);
+    lru->size -= toremove->size;
+    vlc_lru_releaseentry(toremove, lru);
+}
+
+void vlc_lru_InsertSized( vlc_lru *lru, const char *psz_key, void *value,
+                          size_t size )
 {
     struct vlc_lru_entry *entry = calloc(1, sizeof(*entry));
     if(!entry)
@@ -115,21 +142,35 @@ void vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value )
         return;
     }
     entry->value = value;
+    entry->size = sizeof(*entry) + strlen(psz_key) + 1 + size;
     vlc_list_init( &entry->node );
 
     if( vlc_list_is_empty( &lru->list ) )
         lru->last = entry;
     vlc_dictionary_insert( &lru->dict, psz_key, entry );
     vlc_list_add_after( &entry->node, &lru->list );
+    lru->size += entry->size;
 
     if( (unsigned)vlc_dictionary_keys_count(&lru->dict) >= lru->max )
-    {
-        struct vlc_lru_entry *toremove = lru->last;
-        lru->last = vlc_list_entry(toremove->node.prev, struct vlc_lru_entry, node);
-        vlc_list_remove(&toremove->node);
-        vlc_dictionary_remove_value_for_key(&lru->dict, toremove->psz_key, NULL, NULL);
-        vlc_lru_releaseentry(toremove, lru);
-    }
+        vlc_lru_RemoveLast( lru );
+
+    /* never evict the entry just inserted */
+    while( lru->size > lru->maxsize && lru->last != entry )
+        vlc_lru_RemoveLast( lru );
+}
+
+void vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value )
+{
+    vlc_lru_InsertSized( lru, psz_key, value, 0 );
+}
+
+void vlc_lru_DumpStats( vlc_lru *lru, vlc_object_t *p_obj, const char *psz_name )
+{
+    uint64_t lookups = lru->hits + lru->misses;
+    msg_Dbg( p_obj, "%s cache: %"PRIu64"/%"PRIu64" hits (%u%%), %zu entries, %zu KiB",
+             psz_name, lru->hits, lookups,
+             lookups ? (unsigned)(lru->hits * 100 / lookups) : 0,
+             vlc_dictionary_keys_count( &lru->dict ), lru->size >> 10 );
 }
 
 void vlc_lru_Apply( vlc_lru *lru,
@@ -29,10 +29,18 @@ typedef struct vlc_lru vlc_lru;
 vlc_lru * vlc_lru_New( unsigned max,
                        void(*releaseValue)(void *, void *), void * );
 void vlc_lru_Release( vlc_lru *lru );
+/* Also evict the oldest entries above that accounted size (unbounded by default) */
+void vlc_lru_SetMaxSize( vlc_lru *lru, size_t maxsize );
 
 bool   vlc_lru_HasKey( vlc_lru *lru, const char *psz_key );
 void * vlc_lru_Get( vlc_lru *lru, const char *psz_key );
 void   vlc_lru_Insert( vlc_lru *lru, const char *psz_key, void *value );
+/* size is the memory used by the value, accounted against the max size */
+void   vlc_lru_InsertSized( vlc_lru *lru, const char *psz_key, void *value,
+                            size_t size );
+
+/* Logs the hits and misses of vlc_lru_Get() and the cache usage */
+void   vlc_lru_DumpStats( vlc_lru *lru, vlc_object_t *p_obj, const char *psz_name );
 
 void   vlc_lru_Apply( vlc_lru *lru,
                       void(*func)(void *, const char *, void *),
@@ -41,6 +41,7 @@
 #include <vlc_common.h>
 #include <vlc_filter.h>
 #include <vlc_text_style.h>
+#include <vlc_memstream.h>
 
 /* Freetype */
 #include <ft2build.h>
@@ -64,8 +65,10 @@
 #include "freetype.h"
 #include "text_layout.h"
 #include "platform_fonts.h"
+#include "lru.h"
 
 #include <stdlib.h>
+#include <assert.h>
 
 /* Win32 */
 #ifdef _WIN32
@@ -97,21 +100,39 @@
  * having the same font face, size, and style, Unicode script
  * and text direction
  */
+#ifdef HAVE_HARFBUZZ
+/**
+ * Glyphs of a run shaped by HarfBuzz, shared with the shaped runs cache
+ */
+typedef struct shaped_run_t
+{
+    unsigned             i_refcount;
+    unsigned             i_glyph_count;
+    hb_glyph_position_t *p_positions;
+    hb_glyph_info_t      p_infos[];
+} shaped_run_t;
+#endif
+
 typedef struct run_desc_t
 {
     int                         i_start_offset;
     int                         i_end_offset;
     vlc_face_id_t              *p_faceid;
     const text_style_t         *p_style;
+    int                         i_stroker_radius;
 
 #ifdef HAVE_HARFBUZZ
     hb_script_t                 script;
     hb_direction_t              direction;
-    hb_buffer_t                *p_buffer;
+    shaped_run_t               *p_shaped;
 #endif
 
 } run_desc_t;
 
+/* Style applied by modifying the outline of the glyph */
+#define GLYPH_EMBOLDENED 0x1
+#define GLYPH_OBLIQUE    0x2
+
 /**
  * Glyph bitmaps. Advance and offset are 26.6 values
  */
@@ -127,6 +148,8 @@ typedef struct glyph_bitmaps_t
     int      i_y_offset;
     int      i_x_advance;
     int      i_y_advance;
+    FT_UInt  i_glyph_index; /**< source of the cached bitmaps */
+    int      i_glyph_flags; /**< GLYPH_EMBOLDENED, GLYPH_OBLIQUE */
 } glyph_bitmaps_t;
 
 typedef struct paragraph_t
@@ -680,6 +703,160 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
 }
 
 #ifdef HAVE_HARFBUZZ
+static void ShapedRunRelease( shaped_run_t *p_shaped )
+{
+    assert( p_shaped->i_refcount );
+    if( --p_shaped->i_refcount == 0 )
+        free( p_shaped );
+}
+
+static void LRUShapedRunRelease( void *priv, void *value )
+{
+    VLC_UNUSED( priv );
+    ShapedRunRelease( value );
+}
+
+vlc_lru * NewShapedRunsCache( size_t i_maxsize )
+{
+    vlc_lru *p_cache = vlc_lru_New( 256, LRUShapedRunRelease, NULL );
+    if( p_cache )
+        vlc_lru_SetMaxSize( p_cache, i_maxsize );
+    return p_cache;
+}
+
+/**
+ * Key of a run in the shaped runs cache: its font, size, direction and
+ * script, followed by its text as (modified, NUL-free) UTF-8.
+ */
+static char * ShapedRunKey( const paragraph_t *p_paragraph, const run_desc_t *p_run,
+                            const vlc_ftcache_metrics_t *p_metrics )
+{
+    struct vlc_memstream stream;
+    if( vlc_memstream_open( &stream ) )
+        return NULL;
+
+    vlc_memstream_printf( &stream, "%s#%d#%d,%d,%d,%"PRIx32"#",
+                          p_run->p_faceid->psz_filename, p_run->p_faceid->idx,
+                          p_metrics->width_px, p_metrics->height_px,
+                          (int) p_run->direction, (uint32_t) p_run->script );
+
+    for( int i = p_run->i_start_offset; i < p_run->i_end_offset; ++i )
+    {
+        const uni_char_t c = p_paragraph->p_code_points[ i ];
+        if( c != 0 && c < 0x80 )
+            vlc_memstream_putc( &stream, c );
+        else if( c < 0x800 )
+        {
+            vlc_memstream_putc( &stream, 0xC0 | (c >> 6) );
+            vlc_memstream_putc( &stream, 0x80 | (c & 0x3F) );
+        }
+        else if( c < 0x10000 )
+        {
+            vlc_memstream_putc( &stream, 0xE0 | (c >> 12) );
+            vlc_memstream_putc( &stream, 0x80 | ((c >> 6) & 0x3F) );
+            vlc_memstream_putc( &stream, 0x80 | (c & 0x3F) );
+        }
+        else
+        {
+            vlc_memstream_putc( &stream, 0xF0 | ((c >> 18) & 0x07) );
+            vlc_memstream_putc( &stream, 0x80 | ((c >> 12) & 0x3F) );
+            vlc_memstream_putc( &stream, 0x80 | ((c >> 6) & 0x3F) );
+            vlc_memstream_putc( &stream, 0x80 | (c & 0x3F) );
+        }
+    }
+
+    if( vlc_memstream_close( &stream ) )
+        return NULL;
+    return stream.ptr;
+}
+
+/**
+ * Shape a run with its loaded face, or get it from the shaped runs cache.
+ * The returned run must be released with ShapedRunRelease().
+ */
+static shaped_run_t * ShapeRun( filter_t *p_filter, const paragraph_t *p_paragraph,
+                                const run_desc_t *p_run, FT_Face p_face,
+                                const vlc_ftcache_metrics_t *p_metrics )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    char *psz_key = ShapedRunKey( p_paragraph, p_run, p_metrics );
+    shaped_run_t *p_shaped = NULL;
+    if( psz_key )
+        p_shaped = vlc_lru_Get( p_sys->shaped_runs, psz_key );
+    if( p_shaped )
+    {
+        p_shaped->i_refcount++;
+        free( psz_key );
+        return p_shaped;
+    }
+
+    hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
+    if( !p_hb_font )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+        free( psz_key );
+        return NULL;
+    }
+
+    hb_buffer_t *p_buffer = hb_buffer_create();
+    if( !p_buffer )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
+        hb_font_destroy( p_hb_font );
+        free( psz_key );
+        return NULL;
+    }
+
+    hb_buffer_set_direction( p_buffer, p_run->direction );
+    hb_buffer_set_script( p_buffer, p_run->script );
+    hb_buffer_add_utf32( p_buffer,
+                         p_paragraph->p_code_points + p_run->i_start_offset,
+                         p_run->i_end_offset - p_run->i_start_offset, 0,
+                         p_run->i_end_offset - p_run->i_start_offset );
+    hb_shape( p_hb_font, p_buffer, 0, 0 );
+
+    hb_font_destroy( p_hb_font );
+
+    unsigned int i_glyph_count;
+    const hb_glyph_info_t *p_infos =
+            hb_buffer_get_glyph_infos( p_buffer, &i_glyph_count );
+    const hb_glyph_position_t *p_positions =
+            hb_buffer_get_glyph_positions( p_buffer, &i_glyph_count );
+    if( i_glyph_count == 0 )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz() invalid glyph count in shaped run" );
+        hb_buffer_destroy( p_buffer );
+        free( psz_key );
+        return NULL;
+    }
+
+    const size_t i_size = sizeof( *p_shaped ) + i_glyph_count *
+                          ( sizeof( *p_infos ) + sizeof( *p_positions ) );
+    p_shaped = malloc( i_size );
+    if( p_shaped )
+    {
+        p_shaped->i_refcount = 1;
+        p_shaped->i_glyph_count = i_glyph_count;
+        p_shaped->p_positions =
+                (hb_glyph_position_t *) &p_shaped->p_infos[ i_glyph_count ];
+        memcpy( p_shaped->p_infos, p_infos, i_glyph_count * sizeof( *p_infos ) );
+        memcpy( p_shaped->p_positions, p_positions,
+                i_glyph_count * sizeof( *p_positions ) );
+        if( psz_key )
+        {
+            p_shaped->i_refcount++;
+            vlc_lru_InsertSized( p_sys->shaped_runs, psz_key, p_shaped, i_size );
+        }
+    }
+    hb_buffer_destroy( p_buffer );
+    free( psz_key );
+    return p_shaped;
+}
+
 /**
  * Shape an itemized paragraph using HarfBuzz.
  * This is where the glyphs of complex scripts get their positions
@@ -742,43 +919,11 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
         if(!p_face)
             goto error;
 
-        hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_hb_font )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+        p_run->p_shaped = ShapeRun( p_filter, p_paragraph, p_run, p_face, &metrics );
+        if( !p_run->p_shaped )
             goto error;
-        }
-
-        p_run->p_buffer = hb_buffer_create();
-        if( !p_run->p_buffer )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
-            hb_font_destroy( p_hb_font );
-            goto error;
-        }
-
-        hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
-        hb_buffer_set_script( p_run->p_buffer, p_run->script );
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-        hb_shape( p_hb_font, p_run->p_buffer, 0, 0 );
 
-        hb_font_destroy( p_hb_font );
-        p_hb_font = 0;
-
-        const unsigned length = hb_buffer_get_length( p_run->p_buffer );
-        if( length == 0 )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz() invalid glyph count in shaped run" );
-            goto error;
-        }
-
-        i_total_glyphs += length;
+        i_total_glyphs += p_run->p_shaped->i_glyph_count;
     }
 
     p_new_paragraph = NewParagraph( p_filter, i_total_glyphs,
@@ -801,11 +946,9 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
         run_desc_t *p_run = p_paragraph->p_runs + i;
-        unsigned int i_glyph_count;
-        const hb_glyph_info_t *p_infos =
-                hb_buffer_get_glyph_infos( p_run->p_buffer, &i_glyph_count );
-        const hb_glyph_position_t *p_positions =
-                hb_buffer_get_glyph_positions( p_run->p_buffer, &i_glyph_count );
+        const unsigned int i_glyph_count = p_run->p_shaped->i_glyph_count;
+        const hb_glyph_info_t *p_infos = p_run->p_shaped->p_infos;
+        const hb_glyph_position_t *p_positions = p_run->p_shaped->p_positions;
         for( unsigned int j = 0; j < i_glyph_count; ++j )
         {
             /*
@@ -852,7 +995,7 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
-        hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        ShapedRunRelease( p_paragraph->p_runs[ i ].p_shaped );
     }
     FreeParagraph( *p_old_paragraph );
     *p_old_paragraph = p_new_paragraph;
@@ -862,8 +1005,8 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 error:
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
-        if( p_paragraph->p_runs[ i ].p_buffer )
-            hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        if( p_paragraph->p_runs[ i ].p_shaped )
+            ShapedRunRelease( p_paragraph->p_runs[ i ].p_shaped );
     }
 
     if( p_new_paragraph )
@@ -1037,6 +1180,7 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                             FT_STROKER_LINECAP_ROUND,
                             FT_STROKER_LINEJOIN_ROUND, 0 );
         }
+        p_run->i_stroker_radius = i_stroker_radius;
 
         for( int j = p_run->i_start_offset; j < p_run->i_end_offset; ++j )
         {
@@ -1100,6 +1244,9 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
 
 #undef SKIP_GLYPH
 
+            p_bitmaps->i_glyph_index = i_glyph_index;
+            p_bitmaps->i_glyph_flags = 0;
+
             const bool b_embolden = ( p_style->i_style_flags & STYLE_BOLD ) &&
                                    !( style_flags & FT_STYLE_FLAG_BOLD );
             const bool b_oblique = ( p_style->i_style_flags & STYLE_ITALIC ) &&
@@ -1117,9 +1264,13 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                         FT_Matrix matrix = { .xx = 0x10000L, .xy = 0.12 * 0x10000L,
                                              .yy = 0x10000L, .yx = 0 };
                         FT_Glyph_Transform( transformed, &matrix, 0 );
+                        p_bitmaps->i_glyph_flags |= GLYPH_OBLIQUE;
                     }
                     if( b_embolden )
+                    {
                         FT_Outline_Embolden( &((FT_OutlineGlyph)transformed)->outline, 1<<6 );
+                        p_bitmaps->i_glyph_flags |= GLYPH_EMBOLDENED;
+                    }
                     vlc_ftcache_Glyph_Release( p_sys->ftcache, &p_bitmaps->cglyph );
                     p_bitmaps->cglyph.p_glyph = transformed;
                 }
@@ -1154,6 +1305,22 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
     return VLC_SUCCESS;
 }
 
+/**
+ * Rasterise a glyph of the run, using the bitmaps cache.
+ * i_radius is the stroker radius of the outlined glyphs, 0 otherwise.
+ */
+static int RenderGlyph( filter_t *p_filter, const run_desc_t *p_run,
+                        const vlc_ftcache_metrics_t *p_metrics,
+                        const glyph_bitmaps_t *p_bitmaps, int i_radius,
+                        FT_Glyph *p_glyph, const FT_Vector *p_pen )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    return vlc_ftcache_GetGlyphBitmap( p_sys->ftcache, p_run->p_faceid,
+                                       p_bitmaps->i_glyph_index, p_metrics,
+                                       p_bitmaps->i_glyph_flags, i_radius,
+                                       p_glyph, p_pen );
+}
+
 static int LayoutLine( filter_t *p_filter,
                        paragraph_t *p_paragraph,
                        int i_first_char, int i_last_char,
@@ -1247,17 +1414,18 @@ static int LayoutLine( filter_t *p_filter,
 
         /* Shadow being a reference to main glyph, it must be processed first */
         if( p_bitmaps->p_shadow &&
-            FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                &pen_shadow, 0 ) )
+            RenderGlyph( p_filter, p_run, &metrics, p_bitmaps,
+                         p_bitmaps->p_shadow == p_bitmaps->coutline.p_glyph ?
+                         p_run->i_stroker_radius : 0,
+                         &p_bitmaps->p_shadow, &pen_shadow ) )
         {
             p_bitmaps->p_shadow = 0;
         }
 
         /* Ensure we don't release reference */
         FT_Glyph bitmapglyph = p_bitmaps->cglyph.p_glyph;
-        if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                FT_RENDER_MODE_NORMAL,
-                                &pen_new, 0 ) )
+        if( RenderGlyph( p_filter, p_run, &metrics, p_bitmaps, 0,
+                         &bitmapglyph, &pen_new ) )
         {
             ReleaseGlyphBitMaps( p_filter, p_bitmaps );
             continue;
@@ -1270,9 +1438,8 @@ static int LayoutLine( filter_t *p_filter,
         if( p_bitmaps->coutline.p_glyph )
         {
             bitmapglyph = p_bitmaps->coutline.p_glyph;
-            if( FT_Glyph_To_Bitmap( &bitmapglyph,
-                                    FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 0 ) )
+            if( RenderGlyph( p_filter, p_run, &metrics, p_bitmaps,
+                             p_run->i_stroker_radius, &bitmapglyph, &pen_new ) )
                 bitmapglyph = NULL;
             vlc_ftcache_Custom_Glyph_Release( &p_bitmaps->coutline );
             p_bitmaps->coutline.p_glyph = bitmapglyph;
@@ -105,3 +105,12 @@ typedef struct
  */
 int LayoutTextBlock( filter_t *p_filter, const layout_text_block_t *p_textblock,
                      line_desc_t **pp_lines, FT_BBox *p_bbox, int *pi_max_face_height );
+
+#ifdef HAVE_HARFBUZZ
+/**
+ * Create the cache of the runs shaped by HarfBuzz.
+ *
+ * \param i_maxsize memory bound of the cache, in bytes [IN]
+ */
+vlc_lru * NewShapedRunsCache( size_t i_maxsize );
+#endif
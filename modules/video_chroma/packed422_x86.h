@@ -0,0 +1,156 @@
+/*****************************************************************************
+ * packed422_x86.h: packed YUV 4:2:2 to planar conversion with AVX2
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_AVX2_INTRINSICS
+#include <immintrin.h>
+#include <vlc_cpu.h>
+
+/* Byte offsets of the first Y, U and V samples in a packed macropixel */
+enum packed422_order
+{
+    PACKED422_YUYV, /* Y at 0, U at 1, V at 3 */
+    PACKED422_YVYU, /* Y at 0, V at 1, U at 3 */
+    PACKED422_UYVY, /* U at 0, Y at 1, V at 2 */
+};
+
+/**
+ * Splits one line of packed 4:2:2 into planes, 32 pixels at a time.
+ * p_u and p_v may be NULL to only extract the luma.
+ *
+ * \return the number of pixels converted (a multiple of 32)
+ */
+VLC_AVX2
+static inline unsigned Packed422_Split_AVX2(uint8_t *p_y, uint8_t *p_u,
+                                            uint8_t *p_v, const uint8_t *p_line,
+                                            unsigned i_width,
+                                            enum packed422_order order)
+{
+    const __m256i lo = _mm256_set1_epi16(0x00ff);
+    unsigned i_x = 0;
+
+    for( ; i_x + 32 <= i_width; i_x += 32 )
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&p_line[2 * i_x]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&p_line[2 * i_x + 32]);
+        __m256i ya, yb, ca, cb;
+
+        if( order == PACKED422_UYVY )
+        {
+            ya = _mm256_srli_epi16(a, 8);
+            yb = _mm256_srli_epi16(b, 8);
+            ca = _mm256_and_si256(a, lo);
+            cb = _mm256_and_si256(b, lo);
+        }
+        else
+        {
+            ya = _mm256_and_si256(a, lo);
+            yb = _mm256_and_si256(b, lo);
+            ca = _mm256_srli_epi16(a, 8);
+            cb = _mm256_srli_epi16(b, 8);
+        }
+
+        /* Packing works within 128-bit lanes: restore the quadword order */
+        __m256i y = _mm256_permute4x64_epi64(_mm256_packus_epi16(ya, yb), 0xD8);
+        _mm256_storeu_si256((__m256i *)&p_y[i_x], y);
+
+        if( p_u == NULL )
+            continue;
+
+        /* First and second chroma samples of each macropixel */
+        __m256i c = _mm256_permute4x64_epi64(_mm256_packus_epi16(ca, cb), 0xD8);
+        __m256i c1 = _mm256_and_si256(c, lo);
+        __m256i c2 = _mm256_srli_epi16(c, 8);
+        c = _mm256_permute4x64_epi64(_mm256_packus_epi16(c1, c2), 0xD8);
+
+        __m128i first = _mm256_castsi256_si128(c);
+        __m128i second = _mm256_extracti128_si256(c, 1);
+        if( order == PACKED422_YVYU )
+        {
+            _mm_storeu_si128((__m128i *)&p_v[i_x / 2], first);
+            _mm_storeu_si128((__m128i *)&p_u[i_x / 2], second);
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i *)&p_u[i_x / 2], first);
+            _mm_storeu_si128((__m128i *)&p_v[i_x / 2], second);
+        }
+    }
+    return i_x;
+}
+
+/**
+ * Converts the remaining pixels of a line, after Packed422_Split_AVX2().
+ */
+static inline void Packed422_Split_C(uint8_t *p_y, uint8_t *p_u,
+                                     uint8_t *p_v, const uint8_t *p_line,
+                                     unsigned i_x, unsigned i_width,
+                                     enum packed422_order order)
+{
+    const unsigned y_off = order == PACKED422_UYVY;
+    const unsigned u_off = order == PACKED422_YUYV ? 1 :
+                           order == PACKED422_YVYU ? 3 : 0;
+    const unsigned v_off = order == PACKED422_YUYV ? 3 :
+                           order == PACKED422_YVYU ? 1 : 2;
+
+    for( ; i_x + 1 < i_width; i_x += 2 )
+    {
+        const uint8_t *p = &p_line[2 * i_x];
+        p_y[i_x] = p[y_off];
+        p_y[i_x + 1] = p[y_off + 2];
+        if( p_u != NULL )
+        {
+            p_u[i_x / 2] = p[u_off];
+            p_v[i_x / 2] = p[v_off];
+        }
+    }
+}
+
+/**
+ * Converts a packed 4:2:2 picture to planar 4:2:2 or 4:2:0.
+ * In 4:2:0, the chroma of the odd lines is dropped, as in the C code.
+ */
+VLC_AVX2
+static inline void Packed422_Planar_AVX2(const picture_t *p_source,
+                                         picture_t *p_dest,
+                                         unsigned i_width, unsigned i_height,
+                                         enum packed422_order order,
+                                         bool b_420)
+{
+    const plane_t *p_src = &p_source->p[0];
+
+    for( unsigned i_y = 0; i_y < i_height; i_y++ )
+    {
+        const uint8_t *p_line = &p_src->p_pixels[i_y * p_src->i_pitch];
+        uint8_t *p_y = &p_dest->Y_PIXELS[i_y * p_dest->p[Y_PLANE].i_pitch];
+        uint8_t *p_u = NULL, *p_v = NULL;
+
+        if( !b_420 || !(i_y & 1) )
+        {
+            const unsigned i_cy = b_420 ? i_y / 2 : i_y;
+            p_u = &p_dest->U_PIXELS[i_cy * p_dest->p[U_PLANE].i_pitch];
+            p_v = &p_dest->V_PIXELS[i_cy * p_dest->p[V_PLANE].i_pitch];
+        }
+
+        unsigned i_x = Packed422_Split_AVX2( p_y, p_u, p_v, p_line, i_width,
+                                             order );
+        Packed422_Split_C( p_y, p_u, p_v, p_line, i_x, i_width, order );
+    }
+}
+#endif
@@ -34,6 +34,10 @@
 #include <vlc_picture.h>
 #include <vlc_chroma_probe.h>
 
+#ifdef PLUGIN_AVX2
+# include "packed422_x86.h"
+#endif
+
 #define SRC_FOURCC "YUY2,YUNV,YVYU,UYVY,UYNV,Y422"
 #define DEST_FOURCC  "I420"
 
@@ -46,16 +50,30 @@ static int  Activate ( filter_t * );
  * Module descriptor
  *****************************************************************************/
 
+#if defined (PLUGIN_AVX2)
+#define COST 0.75
+#else
+#define COST 1
+#endif
+
 static void ProbeChroma(vlc_chroma_conv_vec *vec)
 {
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_YUYV, VLC_CODEC_I420, false);
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_YVYU, VLC_CODEC_I420, false);
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_UYVY, VLC_CODEC_I420, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_YUYV, VLC_CODEC_I420, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_YVYU, VLC_CODEC_I420, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_UYVY, VLC_CODEC_I420, false);
 }
 
 vlc_module_begin ()
+#if defined (PLUGIN_AVX2)
+    set_description( N_("AVX2 conversions from " SRC_FOURCC " to "
+                        DEST_FOURCC) )
+    set_callback_video_converter( Activate, 100 )
+# define vlc_CPU_capable() vlc_CPU_AVX2()
+#else
     set_description( N_("Conversions from " SRC_FOURCC " to " DEST_FOURCC) )
     set_callback_video_converter( Activate, 80 )
+# define vlc_CPU_capable() (true)
+#endif
     add_submodule()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
@@ -71,6 +89,9 @@ VIDEO_FILTER_WRAPPER( UYVY_I420 )
  *****************************************************************************/
 static int Activate( filter_t *p_filter )
 {
+    if( !vlc_CPU_capable() )
+        return -1;
+
     if( p_filter->fmt_in.video.i_width & 1
      || p_filter->fmt_in.video.i_height & 1 )
     {
@@ -112,6 +133,8 @@ static int Activate( filter_t *p_filter )
 
 /* Following functions are local */
 
+#if !defined (PLUGIN_AVX2)
+
 /*****************************************************************************
  * YUY2_I420: packed YUY2 4:2:2 to planar YUV 4:2:0
  *****************************************************************************/
@@ -287,8 +310,8 @@ static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
             for( i_x = (p_filter->fmt_out.video.i_x_offset + p_filter->fmt_out.video.i_visible_width) / 8 ; i_x-- ; )
             {
     #define C_UYVY_YUV422_skip( p_line, p_y, p_u, p_v )      \
-                *p_u++ = *p_line++; p_line++; \
-                *p_v++ = *p_line++; p_line++
+                p_line++; *p_y++ = *p_line++; \
+                p_line++; *p_y++ = *p_line++
                 C_UYVY_YUV422_skip( p_line, p_y, p_u, p_v );
                 C_UYVY_YUV422_skip( p_line, p_y, p_u, p_v );
                 C_UYVY_YUV422_skip( p_line, p_y, p_u, p_v );
@@ -315,12 +338,33 @@ static void UYVY_I420( filter_t *p_filter, picture_t *p_source,
             {
                 C_UYVY_YUV422( p_line, p_y, p_u, p_v );
             }
-            p_y += i_dest_margin;
+            p_u += i_dest_margin_c;
+            p_v += i_dest_margin_c;
         }
         p_line += i_source_margin;
-        p_u += i_dest_margin_c;
-        p_v += i_dest_margin_c;
+        p_y += i_dest_margin;
 
         b_skip = !b_skip;
     }
 }
+
+#else
+/*****************************************************************************
+ * AVX2 versions of the above
+ *****************************************************************************/
+#define PACKED422_I420_AVX2( name, order )                                    \
+VLC_AVX2                                                                      \
+static void name( filter_t *p_filter, picture_t *p_source,                    \
+                                      picture_t *p_dest )                     \
+{                                                                             \
+    const video_format_t *fmt = &p_filter->fmt_out.video;                     \
+    Packed422_Planar_AVX2( p_source, p_dest,                                  \
+                           fmt->i_x_offset + fmt->i_visible_width,            \
+                           fmt->i_y_offset + fmt->i_visible_height,           \
+                           order, true );                                     \
+}
+
+PACKED422_I420_AVX2( YUY2_I420, PACKED422_YUYV )
+PACKED422_I420_AVX2( YVYU_I420, PACKED422_YVYU )
+PACKED422_I420_AVX2( UYVY_I420, PACKED422_UYVY )
+#endif
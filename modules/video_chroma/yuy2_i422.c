@@ -34,6 +34,10 @@
 #include <vlc_picture.h>
 #include <vlc_chroma_probe.h>
 
+#ifdef PLUGIN_AVX2
+# include "packed422_x86.h"
+#endif
+
 #define SRC_FOURCC "YUY2,YUNV,YVYU,UYVY,UYNV,Y422"
 #define DEST_FOURCC  "I422"
 
@@ -46,16 +50,30 @@ static int  Activate ( filter_t * );
  * Module descriptor
  *****************************************************************************/
 
+#if defined (PLUGIN_AVX2)
+#define COST 0.75
+#else
+#define COST 1
+#endif
+
 static void ProbeChroma(vlc_chroma_conv_vec *vec)
 {
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_YUYV, VLC_CODEC_I422, false);
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_YVYU, VLC_CODEC_I422, false);
-    vlc_chroma_conv_add(vec, 1, VLC_CODEC_UYVY, VLC_CODEC_I422, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_YUYV, VLC_CODEC_I422, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_YVYU, VLC_CODEC_I422, false);
+    vlc_chroma_conv_add(vec, COST, VLC_CODEC_UYVY, VLC_CODEC_I422, false);
 }
 
 vlc_module_begin ()
+#if defined (PLUGIN_AVX2)
+    set_description( N_("AVX2 conversions from " SRC_FOURCC " to "
+                        DEST_FOURCC) )
+    set_callback_video_converter( Activate, 100 )
+# define vlc_CPU_capable() vlc_CPU_AVX2()
+#else
     set_description( N_("Conversions from " SRC_FOURCC " to " DEST_FOURCC) )
     set_callback_video_converter( Activate, 80 )
+# define vlc_CPU_capable() (true)
+#endif
     add_submodule()
         set_callback_chroma_conv_probe(ProbeChroma)
 vlc_module_end ()
@@ -71,6 +89,9 @@ VIDEO_FILTER_WRAPPER( UYVY_I422 )
  *****************************************************************************/
 static int Activate( filter_t *p_filter )
 {
+    if( !vlc_CPU_capable() )
+        return -1;
+
     if( p_filter->fmt_in.video.i_width & 1
      || p_filter->fmt_in.video.i_height & 1 )
     {
@@ -112,6 +133,8 @@ static int Activate( filter_t *p_filter )
 
 /* Following functions are local */
 
+#if !defined (PLUGIN_AVX2)
+
 /*****************************************************************************
  * YUY2_I422: packed YUY2 4:2:2 to planar YUV 4:2:2
  *****************************************************************************/
@@ -243,3 +266,21 @@ static void UYVY_I422( filter_t *p_filter, picture_t *p_source,
         p_v += i_dest_margin_c;
     }
 }
+
+#else
+/*****************************************************************************
+ * AVX2 versions of the above
+ *****************************************************************************/
+#define PACKED422_I422_AVX2( name, order )                                    \
+VLC_AVX2                                                                      \
+static void name( filter_t *p_filter, picture_t *p_source,                    \
+                                      picture_t *p_dest )                     \
+{                                                                             \
+    Packed422_Planar_AVX2( p_source, p_dest, p_filter->fmt_out.video.i_width, \
+                           p_filter->fmt_out.video.i_height, order, false );  \
+}
+
+PACKED422_I422_AVX2( YUY2_I422, PACKED422_YUYV )
+PACKED422_I422_AVX2( YVYU_I422, PACKED422_YVYU )
+PACKED422_I422_AVX2( UYVY_I422, PACKED422_UYVY )
+#endif
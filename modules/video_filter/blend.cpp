@@ -31,8 +31,19 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+#ifdef __ARM_NEON
+# include <arm_neon.h>
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -79,6 +90,18 @@ public:
     {
         return fmt;
     }
+    const picture_t *getPicture() const
+    {
+        return picture;
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
     bool isFull(unsigned) const
     {
         return true;
@@ -607,13 +630,475 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+/*
+ * Vectorized blending of YUVA onto 8-bit 4:2:0 and of RGBA onto 32-bit RGB,
+ * which cover most subpictures. They compute in 16-bit lanes exactly what the
+ * generic code above does, and leave it the columns on the right that do not
+ * fill a whole vector, and the pictures at odd horizontal offsets.
+ */
+namespace {
+
+#define BLEND_YUV_STEP 32 /* pixels of a YUV line blended at once */
+
+/* Layout of a 32-bit RGB destination */
+template <int r, int g, int b, int a>
+struct RgbLayout {
+    /* source lane of each destination lane, the alpha or padding lane taking
+     * the source alpha */
+    static constexpr int lane(int k)
+    {
+        return k == r ? 0 : k == g ? 1 : k == b ? 2 : 3;
+    }
+    static constexpr short color(int k)
+    {
+        return k == r || k == g || k == b ? -1 : 0;
+    }
+    static const int shuffle = lane(0) | lane(1) << 2 | lane(2) << 4 | lane(3) << 6;
+    static const int alpha_shuffle = a >= 0 ? a * 0x55 : 0;
+};
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+struct BlendSSE2 {
+    static const unsigned rgb_step = 4;
+
+    static inline __m128i div255(__m128i v)
+    {
+        v = _mm_add_epi16(_mm_add_epi16(_mm_srli_epi16(v, 8), v),
+                          _mm_set1_epi16(1));
+        return _mm_srli_epi16(v, 8);
+    }
+    static inline __m128i merge(__m128i dst, __m128i src, __m128i f)
+    {
+        const __m128i nf = _mm_sub_epi16(_mm_set1_epi16(255), f);
+        return div255(_mm_add_epi16(_mm_mullo_epi16(dst, nf),
+                                    _mm_mullo_epi16(src, f)));
+    }
+    /* Loads the samples of the even pixels in 16-bit lanes */
+    static inline __m128i even(const uint8_t *p)
+    {
+        return _mm_and_si128(_mm_loadu_si128((const __m128i *)p),
+                             _mm_set1_epi16(0xff));
+    }
+    static void luma(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                     unsigned width, unsigned alpha)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i va = _mm_set1_epi16(alpha);
+
+        for (unsigned x = 0; x < width; x += 16) {
+            const __m128i s = _mm_loadu_si128((const __m128i *)&src[x]);
+            const __m128i f = _mm_loadu_si128((const __m128i *)&a[x]);
+            const __m128i d = _mm_loadu_si128((const __m128i *)&dst[x]);
+            const __m128i flo = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(f, zero), va));
+            const __m128i fhi = div255(_mm_mullo_epi16(_mm_unpackhi_epi8(f, zero), va));
+            const __m128i lo = merge(_mm_unpacklo_epi8(d, zero),
+                                     _mm_unpacklo_epi8(s, zero), flo);
+            const __m128i hi = merge(_mm_unpackhi_epi8(d, zero),
+                                     _mm_unpackhi_epi8(s, zero), fhi);
+            _mm_storeu_si128((__m128i *)&dst[x], _mm_packus_epi16(lo, hi));
+        }
+    }
+    static void chroma(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                       const uint8_t *sv, const uint8_t *a,
+                       unsigned width, unsigned alpha)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i va = _mm_set1_epi16(alpha);
+
+        for (unsigned x = 0; x < width; x += 32) {
+            const __m128i flo = div255(_mm_mullo_epi16(even(&a[x]), va));
+            const __m128i fhi = div255(_mm_mullo_epi16(even(&a[x + 16]), va));
+            const __m128i u = _mm_loadu_si128((const __m128i *)&du[x / 2]);
+            const __m128i v = _mm_loadu_si128((const __m128i *)&dv[x / 2]);
+            _mm_storeu_si128((__m128i *)&du[x / 2], _mm_packus_epi16(
+                merge(_mm_unpacklo_epi8(u, zero), even(&su[x]), flo),
+                merge(_mm_unpackhi_epi8(u, zero), even(&su[x + 16]), fhi)));
+            _mm_storeu_si128((__m128i *)&dv[x / 2], _mm_packus_epi16(
+                merge(_mm_unpacklo_epi8(v, zero), even(&sv[x]), flo),
+                merge(_mm_unpackhi_epi8(v, zero), even(&sv[x + 16]), fhi)));
+        }
+    }
+    static void chromaSemiPlanar(uint8_t *dc, const uint8_t *s1,
+                                 const uint8_t *s2, const uint8_t *a,
+                                 unsigned width, unsigned alpha)
+    {
+        const __m128i va = _mm_set1_epi16(alpha);
+
+        for (unsigned x = 0; x < width; x += 16) {
+            const __m128i f = div255(_mm_mullo_epi16(even(&a[x]), va));
+            const __m128i d = _mm_loadu_si128((const __m128i *)&dc[x]);
+            const __m128i c1 = merge(_mm_and_si128(d, _mm_set1_epi16(0xff)),
+                                     even(&s1[x]), f);
+            const __m128i c2 = merge(_mm_srli_epi16(d, 8), even(&s2[x]), f);
+            _mm_storeu_si128((__m128i *)&dc[x],
+                             _mm_or_si128(c1, _mm_slli_epi16(c2, 8)));
+        }
+    }
+    /* Blends 2 pixels in 16-bit lanes */
+    template <class L, bool has_alpha>
+    static inline __m128i rgb(__m128i d, __m128i s, __m128i va, __m128i opaque)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i color = _mm_set_epi16(L::color(3), L::color(2),
+                                            L::color(1), L::color(0),
+                                            L::color(3), L::color(2),
+                                            L::color(1), L::color(0));
+        const __m128i sa = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xff), 0xff);
+        s = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, L::shuffle), L::shuffle);
+        if (!has_alpha)
+            return merge(d, s, _mm_and_si128(opaque, color));
+
+        const __m128i f = div255(_mm_mullo_epi16(sa, va));
+        const __m128i da = _mm_shufflehi_epi16(_mm_shufflelo_epi16(d, L::alpha_shuffle),
+                                               L::alpha_shuffle);
+        /* the alpha lane is merged with 255, after the colors are merged
+         * with the inverse of the destination alpha */
+        const __m128i f1 = _mm_andnot_si128(_mm_cmpeq_epi16(f, zero),
+                _mm_and_si128(_mm_sub_epi16(_mm_set1_epi16(255), da), color));
+        s = _mm_or_si128(_mm_and_si128(s, color),
+                         _mm_andnot_si128(color, _mm_set1_epi16(255)));
+        return merge(merge(d, s, f1), s, f);
+    }
+    template <int r, int g, int b, int a>
+    static void rgb(uint8_t *dst, const uint8_t *src, unsigned width,
+                    unsigned alpha)
+    {
+        typedef RgbLayout<r, g, b, a> L;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i va = _mm_set1_epi16(alpha);
+        const __m128i opaque = div255(_mm_mullo_epi16(va, _mm_set1_epi16(255)));
+
+        for (unsigned x = 0; x < width; x += 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *)&src[4 * x]);
+            const __m128i d = _mm_loadu_si128((const __m128i *)&dst[4 * x]);
+            const __m128i lo = rgb<L, a >= 0>(_mm_unpacklo_epi8(d, zero),
+                                              _mm_unpacklo_epi8(s, zero),
+                                              va, opaque);
+            const __m128i hi = rgb<L, a >= 0>(_mm_unpackhi_epi8(d, zero),
+                                              _mm_unpackhi_epi8(s, zero),
+                                              va, opaque);
+            _mm_storeu_si128((__m128i *)&dst[4 * x], _mm_packus_epi16(lo, hi));
+        }
+    }
+};
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+struct BlendAVX2 {
+    static const unsigned rgb_step = 8;
+
+    VLC_AVX2 static inline __m256i div255(__m256i v)
+    {
+        v = _mm256_add_epi16(_mm256_add_epi16(_mm256_srli_epi16(v, 8), v),
+                             _mm256_set1_epi16(1));
+        return _mm256_srli_epi16(v, 8);
+    }
+    VLC_AVX2 static inline __m256i merge(__m256i dst, __m256i src, __m256i f)
+    {
+        const __m256i nf = _mm256_sub_epi16(_mm256_set1_epi16(255), f);
+        return div255(_mm256_add_epi16(_mm256_mullo_epi16(dst, nf),
+                                       _mm256_mullo_epi16(src, f)));
+    }
+    VLC_AVX2 static inline __m256i even(const uint8_t *p)
+    {
+        return _mm256_and_si256(_mm256_loadu_si256((const __m256i *)p),
+                                _mm256_set1_epi16(0xff));
+    }
+    /* Merges 16 samples with the given 16-bit source and factors */
+    VLC_AVX2 static inline void merge16(uint8_t *dst, __m256i s, __m256i f)
+    {
+        const __m256i d = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)dst));
+        const __m256i v = merge(d, s, f);
+        _mm_storeu_si128((__m128i *)dst,
+                         _mm_packus_epi16(_mm256_castsi256_si128(v),
+                                          _mm256_extracti128_si256(v, 1)));
+    }
+    VLC_AVX2 static void luma(uint8_t *dst, const uint8_t *src,
+                              const uint8_t *a, unsigned width, unsigned alpha)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i va = _mm256_set1_epi16(alpha);
+
+        /* unpacking and packing work within 128-bit lanes, and so keep the
+         * pixel order */
+        for (unsigned x = 0; x < width; x += 32) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *)&src[x]);
+            const __m256i f = _mm256_loadu_si256((const __m256i *)&a[x]);
+            const __m256i d = _mm256_loadu_si256((const __m256i *)&dst[x]);
+            const __m256i flo = div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(f, zero), va));
+            const __m256i fhi = div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(f, zero), va));
+            const __m256i lo = merge(_mm256_unpacklo_epi8(d, zero),
+                                     _mm256_unpacklo_epi8(s, zero), flo);
+            const __m256i hi = merge(_mm256_unpackhi_epi8(d, zero),
+                                     _mm256_unpackhi_epi8(s, zero), fhi);
+            _mm256_storeu_si256((__m256i *)&dst[x], _mm256_packus_epi16(lo, hi));
+        }
+    }
+    VLC_AVX2 static void chroma(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                                const uint8_t *sv, const uint8_t *a,
+                                unsigned width, unsigned alpha)
+    {
+        const __m256i va = _mm256_set1_epi16(alpha);
+
+        for (unsigned x = 0; x < width; x += 32) {
+            const __m256i f = div255(_mm256_mullo_epi16(even(&a[x]), va));
+            merge16(&du[x / 2], even(&su[x]), f);
+            merge16(&dv[x / 2], even(&sv[x]), f);
+        }
+    }
+    VLC_AVX2 static void chromaSemiPlanar(uint8_t *dc, const uint8_t *s1,
+                                          const uint8_t *s2, const uint8_t *a,
+                                          unsigned width, unsigned alpha)
+    {
+        const __m256i va = _mm256_set1_epi16(alpha);
+
+        for (unsigned x = 0; x < width; x += 32) {
+            const __m256i f = div255(_mm256_mullo_epi16(even(&a[x]), va));
+            const __m256i d = _mm256_loadu_si256((const __m256i *)&dc[x]);
+            const __m256i c1 = merge(_mm256_and_si256(d, _mm256_set1_epi16(0xff)),
+                                     even(&s1[x]), f);
+            const __m256i c2 = merge(_mm256_srli_epi16(d, 8), even(&s2[x]), f);
+            _mm256_storeu_si256((__m256i *)&dc[x],
+                                _mm256_or_si256(c1, _mm256_slli_epi16(c2, 8)));
+        }
+    }
+    /* Blends 4 pixels in 16-bit lanes */
+    template <class L, bool has_alpha>
+    VLC_AVX2 static inline __m256i rgb(__m256i d, __m256i s, __m256i va,
+                                       __m256i opaque)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i color = _mm256_set_epi16(L::color(3), L::color(2),
+                                               L::color(1), L::color(0),
+                                               L::color(3), L::color(2),
+                                               L::color(1), L::color(0),
+                                               L::color(3), L::color(2),
+                                               L::color(1), L::color(0),
+                                               L::color(3), L::color(2),
+                                               L::color(1), L::color(0));
+        const __m256i sa = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xff), 0xff);
+        s = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, L::shuffle), L::shuffle);
+        if (!has_alpha)
+            return merge(d, s, _mm256_and_si256(opaque, color));
+
+        const __m256i f = div255(_mm256_mullo_epi16(sa, va));
+        const __m256i da = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(d, L::alpha_shuffle),
+                                                  L::alpha_shuffle);
+        const __m256i f1 = _mm256_andnot_si256(_mm256_cmpeq_epi16(f, zero),
+                _mm256_and_si256(_mm256_sub_epi16(_mm256_set1_epi16(255), da), color));
+        s = _mm256_or_si256(_mm256_and_si256(s, color),
+                            _mm256_andnot_si256(color, _mm256_set1_epi16(255)));
+        return merge(merge(d, s, f1), s, f);
+    }
+    template <int r, int g, int b, int a>
+    VLC_AVX2 static void rgb(uint8_t *dst, const uint8_t *src, unsigned width,
+                             unsigned alpha)
+    {
+        typedef RgbLayout<r, g, b, a> L;
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i va = _mm256_set1_epi16(alpha);
+        const __m256i opaque = div255(_mm256_mullo_epi16(va, _mm256_set1_epi16(255)));
+
+        for (unsigned x = 0; x < width; x += 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *)&src[4 * x]);
+            const __m256i d = _mm256_loadu_si256((const __m256i *)&dst[4 * x]);
+            const __m256i lo = rgb<L, a >= 0>(_mm256_unpacklo_epi8(d, zero),
+                                              _mm256_unpacklo_epi8(s, zero),
+                                              va, opaque);
+            const __m256i hi = rgb<L, a >= 0>(_mm256_unpackhi_epi8(d, zero),
+                                              _mm256_unpackhi_epi8(s, zero),
+                                              va, opaque);
+            _mm256_storeu_si256((__m256i *)&dst[4 * x], _mm256_packus_epi16(lo, hi));
+        }
+    }
+};
+#endif
+
+#ifdef __ARM_NEON
+struct BlendNEON {
+    static const unsigned rgb_step = 16;
+
+    static inline uint16x8_t div255(uint16x8_t v)
+    {
+        return vshrq_n_u16(vaddq_u16(vsraq_n_u16(v, v, 8), vdupq_n_u16(1)), 8);
+    }
+    static inline uint16x8_t merge(uint16x8_t dst, uint16x8_t src, uint16x8_t f)
+    {
+        const uint16x8_t nf = vsubq_u16(vdupq_n_u16(255), f);
+        return div255(vmlaq_u16(vmulq_u16(dst, nf), src, f));
+    }
+    /* Merges 16 samples with 16-bit factors */
+    static inline uint8x16_t merge(uint8x16_t dst, uint8x16_t src,
+                                   uint16x8_t flo, uint16x8_t fhi)
+    {
+        const uint16x8_t lo = merge(vmovl_u8(vget_low_u8(dst)),
+                                    vmovl_u8(vget_low_u8(src)), flo);
+        const uint16x8_t hi = merge(vmovl_u8(vget_high_u8(dst)),
+                                    vmovl_u8(vget_high_u8(src)), fhi);
+        return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+    }
+    static inline uint16x8_t factor(uint8x8_t a, uint16x8_t va)
+    {
+        return div255(vmulq_u16(vmovl_u8(a), va));
+    }
+    static void luma(uint8_t *dst, const uint8_t *src, const uint8_t *a,
+                     unsigned width, unsigned alpha)
+    {
+        const uint16x8_t va = vdupq_n_u16(alpha);
+
+        for (unsigned x = 0; x < width; x += 16) {
+            const uint8x16_t f = vld1q_u8(&a[x]);
+            vst1q_u8(&dst[x], merge(vld1q_u8(&dst[x]), vld1q_u8(&src[x]),
+                                    factor(vget_low_u8(f), va),
+                                    factor(vget_high_u8(f), va)));
+        }
+    }
+    static void chroma(uint8_t *du, uint8_t *dv, const uint8_t *su,
+                       const uint8_t *sv, const uint8_t *a,
+                       unsigned width, unsigned alpha)
+    {
+        const uint16x8_t va = vdupq_n_u16(alpha);
+
+        for (unsigned x = 0; x < width; x += 32) {
+            const uint8x16_t f = vld2q_u8(&a[x]).val[0];
+            const uint16x8_t flo = factor(vget_low_u8(f), va);
+            const uint16x8_t fhi = factor(vget_high_u8(f), va);
+            vst1q_u8(&du[x / 2], merge(vld1q_u8(&du[x / 2]),
+                                       vld2q_u8(&su[x]).val[0], flo, fhi));
+            vst1q_u8(&dv[x / 2], merge(vld1q_u8(&dv[x / 2]),
+                                       vld2q_u8(&sv[x]).val[0], flo, fhi));
+        }
+    }
+    static void chromaSemiPlanar(uint8_t *dc, const uint8_t *s1,
+                                 const uint8_t *s2, const uint8_t *a,
+                                 unsigned width, unsigned alpha)
+    {
+        const uint16x8_t va = vdupq_n_u16(alpha);
+
+        for (unsigned x = 0; x < width; x += 32) {
+            const uint8x16_t f = vld2q_u8(&a[x]).val[0];
+            const uint16x8_t flo = factor(vget_low_u8(f), va);
+            const uint16x8_t fhi = factor(vget_high_u8(f), va);
+            uint8x16x2_t d = vld2q_u8(&dc[x]);
+            d.val[0] = merge(d.val[0], vld2q_u8(&s1[x]).val[0], flo, fhi);
+            d.val[1] = merge(d.val[1], vld2q_u8(&s2[x]).val[0], flo, fhi);
+            vst2q_u8(&dc[x], d);
+        }
+    }
+    template <int r, int g, int b, int a>
+    static void rgb(uint8_t *dst, const uint8_t *src, unsigned width,
+                    unsigned alpha)
+    {
+        const uint16x8_t va = vdupq_n_u16(alpha);
+
+        for (unsigned x = 0; x < width; x += 16) {
+            const uint8x16x4_t s = vld4q_u8(&src[4 * x]);
+            uint8x16x4_t d = vld4q_u8(&dst[4 * x]);
+            const uint8x16_t sa = a >= 0 ? s.val[3] : vdupq_n_u8(255);
+            const uint16x8_t flo = factor(vget_low_u8(sa), va);
+            const uint16x8_t fhi = factor(vget_high_u8(sa), va);
+
+            if (a >= 0) {
+                /* merge first with the inverse of the destination alpha */
+                const uint8x16_t da = vmvnq_u8(d.val[a >= 0 ? a : 0]);
+                const uint16x8_t f1lo = vandq_u16(vmovl_u8(vget_low_u8(da)),
+                                                  vtstq_u16(flo, flo));
+                const uint16x8_t f1hi = vandq_u16(vmovl_u8(vget_high_u8(da)),
+                                                  vtstq_u16(fhi, fhi));
+                d.val[r] = merge(d.val[r], s.val[0], f1lo, f1hi);
+                d.val[g] = merge(d.val[g], s.val[1], f1lo, f1hi);
+                d.val[b] = merge(d.val[b], s.val[2], f1lo, f1hi);
+            }
+            d.val[r] = merge(d.val[r], s.val[0], flo, fhi);
+            d.val[g] = merge(d.val[g], s.val[1], flo, fhi);
+            d.val[b] = merge(d.val[b], s.val[2], flo, fhi);
+            if (a >= 0)
+                d.val[a >= 0 ? a : 0] = merge(d.val[a >= 0 ? a : 0],
+                                              vdupq_n_u8(255), flo, fhi);
+            vst4q_u8(&dst[4 * x], d);
+        }
+    }
+};
+#endif
+
+template <class Isa, bool semiplanar, bool swap_uv, blend_function_t fallback>
+void BlendYUVA420(const CPicture &dst_data, const CPicture &src_data,
+                  unsigned width, unsigned height, int alpha)
+{
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const unsigned dx = dst_data.getX();
+    const unsigned sx = src_data.getX();
+    /* the chroma of the pixels at odd offsets is not merged */
+    const unsigned w = (dx % 2) ? 0 : width & ~(BLEND_YUV_STEP - 1);
+
+    for (unsigned y = 0; w > 0 && y < height; y++) {
+        const unsigned dy = dst_data.getY() + y;
+        const unsigned sy = src_data.getY() + y;
+        const uint8_t *s[4];
+        for (unsigned i = 0; i < 4; i++)
+            s[i] = &src->p[i].p_pixels[sy * src->p[i].i_pitch + sx];
+
+        Isa::luma(&dst->p[0].p_pixels[dy * dst->p[0].i_pitch + dx],
+                  s[0], s[3], w, alpha);
+        if (dy % 2)
+            continue;
+
+        if (semiplanar) {
+            uint8_t *dc = &dst->p[1].p_pixels[dy / 2 * dst->p[1].i_pitch + dx];
+            Isa::chromaSemiPlanar(dc, s[swap_uv ? 2 : 1], s[swap_uv ? 1 : 2],
+                                  s[3], w, alpha);
+        } else {
+            const plane_t *u = &dst->p[swap_uv ? 2 : 1];
+            const plane_t *v = &dst->p[swap_uv ? 1 : 2];
+            Isa::chroma(&u->p_pixels[dy / 2 * u->i_pitch + dx / 2],
+                        &v->p_pixels[dy / 2 * v->i_pitch + dx / 2],
+                        s[1], s[2], s[3], w, alpha);
+        }
+    }
+
+    if (w < width)
+        fallback(CPicture(dst, dst_data.getFormat(), dx + w, dst_data.getY()),
+                 CPicture(src, src_data.getFormat(), sx + w, src_data.getY()),
+                 width - w, height, alpha);
+}
+
+template <class Isa, int r, int g, int b, int a, blend_function_t fallback>
+void BlendRGBA32(const CPicture &dst_data, const CPicture &src_data,
+                 unsigned width, unsigned height, int alpha)
+{
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const unsigned dx = dst_data.getX();
+    const unsigned sx = src_data.getX();
+    const unsigned w = width & ~(Isa::rgb_step - 1);
+
+    for (unsigned y = 0; w > 0 && y < height; y++) {
+        const unsigned dy = dst_data.getY() + y;
+        const unsigned sy = src_data.getY() + y;
+
+        Isa::template rgb<r, g, b, a>(
+            &dst->p[0].p_pixels[dy * dst->p[0].i_pitch + 4 * dx],
+            &src->p[0].p_pixels[sy * src->p[0].i_pitch + 4 * sx], w, alpha);
+    }
+
+    if (w < width)
+        fallback(CPicture(dst, dst_data.getFormat(), dx + w, dst_data.getY()),
+                 CPicture(src, src_data.getFormat(), sx + w, src_data.getY()),
+                 width - w, height, alpha);
+}
+
+} // namespace
+
 namespace {
 
-static const struct {
+struct blend_entry {
     vlc_fourcc_t     dst;
     vlc_fourcc_t     src;
     blend_function_t blend;
-} blends[] = {
+};
+
+static const blend_entry blends[] = {
 #undef RGB
 #undef YUV
 #define RGB(csp, picture, cvt) \
@@ -687,6 +1172,49 @@ static const struct {
 #undef YUV
 };
 
+#define SIMD_YUV(isa, csp, picture, semiplanar, swap_uv) \
+    { csp, VLC_CODEC_YUVA, BlendYUVA420<isa, semiplanar, swap_uv, \
+        Blend<picture, CPictureYUVA, compose<convertNone, convertNone> > > }
+#define SIMD_RGB(isa, csp, picture, cvt, r, g, b, a) \
+    { csp, VLC_CODEC_RGBA, BlendRGBA32<isa, r, g, b, a, \
+        Blend<picture, CPictureRGBA, compose<cvt, convertNone> > > }
+#define SIMD(isa) \
+    SIMD_YUV(isa, VLC_CODEC_I420, CPictureI420_8, false, false), \
+    SIMD_YUV(isa, VLC_CODEC_YV12, CPictureYV12,   false, true), \
+    SIMD_YUV(isa, VLC_CODEC_NV12, CPictureNV12,   true,  false), \
+    SIMD_YUV(isa, VLC_CODEC_NV21, CPictureNV21,   true,  true), \
+    SIMD_RGB(isa, VLC_CODEC_RGBA, CPictureRGBA,  convertNone,      0, 1, 2,  3), \
+    SIMD_RGB(isa, VLC_CODEC_ARGB, CPictureRGBA,  convertNone,      1, 2, 3,  0), \
+    SIMD_RGB(isa, VLC_CODEC_BGRA, CPictureBGRA,  convertNone,      2, 1, 0,  3), \
+    SIMD_RGB(isa, VLC_CODEC_ABGR, CPictureBGRA,  convertNone,      3, 2, 1,  0), \
+    SIMD_RGB(isa, VLC_CODEC_RGBX, CPictureRGB32, convertAddOpaque, 0, 1, 2, -1), \
+    SIMD_RGB(isa, VLC_CODEC_XRGB, CPictureRGB32, convertAddOpaque, 1, 2, 3, -1), \
+    SIMD_RGB(isa, VLC_CODEC_BGRX, CPictureRGB32, convertAddOpaque, 2, 1, 0, -1), \
+    SIMD_RGB(isa, VLC_CODEC_XBGR, CPictureRGB32, convertAddOpaque, 3, 2, 1, -1)
+
+#ifdef HAVE_AVX2_INTRINSICS
+static const blend_entry blends_avx2[] = { SIMD(BlendAVX2) };
+#endif
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+static const blend_entry blends_sse2[] = { SIMD(BlendSSE2) };
+#endif
+#ifdef __ARM_NEON
+static const blend_entry blends_neon[] = { SIMD(BlendNEON) };
+#endif
+#undef SIMD
+#undef SIMD_RGB
+#undef SIMD_YUV
+
+static blend_function_t FindBlend(const blend_entry *table, size_t count,
+                                  vlc_fourcc_t dst, vlc_fourcc_t src)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (table[i].src == src && table[i].dst == dst)
+            return table[i].blend;
+    }
+    return NULL;
+}
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
     {
@@ -742,10 +1270,20 @@ static int Open(filter_t *filter)
     const vlc_fourcc_t dst = filter->fmt_out.video.i_chroma;
 
     filter_sys_t *sys = new filter_sys_t();
-    for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
-        if (blends[i].src == src && blends[i].dst == dst)
-            sys->blend = blends[i].blend;
-    }
+#ifdef HAVE_AVX2_INTRINSICS
+    if (!sys->blend && vlc_CPU_AVX2())
+        sys->blend = FindBlend(blends_avx2, ARRAY_SIZE(blends_avx2), dst, src);
+#endif
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if (!sys->blend && vlc_CPU_SSE2())
+        sys->blend = FindBlend(blends_sse2, ARRAY_SIZE(blends_sse2), dst, src);
+#endif
+#ifdef __ARM_NEON
+    if (!sys->blend && vlc_CPU_ARM_NEON())
+        sys->blend = FindBlend(blends_neon, ARRAY_SIZE(blends_neon), dst, src);
+#endif
+    if (!sys->blend)
+        sys->blend = FindBlend(blends, ARRAY_SIZE(blends), dst, src);
 
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
@@ -32,6 +32,10 @@
 #include <vlc_picture.h>
 #include <vlc_filter.h>
 
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #include "deinterlace.h" /* filter_sys_t */
 #include "helpers.h"     /* ComposeFrame() */
 
@@ -41,6 +45,125 @@
  * Internal functions
  *****************************************************************************/
 
+/* Luma: the operation is just a shift + bitwise AND, so we vectorize
+   even in the C version. */
+static void DarkenLumaLineC( uint8_t *p_out, int w, int i_strength )
+{
+    /* Bitwise ANDing with this clears the i_strength highest bits
+       of each byte */
+    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
+    const uint64_t remove_high_u64 = remove_high_u8 *
+                                            INT64_C(0x0101010101010101);
+
+    int wm8 = w % 8;   /* remainder */
+    int w8  = w - wm8; /* part of width that is divisible by 8 */
+    uint64_t *po = (uint64_t *)p_out;
+    int x = 0;
+
+    for( ; x < w8; x += 8, ++po )
+        (*po) = ( ((*po) >> i_strength) & remove_high_u64 );
+
+    /* handle the width remainder */
+    uint8_t *po_temp = (uint8_t *)po;
+    for( ; x < w; ++x, ++po_temp )
+        (*po_temp) = ( ((*po_temp) >> i_strength) & remove_high_u8 );
+}
+
+/* Chroma: the origin (black) is at YUV = (0, 128, 128) in the uint8 format. */
+static void DarkenChromaLineC( uint8_t *p_out, int w, int i_strength )
+{
+    uint8_t *po = p_out;
+    for( int x = 0; x < w; ++x, ++po )
+        (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
+}
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+static void DarkenLumaLineSSE2( uint8_t *p_out, int w, int i_strength )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    const __m128i remove_high = _mm_set1_epi8( 0xFF >> i_strength );
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+    {
+        __m128i v = _mm_loadu_si128( (__m128i *)&p_out[x] );
+        v = _mm_and_si128( _mm_srl_epi16( v, shift ), remove_high );
+        _mm_storeu_si128( (__m128i *)&p_out[x], v );
+    }
+
+    DarkenLumaLineC( p_out + x, w - x, i_strength );
+}
+
+/* Same as DarkenChromaLineC(): the division truncates toward zero, so the
+   negative values are biased before the arithmetic shift. */
+static void DarkenChromaLineSSE2( uint8_t *p_out, int w, int i_strength )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_strength );
+    const __m128i bias = _mm_set1_epi16( (1 << i_strength) - 1 );
+    const __m128i origin = _mm_set1_epi16( 128 );
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+    {
+        __m128i v = _mm_loadu_si128( (__m128i *)&p_out[x] );
+        __m128i lo = _mm_sub_epi16( _mm_unpacklo_epi8( v, zero ), origin );
+        __m128i hi = _mm_sub_epi16( _mm_unpackhi_epi8( v, zero ), origin );
+
+        lo = _mm_add_epi16( lo, _mm_and_si128( _mm_srai_epi16( lo, 15 ), bias ) );
+        hi = _mm_add_epi16( hi, _mm_and_si128( _mm_srai_epi16( hi, 15 ), bias ) );
+        lo = _mm_add_epi16( _mm_sra_epi16( lo, shift ), origin );
+        hi = _mm_add_epi16( _mm_sra_epi16( hi, shift ), origin );
+        _mm_storeu_si128( (__m128i *)&p_out[x], _mm_packus_epi16( lo, hi ) );
+    }
+
+    DarkenChromaLineC( p_out + x, w - x, i_strength );
+}
+#endif
+
+struct darken_field
+{
+    picture_t *p_dst;
+    int i_field;
+    int i_strength;
+    bool process_chroma;
+    void (*pf_luma)( uint8_t *, int, int );
+    void (*pf_chroma)( uint8_t *, int, int );
+};
+
+static void DarkenFieldSlice( filter_t *p_filter, void *opaque,
+                              unsigned i_first, unsigned i_end )
+{
+    VLC_UNUSED(p_filter);
+    const struct darken_field *d = opaque;
+    picture_t *p_dst = d->p_dst;
+
+    /* Process chroma only if the field chromas are independent */
+    const int i_planes = d->process_chroma ? p_dst->i_planes : 1;
+
+    for( int i_plane = Y_PLANE; i_plane < i_planes; i_plane++ )
+    {
+        const int w = p_dst->p[i_plane].i_visible_pitch;
+        const int i_pitch = p_dst->p[i_plane].i_pitch;
+
+        int i_first_line, i_end_line;
+        SliceToPlaneLines( p_dst, i_plane, i_first, i_end,
+                           &i_first_line, &i_end_line );
+
+        /* Only the lines of the field */
+        int y = i_first_line + ( ( i_first_line ^ d->i_field ) & 1 );
+        for( ; y < i_end_line; y += 2 )
+        {
+            uint8_t *p_out = &p_dst->p[i_plane].p_pixels[y * i_pitch];
+
+            if( i_plane == Y_PLANE )
+                d->pf_luma( p_out, w, d->i_strength );
+            else
+                d->pf_chroma( p_out, w, d->i_strength );
+        }
+    }
+}
+
 /**
  * Internal helper function: dims (darkens) the given field
  * of the given picture.
@@ -57,13 +180,16 @@
  *     filter strengths, especially for pixels whose U and/or V values are
  *     far away from the origin (which is at 128 in uint8 format).
  *
+ * The lines are processed in slices on the filter threads.
+ *
+ * @param p_filter The filter instance.
  * @param p_dst Input/output picture. Will be modified in-place.
  * @param i_field Darken which field? 0 = top, 1 = bottom.
  * @param i_strength Strength of effect: 1, 2 or 3 (division by 2, 4 or 8).
  * @see RenderPhosphor()
  * @see ComposeFrame()
  */
-static void DarkenField( picture_t *p_dst,
+static void DarkenField( filter_t *p_filter, picture_t *p_dst,
                          const int i_field, const int i_strength,
                          bool process_chroma )
 {
@@ -71,76 +197,24 @@ static void DarkenField( picture_t *p_dst,
     assert( i_field == 0 || i_field == 1 );
     assert( i_strength >= 1 && i_strength <= 3 );
 
-    /* Bitwise ANDing with this clears the i_strength highest bits
-       of each byte */
-    const uint8_t  remove_high_u8 = 0xFF >> i_strength;
-    const uint64_t remove_high_u64 = remove_high_u8 *
-                                            INT64_C(0x0101010101010101);
-
-    /* Process luma.
-
-       For luma, the operation is just a shift + bitwise AND, so we vectorize
-       even in the C version.
-
-       There are SIMD versions too, which perform significantly faster.
-    */
-    int i_plane = Y_PLANE;
-    uint8_t *p_out, *p_out_end;
-    int w = p_dst->p[i_plane].i_visible_pitch;
-    p_out = p_dst->p[i_plane].p_pixels;
-    p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                      * p_dst->p[i_plane].i_visible_lines;
-
-    /* skip first line for bottom field */
-    if( i_field == 1 )
-        p_out += p_dst->p[i_plane].i_pitch;
-
-    int wm8 = w % 8;   /* remainder */
-    int w8  = w - wm8; /* part of width that is divisible by 8 */
-    for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
+    struct darken_field d = {
+        .p_dst = p_dst,
+        .i_field = i_field,
+        .i_strength = i_strength,
+        .process_chroma = process_chroma,
+        .pf_luma = DarkenLumaLineC,
+        .pf_chroma = DarkenChromaLineC,
+    };
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if( vlc_CPU_SSE2() )
     {
-        uint64_t *po = (uint64_t *)p_out;
-        int x = 0;
-
-        for( ; x < w8; x += 8, ++po )
-            (*po) = ( ((*po) >> i_strength) & remove_high_u64 );
-
-        /* handle the width remainder */
-        uint8_t *po_temp = (uint8_t *)po;
-        for( ; x < w; ++x, ++po_temp )
-            (*po_temp) = ( ((*po_temp) >> i_strength) & remove_high_u8 );
+        d.pf_luma = DarkenLumaLineSSE2;
+        d.pf_chroma = DarkenChromaLineSSE2;
     }
+#endif
 
-    /* Process chroma if the field chromas are independent.
-
-       The origin (black) is at YUV = (0, 128, 128) in the uint8 format.
-       The chroma processing is a bit more complicated than luma,
-       and needs SIMD for vectorization.
-    */
-    if( process_chroma )
-    {
-        for( i_plane++ /* luma already handled*/;
-             i_plane < p_dst->i_planes;
-             i_plane++ )
-        {
-            w = p_dst->p[i_plane].i_visible_pitch;
-            p_out = p_dst->p[i_plane].p_pixels;
-            p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                              * p_dst->p[i_plane].i_visible_lines;
-
-            /* skip first line for bottom field */
-            if( i_field == 1 )
-                p_out += p_dst->p[i_plane].i_pitch;
-
-            for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
-            {
-                /* Handle the width remainder */
-                uint8_t *po = p_out;
-                for( int x = 0; x < w; ++x, ++po )
-                    (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
-            } /* for p_out... */
-        } /* for i_plane... */
-    } /* if process_chroma */
+    vlc_filter_RunSlices( p_filter, p_dst->p[Y_PLANE].i_visible_lines,
+                          DarkenFieldSlice, &d );
 }
 
 /*****************************************************************************
@@ -229,7 +303,7 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
-            DarkenField( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+            DarkenField( p_filter, p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
                 p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
                 p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
     }
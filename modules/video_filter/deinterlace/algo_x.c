@@ -29,8 +29,14 @@
 #include <vlc_common.h>
 #include <vlc_cpu.h>
 #include <vlc_picture.h>
+#include <vlc_filter.h>
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
 
 #include "deinterlace.h" /* filter_sys_t */
+#include "helpers.h"     /* SliceToPlaneLines() */
 
 #include "algo_x.h"
 
@@ -164,6 +170,150 @@ static inline void XDeint8x8FieldC( uint8_t *dst, int i_dst,
     }
 }
 
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+/* SSE2 versions of the 8x8 block functions, bit exact with the C ones */
+static inline __m128i XDeintLoad8( const uint8_t *src )
+{
+    return _mm_unpacklo_epi8( _mm_loadl_epi64( (const __m128i *)src ),
+                              _mm_setzero_si128() );
+}
+
+static inline __m128i XDeintAbsDiff8( const uint8_t *a, const uint8_t *b )
+{
+    __m128i va = _mm_loadl_epi64( (const __m128i *)a );
+    __m128i vb = _mm_loadl_epi64( (const __m128i *)b );
+    return _mm_unpacklo_epi8( _mm_or_si128( _mm_subs_epu8( va, vb ),
+                                            _mm_subs_epu8( vb, va ) ),
+                              _mm_setzero_si128() );
+}
+
+static inline int XDeintHAdd32( __m128i v )
+{
+    v = _mm_add_epi32( v, _mm_srli_si128( v, 8 ) );
+    v = _mm_add_epi32( v, _mm_srli_si128( v, 4 ) );
+    return _mm_cvtsi128_si32( v );
+}
+
+static inline int XDeint8x8DetectSSE2( uint8_t *src, int i_src )
+{
+    __m128i l0 = XDeintLoad8( src );
+    __m128i l1 = XDeintLoad8( &src[i_src] );
+
+    /* Detect interlacing */
+    for( int y = 0; y < 7; y += 2 )
+    {
+        __m128i l2 = XDeintLoad8( &src[2*i_src] );
+        __m128i l3 = XDeintLoad8( &src[3*i_src] );
+        __m128i d01 = _mm_sub_epi16( l0, l1 );
+        __m128i d12 = _mm_sub_epi16( l1, l2 );
+        __m128i d02 = _mm_sub_epi16( l0, l2 );
+        __m128i d13 = _mm_sub_epi16( l1, l3 );
+
+        const int fr = XDeintHAdd32( _mm_add_epi32( _mm_madd_epi16( d01, d01 ),
+                                                    _mm_madd_epi16( d12, d12 ) ) );
+        const int ff = XDeintHAdd32( _mm_add_epi32( _mm_madd_epi16( d02, d02 ),
+                                                    _mm_madd_epi16( d13, d13 ) ) );
+        if( ff < 6*fr/8 && fr > 32 )
+            return true;
+
+        l0 = l2;
+        l1 = l3;
+        src += 2*i_src;
+    }
+
+    return false;
+}
+
+static inline void XDeint8x8MergeSSE2( uint8_t *dst,  int i_dst,
+                                       uint8_t *src1, int i_src1,
+                                       uint8_t *src2, int i_src2 )
+{
+    const __m128i four = _mm_set1_epi16( 4 );
+
+    /* Progressive */
+    for( int y = 0; y < 8; y += 2 )
+    {
+        memcpy( dst, src1, 8 );
+        dst  += i_dst;
+
+        __m128i s2 = XDeintLoad8( src2 );
+        __m128i sum = _mm_add_epi16( XDeintLoad8( src1 ),
+                                     XDeintLoad8( &src1[i_src1] ) );
+        sum = _mm_add_epi16( sum, _mm_slli_epi16( s2, 1 ) );
+        sum = _mm_add_epi16( sum, _mm_slli_epi16( s2, 2 ) );
+        sum = _mm_srli_epi16( _mm_add_epi16( sum, four ), 3 );
+        _mm_storel_epi64( (__m128i *)dst, _mm_packus_epi16( sum, sum ) );
+        dst += i_dst;
+
+        src1 += i_src1;
+        src2 += i_src2;
+    }
+}
+
+static inline __m128i XDeintAverage8( const uint8_t *a, const uint8_t *b )
+{
+    return _mm_srli_epi16( _mm_add_epi16( XDeintLoad8( a ),
+                                          XDeintLoad8( b ) ), 1 );
+}
+
+static inline void XDeint8x8FieldESSE2( uint8_t *dst, int i_dst,
+                                        uint8_t *src, int i_src )
+{
+    /* Interlaced */
+    for( int y = 0; y < 8; y += 2 )
+    {
+        memcpy( dst, src, 8 );
+        dst += i_dst;
+
+        __m128i avg = XDeintAverage8( src, &src[2*i_src] );
+        _mm_storel_epi64( (__m128i *)dst, _mm_packus_epi16( avg, avg ) );
+        dst += 1*i_dst;
+        src += 2*i_src;
+    }
+}
+
+static inline void XDeint8x8FieldSSE2( uint8_t *dst, int i_dst,
+                                       uint8_t *src, int i_src )
+{
+    /* Interlaced */
+    for( int y = 0; y < 8; y += 2 )
+    {
+        memcpy( dst, src, 8 );
+        dst += i_dst;
+
+        uint8_t *src2 = &src[2*i_src];
+        __m128i c0 = _mm_setzero_si128();
+        __m128i c1 = _mm_setzero_si128();
+        __m128i c2 = _mm_setzero_si128();
+
+        for( int k = -4; k < 4; k++ )
+        {
+            c0 = _mm_add_epi16( c0, XDeintAbsDiff8( &src[k],   &src2[k+2] ) );
+            c1 = _mm_add_epi16( c1, XDeintAbsDiff8( &src[k+1], &src2[k+1] ) );
+            c2 = _mm_add_epi16( c2, XDeintAbsDiff8( &src[k+2], &src2[k]   ) );
+        }
+
+        /* c0 < c1 && c1 <= c2 */
+        __m128i m0 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c2 ),
+                                       _mm_cmpgt_epi16( c1, c0 ) );
+        /* c2 < c1 && c1 <= c0 */
+        __m128i m2 = _mm_andnot_si128( _mm_cmpgt_epi16( c1, c0 ),
+                                       _mm_cmpgt_epi16( c1, c2 ) );
+
+        __m128i v0 = XDeintAverage8( &src[-1], &src2[1] );
+        __m128i v1 = XDeintAverage8( &src[0],  &src2[0] );
+        __m128i v2 = XDeintAverage8( &src[1],  &src2[-1] );
+        __m128i v = _mm_or_si128( _mm_and_si128( m0, v0 ),
+                                  _mm_and_si128( m2, v2 ) );
+        v = _mm_or_si128( v, _mm_andnot_si128( _mm_or_si128( m0, m2 ), v1 ) );
+        _mm_storel_epi64( (__m128i *)dst, _mm_packus_epi16( v, v ) );
+
+        dst += 1*i_dst;
+        src += 2*i_src;
+    }
+}
+#endif
+
 /* NxN arbitrary size (and then only use pixel in the NxN block)
  */
 static inline int XDeintNxNDetect( uint8_t *src, int i_src,
@@ -291,17 +441,55 @@ static inline void XDeintBand8x8C( uint8_t *dst, int i_dst,
         XDeintNxN( dst, i_dst, src, i_src, i_modx, 8 );
 }
 
-/*****************************************************************************
- * Public functions
- *****************************************************************************/
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+static inline void XDeintBand8x8SSE2( uint8_t *dst, int i_dst,
+                                      uint8_t *src, int i_src,
+                                      const int i_mbx, int i_modx )
+{
+    int x;
 
-int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+    for( x = 0; x < i_mbx; x++ )
+    {
+        if( XDeint8x8DetectSSE2( src, i_src ) )
+        {
+            if( x == 0 || x == i_mbx - 1 )
+                XDeint8x8FieldESSE2( dst, i_dst, src, i_src );
+            else
+                XDeint8x8FieldSSE2( dst, i_dst, src, i_src );
+        }
+        else
+        {
+            XDeint8x8MergeSSE2( dst, i_dst,
+                                &src[0*i_src], 2*i_src,
+                                &src[1*i_src], 2*i_src );
+        }
+
+        dst += 8;
+        src += 8;
+    }
+
+    if( i_modx )
+        XDeintNxN( dst, i_dst, src, i_src, i_modx, 8 );
+}
+#endif
+
+struct x_slices
+{
+    picture_t *p_outpic;
+    const picture_t *p_pic;
+    void (*band)( uint8_t *, int, uint8_t *, int, const int, int );
+};
+
+/* Renders the bands of 8 lines starting in the slice, in each plane */
+static void RenderXSlice( filter_t *p_filter, void *opaque,
+                          unsigned i_first, unsigned i_end )
 {
     VLC_UNUSED(p_filter);
-    int i_plane;
+    const struct x_slices *s = opaque;
+    picture_t *p_outpic = s->p_outpic;
+    const picture_t *p_pic = s->p_pic;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    for( int i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
         const int i_mby = ( p_outpic->p[i_plane].i_visible_lines + 7 )/8 - 1;
         const int i_mbx = p_outpic->p[i_plane].i_visible_pitch/8;
@@ -312,21 +500,26 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         const int i_dst = p_outpic->p[i_plane].i_pitch;
         const int i_src = p_pic->p[i_plane].i_pitch;
 
+        int i_first_line, i_end_line;
+        SliceToPlaneLines( p_outpic, i_plane, i_first, i_end,
+                           &i_first_line, &i_end_line );
+
         int y, x;
 
-        for( y = 0; y < i_mby; y++ )
+        for( y = ( i_first_line + 7 ) / 8;
+             y < __MIN( ( i_end_line + 7 ) / 8, i_mby ); y++ )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
 
-            XDeintBand8x8C( dst, i_dst, src, i_src, i_mbx, i_modx );
+            s->band( dst, i_dst, src, i_src, i_mbx, i_modx );
         }
 
         /* Last line (C only)*/
-        if( i_mody )
+        if( i_mody && i_first_line <= 8*i_mby && 8*i_mby < i_end_line )
         {
-            uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
-            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
+            uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*i_mby*i_dst];
+            uint8_t *src = &p_pic->p[i_plane].p_pixels[8*i_mby*i_src];
 
             for( x = 0; x < i_mbx; x++ )
             {
@@ -340,6 +533,26 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
                 XDeintNxN( dst, i_dst, src, i_src, i_modx, i_mody );
         }
     }
+}
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+
+int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    struct x_slices slices = {
+        .p_outpic = p_outpic,
+        .p_pic = p_pic,
+        .band = XDeintBand8x8C,
+    };
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if( vlc_CPU_SSE2() )
+        slices.band = XDeintBand8x8SSE2;
+#endif
+
+    vlc_filter_RunSlices( p_filter, p_outpic->p[Y_PLANE].i_visible_lines,
+                          RenderXSlice, &slices );
 
     return VLC_SUCCESS;
 }
@@ -26,12 +26,17 @@
 
 #include <stdint.h>
 #include <assert.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 #include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
 
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #include "deinterlace.h" /* definition of p_sys, needed for Merge() */
 #include "common.h"      /* FFMIN3 et al. */
 #include "merge.h"
@@ -164,6 +169,161 @@ static int TestForMotionInBlock( uint8_t *p_pix_p, uint8_t *p_pix_c,
        changes "enough". */
     return (i_motion >= 8);
 }
+
+/**
+ * Internal helper function for EstimateNumBlocksWithMotion():
+ * tests the i_mbx blocks of a row of 8x8 blocks with TestForMotionInBlock(),
+ * and adds their scores.
+ */
+static void TestForMotionInBlockRowC( uint8_t *p_pix_p, uint8_t *p_pix_c,
+                                      int i_pitch_prev, int i_pitch_curr,
+                                      int i_mbx, int *pi_score,
+                                      int *pi_top, int *pi_bot )
+{
+    for( int bx = 0; bx < i_mbx; ++bx )
+    {
+        int i_top_temp, i_bot_temp;
+        *pi_score += TestForMotionInBlock( p_pix_p, p_pix_c,
+                                           i_pitch_prev, i_pitch_curr,
+                                           &i_top_temp, &i_bot_temp );
+        *pi_top += i_top_temp;
+        *pi_bot += i_bot_temp;
+
+        p_pix_p += 8;
+        p_pix_c += 8;
+    }
+}
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+/* Same as TestForMotionInBlockRowC(), two blocks at a time: the pixels over
+   the threshold of each block line are counted by the two halves of psadbw. */
+static void TestForMotionInBlockRowSSE2( uint8_t *p_pix_p, uint8_t *p_pix_c,
+                                         int i_pitch_prev, int i_pitch_curr,
+                                         int i_mbx, int *pi_score,
+                                         int *pi_top, int *pi_bot )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8( 1 );
+    const __m128i threshold = _mm_set1_epi8( T + 1 );
+    int bx = 0;
+
+    for( ; bx + 2 <= i_mbx; bx += 2 )
+    {
+        __m128i top = zero, bot = zero;
+
+        for( int y = 0; y < 8; ++y )
+        {
+            __m128i p = _mm_loadu_si128( (__m128i *)&p_pix_p[y * i_pitch_prev] );
+            __m128i c = _mm_loadu_si128( (__m128i *)&p_pix_c[y * i_pitch_curr] );
+            __m128i diff = _mm_or_si128( _mm_subs_epu8( p, c ),
+                                         _mm_subs_epu8( c, p ) );
+            /* diff > T */
+            __m128i over = _mm_cmpeq_epi8( _mm_max_epu8( diff, threshold ),
+                                           diff );
+            __m128i score = _mm_sad_epu8( _mm_and_si128( over, one ), zero );
+            if( y % 2 == 0 )
+                top = _mm_add_epi64( top, score );
+            else
+                bot = _mm_add_epi64( bot, score );
+        }
+
+        for( int i = 0; i < 2; i++ )
+        {
+            int i_top_motion = _mm_cvtsi128_si32( top );
+            int i_bot_motion = _mm_cvtsi128_si32( bot );
+            top = _mm_srli_si128( top, 8 );
+            bot = _mm_srli_si128( bot, 8 );
+
+            /* Same thresholds as TestForMotionInBlock() */
+            *pi_score += ( i_top_motion + i_bot_motion >= 8 );
+            *pi_top += ( i_top_motion >= 8 );
+            *pi_bot += ( i_bot_motion >= 8 );
+        }
+
+        p_pix_p += 16;
+        p_pix_c += 16;
+    }
+
+    TestForMotionInBlockRowC( p_pix_p, p_pix_c, i_pitch_prev, i_pitch_curr,
+                              i_mbx - bx, pi_score, pi_top, pi_bot );
+}
+#endif
+#undef T
+
+/* Threshold (value from Transcode 1.1.5) */
+#define T 100
+
+/**
+ * Internal helper function for CalculateInterlaceScore(): counts the pixels
+ * of a line combing with the neighbouring lines of the other field.
+ */
+static int CountCombingC( const uint8_t *p_c, const uint8_t *p_p,
+                          const uint8_t *p_n, int w )
+{
+    int i_score = 0;
+
+    for( int x = 0; x < w; ++x )
+    {
+        /* Worst case: need 17 bits for "comb". */
+        int_fast32_t C = *p_c;
+        int_fast32_t P = *p_p;
+        int_fast32_t N = *p_n;
+
+        /* Comments in Transcode's filter_ivtc.c attribute this
+           combing metric to Gunnar Thalin.
+
+            The idea is that if the picture is interlaced, both
+            expressions will have the same sign, and this comes
+            up positive. The value T = 100 has been chosen such
+            that a pixel difference of 10 (on average) will
+            trigger the detector.
+        */
+        int_fast32_t comb = (P - C) * (N - C);
+        if( comb > T )
+            ++i_score;
+
+        ++p_c;
+        ++p_p;
+        ++p_n;
+    }
+    return i_score;
+}
+
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+static int CountCombingSSE2( const uint8_t *p_c, const uint8_t *p_p,
+                             const uint8_t *p_n, int w )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i threshold = _mm_set1_epi32( T );
+    __m128i score = zero;
+    int x = 0;
+
+    for( ; x + 8 <= w; x += 8 )
+    {
+        __m128i c = _mm_unpacklo_epi8( _mm_loadl_epi64( (__m128i *)&p_c[x] ),
+                                       zero );
+        __m128i p = _mm_unpacklo_epi8( _mm_loadl_epi64( (__m128i *)&p_p[x] ),
+                                       zero );
+        __m128i n = _mm_unpacklo_epi8( _mm_loadl_epi64( (__m128i *)&p_n[x] ),
+                                       zero );
+        __m128i dp = _mm_sub_epi16( p, c );
+        __m128i dn = _mm_sub_epi16( n, c );
+        /* 32-bit products */
+        __m128i lo = _mm_mullo_epi16( dp, dn );
+        __m128i hi = _mm_mulhi_epi16( dp, dn );
+        __m128i comb0 = _mm_unpacklo_epi16( lo, hi );
+        __m128i comb1 = _mm_unpackhi_epi16( lo, hi );
+
+        score = _mm_sub_epi32( score, _mm_cmpgt_epi32( comb0, threshold ) );
+        score = _mm_sub_epi32( score, _mm_cmpgt_epi32( comb1, threshold ) );
+    }
+
+    score = _mm_add_epi32( score, _mm_srli_si128( score, 8 ) );
+    score = _mm_add_epi32( score, _mm_srli_si128( score, 4 ) );
+    return _mm_cvtsi128_si32( score )
+         + CountCombingC( p_c + x, p_p + x, p_n + x, w - x );
+}
+#endif
 #undef T
 
 /*****************************************************************************
@@ -300,30 +460,41 @@ void ComposeFrame( filter_t *p_filter,
 }
 
 /* See header for function doc. */
-int EstimateNumBlocksWithMotion( const picture_t* p_prev,
-                                 const picture_t* p_curr,
-                                 int *pi_top, int *pi_bot)
+void SliceToPlaneLines( const picture_t *p_pic, int i_plane,
+                        unsigned i_first, unsigned i_end,
+                        int *pi_first, int *pi_end )
 {
-    assert( p_prev != NULL );
-    assert( p_curr != NULL );
+    const uint64_t i_lines = p_pic->p[i_plane].i_visible_lines;
+    const unsigned i_luma_lines = p_pic->p[Y_PLANE].i_visible_lines;
 
-    int i_score_top = 0;
-    int i_score_bot = 0;
-
-    if( p_prev->i_planes != p_curr->i_planes )
-        return -1;
+    *pi_first = i_first * i_lines / i_luma_lines;
+    *pi_end = i_end * i_lines / i_luma_lines;
+}
 
-    int (*motion_in_block)(uint8_t *, uint8_t *, int , int, int *, int *) =
-        TestForMotionInBlock;
+struct motion_estimation
+{
+    const picture_t *p_prev;
+    const picture_t *p_curr;
+    void (*pf_row)( uint8_t *, uint8_t *, int, int, int, int *, int *, int * );
+    atomic_int i_score;
+    atomic_int i_score_top;
+    atomic_int i_score_bot;
+};
+
+static void EstimateMotionSlice( filter_t *p_filter, void *opaque,
+                                 unsigned i_first, unsigned i_end )
+{
+    VLC_UNUSED(p_filter);
+    struct motion_estimation *p_me = opaque;
+    const picture_t *p_prev = p_me->p_prev;
+    const picture_t *p_curr = p_me->p_curr;
 
     int i_score = 0;
+    int i_score_top = 0;
+    int i_score_bot = 0;
+
     for( int i_plane = 0 ; i_plane < p_prev->i_planes ; i_plane++ )
     {
-        /* Sanity check */
-        if( p_prev->p[i_plane].i_visible_lines !=
-            p_curr->p[i_plane].i_visible_lines )
-            return -1;
-
         const int i_pitch_prev = p_prev->p[i_plane].i_pitch;
         const int i_pitch_curr = p_curr->p[i_plane].i_pitch;
 
@@ -334,39 +505,132 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
                              p_curr->p[i_plane].i_visible_pitch );
         const int i_mbx = w / 8;
 
-        for( int by = 0; by < i_mby; ++by )
+        /* The slice has the block rows starting in its lines */
+        int i_first_line, i_end_line;
+        SliceToPlaneLines( p_prev, i_plane, i_first, i_end,
+                           &i_first_line, &i_end_line );
+        const int i_first_by = ( i_first_line + 7 ) / 8;
+        const int i_end_by = __MIN( ( i_end_line + 7 ) / 8, i_mby );
+
+        for( int by = i_first_by; by < i_end_by; ++by )
         {
             uint8_t *p_pix_p = &p_prev->p[i_plane].p_pixels[i_pitch_prev*8*by];
             uint8_t *p_pix_c = &p_curr->p[i_plane].p_pixels[i_pitch_curr*8*by];
 
-            for( int bx = 0; bx < i_mbx; ++bx )
-            {
-                int i_top_temp, i_bot_temp;
-                i_score += motion_in_block( p_pix_p, p_pix_c,
-                                            i_pitch_prev, i_pitch_curr,
-                                            &i_top_temp, &i_bot_temp );
-                i_score_top += i_top_temp;
-                i_score_bot += i_bot_temp;
-
-                p_pix_p += 8;
-                p_pix_c += 8;
-            }
+            p_me->pf_row( p_pix_p, p_pix_c, i_pitch_prev, i_pitch_curr, i_mbx,
+                          &i_score, &i_score_top, &i_score_bot );
         }
     }
 
+    atomic_fetch_add_explicit( &p_me->i_score, i_score,
+                               memory_order_relaxed );
+    atomic_fetch_add_explicit( &p_me->i_score_top, i_score_top,
+                               memory_order_relaxed );
+    atomic_fetch_add_explicit( &p_me->i_score_bot, i_score_bot,
+                               memory_order_relaxed );
+}
+
+/* See header for function doc. */
+int EstimateNumBlocksWithMotion( filter_t *p_filter,
+                                 const picture_t* p_prev,
+                                 const picture_t* p_curr,
+                                 int *pi_top, int *pi_bot)
+{
+    assert( p_prev != NULL );
+    assert( p_curr != NULL );
+
+    if( p_prev->i_planes != p_curr->i_planes )
+        return -1;
+
+    for( int i_plane = 0 ; i_plane < p_prev->i_planes ; i_plane++ )
+    {
+        /* Sanity check */
+        if( p_prev->p[i_plane].i_visible_lines !=
+            p_curr->p[i_plane].i_visible_lines )
+            return -1;
+    }
+
+    struct motion_estimation me = {
+        .p_prev = p_prev,
+        .p_curr = p_curr,
+        .pf_row = TestForMotionInBlockRowC,
+    };
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if( vlc_CPU_SSE2() )
+        me.pf_row = TestForMotionInBlockRowSSE2;
+#endif
+    atomic_init( &me.i_score, 0 );
+    atomic_init( &me.i_score_top, 0 );
+    atomic_init( &me.i_score_bot, 0 );
+
+    vlc_filter_RunSlices( p_filter, p_prev->p[Y_PLANE].i_visible_lines,
+                          EstimateMotionSlice, &me );
+
     if( pi_top )
-        (*pi_top) = i_score_top;
+        (*pi_top) = atomic_load_explicit( &me.i_score_top,
+                                          memory_order_relaxed );
     if( pi_bot )
-        (*pi_bot) = i_score_bot;
+        (*pi_bot) = atomic_load_explicit( &me.i_score_bot,
+                                          memory_order_relaxed );
 
-    return i_score;
+    return atomic_load_explicit( &me.i_score, memory_order_relaxed );
 }
 
-/* Threshold (value from Transcode 1.1.5) */
-#define T 100
+struct interlace_score
+{
+    const picture_t *p_pic_top;
+    const picture_t *p_pic_bot;
+    int (*pf_count)( const uint8_t *, const uint8_t *, const uint8_t *, int );
+    atomic_int i_score;
+};
+
+static void InterlaceScoreSlice( filter_t *p_filter, void *opaque,
+                                 unsigned i_first, unsigned i_end )
+{
+    VLC_UNUSED(p_filter);
+    struct interlace_score *p_is = opaque;
+    const picture_t *p_pic_top = p_is->p_pic_top;
+    const picture_t *p_pic_bot = p_is->p_pic_bot;
+    int32_t i_score = 0;
+
+    for( int i_plane = 0 ; i_plane < p_pic_top->i_planes ; ++i_plane )
+    {
+        const int i_lasty = p_pic_top->p[i_plane].i_visible_lines-1;
+        const int w = FFMIN( p_pic_top->p[i_plane].i_visible_pitch,
+                             p_pic_bot->p[i_plane].i_visible_pitch );
+
+        int i_first_line, i_end_line;
+        SliceToPlaneLines( p_pic_top, i_plane, i_first, i_end,
+                           &i_first_line, &i_end_line );
+
+        /* Transcode 1.1.5 only checks every other line. Checking every line
+           works better for anime, which may contain horizontal,
+           one pixel thick cartoon outlines.
+        */
+        for( int y = __MAX( i_first_line, 1 );
+             y < __MIN( i_end_line, i_lasty ); ++y )
+        {
+            /* Current line / neighbouring lines picture pointers: the current
+               line alternates between the bottom and the top field */
+            const picture_t *cur = ( y % 2 ) ? p_pic_bot : p_pic_top;
+            const picture_t *ngh = ( y % 2 ) ? p_pic_top : p_pic_bot;
+            const int wc = cur->p[i_plane].i_pitch;
+            const int wn = ngh->p[i_plane].i_pitch;
+
+            i_score += p_is->pf_count(
+                        &cur->p[i_plane].p_pixels[y*wc],      /* this line */
+                        &ngh->p[i_plane].p_pixels[(y-1)*wn],  /* prev line */
+                        &ngh->p[i_plane].p_pixels[(y+1)*wn],  /* next line */
+                        w );
+        }
+    }
+
+    atomic_fetch_add_explicit( &p_is->i_score, i_score, memory_order_relaxed );
+}
 
 /* See header for function doc. */
-int CalculateInterlaceScore( const picture_t* p_pic_top,
+int CalculateInterlaceScore( filter_t *p_filter,
+                             const picture_t* p_pic_top,
                              const picture_t* p_pic_bot )
 {
     /*
@@ -385,70 +649,27 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     if( p_pic_top->i_planes != p_pic_bot->i_planes )
         return -1;
 
-    int32_t i_score = 0;
-
     for( int i_plane = 0 ; i_plane < p_pic_top->i_planes ; ++i_plane )
     {
         /* Sanity check */
         if( p_pic_top->p[i_plane].i_visible_lines !=
             p_pic_bot->p[i_plane].i_visible_lines )
             return -1;
+    }
 
-        const int i_lasty = p_pic_top->p[i_plane].i_visible_lines-1;
-        const int w = FFMIN( p_pic_top->p[i_plane].i_visible_pitch,
-                             p_pic_bot->p[i_plane].i_visible_pitch );
-
-        /* Current line / neighbouring lines picture pointers */
-        const picture_t *cur = p_pic_bot;
-        const picture_t *ngh = p_pic_top;
-        int wc = cur->p[i_plane].i_pitch;
-        int wn = ngh->p[i_plane].i_pitch;
-
-        /* Transcode 1.1.5 only checks every other line. Checking every line
-           works better for anime, which may contain horizontal,
-           one pixel thick cartoon outlines.
-        */
-        for( int y = 1; y < i_lasty; ++y )
-        {
-            uint8_t *p_c = &cur->p[i_plane].p_pixels[y*wc];     /* this line */
-            uint8_t *p_p = &ngh->p[i_plane].p_pixels[(y-1)*wn]; /* prev line */
-            uint8_t *p_n = &ngh->p[i_plane].p_pixels[(y+1)*wn]; /* next line */
-
-            for( int x = 0; x < w; ++x )
-            {
-                /* Worst case: need 17 bits for "comb". */
-                int_fast32_t C = *p_c;
-                int_fast32_t P = *p_p;
-                int_fast32_t N = *p_n;
-
-                /* Comments in Transcode's filter_ivtc.c attribute this
-                   combing metric to Gunnar Thalin.
-
-                    The idea is that if the picture is interlaced, both
-                    expressions will have the same sign, and this comes
-                    up positive. The value T = 100 has been chosen such
-                    that a pixel difference of 10 (on average) will
-                    trigger the detector.
-                */
-                int_fast32_t comb = (P - C) * (N - C);
-                if( comb > T )
-                    ++i_score;
-
-                ++p_c;
-                ++p_p;
-                ++p_n;
-            }
+    struct interlace_score is = {
+        .p_pic_top = p_pic_top,
+        .p_pic_bot = p_pic_bot,
+        .pf_count = CountCombingC,
+    };
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if( vlc_CPU_SSE2() )
+        is.pf_count = CountCombingSSE2;
+#endif
+    atomic_init( &is.i_score, 0 );
 
-            /* Now the other field - swap current and neighbour pictures */
-            const picture_t *tmp = cur;
-            cur = ngh;
-            ngh = tmp;
-            int tmp_pitch = wc;
-            wc = wn;
-            wn = tmp_pitch;
-        }
-    }
+    vlc_filter_RunSlices( p_filter, p_pic_top->p[Y_PLANE].i_visible_lines,
+                          InterlaceScoreSlice, &is );
 
-    return i_score;
+    return atomic_load_explicit( &is.i_score, memory_order_relaxed );
 }
-#undef T
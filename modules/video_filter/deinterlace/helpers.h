@@ -98,6 +98,24 @@ void ComposeFrame( filter_t *p_filter,
                    picture_t *p_inpic_top, picture_t *p_inpic_bottom,
                    compose_chroma_t i_output_chroma, bool swapped_uv_conversion );
 
+/**
+ * Helper function: maps a slice of luma lines, as processed by a
+ * vlc_filter_RunSlices() callback, to the lines of the given plane.
+ *
+ * The slices of the chroma planes of a picture are contiguous and do not
+ * overlap, whatever the subsampling and the number of lines.
+ *
+ * @param p_pic The picture being processed.
+ * @param i_plane The plane index.
+ * @param i_first First luma line of the slice.
+ * @param i_end Luma line following the slice.
+ * @param[out] pi_first First line of the plane in the slice.
+ * @param[out] pi_end Line of the plane following the slice.
+ */
+void SliceToPlaneLines( const picture_t *p_pic, int i_plane,
+                        unsigned i_first, unsigned i_end,
+                        int *pi_first, int *pi_end );
+
 /**
  * Helper function: Estimates the number of 8x8 blocks which have motion
  * between the given pictures. Needed for various detectors in RenderIVTC().
@@ -120,6 +138,9 @@ void ComposeFrame( filter_t *p_filter,
  * chroma, and odd-numbered chroma lines the "bottom field" for chroma.
  * This is correct for IVTC purposes.
  *
+ * The blocks are tested by slices on the filter threads.
+ *
+ * @param p_filter The filter instance.
  * @param[in] p_prev Previous picture
  * @param[in] p_curr Current picture
  * @param[out] pi_top Number of 8x8 blocks where top field has motion.
@@ -129,7 +150,8 @@ void ComposeFrame( filter_t *p_filter,
  * @see TestForMotionInBlock()
  * @see RenderIVTC()
  */
-int EstimateNumBlocksWithMotion( const picture_t* p_prev,
+int EstimateNumBlocksWithMotion( filter_t *p_filter,
+                                 const picture_t* p_prev,
                                  const picture_t* p_curr,
                                  int *pi_top, int *pi_bot);
 
@@ -155,6 +177,9 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
  * each other locally (in the temporal sense) to make meaningful decisions
  * about progressive or interlaced frames.
  *
+ * The lines are tested by slices on the filter threads.
+ *
+ * @param p_filter The filter instance.
  * @param p_pic_top Picture to take the top field from.
  * @param p_pic_bot Picture to take the bottom field from (same or different).
  * @return Interlace score, >= 0. Higher values mean more interlaced.
@@ -162,7 +187,8 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
  * @see RenderIVTC()
  * @see ComposeFrame()
  */
-int CalculateInterlaceScore( const picture_t* p_pic_top,
+int CalculateInterlaceScore( filter_t *p_filter,
+                             const picture_t* p_pic_top,
                              const picture_t* p_pic_bot );
 
 #endif
@@ -165,9 +165,11 @@ static void Destroy( filter_t *p_filter )
         const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
         const int sigma = atomic_load(&p_sys->sigma);         \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
+        if( i_first == 0 )                                              \
+            memcpy(p_out, p_src, i_visible_pitch);                      \
                                                                         \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = __MAX(i_first, 1);                            \
+             i < __MIN(i_end, i_visible_lines - 1); i++ )               \
         {                                                               \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
@@ -194,13 +196,24 @@ static void Destroy( filter_t *p_filter )
             p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
                 p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
+        if( i_end == i_visible_lines )                                  \
+            memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],      \
+                   &p_src[(i_visible_lines - 1) * i_src_line_len],      \
+                   i_visible_pitch);                                    \
     } while (0)
 
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+struct sharpen_frame
 {
+    const picture_t *p_pic;
+    picture_t *p_outpic;
+};
+
+static void FilterSlice( filter_t *p_filter, void *opaque,
+                         unsigned i_first, unsigned i_end )
+{
+    const struct sharpen_frame *frame = opaque;
+    const picture_t *p_pic = frame->p_pic;
+    picture_t *p_outpic = frame->p_outpic;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
     const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
@@ -212,6 +225,14 @@ static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
         SHARPEN_FRAME(255, uint8_t);
     else
         SHARPEN_FRAME(1023, uint16_t);
+}
+
+static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+{
+    struct sharpen_frame frame = { p_pic, p_outpic };
+
+    vlc_filter_RunSlices( p_filter, p_pic->p[Y_PLANE].i_visible_lines,
+                          FilterSlice, &frame );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
     plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
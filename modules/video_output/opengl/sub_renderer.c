@@ -56,6 +56,8 @@ typedef struct {
 
     float    tex_width;
     float    tex_height;
+
+    uint64_t serial; /* render serial of the last upload, 0 if none */
 } gl_region_t;
 
 struct vlc_gl_sub_renderer
@@ -308,6 +310,31 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr,
             glr->bottom = -2.0 * (r->place.y + r->place.height) / sr->output_height + 1.0;
 
             glr->texture = 0;
+            /* An unchanged region is still in its texture if it was uploaded
+               from the previous render, at the same place: draw it without
+               uploading it again. */
+            if (r->b_unchanged) {
+                for (int j = 0; j < last_count; j++) {
+                    if (last[j].texture &&
+                        last[j].serial + 1 == subpicture->i_serial &&
+                        last[j].width  == glr->width &&
+                        last[j].height == glr->height &&
+                        last[j].left   == glr->left &&
+                        last[j].top    == glr->top &&
+                        last[j].right  == glr->right &&
+                        last[j].bottom == glr->bottom) {
+                        glr->texture = last[j].texture;
+                        memset(&last[j], 0, sizeof(last[j]));
+                        break;
+                    }
+                }
+                if (glr->texture) {
+                    glr->serial = subpicture->i_serial;
+                    i++;
+                    continue;
+                }
+            }
+
             /* Try to recycle the textures allocated by the previous
                call to this function. */
             for (int j = 0; j < last_count; j++) {
@@ -343,6 +370,7 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr,
                                                     r->p_picture, &pixels_offset);
             if (ret != VLC_SUCCESS)
                 break;
+            glr->serial = subpicture->i_serial;
             i++;
         }
     }
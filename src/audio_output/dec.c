@@ -40,6 +40,11 @@
 #include "../libvlc.h"
 
 #define BLOCK_FLAG_CORE_PRIVATE_FILTERED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
+/* Drain request queued to the filter thread */
+#define BLOCK_FLAG_CORE_PRIVATE_DRAIN (2 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
+
+/* Maximum length of the blocks queued to the filter thread */
+#define AOUT_PIPELINE_MAX_LENGTH VLC_TICK_FROM_MS(200)
 
 struct vlc_aout_stream
 {
@@ -110,6 +115,25 @@ struct vlc_aout_stream
 
     atomic_uint buffers_lost;
     atomic_uint buffers_played;
+
+    /* Optional thread running the filters, the volume and the output of the
+     * played blocks, to decouple the decoder from the DSP work */
+    struct
+    {
+        bool enabled;
+        vlc_thread_t thread;
+        vlc_mutex_t lock; /* Guard the fifo and serialize the stream calls
+                             with the thread */
+        vlc_cond_t wait_block;
+        vlc_cond_t wait_idle; /* processing done or room in the fifo */
+        block_t *fifo_first;
+        block_t **fifo_last;
+        vlc_tick_t fifo_length;
+        bool processing;
+        bool paused;
+        bool closing;
+        int status; /* Status of the last block played by the thread */
+    } pipeline;
 };
 
 static inline aout_owner_t *aout_stream_owner(vlc_aout_stream *stream)
@@ -180,6 +204,10 @@ static bool stream_IsDrained(vlc_aout_stream *stream)
         return atomic_load_explicit(&stream->drained, memory_order_relaxed);
 }
 
+static int stream_Play(vlc_aout_stream *stream, block_t *block);
+static void stream_Flush(vlc_aout_stream *stream);
+static void stream_Drain(vlc_aout_stream *stream);
+
 static int stream_StartDiscontinuity(vlc_aout_stream *stream, block_t *block)
 {
     audio_output_t *aout = aout_stream_aout(stream);
@@ -204,7 +232,7 @@ static int stream_StartDiscontinuity(vlc_aout_stream *stream, block_t *block)
 
     msg_Dbg(aout, "discontinuity: at %"PRId64" us, draining output",
             block->i_pts);
-    vlc_aout_stream_Drain(stream);
+    stream_Drain(stream);
     stream->discontinuity.draining = true;
 
     stream->discontinuity.fifo_first = NULL;
@@ -248,7 +276,7 @@ static int stream_HandleDiscontinuity(vlc_aout_stream *stream, block_t *block)
 
     /* Reset the discontinuity state, and flush */
     stream->discontinuity.draining = false;
-    vlc_aout_stream_Flush(stream);
+    stream_Flush(stream);
 
     msg_Dbg(aout, "discontinuity: playing back %d blocks for a total length of "
             "%"PRId64" us", count, length);
@@ -263,7 +291,7 @@ static int stream_HandleDiscontinuity(vlc_aout_stream *stream, block_t *block)
         next = block->p_next;
         block->p_next = NULL;
 
-        vlc_aout_stream_Play(stream, block);
+        stream_Play(stream, block);
     }
 
     if (tracer != NULL)
@@ -336,6 +364,110 @@ static void stream_Reset(vlc_aout_stream *stream)
     stream_ResetTimings(stream);
 }
 
+static void *stream_PipelineThread(void *data)
+{
+    vlc_aout_stream *stream = data;
+
+    vlc_thread_set_name("vlc-aout-filter");
+
+    vlc_mutex_lock(&stream->pipeline.lock);
+    for (;;)
+    {
+        while (!stream->pipeline.closing
+            && (stream->pipeline.paused || stream->pipeline.fifo_first == NULL))
+            vlc_cond_wait(&stream->pipeline.wait_block, &stream->pipeline.lock);
+
+        if (stream->pipeline.closing)
+            break;
+
+        block_t *block = stream->pipeline.fifo_first;
+        stream->pipeline.fifo_first = block->p_next;
+        if (stream->pipeline.fifo_first == NULL)
+            stream->pipeline.fifo_last = &stream->pipeline.fifo_first;
+        block->p_next = NULL;
+        stream->pipeline.fifo_length -= block->i_length;
+        stream->pipeline.processing = true;
+        vlc_cond_broadcast(&stream->pipeline.wait_idle);
+        vlc_mutex_unlock(&stream->pipeline.lock);
+
+        if (block->i_flags & BLOCK_FLAG_CORE_PRIVATE_DRAIN)
+        {
+            block_Release(block);
+            stream_Drain(stream);
+            vlc_mutex_lock(&stream->pipeline.lock);
+        }
+        else
+        {
+            int status = stream_Play(stream, block);
+            vlc_mutex_lock(&stream->pipeline.lock);
+            stream->pipeline.status = status;
+        }
+        stream->pipeline.processing = false;
+        vlc_cond_broadcast(&stream->pipeline.wait_idle);
+    }
+    vlc_mutex_unlock(&stream->pipeline.lock);
+    return NULL;
+}
+
+/**
+ * Serializes a call from the decoder thread with the filter thread: waits for
+ * the block being processed, and prevents the next one from being processed.
+ */
+static void stream_PipelineLock(vlc_aout_stream *stream)
+{
+    if (!stream->pipeline.enabled)
+        return;
+
+    vlc_mutex_lock(&stream->pipeline.lock);
+    while (stream->pipeline.processing)
+        vlc_cond_wait(&stream->pipeline.wait_idle, &stream->pipeline.lock);
+}
+
+static void stream_PipelineUnlock(vlc_aout_stream *stream)
+{
+    if (stream->pipeline.enabled)
+        vlc_mutex_unlock(&stream->pipeline.lock);
+}
+
+static void stream_PipelineFlush(vlc_aout_stream *stream)
+{
+    block_ChainRelease(stream->pipeline.fifo_first);
+    stream->pipeline.fifo_first = NULL;
+    stream->pipeline.fifo_last = &stream->pipeline.fifo_first;
+    stream->pipeline.fifo_length = 0;
+}
+
+static int stream_PipelineStart(vlc_aout_stream *stream)
+{
+    vlc_mutex_init(&stream->pipeline.lock);
+    vlc_cond_init(&stream->pipeline.wait_block);
+    vlc_cond_init(&stream->pipeline.wait_idle);
+    stream->pipeline.fifo_first = NULL;
+    stream->pipeline.fifo_last = &stream->pipeline.fifo_first;
+    stream->pipeline.fifo_length = 0;
+    stream->pipeline.processing = false;
+    stream->pipeline.paused = false;
+    stream->pipeline.closing = false;
+    stream->pipeline.status = AOUT_DEC_SUCCESS;
+
+    if (vlc_clone(&stream->pipeline.thread, stream_PipelineThread, stream))
+        return VLC_EGENERIC;
+    stream->pipeline.enabled = true;
+    return VLC_SUCCESS;
+}
+
+static void stream_PipelineStop(vlc_aout_stream *stream)
+{
+    vlc_mutex_lock(&stream->pipeline.lock);
+    stream->pipeline.closing = true;
+    vlc_cond_signal(&stream->pipeline.wait_block);
+    vlc_mutex_unlock(&stream->pipeline.lock);
+
+    vlc_join(stream->pipeline.thread, NULL);
+    stream_PipelineFlush(stream);
+    stream->pipeline.enabled = false;
+}
+
 /**
  * Creates an audio output
  */
@@ -411,6 +543,8 @@ vlc_aout_stream * vlc_aout_stream_New(audio_output_t *p_aout,
     atomic_init(&stream->drained, false);
     atomic_init(&stream->drain_deadline, VLC_TICK_INVALID);
 
+    stream->pipeline.enabled = false;
+
     stream->filters = NULL;
     stream->filters_cfg = AOUT_FILTERS_CFG_INIT;
     if (aout_OutputNew(p_aout, stream, &stream->mixer_format, stream->input_profile,
@@ -440,6 +574,11 @@ error:
             free(stream);
             return NULL;
         }
+
+        if (var_InheritBool(p_aout, "audio-filter-thread")
+         && stream_PipelineStart(stream))
+            msg_Warn(p_aout, "cannot start the filter thread, "
+                     "filtering in the decoder thread");
     }
 
     return stream;
@@ -453,6 +592,9 @@ void vlc_aout_stream_Delete (vlc_aout_stream *stream)
     audio_output_t *aout = aout_stream_aout(stream);
     aout_owner_t *owner = aout_stream_owner(stream);
 
+    if (stream->pipeline.enabled)
+        stream_PipelineStop(stream);
+
     if (stream->mixer_format.i_format)
     {
         vlc_audio_meter_Reset(&owner->meter, NULL);
@@ -642,7 +784,7 @@ static void stream_HandleDrift(vlc_aout_stream *stream, vlc_tick_t drift,
         else
             msg_Dbg (aout, "playback too late (%"PRId64"): "
                      "flushing buffers", drift);
-        vlc_aout_stream_Flush(stream);
+        stream_Flush(stream);
         stream_StopResampling(stream);
 
         return; /* nothing can be done if timing is unknown */
@@ -865,9 +1007,9 @@ static vlc_tick_t stream_ClockConvert(vlc_aout_stream *stream,
 }
 
 /*****************************************************************************
- * vlc_aout_stream_Play : filter & mix the decoded buffer
+ * stream_Play : filter & mix the decoded buffer
  *****************************************************************************/
-int vlc_aout_stream_Play(vlc_aout_stream *stream, block_t *block)
+static int stream_Play(vlc_aout_stream *stream, block_t *block)
 {
     aout_owner_t *owner = aout_stream_owner(stream);
     audio_output_t *aout = aout_stream_aout(stream);
@@ -884,7 +1026,13 @@ int vlc_aout_stream_Play(vlc_aout_stream *stream, block_t *block)
     if (block->i_flags & BLOCK_FLAG_DISCONTINUITY && stream->sync.played)
         return stream_StartDiscontinuity(stream, block);
 
-    int ret = stream_CheckReady (stream);
+    int ret;
+    if (stream->pipeline.enabled)
+        /* Restarts are done by vlc_aout_stream_Play() */
+        ret = stream->mixer_format.i_format ? AOUT_DEC_SUCCESS
+                                            : AOUT_DEC_FAILED;
+    else
+        ret = stream_CheckReady (stream);
     if (unlikely(ret == AOUT_DEC_FAILED))
         goto drop; /* Pipeline is unrecoverably broken :-( */
 
@@ -966,6 +1114,46 @@ drop:
     return ret;
 }
 
+int vlc_aout_stream_Play(vlc_aout_stream *stream, block_t *block)
+{
+    if (!stream->pipeline.enabled)
+        return stream_Play(stream, block);
+
+    block->i_length = vlc_tick_from_samples( block->i_nb_samples,
+                                   stream->input_format.i_rate );
+
+    vlc_mutex_lock(&stream->pipeline.lock);
+
+    /* Restart from the decoder thread, so that the status is returned for the
+     * block that noticed the restart. The queued blocks are not filtered yet,
+     * so they are played through the new filters. */
+    int ret = AOUT_DEC_SUCCESS;
+    if (atomic_load_explicit(&stream->restart, memory_order_relaxed) != 0)
+    {
+        while (stream->pipeline.processing)
+            vlc_cond_wait(&stream->pipeline.wait_idle, &stream->pipeline.lock);
+        ret = stream_CheckReady(stream);
+        stream->pipeline.status = (ret == AOUT_DEC_FAILED) ? AOUT_DEC_FAILED
+                                                           : AOUT_DEC_SUCCESS;
+    }
+
+    /* Bounded buffering: wait for the filter thread to catch up, unless it
+     * is paused and would not */
+    while (stream->pipeline.fifo_length >= AOUT_PIPELINE_MAX_LENGTH
+        && stream->pipeline.fifo_first != NULL && !stream->pipeline.paused)
+        vlc_cond_wait(&stream->pipeline.wait_idle, &stream->pipeline.lock);
+
+    block_ChainLastAppend(&stream->pipeline.fifo_last, block);
+    stream->pipeline.fifo_length += block->i_length;
+    vlc_cond_signal(&stream->pipeline.wait_block);
+
+    /* Otherwise, report whether the output is still working */
+    if (ret == AOUT_DEC_SUCCESS)
+        ret = stream->pipeline.status;
+    vlc_mutex_unlock(&stream->pipeline.lock);
+    return ret;
+}
+
 void vlc_aout_stream_GetResetStats(vlc_aout_stream *stream, unsigned *restrict lost,
                            unsigned *restrict played)
 {
@@ -979,6 +1167,14 @@ void vlc_aout_stream_ChangePause(vlc_aout_stream *stream, bool paused, vlc_tick_
 {
     audio_output_t *aout = aout_stream_aout(stream);
 
+    stream_PipelineLock(stream);
+    if (stream->pipeline.enabled)
+    {
+        stream->pipeline.paused = paused;
+        if (!paused)
+            vlc_cond_signal(&stream->pipeline.wait_block);
+    }
+
     if (stream->mixer_format.i_format)
     {
         struct vlc_tracer *tracer = aout_stream_tracer(stream);
@@ -1006,7 +1202,7 @@ void vlc_aout_stream_ChangePause(vlc_aout_stream *stream, bool paused, vlc_tick_
         if (aout->pause != NULL)
             aout->pause(aout, paused, date);
         else if (paused)
-            vlc_aout_stream_Flush(stream);
+            stream_Flush(stream);
 
         /* Update the rate point after the pause */
         if (aout->time_get == NULL && !paused
@@ -1021,19 +1217,24 @@ void vlc_aout_stream_ChangePause(vlc_aout_stream *stream, bool paused, vlc_tick_
             stream->timing.rate_system_ts = play_date;
         }
     }
+    stream_PipelineUnlock(stream);
 }
 
 void vlc_aout_stream_ChangeRate(vlc_aout_stream *stream, float rate)
 {
+    stream_PipelineLock(stream);
     stream->sync.rate = rate;
+    stream_PipelineUnlock(stream);
 }
 
 void vlc_aout_stream_ChangeDelay(vlc_aout_stream *stream, vlc_tick_t delay)
 {
+    stream_PipelineLock(stream);
     stream->sync.request_delay = delay;
+    stream_PipelineUnlock(stream);
 }
 
-void vlc_aout_stream_Flush(vlc_aout_stream *stream)
+static void stream_Flush(vlc_aout_stream *stream)
 {
     audio_output_t *aout = aout_stream_aout(stream);
 
@@ -1046,6 +1247,18 @@ void vlc_aout_stream_Flush(vlc_aout_stream *stream)
     stream_Reset(stream);
 }
 
+void vlc_aout_stream_Flush(vlc_aout_stream *stream)
+{
+    stream_PipelineLock(stream);
+    if (stream->pipeline.enabled)
+    {
+        stream_PipelineFlush(stream);
+        stream->pipeline.status = AOUT_DEC_SUCCESS;
+    }
+    stream_Flush(stream);
+    stream_PipelineUnlock(stream);
+}
+
 void vlc_aout_stream_NotifyGain(vlc_aout_stream *stream, float gain)
 {
     if (stream->volume != NULL)
@@ -1059,14 +1272,29 @@ void vlc_aout_stream_NotifyDrained(vlc_aout_stream *stream)
 
 bool vlc_aout_stream_IsDrained(vlc_aout_stream *stream)
 {
+    bool busy;
+
+    if (stream->pipeline.enabled)
+    {
+        /* Blocks, or the drain request, are still queued. The filter thread
+         * only changes the discontinuity state while processing. */
+        vlc_mutex_lock(&stream->pipeline.lock);
+        busy = stream->pipeline.fifo_first != NULL
+            || stream->pipeline.processing
+            || stream->discontinuity.draining;
+        vlc_mutex_unlock(&stream->pipeline.lock);
+    }
+    else
+        busy = stream->discontinuity.draining;
+
     /* The internal draining state should not mess with the public one */
-    if (stream->discontinuity.draining)
+    if (busy)
         return false;
 
     return stream_IsDrained(stream);
 }
 
-void vlc_aout_stream_Drain(vlc_aout_stream *stream)
+static void stream_Drain(vlc_aout_stream *stream)
 {
     audio_output_t *aout = aout_stream_aout(stream);
 
@@ -1126,3 +1354,25 @@ void vlc_aout_stream_Drain(vlc_aout_stream *stream)
                               memory_order_relaxed);
     }
 }
+
+void vlc_aout_stream_Drain(vlc_aout_stream *stream)
+{
+    if (stream->pipeline.enabled)
+    {
+        /* Drain after the queued blocks are played */
+        block_t *drain = block_Alloc(0);
+        if (likely(drain != NULL))
+        {
+            drain->i_flags |= BLOCK_FLAG_CORE_PRIVATE_DRAIN;
+            vlc_mutex_lock(&stream->pipeline.lock);
+            block_ChainLastAppend(&stream->pipeline.fifo_last, drain);
+            vlc_cond_signal(&stream->pipeline.wait_block);
+            vlc_mutex_unlock(&stream->pipeline.lock);
+            return;
+        }
+    }
+
+    stream_PipelineLock(stream);
+    stream_Drain(stream);
+    stream_PipelineUnlock(stream);
+}
@@ -1784,14 +1784,23 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
 
     vlc_fifo_Unlock(p_owner->p_fifo);
 
+    /* The frame belongs to the decoder once decoding starts */
+    const vlc_tick_t pts = frame != NULL ? frame->i_pts : VLC_TICK_INVALID;
+
     if ( tracer != NULL && frame != NULL )
     {
         vlc_tracer_TraceStreamDTS( tracer, "DEC", p_owner->psz_id, "IN",
                             frame->i_pts, frame->i_dts );
+        vlc_tracer_TraceSpanBegin( tracer, "DEC", p_owner->psz_id, "decode",
+                                   pts );
     }
 
     int ret = p_dec->pf_decode( p_dec, frame );
 
+    if ( tracer != NULL && frame != NULL )
+        vlc_tracer_TraceSpanEnd( tracer, "DEC", p_owner->psz_id, "decode",
+                                 pts );
+
     vlc_fifo_Lock(p_owner->p_fifo);
     switch( ret )
     {
@@ -1986,6 +1995,8 @@ static void *DecoderThread( void *p_data )
 
     vlc_thread_set_name(thread_name);
 
+    struct vlc_tracer *tracer = vlc_object_get_tracer( &p_owner->dec.obj );
+
     /* The decoder's main loop */
     vlc_fifo_Lock( p_owner->p_fifo );
 
@@ -2045,6 +2056,9 @@ static void *DecoderThread( void *p_data )
         vlc_cond_signal( &p_owner->wait_fifo );
 
         vlc_frame_t *frame = vlc_fifo_DequeueUnlocked( p_owner->p_fifo );
+        if( frame != NULL && tracer != NULL )
+            vlc_tracer_TraceSpanEnd( tracer, "DEC", p_owner->psz_id, "queue",
+                                     frame->i_pts );
         if( frame == NULL )
         {
             if( likely(!p_owner->b_draining) )
@@ -2670,11 +2684,15 @@ void vlc_input_decoder_DecodeWithStatus(vlc_input_decoder_t *p_owner, vlc_frame_
     if (vlc_fifo_IsEmpty(p_owner->p_fifo) && p_owner->frames_countdown > 0)
         decoder_Notify(p_owner, frame_next_need_data, false);
 
+    struct vlc_tracer *tracer = vlc_object_get_tracer(&p_owner->dec.obj);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "DEC", p_owner->psz_id, "queue",
+                                  frame->i_pts);
+
     vlc_fifo_QueueUnlocked( p_owner->p_fifo, frame );
     if (status != NULL)
         GetStatusLocked(p_owner, status);
 
-    struct vlc_tracer *tracer = vlc_object_get_tracer(&p_owner->dec.obj);
     if (tracer != NULL)
     {
         size_t fifo_size = vlc_fifo_GetBytes(p_owner->p_fifo);
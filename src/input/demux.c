@@ -35,6 +35,7 @@
 #include <vlc_url.h>
 #include <vlc_modules.h>
 #include <vlc_strings.h>
+#include <vlc_tracer.h>
 #include "input_internal.h"
 
 typedef const struct
@@ -220,7 +221,19 @@ static int demux_ReadDir( stream_t *s, input_item_node_t *p_node )
 int demux_Demux(demux_t *demux)
 {
     if (demux->pf_demux != NULL || (demux->ops != NULL && demux->ops->demux.demux != NULL))
-        return (demux->ops != NULL ? demux->ops->demux.demux : demux->pf_demux)(demux);
+    {
+        struct vlc_tracer *tracer = vlc_object_get_tracer(VLC_OBJECT(demux));
+
+        if (tracer == NULL)
+            return (demux->ops != NULL ? demux->ops->demux.demux : demux->pf_demux)(demux);
+
+        vlc_tracer_TraceSpanBegin(tracer, "DEMUX", demux->psz_name, "demux",
+                                  VLC_TICK_INVALID);
+        int ret = (demux->ops != NULL ? demux->ops->demux.demux : demux->pf_demux)(demux);
+        vlc_tracer_TraceSpanEnd(tracer, "DEMUX", demux->psz_name, "demux",
+                                VLC_TICK_INVALID);
+        return ret;
+    }
 
     if ((demux->pf_readdir != NULL || (demux->ops != NULL && demux->ops->demux.readdir != NULL)) && demux->p_input_item != NULL) {
         input_item_node_t *node = input_item_node_Create(demux->p_input_item);
@@ -3203,11 +3203,21 @@ static int EsOutSend(es_out_t *out, es_out_id_t *es, block_t *p_block )
             vlc_input_decoder_Decode( es->p_dec_record, p_dup,
                                       input_priv(p_input)->b_out_pace_control );
     }
+    /* The block belongs to the decoder once sent */
+    const vlc_tick_t i_pts = p_block->i_pts;
+    if( tracer != NULL )
+        vlc_tracer_TraceSpanBegin( tracer, "DEMUX", es->id.str_id, "send",
+                                   i_pts );
+
     struct vlc_input_decoder_status status;
     vlc_input_decoder_DecodeWithStatus(es->p_dec, p_block,
                                        input_priv(p_input)->b_out_pace_control,
                                        &status);
 
+    if( tracer != NULL )
+        vlc_tracer_TraceSpanEnd( tracer, "DEMUX", es->id.str_id, "send",
+                                 i_pts );
+
     if( status.format.changed )
     {
         int ret = EsOutEsUpdateFmt(es, &status.format.fmt);
@@ -33,8 +33,10 @@
 #include <errno.h>
 #if defined (_WIN32)
 #  include <direct.h>
+#  include <io.h>
 #endif
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <vlc_common.h>
@@ -191,26 +193,87 @@ static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_send_t, header), "in
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_control_t, header), "invalid packing");
 static_assert(offsetof(ts_cmd_t, header) == offsetof(ts_cmd_privcontrol_t, header), "invalid packing");
 
-typedef struct ts_storage_t ts_storage_t;
-struct ts_storage_t
+/* Header of a command stored in the timeshift file: a C_SEND command,
+ * followed by the block data, or a clock update, followed by the command */
+typedef struct attribute_packed
+{
+    int8_t      i_type;
+    vlc_tick_t  i_date;
+    es_out_id_t *p_es;
+    vlc_tick_t  i_dts;
+    vlc_tick_t  i_pts;
+    vlc_tick_t  i_length;
+    uint32_t    i_flags;
+    uint32_t    i_nb_samples;
+    uint32_t    i_buffer;
+} ts_storage_record_t;
+
+/* Any other command, kept in memory with the file position it precedes */
+typedef struct
 {
-    ts_storage_t *p_next;
+    uint64_t i_pos;
+    ts_cmd_t cmd;
+} ts_storage_cmd_t;
 
-    /* */
+#define TS_STORAGE_ALIGN        4096
+#define TS_STORAGE_BUFFER_SIZE  (1024 * 1024)
+#define TS_STORAGE_BUFFER_COUNT 4
+#define TS_STORAGE_INDEX_STEP   VLC_TICK_FROM_SEC(1)
+
+/* The timeshift file is a ring of fixed size chunks: the records are stored
+ * at increasing logical positions, each chunk of positions being mapped to
+ * a slot of the file. The slots of the consumed chunks are reused, and the
+ * oldest chunk is dropped when the file reached its maximum size. */
+typedef struct ts_storage_t
+{
 #ifdef _WIN32
     char    *psz_file;  /* Filename */
 #endif
-    size_t  i_file_max; /* Max size in bytes */
-    int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    int     fd;
 
     /* */
-    uint8_t *p_cmd_r;
-    uint8_t *p_cmd_w;
-    uint8_t *p_cmd_buf;
-    size_t   i_cmd_buf;
-};
+    size_t  i_chunk_size;   /* Size in bytes of a chunk */
+    size_t  i_slots_max;    /* Maximum number of slots (0 for unlimited) */
+    size_t  i_slots;        /* Number of slots of the file */
+    uint64_t i_first_chunk; /* First chunk still mapped */
+    struct VLC_VECTOR(size_t) chunks;     /* Slot of the mapped chunks */
+    struct VLC_VECTOR(size_t) free_slots;
+
+    /* Logical positions */
+    uint64_t i_read;
+    uint64_t i_write;
+    bool     b_skipped;
+    unsigned i_seek;        /* Number of moves of the reading position */
+
+    /* */
+    struct VLC_VECTOR(ts_storage_cmd_t) cmds;
+    size_t   i_cmd_first;
+
+    /* Sources of the clock updates stored in the file */
+    struct VLC_VECTOR(input_source_t *) sources;
+
+    /* Position of the first record of each TS_STORAGE_INDEX_STEP, from
+     * i_index_first */
+    vlc_tick_t i_index_date;
+    struct VLC_VECTOR(uint64_t) index;
+    size_t   i_index_first;
+
+    /* Only used by the reader, which loads it without the caller lock */
+    uint8_t  *p_cache;
+    uint64_t i_cache;       /* Buffer number held by p_cache */
+
+    /* Background writer */
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;      /* Lock for all following fields */
+    vlc_cond_t   wait;
+    bool         b_stop;
+    uint64_t     i_queued;  /* End of the full buffers */
+    uint64_t     i_flushed; /* End of the written buffers */
+    uint64_t     i_failed;  /* Start of the first buffer not written */
+    int          i_error;   /* errno of the first failed write, 0 if none */
+    uint8_t      *pp_buffer[TS_STORAGE_BUFFER_COUNT];
+    uint64_t     pi_offset[TS_STORAGE_BUFFER_COUNT];
+} ts_storage_t;
 
 typedef struct
 {
@@ -220,6 +283,8 @@ typedef struct
     es_out_t       *p_tsout;
     struct vlc_input_es_out *p_out;
     int64_t        i_tmp_size_max;
+    int64_t        i_tmp_total_max;
+    bool           b_tmp_direct;
     const char     *psz_tmp_path;
 
     /* Lock for all following fields */
@@ -241,8 +306,8 @@ typedef struct
     vlc_tick_t     i_buffering_delay;
 
     /* */
-    ts_storage_t   *p_storage_r;
-    ts_storage_t   *p_storage_w;
+    ts_storage_t   *p_storage;
+    bool           b_write_error; /* The write error was reported */
 
     vlc_tick_t     i_cmd_delay;
 
@@ -259,7 +324,9 @@ struct es_out_timeshift
     struct vlc_input_es_out *p_out;
 
     /* Configuration */
-    int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
+    int64_t        i_tmp_size_max;    /* Temporary file chunk size in byte */
+    int64_t        i_tmp_total_max;   /* Maximal temporary file size in byte */
+    bool           b_tmp_direct;      /* Bypass the system cache */
     char           *psz_tmp_path;     /* Path for temporary files */
 
     /* Lock for all following fields */
@@ -289,7 +356,7 @@ static void         TsAutoStop( es_out_t * );
 
 static void         TsStop( ts_thread_t * );
 static void         TsPushCmd( ts_thread_t *, ts_cmd_t * );
-static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool b_flush );
+static int          TsPopCmdLocked( ts_thread_t *, ts_cmd_t *, bool *pb_skipped );
 static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, vlc_tick_t i_date );
@@ -297,13 +364,13 @@ static int          TsChangeRate( ts_thread_t *, float src_rate, float rate );
 
 static void         *TsRun( void * );
 
-static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_chunk_size,
+                                   int64_t i_size_max, bool b_direct );
 static void         TsStorageDelete( ts_storage_t * );
-static void         TsStoragePack( ts_storage_t *p_storage );
-static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
-static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
-static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
+static int          TsStoragePushCmd( ts_storage_t *, ts_cmd_t *p_cmd );
+static int          TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool *pb_skipped,
+                                     vlc_mutex_t *p_lock );
 
 static void CmdClean( ts_cmd_t * );
 
@@ -905,6 +972,12 @@ input_EsOutTimeshiftNew(input_thread_t *p_input,
     msg_Dbg( p_input, "using timeshift granularity of %d MiB",
              (int)p_sys->i_tmp_size_max/(1024*1024) );
 
+    const int64_t i_tmp_total_max = var_InheritInteger( p_input, "input-timeshift-size" );
+    p_sys->i_tmp_total_max = __MAX( i_tmp_total_max, 0 ) * 1024 * 1024;
+    if( p_sys->i_tmp_total_max > 0 )
+        msg_Dbg( p_input, "using timeshift size of %"PRId64" MiB", i_tmp_total_max );
+    p_sys->b_tmp_direct = var_InheritBool( p_input, "input-timeshift-direct" );
+
     p_sys->psz_tmp_path = var_InheritString( p_input, "input-timeshift-path" );
 #if defined (_WIN32)
     if( p_sys->psz_tmp_path == NULL )
@@ -983,6 +1056,8 @@ static int TsStart(struct es_out_timeshift *p_sys)
         return VLC_EGENERIC;
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
+    p_ts->i_tmp_total_max = p_sys->i_tmp_total_max;
+    p_ts->b_tmp_direct = p_sys->b_tmp_direct;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
     p_ts->p_input = p_sys->p_input;
     p_ts->ts = p_sys;
@@ -999,8 +1074,8 @@ static int TsStart(struct es_out_timeshift *p_sys)
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
-    p_ts->p_storage_r = NULL;
-    p_ts->p_storage_w = NULL;
+    p_ts->p_storage = NULL;
+    p_ts->b_write_error = false;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts ) )
@@ -1035,20 +1110,8 @@ static void TsStop( ts_thread_t *p_ts )
     vlc_mutex_unlock( &p_ts->lock );
     vlc_join( p_ts->thread, NULL );
 
-    vlc_mutex_lock( &p_ts->lock );
-    for( ;; )
-    {
-        ts_cmd_t cmd;
-
-        if( TsPopCmdLocked( p_ts, &cmd, true ) )
-            break;
-
-        CmdClean( &cmd );
-    }
-    assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
-    vlc_mutex_unlock( &p_ts->lock );
+    if( p_ts->p_storage )
+        TsStorageDelete( p_ts->p_storage );
 
     TsDestroy( p_ts );
 }
@@ -1056,64 +1119,51 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
-    if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
+    if( !p_ts->p_storage )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
-
-        if( !p_storage )
+        p_ts->p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max,
+                                        p_ts->i_tmp_total_max, p_ts->b_tmp_direct );
+        if( !p_ts->p_storage )
         {
             CmdClean( p_cmd );
             vlc_mutex_unlock( &p_ts->lock );
             /* TODO warn the user (but only once) */
             return;
         }
+    }
 
-        if( !p_ts->p_storage_w )
-        {
-            p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
-        }
-        else
+    const int i_ret = TsStoragePushCmd( p_ts->p_storage, p_cmd );
+    if( i_ret != VLC_SUCCESS )
+    {
+        if( i_ret != VLC_EGENERIC && i_ret != VLC_ENOMEM &&
+            !p_ts->b_write_error )
         {
-            TsStoragePack( p_ts->p_storage_w );
-            p_ts->p_storage_w->p_next = p_storage;
-            p_ts->p_storage_w = p_storage;
+            msg_Err( p_ts->p_input, "cannot write the timeshift file: %s",
+                     vlc_strerror_c( -i_ret ) );
+            p_ts->b_write_error = true;
         }
+        CmdClean( p_cmd );
     }
 
-    /* TODO return error and warn the user (but only once) */
-    TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
-
     vlc_cond_signal( &p_ts->wait );
 
     vlc_mutex_unlock( &p_ts->lock );
 }
-static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
+static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool *pb_skipped )
 {
     vlc_mutex_assert( &p_ts->lock );
 
-    if( TsStorageIsEmpty( p_ts->p_storage_r ) )
+    if( TsStorageIsEmpty( p_ts->p_storage ) )
         return VLC_EGENERIC;
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
-
-    while( TsStorageIsEmpty( p_ts->p_storage_r ) )
-    {
-        ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
-            break;
-
-        TsStorageDelete( p_ts->p_storage_r );
-        p_ts->p_storage_r = p_next;
-    }
-
-    return VLC_SUCCESS;
+    return TsStoragePopCmd( p_ts->p_storage, p_cmd, pb_skipped, &p_ts->lock );
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
     bool b_cmd;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_cmd = !TsStorageIsEmpty( p_ts->p_storage_r );
+    b_cmd = !TsStorageIsEmpty( p_ts->p_storage );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_cmd;
@@ -1125,7 +1175,7 @@ static bool TsIsUnused( ts_thread_t *p_ts )
     vlc_mutex_lock( &p_ts->lock );
     b_unused = !p_ts->b_paused &&
                p_ts->rate == p_ts->rate_source &&
-               TsStorageIsEmpty( p_ts->p_storage_r );
+               TsStorageIsEmpty( p_ts->p_storage );
     vlc_mutex_unlock( &p_ts->lock );
 
     return b_unused;
@@ -1192,17 +1242,33 @@ static void *TsRun( void *p_data )
     {
         ts_cmd_t cmd;
         vlc_tick_t  i_deadline;
+        bool b_skipped;
 
         /* Pop a command to execute */
         bool b_buffering = es_out_GetBuffering( p_ts->p_out );
 
         if( ( p_ts->b_paused && !b_buffering )
-         || TsPopCmdLocked( p_ts, &cmd, false ) )
+         || TsPopCmdLocked( p_ts, &cmd, &b_skipped ) )
         {
             vlc_cond_wait( &p_ts->wait, &p_ts->lock );
             continue;
         }
 
+        if( b_skipped )
+        {
+            /* The commands we were late on have been dropped from the
+             * storage (possibly before any was read): continue with the
+             * oldest remaining one right away */
+            p_ts->i_cmd_delay += p_ts->i_rate_delay;
+            p_ts->i_rate_date = -1;
+            p_ts->i_rate_delay = 0;
+
+            const vlc_tick_t i_ahead = cmd.header.i_date + p_ts->i_cmd_delay +
+                                       p_ts->i_buffering_delay - vlc_tick_now();
+            if( i_ahead > 0 )
+                p_ts->i_cmd_delay -= i_ahead;
+        }
+
         if( b_buffering && i_buffering_date < 0 )
         {
             i_buffering_date = cmd.header.i_date;
@@ -1293,21 +1359,98 @@ static void *TsRun( void *p_data )
 /*****************************************************************************
  *
  *****************************************************************************/
-#define MAX_COMMAND_SIZE sizeof(ts_cmd_t)
-#define TS_STORAGE_COMMAND_PREALLOC 30000
+static ssize_t TsStorageReadAt( int fd, void *p_data, size_t i_size, uint64_t i_offset )
+{
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle( fd );
+    OVERLAPPED olap = { .Offset = (DWORD)i_offset,
+                        .OffsetHigh = (DWORD)(i_offset >> 32) };
+    DWORD i_done;
+    if( !ReadFile( handle, p_data, i_size, &i_done, &olap ) )
+    {
+        errno = EIO;
+        return -1;
+    }
+    return i_done;
+#else
+    return pread( fd, p_data, i_size, i_offset );
+#endif
+}
 
-static const size_t TsStorageSizeofCommand[] =
+static ssize_t TsStorageWriteAt( int fd, const void *p_data, size_t i_size, uint64_t i_offset )
 {
-    [C_ADD] = sizeof(ts_cmd_add_t),
-    [C_SEND] = sizeof(ts_cmd_send_t),
-    [C_DEL] = sizeof(ts_cmd_del_t),
-    [C_CONTROL] = sizeof(ts_cmd_control_t),
-    [C_PRIVCONTROL] = sizeof(ts_cmd_privcontrol_t)
-};
+#ifdef _WIN32
+    HANDLE handle = (HANDLE)_get_osfhandle( fd );
+    OVERLAPPED olap = { .Offset = (DWORD)i_offset,
+                        .OffsetHigh = (DWORD)(i_offset >> 32) };
+    DWORD i_done;
+    if( !WriteFile( handle, p_data, i_size, &i_done, &olap ) )
+    {
+        errno = EIO;
+        return -1;
+    }
+    return i_done;
+#else
+    return pwrite( fd, p_data, i_size, i_offset );
+#endif
+}
+
+static void *TsStorageRun( void *p_data )
+{
+    vlc_thread_set_name("vlc-timeshift-w");
 
-static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_max )
+    ts_storage_t *p_storage = p_data;
+
+    vlc_mutex_lock( &p_storage->lock );
+    for( ;; )
+    {
+        while( !p_storage->b_stop && p_storage->i_flushed >= p_storage->i_queued )
+            vlc_cond_wait( &p_storage->wait, &p_storage->lock );
+        if( p_storage->b_stop )
+            break;
+
+        const size_t i_buffer = (p_storage->i_flushed / TS_STORAGE_BUFFER_SIZE) % TS_STORAGE_BUFFER_COUNT;
+        const uint8_t *p_buffer = p_storage->pp_buffer[i_buffer];
+        const uint64_t i_offset = p_storage->pi_offset[i_buffer];
+        /* Nothing is written after an error, the buffers are only released */
+        const bool b_error = p_storage->i_error != 0;
+        vlc_mutex_unlock( &p_storage->lock );
+
+        /* The buffer is left alone by the other threads until it is
+         * flushed */
+        int i_error = 0;
+        for( size_t i_done = 0; !b_error && i_done < TS_STORAGE_BUFFER_SIZE; )
+        {
+            ssize_t i_ret = TsStorageWriteAt( p_storage->fd, &p_buffer[i_done],
+                                              TS_STORAGE_BUFFER_SIZE - i_done,
+                                              i_offset + i_done );
+            if( i_ret < 0 && errno == EINTR )
+                continue;
+            if( i_ret <= 0 )
+            {
+                i_error = i_ret < 0 ? errno : ENOSPC;
+                break;
+            }
+            i_done += i_ret;
+        }
+
+        vlc_mutex_lock( &p_storage->lock );
+        if( i_error != 0 )
+        {
+            p_storage->i_error = i_error;
+            p_storage->i_failed = p_storage->i_flushed;
+        }
+        p_storage->i_flushed += TS_STORAGE_BUFFER_SIZE;
+        vlc_cond_broadcast( &p_storage->wait );
+    }
+    vlc_mutex_unlock( &p_storage->lock );
+    return NULL;
+}
+
+static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_chunk_size,
+                                   int64_t i_size_max, bool b_direct )
 {
-    ts_storage_t *p_storage = malloc( sizeof (*p_storage) );
+    ts_storage_t *p_storage = calloc( 1, sizeof (*p_storage) );
     if( unlikely(p_storage == NULL) )
         return NULL;
 
@@ -1319,67 +1462,96 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
         return NULL;
     }
 
-    p_storage->p_filew = fdopen( fd, "w+b" );
-    if( p_storage->p_filew == NULL )
-    {
-        vlc_close( fd );
-        vlc_unlink( psz_file );
-        goto error;
-    }
-
-    p_storage->p_filer = vlc_fopen( psz_file, "rb" );
-    if( p_storage->p_filer == NULL )
-    {
-        fclose( p_storage->p_filew );
-        vlc_unlink( psz_file );
-        goto error;
-    }
-
 #ifndef _WIN32
     vlc_unlink( psz_file );
     free( psz_file );
 #else
     p_storage->psz_file = psz_file;
 #endif
-    p_storage->p_next = NULL;
-
-    /* */
-    p_storage->i_file_max = i_tmp_size_max;
-    p_storage->i_file_size = 0;
+    p_storage->fd = fd;
+
+    /* Every access to the file is done on whole aligned buffers, the direct
+     * I/O is used if the file system supports it */
+    if( b_direct )
+    {
+#if defined(O_DIRECT)
+        int i_flags = fcntl( fd, F_GETFL );
+        if( i_flags != -1 )
+            fcntl( fd, F_SETFL, i_flags | O_DIRECT );
+#elif defined(F_NOCACHE)
+        fcntl( fd, F_NOCACHE, 1 );
+#endif
+    }
 
     /* */
-    p_storage->p_cmd_buf = vlc_alloc( TS_STORAGE_COMMAND_PREALLOC, MAX_COMMAND_SIZE );
-    p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
-    p_storage->p_cmd_w = p_storage->p_cmd_buf;
-    p_storage->p_cmd_r = p_storage->p_cmd_buf;
-    //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
-
-    if( !p_storage->p_cmd_buf )
+    p_storage->i_chunk_size = (i_chunk_size + TS_STORAGE_BUFFER_SIZE - 1)
+                            / TS_STORAGE_BUFFER_SIZE * TS_STORAGE_BUFFER_SIZE;
+    p_storage->i_slots_max = 0;
+    if( i_size_max > 0 )
+        p_storage->i_slots_max = __MAX( i_size_max / p_storage->i_chunk_size, 2 );
+    vlc_vector_init( &p_storage->chunks );
+    vlc_vector_init( &p_storage->free_slots );
+    vlc_vector_init( &p_storage->cmds );
+    vlc_vector_init( &p_storage->sources );
+    vlc_vector_init( &p_storage->index );
+    p_storage->i_index_date = VLC_TICK_INVALID;
+    p_storage->i_cache = UINT64_MAX;
+    p_storage->i_failed = UINT64_MAX;
+
+    vlc_mutex_init( &p_storage->lock );
+    vlc_cond_init( &p_storage->wait );
+
+    p_storage->p_cache = aligned_alloc( TS_STORAGE_ALIGN, TS_STORAGE_BUFFER_SIZE );
+    if( !p_storage->p_cache )
+        goto error;
+    for( size_t i = 0; i < TS_STORAGE_BUFFER_COUNT; i++ )
     {
-        TsStorageDelete( p_storage );
-        return NULL;
+        p_storage->pp_buffer[i] = aligned_alloc( TS_STORAGE_ALIGN, TS_STORAGE_BUFFER_SIZE );
+        if( !p_storage->pp_buffer[i] )
+            goto error;
     }
+
+    if( vlc_clone( &p_storage->thread, TsStorageRun, p_storage ) )
+        goto error;
+
     return p_storage;
+
 error:
-    free( psz_file );
+    for( size_t i = 0; i < TS_STORAGE_BUFFER_COUNT; i++ )
+        aligned_free( p_storage->pp_buffer[i] );
+    aligned_free( p_storage->p_cache );
+    vlc_close( p_storage->fd );
+#ifdef _WIN32
+    vlc_unlink( p_storage->psz_file );
+    free( p_storage->psz_file );
+#endif
     free( p_storage );
     return NULL;
 }
 
 static void TsStorageDelete( ts_storage_t *p_storage )
 {
-    while( p_storage->p_cmd_r < p_storage->p_cmd_w )
-    {
-        ts_cmd_t cmd;
-
-        TsStoragePopCmd( p_storage, &cmd, true );
-
-        CmdClean( &cmd );
-    }
-    free( p_storage->p_cmd_buf );
-
-    fclose( p_storage->p_filer );
-    fclose( p_storage->p_filew );
+    vlc_mutex_lock( &p_storage->lock );
+    p_storage->b_stop = true;
+    vlc_cond_broadcast( &p_storage->wait );
+    vlc_mutex_unlock( &p_storage->lock );
+    vlc_join( p_storage->thread, NULL );
+
+    for( size_t i = p_storage->i_cmd_first; i < p_storage->cmds.size; i++ )
+        CmdClean( &p_storage->cmds.data[i].cmd );
+    vlc_vector_destroy( &p_storage->cmds );
+    for( size_t i = 0; i < p_storage->sources.size; i++ )
+        input_source_Release( p_storage->sources.data[i] );
+    vlc_vector_destroy( &p_storage->sources );
+    vlc_vector_destroy( &p_storage->index );
+    vlc_vector_destroy( &p_storage->free_slots );
+    vlc_vector_destroy( &p_storage->chunks );
+
+    for( size_t i = 0; i < TS_STORAGE_BUFFER_COUNT; i++ )
+        aligned_free( p_storage->pp_buffer[i] );
+    aligned_free( p_storage->p_cache );
+
+    vlc_close( p_storage->fd );
 #ifdef _WIN32
     vlc_unlink( p_storage->psz_file );
     free( p_storage->psz_file );
@@ -1387,113 +1559,447 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     free( p_storage );
 }
 
-static void TsStoragePack( ts_storage_t *p_storage )
+static bool TsStorageIsEmpty( ts_storage_t *p_storage )
 {
-    /* Try to release a bit of memory */
-    if( (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) == p_storage->i_cmd_buf )
-        return;
+    return !p_storage || ( p_storage->i_cmd_first >= p_storage->cmds.size &&
+                           p_storage->i_read >= p_storage->i_write );
+}
+
+static uint64_t TsStorageGetOffset( ts_storage_t *p_storage, uint64_t i_pos )
+{
+    const uint64_t i_chunk = i_pos / p_storage->i_chunk_size;
+
+    assert( i_chunk >= p_storage->i_first_chunk &&
+            i_chunk - p_storage->i_first_chunk < p_storage->chunks.size );
+    const size_t i_slot = p_storage->chunks.data[i_chunk - p_storage->i_first_chunk];
 
-    size_t i_realloc = p_storage->p_cmd_w - p_storage->p_cmd_buf;
-    uint8_t *p_realloc = realloc( p_storage->p_cmd_buf, i_realloc );
-    if( p_realloc )
+    return (uint64_t)i_slot * p_storage->i_chunk_size + i_pos % p_storage->i_chunk_size;
+}
+
+static bool TsIsClockCmd( const ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->header.i_type )
     {
-        p_storage->p_cmd_r = p_realloc + (p_storage->p_cmd_r - p_storage->p_cmd_buf);
-        p_storage->p_cmd_w = p_realloc + i_realloc;
-        p_storage->i_cmd_buf = i_realloc;
-        p_storage->p_cmd_buf = p_realloc;
+    case C_CONTROL:
+        return p_cmd->control.i_query == ES_OUT_SET_PCR ||
+               p_cmd->control.i_query == ES_OUT_SET_GROUP_PCR;
+    case C_PRIVCONTROL:
+        return p_cmd->privcontrol.i_query == ES_OUT_PRIV_SET_TIMES;
+    default:
+        return false;
     }
 }
 
-static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
+/* Move the reading position to the first record of i_date, in constant time
+ * using the index. It can only go forward */
+static void TsStorageSeek( ts_storage_t *p_storage, vlc_tick_t i_date )
 {
-    if( p_cmd && p_cmd->header.i_type == C_SEND && p_storage->p_cmd_w )
+    uint64_t i_pos = p_storage->i_write;
+
+    if( p_storage->i_index_first < p_storage->index.size )
     {
-        size_t i_size = sizeof(*p_cmd->send.p_block) + p_cmd->send.p_block->i_buffer;
+        size_t i_step = 0;
+        if( i_date > p_storage->i_index_date )
+            i_step = (i_date - p_storage->i_index_date) / TS_STORAGE_INDEX_STEP;
+        if( i_step < p_storage->index.size - p_storage->i_index_first )
+            i_pos = p_storage->index.data[p_storage->i_index_first + i_step];
+    }
+    if( i_pos <= p_storage->i_read )
+        return;
+
+    /* The outdated clock updates are skipped with the records, the other
+     * commands of the skipped part are still executed to keep the ES
+     * states */
+    p_storage->i_read = i_pos;
+    p_storage->b_skipped = true;
+    p_storage->i_seek++;
+}
+
+static void TsStorageUnmapFirstChunk( ts_storage_t *p_storage )
+{
+    /* The slot is kept for the next chunk to map (or leaked on allocation
+     * failure) */
+    const size_t i_slot = p_storage->chunks.data[0];
+    vlc_vector_remove( &p_storage->chunks, 0 );
+    p_storage->i_first_chunk++;
+    vlc_vector_push( &p_storage->free_slots, i_slot );
+
+    /* Drop the index steps starting before the chunk end */
+    const uint64_t i_start = p_storage->i_first_chunk * p_storage->i_chunk_size;
+    while( p_storage->i_index_first < p_storage->index.size &&
+           p_storage->index.data[p_storage->i_index_first] < i_start )
+    {
+        p_storage->i_index_first++;
+        p_storage->i_index_date += TS_STORAGE_INDEX_STEP;
+    }
+
+    /* Release the dropped steps from time to time */
+    if( p_storage->i_index_first > 0 &&
+        p_storage->i_index_first * 2 >= p_storage->index.size )
+    {
+        vlc_vector_remove_slice( &p_storage->index, 0, p_storage->i_index_first );
+        p_storage->i_index_first = 0;
+    }
+
+    if( p_storage->i_read < i_start )
+        TsStorageSeek( p_storage, p_storage->i_index_date );
+}
 
-        if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
+/* Map the chunks needed to store i_size bytes at the writing position */
+static bool TsStorageReserve( ts_storage_t *p_storage, size_t i_size )
+{
+    const uint64_t i_end = p_storage->i_write + i_size;
+
+    for( ;; )
+    {
+        const uint64_t i_chunk = p_storage->i_first_chunk + p_storage->chunks.size;
+        if( i_chunk * p_storage->i_chunk_size >= i_end )
             return true;
+
+        /* Reclaim the chunks that have been read and written */
+        vlc_mutex_lock( &p_storage->lock );
+        const uint64_t i_done = __MIN( p_storage->i_read, p_storage->i_flushed );
+        vlc_mutex_unlock( &p_storage->lock );
+        while( p_storage->chunks.size > 0 &&
+               (p_storage->i_first_chunk + 1) * p_storage->i_chunk_size <= i_done )
+            TsStorageUnmapFirstChunk( p_storage );
+
+        size_t i_slot;
+        if( p_storage->free_slots.size > 0 )
+        {
+            i_slot = p_storage->free_slots.data[p_storage->free_slots.size - 1];
+            vlc_vector_remove( &p_storage->free_slots, p_storage->free_slots.size - 1 );
+        }
+        else if( p_storage->i_slots_max == 0 ||
+                 p_storage->i_slots < p_storage->i_slots_max )
+        {
+            i_slot = p_storage->i_slots++;
+        }
+        else
+        {
+            /* The file is full: drop the oldest chunk, unless the record
+             * would overwrite its own beginning */
+            const uint64_t i_first_end = (p_storage->i_first_chunk + 1) * p_storage->i_chunk_size;
+            if( p_storage->chunks.size == 0 || i_first_end > p_storage->i_write )
+                return false;
+
+            vlc_mutex_lock( &p_storage->lock );
+            while( p_storage->i_flushed < i_first_end )
+                vlc_cond_wait( &p_storage->wait, &p_storage->lock );
+            vlc_mutex_unlock( &p_storage->lock );
+
+            TsStorageUnmapFirstChunk( p_storage );
+            continue;
+        }
+
+        if( !vlc_vector_push( &p_storage->chunks, i_slot ) )
+        {
+            vlc_vector_push( &p_storage->free_slots, i_slot );
+            return false;
+        }
     }
-    return (size_t)(p_storage->p_cmd_w - p_storage->p_cmd_buf) > p_storage->i_cmd_buf - MAX_COMMAND_SIZE;
 }
 
-static bool TsStorageIsEmpty( ts_storage_t *p_storage )
+static void TsStorageWrite( ts_storage_t *p_storage, const void *p_data, size_t i_size )
 {
-    return !p_storage || p_storage->p_cmd_r >= p_storage->p_cmd_w;
+    const uint8_t *p = p_data;
+
+    while( i_size > 0 )
+    {
+        const uint64_t i_pos = p_storage->i_write;
+        uint8_t **pp_buffer = &p_storage->pp_buffer[(i_pos / TS_STORAGE_BUFFER_SIZE) % TS_STORAGE_BUFFER_COUNT];
+        const size_t i_in = i_pos % TS_STORAGE_BUFFER_SIZE;
+
+        if( i_in == 0 )
+        {
+            /* Wait for the buffer to be written */
+            vlc_mutex_lock( &p_storage->lock );
+            while( i_pos - p_storage->i_flushed >= TS_STORAGE_BUFFER_COUNT * TS_STORAGE_BUFFER_SIZE )
+                vlc_cond_wait( &p_storage->wait, &p_storage->lock );
+            vlc_mutex_unlock( &p_storage->lock );
+
+            p_storage->pi_offset[pp_buffer - p_storage->pp_buffer] =
+                TsStorageGetOffset( p_storage, i_pos );
+        }
+
+        const size_t i_copy = __MIN( i_size, TS_STORAGE_BUFFER_SIZE - i_in );
+        memcpy( &(*pp_buffer)[i_in], p, i_copy );
+        p += i_copy;
+        i_size -= i_copy;
+        p_storage->i_write += i_copy;
+
+        if( i_in + i_copy == TS_STORAGE_BUFFER_SIZE )
+        {
+            vlc_mutex_lock( &p_storage->lock );
+            p_storage->i_queued = p_storage->i_write;
+            vlc_cond_broadcast( &p_storage->wait );
+            vlc_mutex_unlock( &p_storage->lock );
+        }
+    }
 }
 
-static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bool b_flush )
+static bool TsStorageLoad( ts_storage_t *p_storage, uint64_t i_offset )
 {
-    assert( !TsStorageIsFull( p_storage, p_cmd ) );
-    ts_cmd_t cmd;
-    memcpy(&cmd, p_cmd, TsStorageSizeofCommand[p_cmd->header.i_type]);
+    size_t i_done = 0;
 
-    if( cmd.header.i_type == C_SEND )
+    while( i_done < TS_STORAGE_BUFFER_SIZE )
     {
-        block_t *p_block = cmd.send.p_block;
+        ssize_t i_ret = TsStorageReadAt( p_storage->fd, &p_storage->p_cache[i_done],
+                                         TS_STORAGE_BUFFER_SIZE - i_done,
+                                         i_offset + i_done );
+        if( i_ret < 0 && errno == EINTR )
+            continue;
+        if( i_ret <= 0 )
+            break;
+        i_done += i_ret;
+    }
+    return i_done == TS_STORAGE_BUFFER_SIZE;
+}
+
+/* Read at the reading position. p_lock, that protects the storage against the
+ * writer, is released while reading the file: the reading position may have
+ * been moved on return (if the chunk was dropped meanwhile) */
+static bool TsStorageRead( ts_storage_t *p_storage, void *p_data, size_t i_size,
+                           vlc_mutex_t *p_lock )
+{
+    uint8_t *p = p_data;
+
+    while( i_size > 0 )
+    {
+        const uint64_t i_pos = p_storage->i_read;
+        const uint64_t i_buffer = i_pos / TS_STORAGE_BUFFER_SIZE;
+        const size_t i_in = i_pos % TS_STORAGE_BUFFER_SIZE;
+        const size_t i_copy = __MIN( i_size, TS_STORAGE_BUFFER_SIZE - i_in );
+        const uint8_t *p_buffer;
 
-        cmd.send.p_block = NULL;
-        cmd.send.i_offset = ftell( p_storage->p_filew );
+        vlc_mutex_lock( &p_storage->lock );
+        const uint64_t i_flushed = p_storage->i_flushed;
+        const uint64_t i_failed = p_storage->i_failed;
+        vlc_mutex_unlock( &p_storage->lock );
 
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
+        assert( i_pos + i_copy <= p_storage->i_write );
+        if( i_pos >= i_flushed )
         {
-            block_Release( p_block );
-            return;
+            /* Not written yet */
+            p_buffer = p_storage->pp_buffer[i_buffer % TS_STORAGE_BUFFER_COUNT];
+        }
+        else if( i_pos - i_in >= i_failed )
+        {
+            /* Lost on a write error */
+            p_storage->i_read += i_size;
+            return false;
         }
-        p_storage->i_file_size += sizeof(*p_block);
-        if( p_block->i_buffer > 0 )
+        else
         {
-            if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
+            if( p_storage->i_cache != i_buffer )
             {
-                block_Release( p_block );
-                return;
+                const uint64_t i_offset = TsStorageGetOffset( p_storage, i_pos - i_in );
+                const unsigned i_seek = p_storage->i_seek;
+
+                p_storage->i_cache = UINT64_MAX;
+                vlc_mutex_unlock( p_lock );
+                const bool b_loaded = TsStorageLoad( p_storage, i_offset );
+                vlc_mutex_lock( p_lock );
+
+                /* The slot may have been reused for another chunk */
+                if( p_storage->i_seek != i_seek )
+                    return false;
+                if( !b_loaded )
+                {
+                    p_storage->i_read += i_size;
+                    return false;
+                }
+                p_storage->i_cache = i_buffer;
             }
+            p_buffer = p_storage->p_cache;
         }
-        p_storage->i_file_size += p_block->i_buffer;
-        block_Release( p_block );
 
-        if( b_flush )
-            fflush( p_storage->p_filew );
+        memcpy( p, &p_buffer[i_in], i_copy );
+        p += i_copy;
+        i_size -= i_copy;
+        p_storage->i_read += i_copy;
     }
-    size_t i_cmdsize = TsStorageSizeofCommand[ cmd.header.i_type ];
-    memcpy( p_storage->p_cmd_w, &cmd, i_cmdsize );
-    p_storage->p_cmd_w += i_cmdsize;
+    return true;
 }
 
-static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush )
+/* Keep a reference on a source stored in the file, as the records do not
+ * hold any */
+static bool TsStorageHoldSource( ts_storage_t *p_storage, input_source_t *in,
+                                 bool *pb_held )
 {
-    assert( !TsStorageIsEmpty( p_storage ) );
+    *pb_held = false;
+    for( size_t i = 0; i < p_storage->sources.size; i++ )
+    {
+        if( p_storage->sources.data[i] == in )
+        {
+            *pb_held = true;
+            return true;
+        }
+    }
+    return vlc_vector_push( &p_storage->sources, in );
+}
 
-    p_cmd->header.i_type = p_storage->p_cmd_r[0];
-    size_t i_cmdsize = TsStorageSizeofCommand[ p_cmd->header.i_type ];
-    memcpy(p_cmd, p_storage->p_cmd_r, i_cmdsize);
-    p_storage->p_cmd_r += i_cmdsize;
+static int TsStoragePushCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd )
+{
+    /* The ES and group changes are kept in memory, as they must be executed
+     * even if their part is skipped */
+    if( p_cmd->header.i_type != C_SEND && !TsIsClockCmd( p_cmd ) )
+    {
+        ts_storage_cmd_t cmd = { .i_pos = p_storage->i_write, .cmd = *p_cmd };
 
-    if( p_cmd->header.i_type == C_SEND )
+        if( !vlc_vector_push( &p_storage->cmds, cmd ) )
+            return VLC_ENOMEM;
+        return VLC_SUCCESS;
+    }
+
+    /* Nothing can be stored anymore after a write error */
+    vlc_mutex_lock( &p_storage->lock );
+    const int i_error = p_storage->i_error;
+    vlc_mutex_unlock( &p_storage->lock );
+    if( i_error != 0 )
+        return -i_error;
+
+    ts_storage_record_t record = {
+        .i_type = p_cmd->header.i_type,
+        .i_date = p_cmd->header.i_date,
+    };
+    block_t *p_block = NULL;
+    input_source_t *in = NULL;
+    const void *p_data;
+
+    if( record.i_type == C_SEND )
     {
-        block_t block;
+        p_block = p_cmd->send.p_block;
+        if( p_block->i_buffer > UINT32_MAX )
+            return VLC_EGENERIC;
+
+        record.p_es = p_cmd->send.p_es;
+        record.i_dts = p_block->i_dts;
+        record.i_pts = p_block->i_pts;
+        record.i_length = p_block->i_length;
+        record.i_flags = p_block->i_flags;
+        record.i_nb_samples = p_block->i_nb_samples;
+        record.i_buffer = p_block->i_buffer;
+        p_data = p_block->p_buffer;
+    }
+    else
+    {
+        in = record.i_type == C_CONTROL ? p_cmd->control.in
+                                        : p_cmd->privcontrol.in;
+        record.i_buffer = sizeof(*p_cmd);
+        p_data = p_cmd;
+    }
+
+    if( !TsStorageReserve( p_storage, sizeof(record) + record.i_buffer ) )
+        return VLC_EGENERIC;
+
+    bool b_held = false;
+    if( in && !TsStorageHoldSource( p_storage, in, &b_held ) )
+        return VLC_ENOMEM;
+
+    /* */
+    if( p_storage->i_index_date == VLC_TICK_INVALID )
+        p_storage->i_index_date = record.i_date;
+    if( record.i_date >= p_storage->i_index_date )
+    {
+        const size_t i_step = p_storage->i_index_first +
+            (record.i_date - p_storage->i_index_date) / TS_STORAGE_INDEX_STEP;
+        while( p_storage->index.size <= i_step &&
+               vlc_vector_push( &p_storage->index, p_storage->i_write ) )
+            ;
+    }
+
+    TsStorageWrite( p_storage, &record, sizeof(record) );
+    TsStorageWrite( p_storage, p_data, record.i_buffer );
+    if( p_block )
+    {
+        block_Release( p_block );
+        p_cmd->send.p_block = NULL;
+    }
+    if( b_held )
+        input_source_Release( in );
+    return VLC_SUCCESS;
+}
+
+static int TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool *pb_skipped,
+                            vlc_mutex_t *p_lock )
+{
+    vlc_mutex_assert( p_lock );
+    *pb_skipped = false;
 
-        if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+    for( ;; )
+    {
+        if( p_storage->i_cmd_first < p_storage->cmds.size &&
+            p_storage->cmds.data[p_storage->i_cmd_first].i_pos <= p_storage->i_read )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
-            if( p_block )
+            *p_cmd = p_storage->cmds.data[p_storage->i_cmd_first++].cmd;
+
+            /* Release the popped commands from time to time */
+            if( p_storage->i_cmd_first * 2 >= p_storage->cmds.size )
             {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
+                vlc_vector_remove_slice( &p_storage->cmds, 0, p_storage->i_cmd_first );
+                p_storage->i_cmd_first = 0;
             }
-            p_cmd->send.p_block = p_block;
+            break;
         }
-        else
+
+        if( p_storage->i_read >= p_storage->i_write )
+            return VLC_EGENERIC;
+
+        const unsigned i_seek = p_storage->i_seek;
+        ts_storage_record_t record;
+        if( !TsStorageRead( p_storage, &record, sizeof(record), p_lock ) )
         {
-            //perror( "TsStoragePopCmd" );
-            p_cmd->send.p_block = block_Alloc( 1 );
+            if( p_storage->i_seek != i_seek )
+                continue;
+            /* The record cannot be trusted anymore: skip what is left */
+            p_storage->i_read = p_storage->i_write;
+            return VLC_EGENERIC;
         }
+
+        if( record.i_type != C_SEND )
+        {
+            assert( record.i_buffer == sizeof(*p_cmd) );
+            if( !TsStorageRead( p_storage, p_cmd, sizeof(*p_cmd), p_lock ) )
+                continue; /* Skip the lost or outdated clock update */
+
+            if( p_cmd->header.i_type == C_CONTROL && p_cmd->control.in )
+                p_cmd->control.in = input_source_Hold( p_cmd->control.in );
+            else if( p_cmd->header.i_type == C_PRIVCONTROL && p_cmd->privcontrol.in )
+                p_cmd->privcontrol.in = input_source_Hold( p_cmd->privcontrol.in );
+            break;
+        }
+
+        block_t *p_block = block_Alloc( record.i_buffer );
+        if( p_block )
+        {
+            p_block->i_dts      = record.i_dts;
+            p_block->i_pts      = record.i_pts;
+            p_block->i_flags    = record.i_flags;
+            p_block->i_length   = record.i_length;
+            p_block->i_nb_samples = record.i_nb_samples;
+            if( !TsStorageRead( p_storage, p_block->p_buffer, record.i_buffer, p_lock ) )
+            {
+                block_Release( p_block );
+                if( p_storage->i_seek != i_seek )
+                    continue;
+                p_block = NULL;
+            }
+        }
+        else
+            p_storage->i_read += record.i_buffer;
+
+        p_cmd->send.header.i_type = C_SEND;
+        p_cmd->send.header.i_date = record.i_date;
+        p_cmd->send.p_es = record.p_es;
+        p_cmd->send.p_block = p_block;
+        break;
     }
+
+    /* The commands kept from the skipped part are late too */
+    *pb_skipped = p_storage->b_skipped;
+    p_storage->b_skipped = false;
+    return VLC_SUCCESS;
 }
 
 /*****************************************************************************
@@ -219,6 +219,12 @@ static const char *const ppsz_mix_mode_texts[] = {
     "4.0", "5.1", "7.1",
 };
 
+#define AUDIO_FILTER_THREAD_TEXT N_("Run the audio filters in their own thread")
+#define AUDIO_FILTER_THREAD_LONGTEXT N_( \
+    "This runs the audio filters, resampling and volume of the played " \
+    "audio in a dedicated thread with a little buffering, so that heavy " \
+    "filters do not delay the decoder." )
+
 #define AUDIO_FILTER_TEXT N_("Audio filters")
 #define AUDIO_FILTER_LONGTEXT N_( \
     "This adds audio post processing filters, to modify " \
@@ -443,6 +449,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads used by the video filters that process pictures " \
+    "in slices (0 = number of CPUs).")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -785,9 +796,19 @@ static const char* const ppsz_restore_playback_desc[] = {
 
 #define INPUT_TIMESHIFT_GRANULARITY_TEXT N_("Timeshift granularity")
 #define INPUT_TIMESHIFT_GRANULARITY_LONGTEXT N_( \
-    "This is the maximum size in bytes of the temporary files " \
+    "This is the size in bytes of the chunks of the temporary file " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_SIZE_TEXT N_("Timeshift size")
+#define INPUT_TIMESHIFT_SIZE_LONGTEXT N_( \
+    "This is the maximum size in MiB of the temporary file used to store " \
+    "the timeshifted streams (0 for unlimited). The oldest part of the " \
+    "timeshift is dropped when it is reached." )
+
+#define INPUT_TIMESHIFT_DIRECT_TEXT N_("Timeshift direct I/O")
+#define INPUT_TIMESHIFT_DIRECT_LONGTEXT N_( \
+    "Bypass the system cache when accessing the timeshift temporary file." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -1158,6 +1179,15 @@ static const char* const ppsz_restore_playback_desc[] = {
     "all the processor time and render the whole system unresponsive which " \
     "might require a reboot of your machine.")
 
+#define FRAME_CACHE_TEXT N_("Frame cache size (kB)")
+#define FRAME_CACHE_LONGTEXT N_( \
+    "Small data buffers are recycled through a cache in each thread " \
+    "instead of being given back to the system. This sets the maximum " \
+    "size of each of those caches (0 disables them). The caches are " \
+    "shared by the whole process: the largest size set by the running " \
+    "instances applies. Cached buffers are rounded up to a power of two " \
+    "size.")
+
 #define CLOCK_SOURCE_TEXT N_("Clock source")
 #ifdef _WIN32
 static const char *const clock_sources[] = {
@@ -1645,6 +1675,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_AUDIO_AFILTER )
         add_bool( "audio-bitexact", false, AUDIO_BITEXACT_TEXT,
                    AUDIO_BITEXACT_LONGTEXT )
+    add_bool( "audio-filter-thread", false, AUDIO_FILTER_THREAD_TEXT,
+              AUDIO_FILTER_THREAD_LONGTEXT )
     add_module_list("audio-filter", "audio filter", NULL,
                     AUDIO_FILTER_TEXT, AUDIO_FILTER_LONGTEXT)
     set_subcategory( SUBCAT_AUDIO_VISUAL )
@@ -1777,6 +1809,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "filter-threads", 0, FILTER_THREADS_TEXT,
+                 FILTER_THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -2019,6 +2054,10 @@ vlc_module_begin ()
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT )
+    add_integer( "input-timeshift-size", 0, INPUT_TIMESHIFT_SIZE_TEXT,
+                 INPUT_TIMESHIFT_SIZE_LONGTEXT )
+    add_bool( "input-timeshift-direct", false, INPUT_TIMESHIFT_DIRECT_TEXT,
+              INPUT_TIMESHIFT_DIRECT_LONGTEXT )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT )
 
@@ -2117,6 +2156,10 @@ vlc_module_begin ()
     add_obsolete_bool( "inhibit" ) /* since 3.0.0 */
 #endif
 
+    add_integer( "frame-cache", 0, FRAME_CACHE_TEXT,
+                 FRAME_CACHE_LONGTEXT )
+        change_integer_range( 0, 1 << 20 )
+
 #if defined(_WIN32) || defined(__OS2__)
     add_bool( "high-priority", false, HPRIORITY_TEXT,
               HPRIORITY_LONGTEXT )
@@ -63,6 +63,7 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_tracer.h>
+#include <vlc_executor.h>
 #include "player/player.h"
 
 #include "libvlc.h"
@@ -96,6 +97,8 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->filter_executor = NULL;
+    priv->frame_cache.bytes = 0;
 
     vlc_ExitInit( &priv->exit );
 
@@ -214,6 +217,11 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
+    priv->frame_cache.bytes = var_InheritInteger( p_libvlc, "frame-cache" )
+                            * 1024;
+    if( priv->frame_cache.bytes != 0 )
+        vlc_frame_cache_AddLimit( &priv->frame_cache );
+
     if( var_InheritBool( p_libvlc, "media-library") )
     {
         priv->p_media_library = libvlc_MlCreate( p_libvlc );
@@ -372,6 +380,12 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( priv->media_source_provider )
         vlc_media_source_provider_Delete( priv->media_source_provider );
 
+    if( priv->filter_executor )
+        vlc_executor_Delete( priv->filter_executor );
+
+    if( priv->frame_cache.bytes != 0 )
+        vlc_frame_cache_RemoveLimit( &priv->frame_cache );
+
     libvlc_InternalDialogClean( p_libvlc );
     libvlc_InternalKeystoreClean( p_libvlc );
     libvlc_InternalActionsClean( p_libvlc );
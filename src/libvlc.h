@@ -53,6 +53,26 @@ void vlc_threads_setup (libvlc_int_t *);
 void vlc_trace (const char *fn, const char *file, unsigned line);
 #define vlc_backtrace() vlc_trace(__func__, __FILE__, __LINE__)
 
+/*
+ * Frames
+ */
+
+/**
+ * Frame cache size asked by a libvlc instance.
+ *
+ * The frame caches belong to the threads, and are shared by all the
+ * instances of the process: the largest size of the registered limits
+ * bounds each thread cache. Without any limit, the caches are disabled.
+ */
+struct vlc_frame_cache_limit
+{
+    size_t bytes;
+    struct vlc_list node;
+};
+
+void vlc_frame_cache_AddLimit(struct vlc_frame_cache_limit *);
+void vlc_frame_cache_RemoveLimit(struct vlc_frame_cache_limit *);
+
 /*
  * Logging
  */
@@ -177,7 +197,7 @@ typedef struct libvlc_priv_t
     libvlc_int_t       public_data;
 
     /* Singleton objects */
-    vlc_mutex_t lock; ///< protect playlist and interfaces
+    vlc_mutex_t lock; ///< protect playlist, interfaces and filter threads
     vlm_t             *p_vlm;  ///< the VLM singleton (or NULL)
     vlc_dialog_provider *p_dialog_provider; ///< dialog provider
     vlc_keystore      *p_memory_keystore; ///< memory keystore
@@ -187,6 +207,8 @@ typedef struct libvlc_priv_t
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    struct vlc_executor *filter_executor; ///< Filter slice threads (or NULL)
+    struct vlc_frame_cache_limit frame_cache; ///< Frame cache size (or 0)
 
     /* Exit callback */
     vlc_exit_t       exit;
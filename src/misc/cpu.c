@@ -64,15 +64,21 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
 # define cpuid(reg)  \
     do { \
         int cpuInfo[4]; \
-        __cpuid(cpuInfo, reg); \
+        __cpuidex(cpuInfo, reg, 0); \
         i_eax = cpuInfo[0]; i_ebx = cpuInfo[1]; i_ecx = cpuInfo[2]; i_edx = cpuInfo[3]; \
     } while(0)
+# define xgetbv(xcr0) \
+    xcr0 = (uint32_t)_xgetbv(0)
 #else // !_MSC_VER
 # define cpuid(reg) \
     asm ("cpuid" \
          : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-         : "a" (reg) \
+         : "a" (reg), "c" (0) \
          : "cc");
+# define xgetbv(xcr0) \
+    asm (".byte 0x0f, 0x01, 0xd0" /* xgetbv */ \
+         : "=a" (xcr0), "=d" (i_edx) \
+         : "c" (0));
 #endif // !_MSC_VER
 
      /* Check if the OS really supports the requested instructions */
@@ -105,6 +111,9 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
         goto out;
 #endif
 
+    cpuid( 0x00000000 );
+    const unsigned i_max_leaf = i_eax;
+
     cpuid( 0x00000001 );
 
     if (i_edx & 0x04000000)
@@ -116,6 +125,25 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
     if (i_ecx & 0x00080000)
         i_capabilities |= VLC_CPU_SSE4_1;
 
+    /* AVX needs the OS to save the YMM registers: OSXSAVE */
+    if ((i_ecx & 0x18000000) == 0x18000000)
+    {
+        uint32_t xcr0;
+        xgetbv(xcr0);
+
+        if ((xcr0 & 0x06) == 0x06)
+        {
+            i_capabilities |= VLC_CPU_AVX;
+
+            if (i_max_leaf >= 7)
+            {
+                cpuid( 0x00000007 );
+                if (i_ebx & 0x00000020)
+                    i_capabilities |= VLC_CPU_AVX2;
+            }
+        }
+    }
+
     /* test for additional capabilities */
     cpuid( 0x80000000 );
 
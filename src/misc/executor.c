@@ -46,6 +46,21 @@ struct vlc_executor_thread {
 
     /** The current task executed by the thread, NULL if none */
     struct vlc_runnable *current_task;
+
+    /* The following fields are only used by a work-stealing executor */
+
+    /** Index in vlc_executor.workers */
+    unsigned index;
+
+    /** Lock protecting the local queue */
+    vlc_mutex_t lock;
+
+    /** Local queue of vlc_runnable: the thread takes runnables from the
+     * front, idle threads steal them from the back */
+    struct vlc_list queue;
+
+    /** Number of runnables in the local queue, readable without lock */
+    atomic_uint queued;
 };
 
 /**
@@ -78,14 +93,40 @@ struct vlc_executor {
 
     /** True if executor deletion is requested */
     bool closing;
+
+    /* The following fields are only used by a work-stealing executor, which
+     * uses one queue per thread instead of the single queue. The lock only
+     * protects "closing" and the wait conditions. */
+
+    /** Array of max_threads threads, NULL if not work-stealing */
+    struct vlc_executor_thread *workers;
+
+    /** Number of runnables in all the local queues */
+    atomic_uint queued;
+
+    /** Number of tasks requested but not finished */
+    atomic_uint pending;
+
+    /** Number of threads waiting on queue_wait */
+    atomic_uint sleepers;
+
+    /** Round-robin counter to distribute submissions */
+    atomic_uint next_worker;
 };
 
+/** The work-stealing executor thread running on the current thread */
+static thread_local struct vlc_executor_thread *current_worker;
+
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable,
+          enum vlc_executor_priority priority)
 {
     vlc_mutex_assert(&executor->lock);
 
-    vlc_list_append(&runnable->node, &executor->queue);
+    if (priority == VLC_EXECUTOR_PRIORITY_HIGH)
+        vlc_list_prepend(&runnable->node, &executor->queue);
+    else
+        vlc_list_append(&runnable->node, &executor->queue);
     vlc_cond_signal(&executor->queue_wait);
 }
 
@@ -149,6 +190,144 @@ ThreadRun(void *userdata)
     return NULL;
 }
 
+static void
+WorkerPush(struct vlc_executor_thread *worker, struct vlc_runnable *runnable,
+           enum vlc_executor_priority priority)
+{
+    vlc_executor_t *executor = worker->owner;
+
+    runnable->worker = worker;
+
+    vlc_mutex_lock(&worker->lock);
+    if (priority == VLC_EXECUTOR_PRIORITY_HIGH)
+        vlc_list_prepend(&runnable->node, &worker->queue);
+    else
+        vlc_list_append(&runnable->node, &worker->queue);
+    atomic_fetch_add_explicit(&worker->queued, 1, memory_order_relaxed);
+    vlc_mutex_unlock(&worker->lock);
+
+    atomic_fetch_add(&executor->queued, 1);
+
+    /* Only take the lock if a thread may be waiting for work */
+    if (atomic_load(&executor->sleepers))
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+static struct vlc_runnable *
+WorkerPop(struct vlc_executor_thread *worker, bool steal)
+{
+    if (!atomic_load_explicit(&worker->queued, memory_order_relaxed))
+        return NULL;
+
+    vlc_mutex_lock(&worker->lock);
+
+    struct vlc_runnable *runnable = steal
+        ? vlc_list_last_entry_or_null(&worker->queue, struct vlc_runnable, node)
+        : vlc_list_first_entry_or_null(&worker->queue, struct vlc_runnable,
+                                       node);
+    if (runnable)
+    {
+        vlc_list_remove(&runnable->node);
+
+        /* Set links to NULL to know that it has been taken by a thread in
+         * vlc_executor_Cancel() */
+        runnable->node.prev = runnable->node.next = NULL;
+
+        atomic_fetch_sub_explicit(&worker->queued, 1, memory_order_relaxed);
+        atomic_fetch_sub(&worker->owner->queued, 1);
+    }
+
+    vlc_mutex_unlock(&worker->lock);
+
+    return runnable;
+}
+
+static struct vlc_runnable *
+WorkerTake(struct vlc_executor_thread *worker)
+{
+    vlc_executor_t *executor = worker->owner;
+
+    struct vlc_runnable *runnable = WorkerPop(worker, false);
+    if (runnable)
+        return runnable;
+
+    /* Nothing left locally, steal from the other threads */
+    for (unsigned i = 1; i < executor->max_threads; ++i)
+    {
+        unsigned index = (worker->index + i) % executor->max_threads;
+        runnable = WorkerPop(&executor->workers[index], true);
+        if (runnable)
+            return runnable;
+    }
+
+    return NULL;
+}
+
+static bool
+WorkerWait(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+
+    /* Paired with the sleepers check in WorkerPush() */
+    atomic_fetch_add(&executor->sleepers, 1);
+    while (!executor->closing && !atomic_load(&executor->queued))
+        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+    atomic_fetch_sub(&executor->sleepers, 1);
+
+    bool closing = executor->closing;
+    vlc_mutex_unlock(&executor->lock);
+
+    return !closing;
+}
+
+static void
+WorkerTaskDone(vlc_executor_t *executor)
+{
+    if (atomic_fetch_sub_explicit(&executor->pending, 1,
+                                  memory_order_acq_rel) == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+static void *
+WorkerRun(void *userdata)
+{
+    struct vlc_executor_thread *thread = userdata;
+    vlc_executor_t *executor = thread->owner;
+
+    vlc_thread_set_name("vlc-exec-worker");
+
+    current_worker = thread;
+
+    /* When the executor is closing, WorkerWait() returns false */
+    do
+    {
+        struct vlc_runnable *runnable;
+        while ((runnable = WorkerTake(thread)))
+        {
+            thread->current_task = runnable;
+
+            /* The runnable may be freed by run() */
+            runnable->run(runnable->userdata);
+
+            thread->current_task = NULL;
+
+            vlc_thread_set_name("vlc-exec-worker");
+
+            WorkerTaskDone(executor);
+        }
+    } while (WorkerWait(executor));
+
+    return NULL;
+}
+
 static int
 SpawnThread(vlc_executor_t *executor)
 {
@@ -194,6 +373,7 @@ vlc_executor_New(unsigned max_threads)
     vlc_cond_init(&executor->queue_wait);
 
     executor->closing = false;
+    executor->workers = NULL;
 
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
     int ret = SpawnThread(executor);
@@ -206,14 +386,121 @@ vlc_executor_New(unsigned max_threads)
     return executor;
 }
 
+vlc_executor_t *
+vlc_executor_NewWorkStealing(unsigned threads)
+{
+    assert(threads);
+    vlc_executor_t *executor = malloc(sizeof(*executor));
+    if (!executor)
+        return NULL;
+
+    executor->workers = vlc_alloc(threads, sizeof(*executor->workers));
+    if (!executor->workers)
+    {
+        free(executor);
+        return NULL;
+    }
+
+    vlc_mutex_init(&executor->lock);
+
+    executor->max_threads = threads;
+    executor->nthreads = 0;
+    executor->unfinished = 0;
+
+    vlc_list_init(&executor->threads);
+    vlc_list_init(&executor->queue);
+
+    vlc_cond_init(&executor->idle_wait);
+    vlc_cond_init(&executor->queue_wait);
+
+    executor->closing = false;
+
+    atomic_init(&executor->queued, 0);
+    atomic_init(&executor->pending, 0);
+    atomic_init(&executor->sleepers, 0);
+    atomic_init(&executor->next_worker, 0);
+
+    /* Initialize all the queues before any thread may steal from them */
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        struct vlc_executor_thread *thread = &executor->workers[i];
+
+        thread->owner = executor;
+        thread->current_task = NULL;
+        thread->index = i;
+        vlc_mutex_init(&thread->lock);
+        vlc_list_init(&thread->queue);
+        atomic_init(&thread->queued, 0);
+    }
+
+    for (unsigned i = 0; i < threads; ++i)
+    {
+        struct vlc_executor_thread *thread = &executor->workers[i];
+
+        if (vlc_clone(&thread->thread, WorkerRun, thread))
+        {
+            /* Stop the threads already started */
+            vlc_mutex_lock(&executor->lock);
+            executor->closing = true;
+            vlc_cond_broadcast(&executor->queue_wait);
+            vlc_mutex_unlock(&executor->lock);
+
+            for (unsigned j = 0; j < i; ++j)
+                vlc_join(executor->workers[j].thread, NULL);
+
+            free(executor->workers);
+            free(executor);
+            return NULL;
+        }
+        executor->nthreads++;
+    }
+
+    return executor;
+}
+
+static void
+WorkerSubmit(vlc_executor_t *executor, struct vlc_runnable *runnable,
+             enum vlc_executor_priority priority, int affinity)
+{
+    struct vlc_executor_thread *worker;
+    if (affinity >= 0)
+        worker = &executor->workers[(unsigned) affinity % executor->max_threads];
+    else if (current_worker != NULL && current_worker->owner == executor)
+        /* Keep the tasks spawned by a task on the same thread */
+        worker = current_worker;
+    else
+    {
+        unsigned index = atomic_fetch_add_explicit(&executor->next_worker, 1,
+                                                   memory_order_relaxed);
+        worker = &executor->workers[index % executor->max_threads];
+    }
+
+    atomic_fetch_add_explicit(&executor->pending, 1, memory_order_relaxed);
+    WorkerPush(worker, runnable, priority);
+}
+
 void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
+    vlc_executor_SubmitExt(executor, runnable, VLC_EXECUTOR_PRIORITY_NORMAL,
+                           -1);
+}
+
+void
+vlc_executor_SubmitExt(vlc_executor_t *executor, struct vlc_runnable *runnable,
+                       enum vlc_executor_priority priority, int affinity)
+{
+    if (executor->workers)
+    {
+        WorkerSubmit(executor, runnable, priority, affinity);
+        return;
+    }
+
     vlc_mutex_lock(&executor->lock);
 
     assert(!executor->closing);
 
-    QueuePush(executor, runnable);
+    QueuePush(executor, runnable, priority);
 
     if (++executor->unfinished > executor->nthreads
             && executor->nthreads < executor->max_threads)
@@ -223,9 +510,41 @@ vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
     vlc_mutex_unlock(&executor->lock);
 }
 
+static bool
+WorkerCancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    /* A runnable is never moved to another queue once submitted */
+    struct vlc_executor_thread *worker = runnable->worker;
+    assert(worker->owner == executor);
+
+    vlc_mutex_lock(&worker->lock);
+
+    /* Either both prev and next are set, either both are NULL */
+    assert(!runnable->node.prev == !runnable->node.next);
+
+    bool in_queue = runnable->node.prev;
+    if (in_queue)
+    {
+        vlc_list_remove(&runnable->node);
+        runnable->node.prev = runnable->node.next = NULL;
+        atomic_fetch_sub_explicit(&worker->queued, 1, memory_order_relaxed);
+        atomic_fetch_sub(&executor->queued, 1);
+    }
+
+    vlc_mutex_unlock(&worker->lock);
+
+    if (in_queue)
+        WorkerTaskDone(executor);
+
+    return in_queue;
+}
+
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
+    if (executor->workers)
+        return WorkerCancel(executor, runnable);
+
     vlc_mutex_lock(&executor->lock);
 
     /* Either both prev and next are set, either both are NULL */
@@ -251,14 +570,52 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
-        vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    if (executor->workers)
+        while (atomic_load(&executor->pending))
+            vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    else
+        while (executor->unfinished)
+            vlc_cond_wait(&executor->idle_wait, &executor->lock);
+    vlc_mutex_unlock(&executor->lock);
+}
+
+static void
+WorkersDelete(vlc_executor_t *executor)
+{
+    vlc_mutex_lock(&executor->lock);
+
+    executor->closing = true;
+
+    /* All the tasks must be canceled on delete */
+    assert(!atomic_load(&executor->queued));
+
+    /* "closing" is now true, this will wake up threads */
+    vlc_cond_broadcast(&executor->queue_wait);
+
     vlc_mutex_unlock(&executor->lock);
+
+    for (unsigned i = 0; i < executor->max_threads; ++i)
+    {
+        vlc_join(executor->workers[i].thread, NULL);
+        assert(vlc_list_is_empty(&executor->workers[i].queue));
+    }
+
+    /* There are no tasks anymore */
+    assert(!atomic_load(&executor->pending));
+
+    free(executor->workers);
+    free(executor);
 }
 
 void
 vlc_executor_Delete(vlc_executor_t *executor)
 {
+    if (executor->workers)
+    {
+        WorkersDelete(executor);
+        return;
+    }
+
     vlc_mutex_lock(&executor->lock);
 
     executor->closing = true;
@@ -26,10 +26,12 @@
 #endif
 
 #include <assert.h>
+#include <stdalign.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include "../libvlc.h"
 
 /**
@@ -141,3 +143,230 @@ block_t *vlc_fifo_Show( block_fifo_t *p_fifo )
 
     return b;
 }
+
+/**
+ * Internal state for single-producer single-consumer frame queues
+ *
+ * Frames are stored in a linked list of fixed-size segments. The producer
+ * fills the tail segment and links a new one once it is full; the consumer
+ * empties the head segment and frees it once it has moved past it.
+ * Both sides only ever share the total frame counters and the links.
+ */
+#define SPSC_SEGMENT_SIZE 256
+/* Polls before parking the consumer, so that a producer running at about the
+ * same pace on another CPU does not need to wake it up for every frame */
+#define SPSC_SPIN_COUNT 1000
+/* Size of the cache lines, that the producer and the consumer must not
+ * share */
+#define SPSC_CACHE_LINE 64
+
+struct vlc_spsc_segment
+{
+    _Atomic(struct vlc_spsc_segment *) next;
+    vlc_frame_t *frames[SPSC_SEGMENT_SIZE];
+};
+
+struct vlc_spsc_fifo_t
+{
+    /* Producer side */
+    alignas (SPSC_CACHE_LINE) struct vlc_spsc_segment *tail_segment;
+    atomic_size_t tail; /**< total number of queued frames */
+    atomic_bool closed;
+
+    /* Consumer side */
+    alignas (SPSC_CACHE_LINE) struct vlc_spsc_segment *head_segment;
+    atomic_size_t head; /**< total number of dequeued frames */
+    atomic_bool parked;
+    atomic_uint wakeup;
+    unsigned spin;
+};
+
+static struct vlc_spsc_segment *vlc_spsc_segment_New(void)
+{
+    struct vlc_spsc_segment *seg = malloc(sizeof (*seg));
+
+    if (likely(seg != NULL))
+        atomic_init(&seg->next, NULL);
+    return seg;
+}
+
+vlc_spsc_fifo_t *vlc_spsc_fifo_New(void)
+{
+    vlc_spsc_fifo_t *fifo = aligned_alloc(alignof (vlc_spsc_fifo_t),
+                                          sizeof (*fifo));
+    if (unlikely(fifo == NULL))
+        return NULL;
+
+    struct vlc_spsc_segment *seg = vlc_spsc_segment_New();
+    if (unlikely(seg == NULL))
+    {
+        aligned_free(fifo);
+        return NULL;
+    }
+
+    fifo->tail_segment = seg;
+    atomic_init(&fifo->tail, 0);
+    atomic_init(&fifo->closed, false);
+    fifo->head_segment = seg;
+    atomic_init(&fifo->head, 0);
+    atomic_init(&fifo->parked, false);
+    atomic_init(&fifo->wakeup, 0);
+    fifo->spin = vlc_GetCPUCount() > 1 ? SPSC_SPIN_COUNT : 0;
+    return fifo;
+}
+
+void vlc_spsc_fifo_Delete(vlc_spsc_fifo_t *fifo)
+{
+    vlc_frame_ChainRelease(vlc_spsc_fifo_PopAll(fifo));
+
+    assert(fifo->head_segment == fifo->tail_segment);
+    free(fifo->head_segment);
+    aligned_free(fifo);
+}
+
+static void vlc_spsc_fifo_Wake(vlc_spsc_fifo_t *fifo)
+{
+    /* Pairs with the fence in vlc_spsc_fifo_Get(): either the consumer sees
+     * the new tail, or we see it parked. */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    /* Only the first producer call after the consumer parked wakes it up */
+    if (atomic_load_explicit(&fifo->parked, memory_order_relaxed)
+     && atomic_exchange_explicit(&fifo->parked, false, memory_order_relaxed))
+    {
+        atomic_fetch_add_explicit(&fifo->wakeup, 1, memory_order_relaxed);
+        vlc_atomic_notify_one(&fifo->wakeup);
+    }
+}
+
+int vlc_spsc_fifo_Put(vlc_spsc_fifo_t *fifo, vlc_frame_t *frame)
+{
+    assert(!atomic_load_explicit(&fifo->closed, memory_order_relaxed));
+
+    if (frame == NULL)
+        return VLC_SUCCESS;
+
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+    int ret = VLC_SUCCESS;
+
+    while (frame != NULL)
+    {
+        size_t index = tail % SPSC_SEGMENT_SIZE;
+
+        if (index == 0 && tail != 0)
+        {
+            /* The tail segment is full, link a new one. */
+            struct vlc_spsc_segment *seg = vlc_spsc_segment_New();
+            if (unlikely(seg == NULL))
+            {
+                vlc_frame_ChainRelease(frame);
+                ret = VLC_ENOMEM;
+                break;
+            }
+
+            atomic_store_explicit(&fifo->tail_segment->next, seg,
+                                  memory_order_release);
+            fifo->tail_segment = seg;
+        }
+
+        vlc_frame_t *next = frame->p_next;
+
+        frame->p_next = NULL;
+        fifo->tail_segment->frames[index] = frame;
+        frame = next;
+        tail++;
+    }
+
+    /* Publish the whole chain at once, and wake the consumer at most once. */
+    atomic_store_explicit(&fifo->tail, tail, memory_order_release);
+    vlc_spsc_fifo_Wake(fifo);
+    return ret;
+}
+
+void vlc_spsc_fifo_Close(vlc_spsc_fifo_t *fifo)
+{
+    atomic_store_explicit(&fifo->closed, true, memory_order_release);
+    vlc_spsc_fifo_Wake(fifo);
+}
+
+static vlc_frame_t *vlc_spsc_fifo_PopUntil(vlc_spsc_fifo_t *fifo,
+                                           size_t head, size_t tail)
+{
+    vlc_frame_t *first = NULL, **pp = &first;
+
+    for (; head != tail; head++)
+    {
+        size_t index = head % SPSC_SEGMENT_SIZE;
+
+        if (index == 0 && head != 0)
+        {
+            /* The producer linked the next segment before publishing any
+             * frame in it, and will not touch this one anymore. */
+            struct vlc_spsc_segment *seg =
+                atomic_load_explicit(&fifo->head_segment->next,
+                                     memory_order_acquire);
+            assert(seg != NULL);
+            free(fifo->head_segment);
+            fifo->head_segment = seg;
+        }
+
+        *pp = fifo->head_segment->frames[index];
+        pp = &(*pp)->p_next;
+    }
+
+    atomic_store_explicit(&fifo->head, head, memory_order_relaxed);
+    return first;
+}
+
+vlc_frame_t *vlc_spsc_fifo_Pop(vlc_spsc_fifo_t *fifo)
+{
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+
+    if (head == tail)
+        return NULL;
+    return vlc_spsc_fifo_PopUntil(fifo, head, head + 1);
+}
+
+vlc_frame_t *vlc_spsc_fifo_PopAll(vlc_spsc_fifo_t *fifo)
+{
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_acquire);
+
+    return vlc_spsc_fifo_PopUntil(fifo, head, tail);
+}
+
+vlc_frame_t *vlc_spsc_fifo_Get(vlc_spsc_fifo_t *fifo)
+{
+    for (;;)
+    {
+        vlc_frame_t *frame = vlc_spsc_fifo_Pop(fifo);
+        if (frame != NULL)
+            return frame;
+
+        if (atomic_load_explicit(&fifo->closed, memory_order_acquire))
+            /* Frames queued before closing are visible now */
+            return vlc_spsc_fifo_Pop(fifo);
+
+        size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+        bool ready = false;
+
+        for (unsigned i = 0; i < fifo->spin && !ready; i++)
+            ready = atomic_load_explicit(&fifo->tail, memory_order_relaxed)
+                        != head
+                 || atomic_load_explicit(&fifo->closed, memory_order_relaxed);
+        if (ready)
+            continue;
+
+        unsigned seq = atomic_load(&fifo->wakeup);
+
+        atomic_store_explicit(&fifo->parked, true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        if (atomic_load_explicit(&fifo->tail, memory_order_relaxed) == head
+         && !atomic_load_explicit(&fifo->closed, memory_order_relaxed))
+            vlc_atomic_wait(&fifo->wakeup, seq);
+
+        atomic_store_explicit(&fifo->parked, false, memory_order_relaxed);
+    }
+}
@@ -30,6 +30,7 @@
 #include <vlc_configuration.h>
 #include "../libvlc.h"
 #include <vlc_filter.h>
+#include <vlc_executor.h>
 #include <vlc_modules.h>
 #include "../misc/variables.h"
 
@@ -110,6 +111,143 @@ void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 
 /* */
 
+#define SLICE_ALIGN     16 /* lines, a multiple of any chroma subsampling */
+#define SLICE_MIN_LINES 32
+#define SLICE_MAX       32
+
+struct filter_slices
+{
+    filter_t *filter;
+    vlc_filter_slice_cb cb;
+    void *opaque;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned pending;
+};
+
+struct filter_slice
+{
+    struct vlc_runnable runnable;
+    struct filter_slices *slices;
+    unsigned first;
+    unsigned end;
+};
+
+static void RunSlice(struct filter_slice *slice)
+{
+    struct filter_slices *slices = slice->slices;
+
+    slices->cb(slices->filter, slices->opaque, slice->first, slice->end);
+}
+
+static void RunSubmittedSlice(void *data)
+{
+    struct filter_slice *slice = data;
+    struct filter_slices *slices = slice->slices;
+
+    RunSlice(slice);
+
+    vlc_mutex_lock(&slices->lock);
+    assert(slices->pending > 0);
+    if (--slices->pending == 0)
+        vlc_cond_signal(&slices->wait);
+    vlc_mutex_unlock(&slices->lock);
+}
+
+/**
+ * Gets the threads shared by all the filters of the instance, created on
+ * first use.
+ */
+static vlc_executor_t *GetSliceExecutor(filter_t *filter, unsigned *threads)
+{
+    libvlc_priv_t *priv = libvlc_priv(vlc_object_instance(filter));
+
+    unsigned count = var_InheritInteger(filter, "filter-threads");
+    if (count == 0)
+        count = vlc_GetCPUCount();
+    if (count <= 1)
+        return NULL;
+
+    vlc_mutex_lock(&priv->lock);
+    if (priv->filter_executor == NULL)
+        /* The thread calling vlc_filter_RunSlices() also runs slices */
+        priv->filter_executor = vlc_executor_NewWorkStealing(count - 1);
+    vlc_executor_t *executor = priv->filter_executor;
+    vlc_mutex_unlock(&priv->lock);
+
+    *threads = count;
+    return executor;
+}
+
+void vlc_filter_RunSlices(filter_t *filter, unsigned lines,
+                          vlc_filter_slice_cb cb, void *opaque)
+{
+    unsigned threads, count = lines / SLICE_MIN_LINES;
+    vlc_executor_t *executor = NULL;
+
+    if (count > 1)
+        executor = GetSliceExecutor(filter, &threads);
+    if (executor == NULL)
+    {
+        cb(filter, opaque, 0, lines);
+        return;
+    }
+
+    /* Two slices per thread, to even out the load between them */
+    if (count > 2 * threads)
+        count = 2 * threads;
+    if (count > SLICE_MAX)
+        count = SLICE_MAX;
+
+    struct filter_slices slices = {
+        .filter = filter,
+        .cb = cb,
+        .opaque = opaque,
+        .pending = count - 1,
+    };
+    struct filter_slice slice[SLICE_MAX];
+
+    vlc_mutex_init(&slices.lock);
+    vlc_cond_init(&slices.wait);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        slice[i].runnable.run = RunSubmittedSlice;
+        slice[i].runnable.userdata = &slice[i];
+        slice[i].slices = &slices;
+        slice[i].first = i ? (uint64_t)lines * i / count / SLICE_ALIGN
+                             * SLICE_ALIGN : 0;
+        if (i > 0)
+            slice[i - 1].end = slice[i].first;
+    }
+    slice[count - 1].end = lines;
+
+    for (unsigned i = 1; i < count; i++)
+        vlc_executor_Submit(executor, &slice[i].runnable);
+
+    RunSlice(&slice[0]);
+
+    /* Run the slices that no thread has started yet, rather than waiting for
+     * them. This also keeps nested calls from the filter threads from
+     * dead-locking. */
+    unsigned canceled = 0;
+    for (unsigned i = count - 1; i > 0; i--)
+        if (vlc_executor_Cancel(executor, &slice[i].runnable))
+        {
+            RunSlice(&slice[i]);
+            canceled++;
+        }
+
+    vlc_mutex_lock(&slices.lock);
+    slices.pending -= canceled;
+    while (slices.pending > 0)
+        vlc_cond_wait(&slices.wait, &slices.lock);
+    vlc_mutex_unlock(&slices.lock);
+}
+
+/* */
+
 vlc_blender_t *filter_NewBlend( vlc_object_t *p_this,
                            const video_format_t *p_dst_chroma )
 {
@@ -38,8 +38,10 @@
 #include <vlc_atomic.h>
 #include <vlc_frame.h>
 #include <vlc_fs.h>
+#include <vlc_list.h>
 
 #include <vlc_ancillary.h>
+#include "../libvlc.h"
 
 #ifndef NDEBUG
 static void vlc_frame_Check (vlc_frame_t *frame)
@@ -116,6 +118,420 @@ vlc_frame_t *vlc_frame_Init(vlc_frame_t *restrict f, const struct vlc_frame_call
 # define VLC_FRAME_PADDING      32 /* Avoid <= 32 bytes reallocs */
 #endif
 
+static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
+               "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
+
+/*
+ * Per-thread frame cache
+ *
+ * Heap frames keep, together with their buffer, a reference to the cache of
+ * the thread that allocated them, sorted by buffer size classes. Allocations
+ * of a matching size class are served from the cache of the allocating
+ * thread without calling the system allocator.
+ *
+ * Frames released by their owner thread go straight back to its cache.
+ * Frames released by other threads, typically a decoder releasing what the
+ * demuxer allocated, are pushed onto a lock-free list of the owner cache,
+ * which the owner takes over when it runs out of frames of a size class.
+ *
+ * Each thread cache is bounded by the same byte limit, the largest one asked
+ * by the live libvlc instances. A cache is closed when its thread exits, or
+ * when the last limit is removed by its thread. Its structure is freed once
+ * no frames refer to it anymore.
+ */
+#define VLC_FRAME_CACHE_MIN_SHIFT 9  /* smallest class: 512 bytes */
+#define VLC_FRAME_CACHE_CLASSES   8  /* largest class: 64 KiB */
+
+struct vlc_frame_cache;
+
+struct vlc_frame_cached
+{
+    vlc_frame_t self;
+    unsigned size_class;
+    struct vlc_frame_cache *owner;
+};
+
+struct vlc_frame_cache
+{
+    vlc_frame_t *frames[VLC_FRAME_CACHE_CLASSES];
+    size_t bytes;
+    /* Frames released by other threads, or vlc_frame_cache_closed */
+    _Atomic(vlc_frame_t *) remote;
+    atomic_size_t remote_bytes;
+    /* Owner thread plus frames (cached or not) allocated from this cache */
+    atomic_uintptr_t refs;
+    /* Only written by the owner thread, read by vlc_frame_cache_GetStats() */
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_size_t bytes_cached;
+    atomic_size_t high_water;
+    struct vlc_list node;
+};
+
+static atomic_size_t vlc_frame_cache_limit = 0;
+static vlc_mutex_t vlc_frame_cache_lock = VLC_STATIC_MUTEX;
+static struct vlc_list vlc_frame_caches =
+    VLC_LIST_INITIALIZER(&vlc_frame_caches);
+static struct vlc_list vlc_frame_cache_limits =
+    VLC_LIST_INITIALIZER(&vlc_frame_cache_limits);
+static struct vlc_frame_cache_stats vlc_frame_cache_retired;
+static vlc_once_t vlc_frame_cache_once = VLC_STATIC_ONCE;
+static vlc_threadvar_t vlc_frame_cache_key;
+static thread_local struct vlc_frame_cache *vlc_frame_cache_current;
+/* Set once the thread variable destructor ran: no new cache afterwards */
+static thread_local bool vlc_frame_cache_exited;
+/* Marks the remote list of a closed cache */
+static vlc_frame_t vlc_frame_cache_closed;
+
+static size_t vlc_frame_cache_ClassSize(unsigned size_class)
+{
+    return (size_t)1 << (VLC_FRAME_CACHE_MIN_SHIFT + size_class);
+}
+
+static void vlc_frame_cache_Unref(struct vlc_frame_cache *cache)
+{
+    if (atomic_fetch_sub_explicit(&cache->refs, 1, memory_order_acq_rel) == 1)
+        free(cache);
+}
+
+static void vlc_frame_cache_FreeFrame(vlc_frame_t *frame)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    struct vlc_frame_cache *owner = cf->owner;
+
+    free(frame->p_start);
+    free(cf);
+    vlc_frame_cache_Unref(owner);
+}
+
+static void vlc_frame_cache_FreeChain(vlc_frame_t *frame)
+{
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+
+        vlc_frame_cache_FreeFrame(frame);
+        frame = next;
+    }
+}
+
+/* Closes the cache of the calling thread */
+static void vlc_frame_cache_Close(struct vlc_frame_cache *cache)
+{
+    assert(cache == vlc_frame_cache_current);
+    vlc_frame_cache_current = NULL;
+
+    for (size_t i = 0; i < VLC_FRAME_CACHE_CLASSES; i++)
+    {
+        vlc_frame_cache_FreeChain(cache->frames[i]);
+        cache->frames[i] = NULL;
+    }
+    /* Later remote releases free their frame themselves */
+    vlc_frame_cache_FreeChain(atomic_exchange_explicit(&cache->remote,
+                                                       &vlc_frame_cache_closed,
+                                                       memory_order_acquire));
+
+    vlc_mutex_lock(&vlc_frame_cache_lock);
+    vlc_list_remove(&cache->node);
+    vlc_frame_cache_retired.hits += atomic_load_explicit(&cache->hits,
+                                                         memory_order_relaxed);
+    vlc_frame_cache_retired.misses += atomic_load_explicit(&cache->misses,
+                                                           memory_order_relaxed);
+    size_t high_water = atomic_load_explicit(&cache->high_water,
+                                             memory_order_relaxed);
+    if (vlc_frame_cache_retired.high_water < high_water)
+        vlc_frame_cache_retired.high_water = high_water;
+    vlc_mutex_unlock(&vlc_frame_cache_lock);
+    vlc_frame_cache_Unref(cache);
+}
+
+static void vlc_frame_cache_Destroy(void *data)
+{
+    vlc_frame_cache_exited = true;
+    vlc_frame_cache_Close(data);
+}
+
+static void vlc_frame_cache_Init(void *data)
+{
+    bool *ok = data;
+
+    *ok = vlc_threadvar_create(&vlc_frame_cache_key,
+                               vlc_frame_cache_Destroy) == 0;
+}
+
+static struct vlc_frame_cache *vlc_frame_cache_Get(void)
+{
+    struct vlc_frame_cache *cache = vlc_frame_cache_current;
+    if (likely(cache != NULL))
+        return cache;
+    if (vlc_frame_cache_exited)
+        return NULL;
+
+    static bool key_ok;
+    vlc_once(&vlc_frame_cache_once, vlc_frame_cache_Init, &key_ok);
+    if (unlikely(!key_ok))
+        return NULL;
+
+    cache = calloc(1, sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    atomic_init(&cache->refs, 1);
+
+    /* The thread variable is only used to destroy the cache on thread exit */
+    if (vlc_threadvar_set(vlc_frame_cache_key, cache))
+    {
+        free(cache);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&vlc_frame_cache_lock);
+    vlc_list_append(&cache->node, &vlc_frame_caches);
+    vlc_mutex_unlock(&vlc_frame_cache_lock);
+    vlc_frame_cache_current = cache;
+    return cache;
+}
+
+static inline void vlc_frame_cache_Count(atomic_uint_fast64_t *counter)
+{
+    /* Single writer: no need for an atomic read-modify-write */
+    atomic_store_explicit(counter,
+        atomic_load_explicit(counter, memory_order_relaxed) + 1,
+        memory_order_relaxed);
+}
+
+static void vlc_frame_cache_SetBytes(struct vlc_frame_cache *cache,
+                                     size_t bytes)
+{
+    cache->bytes = bytes;
+    atomic_store_explicit(&cache->bytes_cached, bytes, memory_order_relaxed);
+    if (bytes > atomic_load_explicit(&cache->high_water, memory_order_relaxed))
+        atomic_store_explicit(&cache->high_water, bytes, memory_order_relaxed);
+}
+
+/* Puts a frame in the cache of the calling thread, or frees it */
+static void vlc_frame_cache_Put(struct vlc_frame_cache *cache,
+                                vlc_frame_t *frame, size_t limit)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    size_t class_size = vlc_frame_cache_ClassSize(cf->size_class);
+
+    if (cache->bytes + class_size > limit)
+    {
+        vlc_frame_cache_FreeFrame(frame);
+        return;
+    }
+
+    frame->p_next = cache->frames[cf->size_class];
+    cache->frames[cf->size_class] = frame;
+    vlc_frame_cache_SetBytes(cache, cache->bytes + class_size);
+}
+
+/* Pushes a frame to the cache of another thread, or frees it */
+static void vlc_frame_cache_PutRemote(struct vlc_frame_cache *cache,
+                                      vlc_frame_t *frame, size_t limit)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    size_t class_size = vlc_frame_cache_ClassSize(cf->size_class);
+    size_t bytes = atomic_fetch_add_explicit(&cache->remote_bytes, class_size,
+                                             memory_order_relaxed)
+                 + atomic_load_explicit(&cache->bytes_cached,
+                                        memory_order_relaxed);
+    vlc_frame_t *head = atomic_load_explicit(&cache->remote,
+                                             memory_order_relaxed);
+
+    if (bytes + class_size <= limit)
+        do
+        {
+            if (head == &vlc_frame_cache_closed)
+                break;
+            frame->p_next = head;
+        }
+        while (!atomic_compare_exchange_weak_explicit(&cache->remote, &head,
+                                                      frame,
+                                                      memory_order_release,
+                                                      memory_order_relaxed));
+
+    if (bytes + class_size > limit || head == &vlc_frame_cache_closed)
+    {
+        atomic_fetch_sub_explicit(&cache->remote_bytes, class_size,
+                                  memory_order_relaxed);
+        vlc_frame_cache_FreeFrame(frame);
+    }
+}
+
+/* Takes over the frames released to the calling thread by other threads */
+static void vlc_frame_cache_Drain(struct vlc_frame_cache *cache, size_t limit)
+{
+    if (atomic_load_explicit(&cache->remote, memory_order_relaxed) == NULL)
+        return;
+
+    vlc_frame_t *frame = atomic_exchange_explicit(&cache->remote, NULL,
+                                                  memory_order_acquire);
+    while (frame != NULL)
+    {
+        vlc_frame_t *next = frame->p_next;
+        struct vlc_frame_cached *cf =
+            container_of(frame, struct vlc_frame_cached, self);
+
+        atomic_fetch_sub_explicit(&cache->remote_bytes,
+                                  vlc_frame_cache_ClassSize(cf->size_class),
+                                  memory_order_relaxed);
+        vlc_frame_cache_Put(cache, frame, limit);
+        frame = next;
+    }
+}
+
+static void vlc_frame_cache_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_cached *cf =
+        container_of(frame, struct vlc_frame_cached, self);
+    size_t limit = atomic_load_explicit(&vlc_frame_cache_limit,
+                                        memory_order_relaxed);
+
+    if (cf->owner == vlc_frame_cache_current)
+        vlc_frame_cache_Put(cf->owner, frame, limit);
+    else
+        vlc_frame_cache_PutRemote(cf->owner, frame, limit);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_cache_cbs =
+{
+    vlc_frame_cache_Release,
+};
+
+static vlc_frame_t *vlc_frame_cache_Alloc(size_t size, size_t limit)
+{
+    size_t capacity = (2 * VLC_FRAME_PADDING) + size;
+    unsigned size_class = 0;
+
+    while (vlc_frame_cache_ClassSize(size_class) < capacity)
+        if (++size_class >= VLC_FRAME_CACHE_CLASSES)
+            return NULL; /* too large to be cached */
+
+    struct vlc_frame_cache *cache = vlc_frame_cache_Get();
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    if (cache->frames[size_class] == NULL)
+        vlc_frame_cache_Drain(cache, limit);
+
+    vlc_frame_t *frame = cache->frames[size_class];
+    unsigned char *buf;
+
+    capacity = vlc_frame_cache_ClassSize(size_class);
+    if (frame != NULL)
+    {
+        cache->frames[size_class] = frame->p_next;
+        vlc_frame_cache_SetBytes(cache, cache->bytes - capacity);
+        vlc_frame_cache_Count(&cache->hits);
+        buf = frame->p_start;
+        capacity = frame->i_size;
+    }
+    else
+    {
+        vlc_frame_cache_Count(&cache->misses);
+
+        struct vlc_frame_cached *cf = malloc(sizeof (*cf));
+        if (unlikely(cf == NULL))
+            return NULL;
+#ifdef HAVE_ALIGNED_ALLOC
+        buf = aligned_alloc(VLC_FRAME_ALIGN, capacity);
+#else
+        capacity += VLC_FRAME_ALIGN;
+        buf = malloc(capacity);
+#endif
+        if (unlikely(buf == NULL))
+        {
+            free(cf);
+            return NULL;
+        }
+        cf->size_class = size_class;
+        cf->owner = cache;
+        atomic_fetch_add_explicit(&cache->refs, 1, memory_order_relaxed);
+        frame = &cf->self;
+    }
+
+    vlc_frame_Init(frame, &vlc_frame_cache_cbs, buf, capacity);
+#ifndef HAVE_ALIGNED_ALLOC
+    /* Alignment */
+    buf += (-(uintptr_t)(void *)buf) % (uintptr_t)VLC_FRAME_ALIGN;
+#endif
+    /* Header reserve */
+    frame->p_buffer = buf + VLC_FRAME_PADDING;
+    frame->i_buffer = size;
+    return frame;
+}
+
+/* Applies the largest limit, called with vlc_frame_cache_lock held */
+static size_t vlc_frame_cache_UpdateLimit(void)
+{
+    struct vlc_frame_cache_limit *limit;
+    size_t bytes = 0;
+
+    vlc_list_foreach(limit, &vlc_frame_cache_limits, node)
+        if (bytes < limit->bytes)
+            bytes = limit->bytes;
+
+    atomic_store_explicit(&vlc_frame_cache_limit, bytes,
+                          memory_order_relaxed);
+    return bytes;
+}
+
+void vlc_frame_cache_AddLimit(struct vlc_frame_cache_limit *limit)
+{
+    vlc_mutex_lock(&vlc_frame_cache_lock);
+    vlc_list_append(&limit->node, &vlc_frame_cache_limits);
+    vlc_frame_cache_UpdateLimit();
+    vlc_mutex_unlock(&vlc_frame_cache_lock);
+}
+
+void vlc_frame_cache_RemoveLimit(struct vlc_frame_cache_limit *limit)
+{
+    vlc_mutex_lock(&vlc_frame_cache_lock);
+    vlc_list_remove(&limit->node);
+    size_t bytes = vlc_frame_cache_UpdateLimit();
+    vlc_mutex_unlock(&vlc_frame_cache_lock);
+
+    /* The caches are disabled: free that of the calling thread, typically
+     * the main thread, which may never run the thread variable destructor.
+     * The caches of other threads are freed when they exit. */
+    struct vlc_frame_cache *cache = vlc_frame_cache_current;
+    if (bytes == 0 && cache != NULL)
+    {
+        vlc_threadvar_set(vlc_frame_cache_key, NULL);
+        vlc_frame_cache_Close(cache);
+    }
+}
+
+void vlc_frame_cache_GetStats(struct vlc_frame_cache_stats *stats)
+{
+    vlc_mutex_lock(&vlc_frame_cache_lock);
+    *stats = vlc_frame_cache_retired;
+
+    struct vlc_frame_cache *cache;
+    vlc_list_foreach(cache, &vlc_frame_caches, node)
+    {
+        size_t high_water = atomic_load_explicit(&cache->high_water,
+                                                 memory_order_relaxed);
+
+        stats->hits += atomic_load_explicit(&cache->hits,
+                                            memory_order_relaxed);
+        stats->misses += atomic_load_explicit(&cache->misses,
+                                              memory_order_relaxed);
+        stats->cached_bytes += atomic_load_explicit(&cache->bytes_cached,
+                                                    memory_order_relaxed)
+                             + atomic_load_explicit(&cache->remote_bytes,
+                                                    memory_order_relaxed);
+        if (stats->high_water < high_water)
+            stats->high_water = high_water;
+    }
+    vlc_mutex_unlock(&vlc_frame_cache_lock);
+}
+
 vlc_frame_t *vlc_frame_Alloc (size_t size)
 {
     if (unlikely(size >> 28))
@@ -124,8 +540,14 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
         return NULL;
     }
 
-    static_assert ((VLC_FRAME_PADDING % VLC_FRAME_ALIGN) == 0,
-                   "VLC_FRAME_PADDING must be a multiple of VLC_FRAME_ALIGN");
+    size_t limit = atomic_load_explicit(&vlc_frame_cache_limit,
+                                        memory_order_relaxed);
+    if (limit != 0)
+    {
+        vlc_frame_t *f = vlc_frame_cache_Alloc(size, limit);
+        if (f != NULL)
+            return f;
+    }
 
     /* 2 * VLC_FRAME_PADDING: pre + post padding */
     size_t capacity = (2 * VLC_FRAME_PADDING) + size;
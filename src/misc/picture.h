@@ -22,7 +22,6 @@
 #include <stddef.h>
 
 #include <vlc_picture.h>
-#include <vlc_list.h>
 #include <vlc_ancillary.h>
 
 typedef struct
@@ -35,7 +34,7 @@ typedef struct
     } gc;
 
     void *pool; /* Only used by picture_pool.c */
-    struct vlc_list pool_node; /* Only used by picture_pool.c */
+    unsigned pool_index; /* Only used by picture_pool.c */
 
     vlc_ancillary_array ancillaries;
 } picture_priv_t;
@@ -35,19 +35,24 @@
 #include <vlc_threads.h>
 #include <vlc_picture_pool.h>
 #include <vlc_atomic.h>
-#include <vlc_list.h>
 #include "picture.h"
 
 #define POOL_MAX 256
+#define POOL_WORD_BITS (sizeof (unsigned long long) * CHAR_BIT)
+#define POOL_WORDS ((POOL_MAX + POOL_WORD_BITS - 1) / POOL_WORD_BITS)
 
 struct picture_pool_t {
+    /* Only used to sleep in picture_pool_Wait() */
     vlc_mutex_t lock;
     vlc_cond_t  wait;
+    atomic_uint waiters;
+
+    /* Bit set for each available picture */
+    _Atomic unsigned long long available[POOL_WORDS];
 
     vlc_atomic_rc_t    refs;
-    bool released;
-    struct vlc_list inuse_list;
-    struct vlc_list available_list;
+    unsigned count;
+    picture_t *picture[];
 };
 
 static void picture_pool_Destroy(picture_pool_t *pool)
@@ -55,33 +60,32 @@ static void picture_pool_Destroy(picture_pool_t *pool)
     if (!vlc_atomic_rc_dec(&pool->refs))
         return;
 
-    assert(vlc_list_is_empty(&pool->inuse_list));
-    assert(vlc_list_is_empty(&pool->available_list));
-
     free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
+    /* In-use cloned pictures hold a reference to their original picture,
+     * and to the pool, until they are released. */
+    for (unsigned i = 0; i < pool->count; ++i)
+        picture_Release(pool->picture[i]);
+    picture_pool_Destroy(pool);
+}
 
-    /* Release pictures from both available and in-use lists */
-    for (size_t i = 0; i < 2; ++i)
-    {
-        struct vlc_list *list = i == 0 ? &pool->available_list : &pool->inuse_list;
+static void picture_pool_Put(picture_pool_t *pool, unsigned index)
+{
+    unsigned long long bit = 1ULL << (index % POOL_WORD_BITS);
 
-        picture_priv_t *priv;
-        vlc_list_foreach(priv, list, pool_node)
-        {
-            assert(priv->pool == pool);
-            vlc_list_remove(&priv->pool_node);
-            picture_Release(&priv->picture);
-        }
+    /* Pairs with picture_pool_Wait(): either the waiter sees the picture
+     * or we see the waiter. */
+    atomic_fetch_or(&pool->available[index / POOL_WORD_BITS], bit);
+
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
     }
-    /* Prevent in-use cloned pictures to be added back to lists */
-    pool->released = true;
-    vlc_mutex_unlock(&pool->lock);
-    picture_pool_Destroy(pool);
 }
 
 static void picture_pool_ReleaseClone(picture_t *clone)
@@ -95,16 +99,8 @@ static void picture_pool_ReleaseClone(picture_t *clone)
     picture_pool_t *pool = original_priv->pool;
     assert(pool != NULL);
 
-    vlc_mutex_lock(&pool->lock);
-
-    if (!pool->released)
-    {
-        vlc_list_remove(&original_priv->pool_node);
-        vlc_list_append(&original_priv->pool_node, &pool->available_list);
-        vlc_cond_signal(&pool->wait);
-    }
-
-    vlc_mutex_unlock(&pool->lock);
+    /* If the pool was released, nobody will get the picture anymore */
+    picture_pool_Put(pool, original_priv->pool_index);
 
     picture_Release(original);
 
@@ -112,50 +108,60 @@ static void picture_pool_ReleaseClone(picture_t *clone)
 }
 
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
-                                            picture_t *picture)
+                                            unsigned index)
 {
+    picture_t *picture = pool->picture[index];
     picture_t *clone = picture_InternalClone(picture, picture_pool_ReleaseClone,
                                              picture);
     if (clone != NULL) {
         assert(!picture_HasChainedPics(clone));
         vlc_atomic_rc_inc(&pool->refs);
     }
+    else
+        picture_pool_Put(pool, index);
     return clone;
 }
 
-static void picture_pool_AppendPic(picture_pool_t *pool, picture_t *pic)
-{
-    picture_priv_t *priv = container_of(pic, picture_priv_t, picture);
-    assert(priv->pool == NULL);
-    vlc_list_append(&priv->pool_node, &pool->available_list);
-    priv->pool = pool;
-}
-
 static picture_pool_t *
-picture_pool_NewCommon(void)
+picture_pool_NewCommon(unsigned count)
 {
-    picture_pool_t *pool = malloc(sizeof(*pool));
+    picture_pool_t *pool = malloc(sizeof(*pool)
+                                  + count * sizeof(pool->picture[0]));
 
     if (unlikely(pool == NULL))
         return NULL;
 
-    vlc_list_init(&pool->inuse_list);
-    vlc_list_init(&pool->available_list);
-
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
+    atomic_init(&pool->waiters, 0);
+    for (size_t i = 0; i < POOL_WORDS; ++i)
+        atomic_init(&pool->available[i], 0);
     vlc_atomic_rc_init(&pool->refs);
-    pool->released = false;
+    pool->count = 0;
 
     return pool;
 }
 
+static void picture_pool_AppendPic(picture_pool_t *pool, picture_t *pic)
+{
+    picture_priv_t *priv = container_of(pic, picture_priv_t, picture);
+    unsigned index = pool->count++;
+
+    assert(priv->pool == NULL);
+    priv->pool = pool;
+    priv->pool_index = index;
+    pool->picture[index] = pic;
+    atomic_fetch_or_explicit(&pool->available[index / POOL_WORD_BITS],
+                             1ULL << (index % POOL_WORD_BITS),
+                             memory_order_relaxed);
+}
+
 picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 {
     if (unlikely(count > POOL_MAX))
         return NULL;
 
-    picture_pool_t *pool = picture_pool_NewCommon();
+    picture_pool_t *pool = picture_pool_NewCommon(count);
     if (unlikely(pool == NULL))
         return NULL;
 
@@ -172,7 +178,7 @@ picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
     if (unlikely(count > POOL_MAX))
         return NULL;
 
-    picture_pool_t *pool = picture_pool_NewCommon();
+    picture_pool_t *pool = picture_pool_NewCommon(count);
     if (unlikely(pool == NULL))
         return NULL;
 
@@ -190,51 +196,59 @@ picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
     return pool;
 }
 
-static picture_t *picture_pool_GetAvailableLocked(picture_pool_t *pool)
+/**
+ * Takes one available picture, without blocking.
+ *
+ * @return the index of the picture, or -1 if none is available
+ */
+static int picture_pool_Take(picture_pool_t *pool)
 {
-    picture_priv_t *priv = vlc_list_first_entry_or_null(&pool->available_list,
-                                                        picture_priv_t,
-                                                        pool_node);
-    assert(priv != NULL);
-
-    assert(priv->pool == pool);
-
-    vlc_list_remove(&priv->pool_node);
-    vlc_list_append(&priv->pool_node, &pool->inuse_list);
+    for (size_t w = 0; w < POOL_WORDS; ++w)
+    {
+        unsigned long long avail = atomic_load(&pool->available[w]);
 
-    return &priv->picture;
+        while (avail != 0)
+        {
+            unsigned i = stdc_trailing_zeros_ull(avail);
+
+            if (atomic_compare_exchange_weak_explicit(&pool->available[w],
+                                                      &avail,
+                                                      avail & ~(1ULL << i),
+                                                      memory_order_acquire,
+                                                      memory_order_relaxed))
+                return w * POOL_WORD_BITS + i;
+        }
+    }
+    return -1;
 }
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    if (vlc_list_is_empty(&pool->available_list))
-    {
-        vlc_mutex_unlock(&pool->lock);
+    int index = picture_pool_Take(pool);
+    if (index < 0)
         return NULL;
-    }
-
-    picture_t *pic = picture_pool_GetAvailableLocked(pool);
-
-    vlc_mutex_unlock(&pool->lock);
 
-    return picture_pool_ClonePicture(pool, pic);
+    return picture_pool_ClonePicture(pool, index);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (vlc_list_is_empty(&pool->available_list))
-        vlc_cond_wait(&pool->wait, &pool->lock);
+    int index = picture_pool_Take(pool);
+    if (index < 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
 
-    picture_t *pic = picture_pool_GetAvailableLocked(pool);
+        while ((index = picture_pool_Take(pool)) < 0)
+            vlc_cond_wait(&pool->wait, &pool->lock);
 
-    vlc_mutex_unlock(&pool->lock);
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
+    }
 
-    return picture_pool_ClonePicture(pool, pic);
+    return picture_pool_ClonePicture(pool, index);
 }
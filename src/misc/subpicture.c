@@ -107,6 +107,7 @@ vlc_render_subpicture *vlc_render_subpicture_New( void )
     if( unlikely(p_subpic == NULL ) )
         return NULL;
     vlc_vector_init(&p_subpic->regions);
+    p_subpic->i_serial = 0;
     return p_subpic;
 }
 
@@ -217,6 +218,7 @@ typedef struct subpicture_region_private_t
     subpicture_region_t region;
     video_format_t fmt;
     picture_t *p_picture;
+    struct subpicture_region_rendering rendering;
 } subpicture_region_private_t;
 
 const video_format_t * subpicture_region_cache_GetFormat( const subpicture_region_t *p_region )
@@ -246,6 +248,7 @@ void subpicture_region_cache_Invalidate( subpicture_region_t *p_region )
     }
     video_format_Clean( &p_priv->fmt );
     video_format_Init( &p_priv->fmt, 0 );
+    p_priv->rendering.serial = 0;
 }
 
 int subpicture_region_cache_Assign( subpicture_region_t *p_region, picture_t *p_picture )
@@ -254,9 +257,17 @@ int subpicture_region_cache_Assign( subpicture_region_t *p_region, picture_t *p_
     if ( video_format_Copy( &p_priv->fmt, &p_picture->format ) != VLC_SUCCESS )
         return VLC_EGENERIC;
     p_priv->p_picture = p_picture;
+    p_priv->rendering.serial = 0;
     return VLC_SUCCESS;
 }
 
+struct subpicture_region_rendering *
+subpicture_region_GetRendering( subpicture_region_t *p_region )
+{
+    subpicture_region_private_t *p_priv = container_of(p_region, subpicture_region_private_t, region);
+    return &p_priv->rendering;
+}
+
 static subpicture_region_t * subpicture_region_NewInternal( void )
 {
     subpicture_region_private_t *p_region = calloc( 1, sizeof(subpicture_region_private_t) );
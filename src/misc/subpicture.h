@@ -25,3 +25,18 @@ void subpicture_region_cache_Invalidate( subpicture_region_t * );
 const video_format_t * subpicture_region_cache_GetFormat( const subpicture_region_t * );
 int subpicture_region_cache_Assign( subpicture_region_t *p_region, picture_t * );
 bool subpicture_region_cache_IsValid(const subpicture_region_t *);
+
+/* Last render of a region, to find the regions rendered identically by two
+ * successive renders */
+struct subpicture_region_rendering
+{
+    uint64_t serial;               /* render serial, 0 if not rendered yet */
+    const uint8_t *pixels;         /* pixels of the rendered picture */
+    unsigned x_offset, y_offset;   /* visible area of the rendered picture */
+    unsigned width, height;
+    vout_display_place_t place;
+    int alpha;
+};
+
+struct subpicture_region_rendering *
+subpicture_region_GetRendering( subpicture_region_t * );
@@ -31,6 +31,9 @@
 #include <vlc_executor.h>
 #include <vlc_tick.h>
 
+/* Executor constructor under test */
+static vlc_executor_t *(*executor_New)(unsigned);
+
 struct data
 {
     vlc_mutex_t lock;
@@ -55,6 +58,7 @@ static void RunIncrement(void *userdata)
 
     vlc_mutex_lock(&data->lock);
     ++data->started;
+    vlc_cond_signal(&data->cond);
     vlc_mutex_unlock(&data->lock);
 
     if (data->delay > 0)
@@ -68,7 +72,7 @@ static void RunIncrement(void *userdata)
 
 static void test_single_runnable(void)
 {
-    vlc_executor_t *executor = vlc_executor_New(1);
+    vlc_executor_t *executor = executor_New(1);
     assert(executor);
 
     struct data data;
@@ -93,7 +97,7 @@ static void test_single_runnable(void)
 
 static void test_multiple_runnables(void)
 {
-    vlc_executor_t *executor = vlc_executor_New(3);
+    vlc_executor_t *executor = executor_New(3);
     assert(executor);
 
     struct data shared_data;
@@ -120,7 +124,7 @@ static void test_multiple_runnables(void)
 
 static void test_blocking_delete(void)
 {
-    vlc_executor_t *executor = vlc_executor_New(1);
+    vlc_executor_t *executor = executor_New(1);
     assert(executor);
 
     struct data data;
@@ -153,7 +157,7 @@ static void test_blocking_delete(void)
 
 static void test_cancel(void)
 {
-    vlc_executor_t *executor = vlc_executor_New(4);
+    vlc_executor_t *executor = executor_New(4);
     assert(executor);
 
     struct data shared_data;
@@ -250,7 +254,7 @@ static void DoublerRun(void *userdata)
 
 static void test_task_chain(void)
 {
-    vlc_executor_t *executor = vlc_executor_New(4);
+    vlc_executor_t *executor = executor_New(4);
     assert(executor);
 
     /* Numbers from 0 to 99 */
@@ -271,12 +275,75 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
-int main(void)
+static void test_priority(void)
+{
+    vlc_executor_t *executor = executor_New(1);
+    assert(executor);
+
+    struct data data;
+    InitData(&data);
+
+    data.delay = VLC_TICK_FROM_MS(100);
+
+    /* Keep the only thread busy */
+    struct vlc_runnable blocker = {
+        .run = RunIncrement,
+        .userdata = &data,
+    };
+    vlc_executor_Submit(executor, &blocker);
+
+    vlc_mutex_lock(&data.lock);
+    while (data.started == 0)
+        vlc_cond_wait(&data.cond, &data.lock);
+    vlc_mutex_unlock(&data.lock);
+
+    struct data normal_data, high_data;
+    InitData(&normal_data);
+    InitData(&high_data);
+    high_data.delay = VLC_TICK_FROM_MS(100);
+
+    struct vlc_runnable normal = {
+        .run = RunIncrement,
+        .userdata = &normal_data,
+    };
+    struct vlc_runnable high = {
+        .run = RunIncrement,
+        .userdata = &high_data,
+    };
+    vlc_executor_SubmitExt(executor, &normal, VLC_EXECUTOR_PRIORITY_NORMAL, 0);
+    vlc_executor_SubmitExt(executor, &high, VLC_EXECUTOR_PRIORITY_HIGH, 0);
+
+    /* Wait for the high priority task, queued last */
+    vlc_mutex_lock(&high_data.lock);
+    while (high_data.started == 0)
+        vlc_cond_wait(&high_data.cond, &high_data.lock);
+    vlc_mutex_unlock(&high_data.lock);
+
+    /* The normal one is still queued */
+    assert(vlc_executor_Cancel(executor, &normal));
+
+    vlc_executor_WaitIdle(executor);
+    assert(normal_data.started == 0);
+    assert(high_data.ended == 1);
+
+    vlc_executor_Delete(executor);
+}
+
+static void test_all(vlc_executor_t *(*new)(unsigned))
 {
+    executor_New = new;
+
     test_single_runnable();
     test_multiple_runnables();
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_priority();
+}
+
+int main(void)
+{
+    test_all(vlc_executor_New);
+    test_all(vlc_executor_NewWorkStealing);
     return 0;
 }
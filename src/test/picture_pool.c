@@ -29,8 +29,12 @@
 #include <vlc_common.h>
 #include <vlc_es.h>
 #include <vlc_picture_pool.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
 
 #define PICTURES 10
+#define THREADS 4
+#define ROUNDS 50000
 
 const char vlc_module_name[] = "test_picture_pool";
 
@@ -87,6 +91,78 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void test_large(void)
+{
+    enum { COUNT = 150 };
+    picture_t *pics[COUNT];
+
+    pool = picture_pool_NewFromFormat(&fmt, COUNT);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < COUNT; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[j]->p[0].p_pixels != pics[i]->p[0].p_pixels);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    picture_Release(pics[100]);
+    pics[100] = picture_pool_Wait(pool);
+    assert(pics[100] != NULL);
+
+    for (unsigned i = 0; i < COUNT; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
+static void *Hammer(void *data)
+{
+    bool wait = *(bool *)data;
+
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        picture_t *pic = wait ? picture_pool_Wait(pool)
+                              : picture_pool_Get(pool);
+        if (pic != NULL)
+            picture_Release(pic);
+    }
+    return NULL;
+}
+
+static void test_concurrent(unsigned count)
+{
+    vlc_thread_t th[THREADS];
+    /* Half the threads wait like decoders, the others poll like vouts */
+    static bool wait[THREADS] = { true, false, true, false };
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(&th[i], Hammer, &wait[i]) == 0);
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    /* Every picture went back to the pool */
+    picture_t *pics[PICTURES];
+    for (unsigned i = 0; i < count; i++)
+        assert((pics[i] = picture_pool_Get(pool)) != NULL);
+    assert(picture_pool_Get(pool) == NULL);
+    for (unsigned i = 0; i < count; i++)
+        picture_Release(pics[i]);
+
+    picture_pool_Release(pool);
+
+#ifdef TEST_BENCH
+    printf("%u pictures, %u threads: %.0f pictures/s\n", count, THREADS,
+           THREADS * ROUNDS / secf_from_vlc_tick(duration ? duration : 1));
+#else
+    VLC_UNUSED(duration);
+#endif
+}
+
 int main(void)
 {
     video_format_Init(&fmt, VLC_CODEC_I420);
@@ -99,6 +175,9 @@ int main(void)
 
     test(false);
     test(true);
+    test_large();
+    test_concurrent(2);
+    test_concurrent(PICTURES);
 
     return 0;
 }
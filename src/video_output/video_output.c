@@ -406,6 +406,12 @@ void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
     vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
     assert(!sys->dummy);
     assert( !picture_HasChainedPics( picture ) );
+
+    struct vlc_tracer *tracer = GetTracer(sys);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "RENDER", sys->str_id, "queue",
+                                  picture->date);
+
     picture_fifo_Lock(sys->decoder_fifo);
     picture_fifo_Push(sys->decoder_fifo, picture);
     picture_fifo_Unlock(sys->decoder_fifo);
@@ -1061,6 +1067,7 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
 {
     vout_thread_sys_t *sys = vout;
     bool is_late_dropped = sys->is_late_dropped && !frame_by_frame;
+    struct vlc_tracer *tracer = GetTracer(sys);
 
     vlc_mutex_lock(&sys->filter.lock);
 
@@ -1080,6 +1087,10 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
             if (decoded == NULL)
                 break;
 
+            if (tracer != NULL)
+                vlc_tracer_TraceSpanEnd(tracer, "RENDER", sys->str_id, "queue",
+                                        decoded->date);
+
             if (!decoded->b_force)
             {
                 const vlc_tick_t system_now = vlc_tick_now();
@@ -1140,9 +1151,15 @@ static picture_t *PreparePicture(vout_thread_sys_t *vout, bool reuse_decoded,
         sys->displayed.timestamp     = decoded->date;
         sys->displayed.is_interlaced = !decoded->b_progressive;
 
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "RENDER", sys->str_id, "filter",
+                                      sys->displayed.timestamp);
         vout_chrono_Start(&sys->chrono.static_filter);
         picture = filter_chain_VideoFilter(sys->filter.chain_static, sys->displayed.decoded);
         vout_chrono_Stop(&sys->chrono.static_filter);
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "RENDER", sys->str_id, "filter",
+                                    sys->displayed.timestamp);
     }
 
     vlc_mutex_unlock(&sys->filter.lock);
@@ -1215,12 +1232,21 @@ static picture_t *ConvertRGBAAndBlend(vout_thread_sys_t *vout, picture_t *pic,
 
 static picture_t *FilterPictureInteractive(vout_thread_sys_t *sys)
 {
+    struct vlc_tracer *tracer = GetTracer(sys);
+    const vlc_tick_t pts = sys->displayed.current->date;
+
     // hold it as the filter chain will release it or return it and we release it
     picture_Hold(sys->displayed.current);
 
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "RENDER", sys->str_id,
+                                  "interactive", pts);
     vlc_mutex_lock(&sys->filter.lock);
     picture_t *filtered = filter_chain_VideoFilter(sys->filter.chain_interactive, sys->displayed.current);
     vlc_mutex_unlock(&sys->filter.lock);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "RENDER", sys->str_id,
+                                "interactive", pts);
 
     if (filtered && filtered->date != sys->displayed.current->date)
         msg_Warn(&sys->obj, "Unsupported timestamp modifications done by chain_interactive");
@@ -1458,12 +1484,20 @@ static int RenderPicture(vout_thread_sys_t *sys,
     const unsigned frame_rate = todisplay->format.i_frame_rate;
     const unsigned frame_rate_base = todisplay->format.i_frame_rate_base;
 
+    struct vlc_tracer *tracer = GetTracer(sys);
     if (vd->ops->prepare != NULL)
+    {
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanBegin(tracer, "RENDER", sys->str_id,
+                                      "prepare", pts);
         vd->ops->prepare(vd, todisplay, subpic, system_pts);
+        if (tracer != NULL)
+            vlc_tracer_TraceSpanEnd(tracer, "RENDER", sys->str_id,
+                                    "prepare", pts);
+    }
 
     vout_chrono_Stop(&sys->chrono.render);
 
-    struct vlc_tracer *tracer = GetTracer(sys);
     system_now = vlc_tick_now();
     if (!render_now)
     {
@@ -1531,7 +1565,13 @@ static int RenderPicture(vout_thread_sys_t *sys,
         system_now = vlc_tick_now();
 
     /* Display the direct buffer returned by vout_RenderPicture */
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanBegin(tracer, "RENDER", sys->str_id, "display",
+                                  pts);
     vout_display_Display(vd, todisplay);
+    if (tracer != NULL)
+        vlc_tracer_TraceSpanEnd(tracer, "RENDER", sys->str_id, "display",
+                                pts);
     vlc_clock_Lock(sys->clock);
     vlc_tick_t drift = vlc_clock_UpdateVideo(sys->clock,
                                              system_now,
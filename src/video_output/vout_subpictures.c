@@ -119,6 +119,8 @@ struct spu_private_t {
 
     video_palette_t palette;              /**< force palette of subpicture */
 
+    uint64_t render_serial;              /**< serial of the current render */
+
     /* Subpiture filters */
     char           *source_chain_current;
     char           *source_chain_update;
@@ -1092,7 +1094,10 @@ static struct subpicture_region_rendered *SpuRenderRegion(spu_t *spu,
         }
 
         if( changed_palette )
+        {
             *old_palette = new_palette;
+            subpicture_region_GetRendering(region)->serial = 0;
+        }
     }
 
     /* */
@@ -1303,6 +1308,41 @@ static struct subpicture_region_rendered *SpuRenderRegion(spu_t *spu,
     return dst;
 }
 
+/**
+ * Flags the rendered region as unchanged if the previous render rendered it
+ * identically, so that the displays can keep what they made of it.
+ */
+static void SpuRenderCheckUnchanged(spu_private_t *sys,
+                                    subpicture_region_t *region,
+                                    struct subpicture_region_rendered *rendered)
+{
+    struct subpicture_region_rendering *last =
+        subpicture_region_GetRendering(region);
+    const video_format_t *fmt = &rendered->p_picture->format;
+    const struct subpicture_region_rendering current = {
+        .serial   = sys->render_serial,
+        .pixels   = rendered->p_picture->p[0].p_pixels,
+        .x_offset = fmt->i_x_offset,
+        .y_offset = fmt->i_y_offset,
+        .width    = fmt->i_visible_width,
+        .height   = fmt->i_visible_height,
+        .place    = rendered->place,
+        .alpha    = rendered->i_alpha,
+    };
+
+    rendered->b_unchanged = last->serial != 0 &&
+                            last->serial + 1 == current.serial &&
+                            last->pixels == current.pixels &&
+                            last->x_offset == current.x_offset &&
+                            last->y_offset == current.y_offset &&
+                            last->width == current.width &&
+                            last->height == current.height &&
+                            vout_display_PlaceEquals(&last->place,
+                                                     &current.place) &&
+                            last->alpha == current.alpha;
+    *last = current;
+}
+
 static void spu_UpdateOriginalSize(spu_t *spu, subpicture_t *subpic,
                                    const video_format_t *fmtsrc)
 {
@@ -1358,6 +1398,7 @@ static vlc_render_subpicture *SpuRenderSubpictures(spu_t *spu,
     if (unlikely(output == NULL))
         return NULL;
     output->i_order = p_entries[i_subpicture - 1].subpic->i_order;
+    output->i_serial = sys->render_serial;
     struct subpicture_region_rendered *output_last_ptr;
 
     /* Allocate area array for subtitle overlap */
@@ -1494,6 +1535,8 @@ static vlc_render_subpicture *SpuRenderSubpictures(spu_t *spu,
                 output_last_ptr->place.y += video_position->y;
             }
 
+            SpuRenderCheckUnchanged(sys, region, output_last_ptr);
+
             if (cache_pos != NULL)
             {
                 region->b_absolute = false;
@@ -1928,6 +1971,7 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     sys->secondary_alignment = var_InheritInteger(spu,
                                                   "secondary-sub-alignment");
     vlc_vector_init(&sys->subs_pos);
+    sys->render_serial = 0;
 
     sys->source_chain_update = NULL;
     sys->filter_chain_update = NULL;
@@ -2284,6 +2328,9 @@ vlc_render_subpicture *spu_Render(spu_t *spu,
 
     vlc_mutex_lock(&sys->lock);
 
+    /* Even an empty render breaks the chain of unchanged regions */
+    sys->render_serial++;
+
     size_t subpicture_count;
 
     /* Get an array of subpictures to render */
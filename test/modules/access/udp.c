@@ -0,0 +1,198 @@
+/*****************************************************************************
+ * udp.c: loopback test and benchmark of the UDP access
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * A thread sends numbered datagrams of 7 TS packets to the loopback
+ * interface, at most WINDOW datagrams ahead of the reader so that the socket
+ * buffer never overflows. The stream read from the UDP access must be the
+ * exact concatenation of the datagrams.
+ *
+ * Then a burst of datagrams larger than the MTU, up to the largest UDP
+ * payload, must be read whole as well.
+ *
+ * Built with TEST_BENCH, it also prints the throughput of the first part.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_modules.h>
+#include <vlc_network.h>
+#include <vlc_stream.h>
+#include <vlc_threads.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define DATAGRAM  (7 * 188)
+#define COUNT     50000
+#define WINDOW    32
+#define LARGE     65507 /* largest UDP payload over IPv4 */
+
+static const size_t large_sizes[] = { 1401, 4000, 9000, 16000, 32000, LARGE };
+
+static struct
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned consumed;
+} reader = {
+    .lock = VLC_STATIC_MUTEX,
+    .wait = VLC_STATIC_COND,
+};
+
+static int fd;
+static struct sockaddr_in addr;
+
+static void Fill(uint8_t *buf, uint32_t seq, size_t size)
+{
+    memcpy(buf, &seq, sizeof (seq));
+    for (size_t i = sizeof (seq); i < size; i++)
+        buf[i] = seq + i;
+}
+
+static void *Send(void *data)
+{
+    uint8_t buf[DATAGRAM];
+    (void) data;
+
+    for (uint32_t seq = 0; seq < COUNT; seq++)
+    {
+        vlc_mutex_lock(&reader.lock);
+        while (seq - reader.consumed >= WINDOW)
+            vlc_cond_wait(&reader.wait, &reader.lock);
+        vlc_mutex_unlock(&reader.lock);
+
+        Fill(buf, seq, DATAGRAM);
+        ssize_t val = sendto(fd, buf, DATAGRAM, 0,
+                             (struct sockaddr *)&addr, sizeof (addr));
+        assert(val == DATAGRAM);
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    test_init();
+
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd == -1)
+        return 77;
+
+    /* Find a free port */
+    socklen_t addrlen = sizeof (addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(fd, (struct sockaddr *)&addr, sizeof (addr))
+     || getsockname(fd, (struct sockaddr *)&addr, &addrlen))
+    {
+        net_Close(fd);
+        return 77;
+    }
+    net_Close(fd);
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    assert(fd != -1);
+
+    const char * const args[] = {
+        "-v", "--udp-timeout=2",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    if (!module_exists("udp"))
+    {
+        libvlc_release(vlc);
+        net_Close(fd);
+        return 77;
+    }
+
+    char url[32];
+    sprintf(url, "udp://@127.0.0.1:%u", ntohs(addr.sin_port));
+
+    /* The access alone, without the stream filters buffering ahead */
+    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(vlc->p_libvlc_int), url);
+    assert(s != NULL);
+
+    static uint8_t buf[LARGE], expected[LARGE];
+    vlc_thread_t thread;
+    vlc_tick_t start = vlc_tick_now();
+    int ret = vlc_clone(&thread, Send, NULL);
+    assert(ret == 0);
+
+    for (uint32_t seq = 0; seq < COUNT; seq++)
+    {
+        ssize_t val = vlc_stream_Read(s, buf, DATAGRAM);
+        assert(val == DATAGRAM);
+
+        Fill(expected, seq, DATAGRAM);
+        assert(memcmp(buf, expected, DATAGRAM) == 0);
+
+        vlc_mutex_lock(&reader.lock);
+        reader.consumed = seq + 1;
+        vlc_cond_signal(&reader.wait);
+        vlc_mutex_unlock(&reader.lock);
+    }
+
+    vlc_tick_t duration = vlc_tick_now() - start;
+    vlc_join(thread, NULL);
+#ifdef TEST_BENCH
+    printf("udp: %u datagrams, %.1f Mbit/s, %.0f datagrams/s\n", COUNT,
+           8. * COUNT * DATAGRAM / 1e6 / secf_from_vlc_tick(duration),
+           COUNT / secf_from_vlc_tick(duration));
+#else
+    VLC_UNUSED(duration);
+#endif
+
+    /* The whole burst fits in the socket buffer, before anything is read */
+    for (size_t i = 0; i < ARRAY_SIZE(large_sizes); i++)
+    {
+        const size_t size = large_sizes[i];
+
+        Fill(expected, COUNT + i, size);
+        ssize_t val = sendto(fd, expected, size, 0,
+                             (struct sockaddr *)&addr, sizeof (addr));
+        assert((size_t)val == size);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(large_sizes); i++)
+    {
+        const size_t size = large_sizes[i];
+
+        Fill(expected, COUNT + i, size);
+        ssize_t val = vlc_stream_Read(s, buf, size);
+        assert((size_t)val == size);
+        assert(memcmp(buf, expected, size) == 0);
+    }
+
+    vlc_stream_Delete(s);
+    net_Close(fd);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,323 @@
+/*****************************************************************************
+ * mixer.c: test of the float volume, channel mixers and sample conversion
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+#include <vlc_block.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+/* The optimized versions must give the same output as the C code, which the
+ * references below copy. As VLC is built with unsafe math optimizations, the
+ * compiler may reorder the float mixes: those are compared to the rounding.
+ * Odd frame counts check the tails. */
+static const unsigned frame_counts[] = { 1, 7, 9, 1023, 48000 };
+
+static float RandomSample(void)
+{
+    /* a few samples out of range, to check the clipping */
+    return (rand() - RAND_MAX / 2) / (float)(RAND_MAX / 2) * 1.1f;
+}
+
+static block_t *RandomBlock(size_t frames, unsigned channels)
+{
+    block_t *block = block_Alloc(frames * channels * sizeof (float));
+    assert(block != NULL);
+
+    float *p = (float *)block->p_buffer;
+    for (size_t i = 0; i < frames * channels; i++)
+        p[i] = RandomSample();
+    block->i_nb_samples = frames;
+    return block;
+}
+
+static bool Equals(float a, float b)
+{
+    return fabsf(a - b) <= 1e-6f * (1.f + fabsf(b));
+}
+
+/*** Volume ***/
+
+static void TestVolume(vlc_object_t *obj, vlc_fourcc_t format)
+{
+    audio_volume_t *volume = vlc_object_create(obj, sizeof (*volume));
+    assert(volume != NULL);
+    volume->format = format;
+
+    module_t *module = module_need(volume, "audio volume", "float_mixer", true);
+    assert(module != NULL);
+
+    const float amp = 0.8f;
+    for (size_t i = 0; i < ARRAY_SIZE(frame_counts); i++)
+    {
+        const size_t count = frame_counts[i];
+        block_t *block = RandomBlock(count, 2);
+        block_t *ref = block_Duplicate(block);
+        assert(ref != NULL);
+
+        if (format == VLC_CODEC_FL64)
+        {
+            /* twice as many samples in the same buffer */
+            double *p = (double *)ref->p_buffer;
+            for (size_t j = 0; j < count; j++)
+                p[j] *= (double)amp;
+        }
+        else
+        {
+            float *p = (float *)ref->p_buffer;
+            for (size_t j = 0; j < 2 * count; j++)
+                p[j] *= amp;
+        }
+
+        volume->amplify(volume, block, amp);
+        assert(!memcmp(block->p_buffer, ref->p_buffer, block->i_buffer));
+        block_Release(ref);
+        block_Release(block);
+    }
+
+    module_unneed(volume, module);
+    vlc_object_delete(volume);
+}
+
+/*** Audio filters ***/
+
+typedef void (*reference_t)(float *dst, const float *src);
+
+static void Ref_7_1_to_2_0(float *d, const float *s)
+{
+    float ctr = s[6] * 0.7071f;
+    d[0] = ctr + s[0] + s[2] / 4 + s[4] / 4;
+    d[1] = ctr + s[1] + s[3] / 4 + s[5] / 4;
+}
+
+static void Ref_5_1_to_2_0(float *d, const float *s)
+{
+    d[0] = s[0] + 0.7071f * (s[4] + s[2]);
+    d[1] = s[1] + 0.7071f * (s[4] + s[3]);
+}
+
+static void Ref_5_0_to_1_0(float *d, const float *s)
+{
+    d[0] = 0.7071f * (s[0] + s[1]) + s[4] + 0.5f * (s[2] + s[3]);
+}
+
+static void Ref_7_1_to_4_0(float *d, const float *s)
+{
+    d[0] = s[6] + 0.5f * s[0] + s[2] / 6;
+    d[1] = s[6] + 0.5f * s[1] + s[3] / 6;
+    d[2] = s[2] / 6 +  s[4];
+    d[3] = s[3] / 6 +  s[5];
+}
+
+/* Left, right, center with the center remapped to the left */
+static void Ref_remap_center(float *d, const float *s)
+{
+    d[0] = 0.f;
+    d[0] += s[0] / 2;
+    d[0] += s[2] / 2;
+    d[1] = s[1];
+}
+
+/* 5.1 with the center remapped to the left, without the LFE */
+static void Ref_remap_5_1(float *d, const float *s)
+{
+    d[0] = 0.f;
+    d[0] += s[0] / 2;
+    d[0] += s[4] / 2;
+    memcpy(&d[1], &s[1], 3 * sizeof (float));
+}
+
+/* 4.1 without the LFE */
+static void Ref_remap_no_lfe(float *d, const float *s)
+{
+    memcpy(d, s, 4 * sizeof (float));
+}
+
+/* Stereo to 5.1 (rear left and right, center, LFE) */
+static void Ref_upmix(float *d, const float *s)
+{
+    d[0] = s[0];
+    d[1] = s[1];
+    d[2] = d[3] = d[4] = d[5] = 0.f;
+}
+
+/* 7.1 to stereo */
+static void Ref_downmix(float *d, const float *s)
+{
+    d[0] = s[0];
+    d[1] = s[1];
+}
+
+static int16_t Ref_fl32_to_s16(float f)
+{
+    union { float f; int32_t i; } u;
+    u.f = f + 384.f;
+    if (u.i > 0x43c07fff)
+        return 32767;
+    else if (u.i < 0x43bf8000)
+        return -32768;
+    else
+        return u.i - 0x43c00000;
+}
+
+static const struct
+{
+    const char *capability;
+    const char *module;
+    uint16_t in, out;
+    vlc_fourcc_t out_format;
+    reference_t ref;
+} filters[] = {
+    { "audio converter", "simple_channel_mixer",
+      AOUT_CHANS_7_1, AOUT_CHANS_2_0,
+      VLC_CODEC_FL32, Ref_7_1_to_2_0 },
+    { "audio converter", "simple_channel_mixer",
+      AOUT_CHANS_5_1, AOUT_CHANS_2_0,
+      VLC_CODEC_FL32, Ref_5_1_to_2_0 },
+    { "audio converter", "simple_channel_mixer",
+      AOUT_CHANS_5_0, AOUT_CHAN_CENTER,
+      VLC_CODEC_FL32, Ref_5_0_to_1_0 },
+    { "audio converter", "simple_channel_mixer",
+      AOUT_CHANS_7_1, AOUT_CHANS_4_0,
+      VLC_CODEC_FL32, Ref_7_1_to_4_0 },
+    { "audio filter", "remap",
+      AOUT_CHANS_3_0, AOUT_CHANS_2_0,
+      VLC_CODEC_FL32, Ref_remap_center },
+    { "audio filter", "remap",
+      AOUT_CHANS_5_1, AOUT_CHANS_4_0,
+      VLC_CODEC_FL32, Ref_remap_5_1 },
+    { "audio filter", "remap",
+      AOUT_CHANS_4_1, AOUT_CHANS_4_0,
+      VLC_CODEC_FL32, Ref_remap_no_lfe },
+    { "audio converter", "trivial",
+      AOUT_CHANS_2_0, AOUT_CHANS_5_1,
+      VLC_CODEC_FL32, Ref_upmix },
+    { "audio converter", "trivial",
+      AOUT_CHANS_7_1, AOUT_CHANS_2_0,
+      VLC_CODEC_FL32, Ref_downmix },
+    { "audio converter", "audio_format",
+      AOUT_CHANS_2_0, AOUT_CHANS_2_0,
+      VLC_CODEC_S16N, NULL },
+};
+
+static void SetupFormat(audio_format_t *fmt, vlc_fourcc_t format,
+                        uint16_t channels)
+{
+    fmt->i_format = format;
+    fmt->i_rate = 48000;
+    fmt->i_physical_channels = channels;
+    fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    aout_FormatPrepare(fmt);
+}
+
+static void TestFilter(vlc_object_t *obj, size_t index)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, AUDIO_ES, VLC_CODEC_FL32);
+    SetupFormat(&filter->fmt_in.audio, VLC_CODEC_FL32, filters[index].in);
+    es_format_Init(&filter->fmt_out, AUDIO_ES, filters[index].out_format);
+    SetupFormat(&filter->fmt_out.audio, filters[index].out_format,
+                filters[index].out);
+
+    module_t *module = vlc_filter_LoadModule(filter, filters[index].capability,
+                                             filters[index].module, true);
+    assert(module != NULL);
+    /* remap may only change the output layout in the open */
+    assert(filter->fmt_out.audio.i_physical_channels == filters[index].out);
+
+    const unsigned in_nb = aout_FormatNbChannels(&filter->fmt_in.audio);
+    const unsigned out_nb = aout_FormatNbChannels(&filter->fmt_out.audio);
+    const reference_t ref = filters[index].ref;
+
+    for (size_t i = 0; i < ARRAY_SIZE(frame_counts); i++)
+    {
+        const size_t count = frame_counts[i];
+        block_t *in = RandomBlock(count, in_nb);
+        const float *src = (const float *)in->p_buffer;
+        float expected[AOUT_CHAN_MAX];
+
+        /* a copy of the input, as the filters may work in place */
+        float *copy = malloc(in->i_buffer);
+        assert(copy != NULL);
+        memcpy(copy, src, in->i_buffer);
+
+        block_t *out = filter->ops->filter_audio(filter, in);
+        assert(out != NULL && out->i_nb_samples == count);
+
+        for (size_t j = 0; j < count; j++)
+        {
+            const float *frame = &copy[j * in_nb];
+
+            if (ref == NULL)
+            {
+                const int16_t *s16 = (const int16_t *)out->p_buffer;
+                for (unsigned c = 0; c < out_nb; c++)
+                    assert(s16[j * out_nb + c] == Ref_fl32_to_s16(frame[c]));
+                continue;
+            }
+
+            ref(expected, frame);
+            const float *mixed = &((const float *)out->p_buffer)[j * out_nb];
+            for (unsigned c = 0; c < out_nb; c++)
+                assert(Equals(mixed[c], expected[c]));
+        }
+        free(copy);
+        block_Release(out);
+    }
+
+    vlc_filter_Delete(filter);
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v", "--aout-remap-channel-center=0", "--aout-remap-channel-lfe=-1",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    TestVolume(obj, VLC_CODEC_FL32);
+    TestVolume(obj, VLC_CODEC_FL64);
+    for (size_t i = 0; i < ARRAY_SIZE(filters); i++)
+        TestFilter(obj, i);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,300 @@
+/*****************************************************************************
+ * scaletempo.c: scaletempo audio filter test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each SIMD kernel the CPU supports is compared with the C one, for all
+ * the lengths up to a few vectors and for unaligned buffers.
+ *
+ * Then the filter is fed with sines, one phase per channel. Whatever the
+ * rate, the best overlap search must keep the output a sine of the same
+ * frequency and amplitude: no steps, no cancelled periods.
+ *
+ * Built with TEST_BENCH, it also prints the time per sample of each kernel
+ * and how many times faster than real-time the filter runs.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_tick.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+#include "../../../modules/audio_filter/scaletempo_kernels.h"
+
+#include <vlc/vlc.h>
+
+typedef float (*corr_fn)(const float *, const float *, unsigned);
+typedef void (*blend_fn)(float *, const float *, const float *, const float *,
+                         unsigned);
+
+#define KERNEL_MAX 300 /* several vectors of the widest SIMD */
+#define KERNEL_BENCH_SIZE 4096
+#define KERNEL_BENCH_LOOPS 20000
+
+static float Random(uint32_t *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return (*seed >> 8) / (float)(1 << 24) * 2.f - 1.f; /* [-1, 1[ */
+}
+
+static void TestKernel(const char *name, corr_fn corr, blend_fn blend)
+{
+    /* one more float, to misalign all the buffers */
+    float a[KERNEL_MAX + 1], b[KERNEL_MAX + 1], w[KERNEL_MAX + 1];
+    float out_c[KERNEL_MAX + 1], out[KERNEL_MAX + 1];
+    uint32_t seed = 42;
+
+    for (size_t i = 0; i < ARRAY_SIZE(a); i++)
+    {
+        a[i] = Random(&seed);
+        b[i] = Random(&seed);
+        w[i] = (Random(&seed) + 1.f) / 2.f; /* blend factors in [0, 1[ */
+    }
+
+    for (unsigned misalign = 0; misalign <= 1; misalign++)
+        for (unsigned n = 0; n <= KERNEL_MAX - misalign; n++)
+        {
+            const float *pa = a + misalign, *pb = b + misalign;
+            const float *pw = w + misalign;
+
+            /* the summation orders differ: bound the rounding errors */
+            float abs_sum = 0.f;
+            for (unsigned i = 0; i < n; i++)
+                abs_sum += fabsf(pa[i] * pb[i]);
+            const float expected = corr_c(pa, pb, n);
+            const float result = corr(pa, pb, n);
+            assert(fabsf(result - expected) <= 2.f * n * FLT_EPSILON * abs_sum);
+
+            out[misalign + n] = out_c[misalign + n] = 42.f;
+            blend_c(out_c + misalign, pa, pw, pb, n);
+            blend(out + misalign, pa, pw, pb, n);
+            for (unsigned i = 0; i < n; i++)
+                assert(fabsf(out[misalign + i] - out_c[misalign + i])
+                       <= 2.f * FLT_EPSILON);
+            /* nothing is written past the end */
+            assert(out[misalign + n] == 42.f);
+        }
+
+#ifdef TEST_BENCH
+    static float x[KERNEL_BENCH_SIZE], y[KERNEL_BENCH_SIZE];
+    static float z[KERNEL_BENCH_SIZE];
+    for (size_t i = 0; i < KERNEL_BENCH_SIZE; i++)
+    {
+        x[i] = Random(&seed);
+        y[i] = Random(&seed);
+    }
+
+    volatile float sink = 0.f;
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < KERNEL_BENCH_LOOPS; i++)
+        sink += corr(x, y, KERNEL_BENCH_SIZE);
+    const vlc_tick_t corr_time = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < KERNEL_BENCH_LOOPS; i++)
+        blend(z, x, y, z, KERNEL_BENCH_SIZE);
+    const vlc_tick_t blend_time = vlc_tick_now() - start;
+    (void) sink;
+
+    const double samples = (double)KERNEL_BENCH_LOOPS * KERNEL_BENCH_SIZE;
+    printf("scaletempo %-4s: corr %.3f ns/sample, blend %.3f ns/sample\n",
+           name, NS_FROM_VLC_TICK(corr_time) / samples,
+           NS_FROM_VLC_TICK(blend_time) / samples);
+#else
+    VLC_UNUSED(name);
+#endif
+}
+
+static void TestKernels(void)
+{
+    TestKernel("C", corr_c, blend_c);
+#if defined(HAVE_SSE2_INTRINSICS) && defined(__SSE2__)
+    if (vlc_CPU_SSE2())
+        TestKernel("SSE2", corr_sse2, blend_sse2);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        TestKernel("AVX2", corr_avx2, blend_avx2);
+#endif
+#ifdef __ARM_NEON
+    if (vlc_CPU_ARM_NEON())
+        TestKernel("NEON", corr_neon, blend_neon);
+#endif
+}
+
+#define RATE       48000
+#define FREQ       440.
+#define AMPLITUDE  .5f
+#define BLOCK_FRAMES 1024
+#define SECONDS    20
+
+static const float rates[] = { .75f, 1.25f, 1.5f, 2.f };
+static const uint16_t layouts[] = {
+    AOUT_CHAN_CENTER, AOUT_CHANS_2_0, AOUT_CHANS_5_1,
+};
+
+static block_t *SineBlock(uint64_t *pos, unsigned channels)
+{
+    block_t *block = block_Alloc(BLOCK_FRAMES * channels * sizeof (float));
+    assert(block != NULL);
+
+    float *p = (float *)block->p_buffer;
+    for (size_t i = 0; i < BLOCK_FRAMES; i++, (*pos)++)
+        for (unsigned c = 0; c < channels; c++)
+            *p++ = AMPLITUDE * sin(2. * M_PI * FREQ * *pos / RATE + c * .3);
+    block->i_nb_samples = BLOCK_FRAMES;
+    return block;
+}
+
+struct check
+{
+    float prev;
+    float peak;             /* peak of the current period */
+    size_t frames;          /* output frames of the first channel */
+    size_t period_frames;   /* frames in the current period */
+    size_t crossings;
+};
+
+static void Check(struct check *check, const block_t *out, unsigned channels)
+{
+    /* the largest step between two samples of the sine, with some slack for
+     * the blending of two slightly misaligned strides */
+    const float max_step = 1.5f * 2.f * AMPLITUDE * sinf(M_PI * FREQ / RATE);
+    const size_t period = RATE / FREQ + 1;
+    const float *p = (const float *)out->p_buffer;
+
+    for (size_t i = 0; i < out->i_nb_samples; i++, p += channels)
+    {
+        const float s = p[0];
+        assert(isfinite(s) && fabsf(s) <= AMPLITUDE * 1.01f);
+
+        /* skip the first stride, blended from silence */
+        if (check->frames++ < RATE / 10)
+        {
+            check->prev = s;
+            continue;
+        }
+        assert(fabsf(s - check->prev) <= max_step);
+        if (check->prev < 0.f && s >= 0.f)
+            check->crossings++;
+
+        check->peak = fmaxf(check->peak, fabsf(s));
+        if (++check->period_frames == period)
+        {
+            assert(check->peak >= AMPLITUDE * .9f);
+            check->peak = 0.f;
+            check->period_frames = 0;
+        }
+        check->prev = s;
+    }
+}
+
+static void Test(vlc_object_t *obj, uint16_t layout, float rate)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, AUDIO_ES, VLC_CODEC_FL32);
+    filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
+    filter->fmt_in.audio.i_rate = RATE;
+    filter->fmt_in.audio.i_physical_channels = layout;
+    filter->fmt_in.audio.channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    aout_FormatPrepare(&filter->fmt_in.audio);
+    es_format_Copy(&filter->fmt_out, &filter->fmt_in);
+
+    module_t *module = vlc_filter_LoadModule(filter, "audio filter",
+                                             "scaletempo", true);
+    assert(module != NULL);
+
+    /* the output changes the input rate to play at another speed */
+    filter->fmt_in.audio.i_rate = lroundf(RATE * rate);
+
+    const unsigned channels = aout_FormatNbChannels(&filter->fmt_in.audio);
+    const size_t in_frames = (size_t)SECONDS * RATE / BLOCK_FRAMES
+                           * BLOCK_FRAMES;
+    struct check check = { 0 };
+    uint64_t pos = 0;
+    vlc_tick_t time = 0;
+
+    while (pos < in_frames)
+    {
+        block_t *in = SineBlock(&pos, channels);
+        vlc_tick_t start = vlc_tick_now();
+        block_t *out = filter->ops->filter_audio(filter, in);
+        time += vlc_tick_now() - start;
+        if (out == NULL)
+            continue;
+        Check(&check, out, channels);
+        block_Release(out);
+    }
+
+    /* the filter keeps up to a queue of input */
+    const double expected = in_frames / rate;
+    assert(fabs(check.frames - expected) <= RATE / 10 + BLOCK_FRAMES);
+    /* the pitch is preserved */
+    const double freq = check.crossings * (double)RATE
+                      / (check.frames - RATE / 10);
+    assert(fabs(freq - FREQ) <= FREQ * .01);
+
+#ifdef TEST_BENCH
+    printf("scaletempo %u ch, x%.2f: %6.0fx real-time\n", channels, rate,
+           expected / RATE / secf_from_vlc_tick(time ? time : 1));
+#else
+    VLC_UNUSED(time);
+#endif
+
+    vlc_filter_Delete(filter);
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    TestKernels();
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    for (size_t i = 0; i < ARRAY_SIZE(layouts); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(rates); j++)
+            Test(obj, layouts[i], rates[j]);
+
+    libvlc_release(vlc);
+    return 0;
+}
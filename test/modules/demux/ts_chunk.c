@@ -0,0 +1,273 @@
+/*****************************************************************************
+ * ts_chunk.c: MPEG TS batched packets reading tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Packets read one by one and in batches of several sizes must be the same.
+ * Built with TEST_BENCH, it also prints the packets read per second of each
+ * mode.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_stream.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../../modules/demux/mpeg/ts_packet.h"
+#include "../../../modules/demux/mpeg/ts_chunk.h"
+#include "../../../modules/demux/mpeg/ts_streamwrapper.h"
+
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define PACKETS 50000
+
+static void FillPackets(uint8_t *p, size_t i_count, unsigned i_packet_size,
+                        unsigned i_header_size)
+{
+    for(size_t i=0; i<i_count; i++)
+    {
+        uint8_t *pkt = &p[i * i_packet_size];
+        memset(pkt, 0xFF, i_packet_size);
+        SetDWBE(pkt, i); /* header or garbage in payload */
+        pkt += i_header_size;
+        pkt[0] = 0x47;
+        pkt[1] = (i % 31) >> 8;
+        pkt[2] = (i % 31);
+        pkt[3] = 0x10 | (i & 0x0F);
+        SetDWBE(&pkt[4], i);
+    }
+}
+
+static void CheckPacket(const block_t *p_pkt, size_t i,
+                        unsigned i_packet_size, unsigned i_header_size)
+{
+    assert(p_pkt->p_next == NULL);
+    assert(p_pkt->i_buffer == i_packet_size - i_header_size);
+    assert(p_pkt->p_buffer[0] == 0x47);
+    assert(p_pkt->p_buffer[2] == (i % 31));
+    assert((p_pkt->p_buffer[3] & 0x0F) == (i & 0x0F));
+    assert(GetDWBE(&p_pkt->p_buffer[4]) == i);
+}
+
+static vlc_tick_t ReadSingle(vlc_object_t *obj, uint8_t *p_data,
+                             size_t i_count, unsigned i_packet_size,
+                             unsigned i_header_size)
+{
+    stream_t *s = vlc_stream_MemoryNew(obj, p_data,
+                                       i_count * i_packet_size, true);
+    assert(s);
+
+    vlc_tick_t start = vlc_tick_now();
+
+    for(size_t i=0; i<i_count; i++)
+    {
+        block_t *p_pkt = vlc_stream_Block(s, i_packet_size);
+        assert(p_pkt);
+        p_pkt->p_buffer += i_header_size;
+        p_pkt->i_buffer -= i_header_size;
+        CheckPacket(p_pkt, i, i_packet_size, i_header_size);
+        block_Release(p_pkt);
+    }
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    assert(vlc_stream_Block(s, i_packet_size) == NULL);
+    vlc_stream_Delete(s);
+    return duration;
+}
+
+static vlc_tick_t ReadBatched(vlc_object_t *obj, uint8_t *p_data,
+                              size_t i_count, unsigned i_packet_size,
+                              unsigned i_header_size, unsigned i_batch)
+{
+    stream_t *s = vlc_stream_MemoryNew(obj, p_data,
+                                       i_count * i_packet_size, true);
+    assert(s);
+
+    vlc_tick_t start = vlc_tick_now();
+    size_t i = 0;
+    while(i < i_count)
+    {
+        unsigned i_chunk = 0;
+        block_t *p_chain = ts_chunk_Read(s, i_packet_size, i_header_size,
+                                         i_batch, &i_chunk);
+        assert(p_chain);
+        assert(i_chunk > 0 && i_chunk <= i_batch);
+        for(unsigned j=0; j<i_chunk; j++)
+        {
+            block_t *p_pkt = p_chain;
+            assert(p_pkt);
+            p_chain = p_pkt->p_next;
+            p_pkt->p_next = NULL;
+            CheckPacket(p_pkt, i++, i_packet_size, i_header_size);
+            block_Release(p_pkt);
+        }
+        assert(p_chain == NULL);
+    }
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    unsigned i_chunk = 0;
+    assert(ts_chunk_Read(s, i_packet_size, i_header_size,
+                         i_batch, &i_chunk) == NULL);
+    vlc_stream_Delete(s);
+    return duration;
+}
+
+static void TestRead(vlc_object_t *obj, unsigned i_packet_size, unsigned i_header_size)
+{
+    uint8_t *p_data = malloc(PACKETS * i_packet_size);
+    assert(p_data);
+    FillPackets(p_data, PACKETS, i_packet_size, i_header_size);
+
+    vlc_tick_t single = ReadSingle(obj, p_data, PACKETS,
+                                   i_packet_size, i_header_size);
+#ifdef TEST_BENCH
+    printf("packet size %u, single: %.0f packets/s\n", i_packet_size,
+           PACKETS / secf_from_vlc_tick(single ? single : 1));
+#else
+    VLC_UNUSED(single);
+#endif
+
+    static const unsigned batches[] = { 7, 64, 200, TS_CHUNK_MAX_PACKETS };
+    for(size_t i=0; i<ARRAY_SIZE(batches); i++)
+    {
+        vlc_tick_t batched = ReadBatched(obj, p_data, PACKETS, i_packet_size,
+                                         i_header_size, batches[i]);
+#ifdef TEST_BENCH
+        printf("packet size %u, batch %4u: %.0f packets/s\n",
+               i_packet_size, batches[i],
+               PACKETS / secf_from_vlc_tick(batched ? batched : 1));
+#else
+        VLC_UNUSED(batched);
+#endif
+    }
+
+    free(p_data);
+}
+
+/* Packets read ahead are fed again, in order, to a stream filter */
+static void TestUnread(vlc_object_t *obj, unsigned i_packet_size,
+                       unsigned i_header_size)
+{
+    uint8_t p_data[20 * TS_PACKET_SIZE_204];
+    FillPackets(p_data, 20, i_packet_size, i_header_size);
+
+    stream_t *s = vlc_stream_MemoryNew(obj, p_data, 20 * i_packet_size, true);
+    assert(s);
+
+    unsigned i_count = 0;
+    block_t *p_chain = ts_chunk_Read(s, i_packet_size, i_header_size,
+                                     8, &i_count);
+    assert(p_chain && i_count == 8);
+
+    /* 3 packets demuxed, 5 pending */
+    block_t *p_pending = p_chain->p_next->p_next->p_next;
+    p_chain->p_next->p_next->p_next = NULL;
+    block_ChainRelease(p_chain);
+
+    block_t *p_raw = ts_chunk_Unread(p_pending, i_packet_size, i_header_size);
+    assert(p_raw);
+    assert(p_raw->i_buffer == 5 * i_packet_size);
+    assert(!memcmp(p_raw->p_buffer, &p_data[3 * i_packet_size],
+                   5 * i_packet_size));
+
+    stream_t *wrapper = ts_stream_wrapper_New(s);
+    assert(wrapper);
+    ts_stream_wrapper_Prepend(wrapper, p_raw);
+
+    /* The pending packets, then the rest of the stream */
+    for(size_t i=3; i<20; i++)
+    {
+        block_t *p_pkt = vlc_stream_Block(wrapper, i_packet_size);
+        assert(p_pkt && p_pkt->i_buffer == i_packet_size);
+        p_pkt->p_buffer += i_header_size;
+        p_pkt->i_buffer -= i_header_size;
+        CheckPacket(p_pkt, i, i_packet_size, i_header_size);
+        block_Release(p_pkt);
+    }
+    assert(vlc_stream_Block(wrapper, i_packet_size) == NULL);
+
+    assert(ts_chunk_Unread(NULL, i_packet_size, i_header_size) == NULL);
+
+    vlc_stream_Delete(wrapper);
+    vlc_stream_Delete(s);
+}
+
+static void TestSyncLoss(vlc_object_t *obj)
+{
+    uint8_t p_data[10 * TS_PACKET_SIZE_188];
+    FillPackets(p_data, 10, TS_PACKET_SIZE_188, 0);
+    p_data[4 * TS_PACKET_SIZE_188] = 0x00;
+
+    stream_t *s = vlc_stream_MemoryNew(obj, p_data, sizeof(p_data), true);
+    assert(s);
+
+    /* Stops before the packet without sync */
+    unsigned i_count = 0;
+    block_t *p_chain = ts_chunk_Read(s, TS_PACKET_SIZE_188, 0, 100, &i_count);
+    assert(p_chain);
+    assert(i_count == 4);
+    assert(vlc_stream_Tell(s) == 4 * TS_PACKET_SIZE_188);
+
+    /* Shared buffer outlives the first released packets */
+    block_t *p_last = p_chain->p_next->p_next->p_next;
+    assert(p_last->p_next == NULL);
+    p_chain->p_next->p_next->p_next = NULL;
+    block_ChainRelease(p_chain);
+    CheckPacket(p_last, 3, TS_PACKET_SIZE_188, 0);
+    block_Release(p_last);
+
+    assert(ts_chunk_Read(s, TS_PACKET_SIZE_188, 0, 100, &i_count) == NULL);
+    assert(vlc_stream_Tell(s) == 4 * TS_PACKET_SIZE_188);
+
+    /* Partial trailing packet is left to the caller */
+    assert(vlc_stream_Seek(s, 9 * TS_PACKET_SIZE_188 + 1) == VLC_SUCCESS);
+    assert(ts_chunk_Read(s, TS_PACKET_SIZE_188, 0, 100, &i_count) == NULL);
+
+    vlc_stream_Delete(s);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    TestSyncLoss(obj);
+
+    TestRead(obj, TS_PACKET_SIZE_188, 0);
+    TestRead(obj, TS_PACKET_SIZE_192, 4);
+    TestRead(obj, TS_PACKET_SIZE_204, 0);
+
+    TestUnread(obj, TS_PACKET_SIZE_188, 0);
+    TestUnread(obj, TS_PACKET_SIZE_192, 4);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,598 @@
+/*****************************************************************************
+ * ts_threads.c: MPEG TS demux PES gathering threads test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * A two programs stream is demuxed on the input thread, then with the PES
+ * gathered on several threads. Both runs must output the same blocks on each
+ * ES, and the same blocks must have been sent before each PCR of a program.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+#include <vlc_threads.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define FRAMES      300
+#define FRAME_TICKS 3600 /* 90 kHz */
+#define PSI_PERIOD  10 /* frames */
+
+#define PAT_PID     0x00
+#define PROGRAMS    2
+#define STREAMS     (PROGRAMS * 2)
+
+static const struct
+{
+    uint16_t i_number;
+    uint16_t i_pmt_pid;
+    uint16_t pi_pid[2]; /* video carrying the PCR, then audio */
+} programs[PROGRAMS] = {
+    { 1, 0x20, { 0x100, 0x101 } },
+    { 2, 0x21, { 0x200, 0x201 } },
+};
+
+/*
+ * Stream writer
+ */
+struct ts_writer
+{
+    uint8_t *p_data;
+    size_t i_size;
+    size_t i_alloc;
+    uint8_t cc[0x2000];
+};
+
+static uint8_t *NewPacket(struct ts_writer *w)
+{
+    if (w->i_size + 188 > w->i_alloc)
+    {
+        w->i_alloc = w->i_alloc ? w->i_alloc * 2 : 188 * 1024;
+        w->p_data = realloc(w->p_data, w->i_alloc);
+        assert(w->p_data);
+    }
+    uint8_t *pkt = &w->p_data[w->i_size];
+    w->i_size += 188;
+    return pkt;
+}
+
+/* Writes a packet, stuffed through its adaptation field, and returns the
+ * number of payload bytes written */
+static size_t WritePacket(struct ts_writer *w, uint16_t i_pid, bool b_start,
+                          int64_t i_pcr, const uint8_t *p_payload,
+                          size_t i_payload)
+{
+    uint8_t *pkt = NewPacket(w);
+    size_t i_header = 4;
+
+    pkt[0] = 0x47;
+    pkt[1] = (b_start ? 0x40 : 0x00) | (i_pid >> 8);
+    pkt[2] = i_pid & 0xff;
+    pkt[3] = 0x10 | (w->cc[i_pid]++ & 0x0f);
+
+    size_t i_adaptation = i_pcr >= 0 ? 8 : 0;
+    if (i_payload < 184 - i_adaptation)
+    {
+        if (i_adaptation == 0)
+            i_adaptation = 1;
+        i_adaptation = __MAX(i_adaptation, 184 - i_payload);
+    }
+    else
+        i_payload = 184 - i_adaptation;
+
+    if (i_adaptation > 0)
+    {
+        pkt[3] |= 0x20;
+        pkt[4] = i_adaptation - 1;
+        if (i_adaptation > 1)
+        {
+            memset(&pkt[5], 0xff, i_adaptation - 1);
+            pkt[5] = 0x00;
+        }
+        if (i_pcr >= 0)
+        {
+            pkt[5] = 0x10;
+            pkt[6] = i_pcr >> 25;
+            pkt[7] = i_pcr >> 17;
+            pkt[8] = i_pcr >> 9;
+            pkt[9] = i_pcr >> 1;
+            pkt[10] = ((i_pcr & 1) << 7) | 0x7e;
+            pkt[11] = 0x00;
+        }
+        i_header += i_adaptation;
+    }
+
+    memcpy(&pkt[i_header], p_payload, i_payload);
+    return i_payload;
+}
+
+static uint32_t Crc32(const uint8_t *p, size_t i_size)
+{
+    uint32_t i_crc = 0xffffffff;
+
+    for (size_t i = 0; i < i_size; i++)
+    {
+        i_crc ^= (uint32_t)p[i] << 24;
+        for (int j = 0; j < 8; j++)
+            i_crc = (i_crc & 0x80000000) ? (i_crc << 1) ^ 0x04c11db7
+                                         : (i_crc << 1);
+    }
+    return i_crc;
+}
+
+static void WriteSection(struct ts_writer *w, uint16_t i_pid,
+                         uint8_t *p_section, size_t i_size)
+{
+    /* section_length covers the CRC */
+    SetWBE(&p_section[1], 0xb000 | (i_size + 4 - 3));
+    SetDWBE(&p_section[i_size], Crc32(p_section, i_size));
+
+    uint8_t payload[184];
+    memset(payload, 0xff, sizeof(payload));
+    payload[0] = 0x00; /* pointer_field */
+    memcpy(&payload[1], p_section, i_size + 4);
+    WritePacket(w, i_pid, true, -1, payload, sizeof(payload));
+}
+
+static void WritePSI(struct ts_writer *w)
+{
+    uint8_t section[180];
+
+    /* PAT */
+    size_t i_size = 0;
+    section[i_size++] = 0x00;
+    i_size += 2; /* section_length */
+    SetWBE(&section[i_size], 1); /* transport_stream_id */
+    i_size += 2;
+    section[i_size++] = 0xc1; /* version 0, current */
+    section[i_size++] = 0;
+    section[i_size++] = 0;
+    for (size_t i = 0; i < PROGRAMS; i++)
+    {
+        SetWBE(&section[i_size], programs[i].i_number);
+        SetWBE(&section[i_size + 2], 0xe000 | programs[i].i_pmt_pid);
+        i_size += 4;
+    }
+    WriteSection(w, PAT_PID, section, i_size);
+
+    /* PMT */
+    for (size_t i = 0; i < PROGRAMS; i++)
+    {
+        i_size = 0;
+        section[i_size++] = 0x02;
+        i_size += 2; /* section_length */
+        SetWBE(&section[i_size], programs[i].i_number);
+        i_size += 2;
+        section[i_size++] = 0xc1;
+        section[i_size++] = 0;
+        section[i_size++] = 0;
+        SetWBE(&section[i_size], 0xe000 | programs[i].pi_pid[0]); /* PCR */
+        SetWBE(&section[i_size + 2], 0xf000); /* program_info_length */
+        i_size += 4;
+
+        static const uint8_t stream_types[2] = { 0x02, 0x04 };
+        for (size_t j = 0; j < 2; j++)
+        {
+            section[i_size++] = stream_types[j];
+            SetWBE(&section[i_size], 0xe000 | programs[i].pi_pid[j]);
+            SetWBE(&section[i_size + 2], 0xf000); /* ES_info_length */
+            i_size += 4;
+        }
+        WriteSection(w, programs[i].i_pmt_pid, section, i_size);
+    }
+}
+
+static void SetTimestamp(uint8_t *p, uint8_t i_prefix, int64_t i_ts)
+{
+    p[0] = (i_prefix << 4) | ((i_ts >> 29) & 0x0e) | 0x01;
+    SetWBE(&p[1], ((i_ts >> 14) & 0xfffe) | 0x01);
+    SetWBE(&p[3], ((i_ts << 1) & 0xfffe) | 0x01);
+}
+
+/* Builds the PES of a frame, with a payload unique to the stream and frame */
+static size_t BuildPES(uint8_t *p_pes, unsigned i_stream, unsigned i_frame)
+{
+    const bool b_video = (i_stream & 1) == 0;
+    const int64_t i_dts = 90000 + (int64_t)i_frame * FRAME_TICKS;
+    /* Video frames of varying sizes spanning many packets */
+    const size_t i_payload = b_video ? 600 + (i_frame * 397 + i_stream) % 6000
+                                     : 200 + (i_frame * 13) % 300;
+
+    p_pes[0] = 0x00;
+    p_pes[1] = 0x00;
+    p_pes[2] = 0x01;
+    p_pes[3] = b_video ? 0xe0 : 0xc0;
+    SetWBE(&p_pes[4], 3 + 10 + i_payload);
+    p_pes[6] = 0x80;
+    p_pes[7] = 0xc0; /* PTS and DTS */
+    p_pes[8] = 10;
+    SetTimestamp(&p_pes[9], 0x3, i_dts + (b_video ? 2 * FRAME_TICKS
+                                                  : FRAME_TICKS));
+    SetTimestamp(&p_pes[14], 0x1, i_dts + FRAME_TICKS);
+
+    uint8_t *p_payload = &p_pes[19];
+    for (size_t i = 0; i < i_payload; i++)
+        p_payload[i] = i_stream * 59 + i_frame * 7 + i;
+    return 19 + i_payload;
+}
+
+static uint8_t *BuildStream(size_t *pi_size)
+{
+    struct ts_writer w = { .p_data = NULL };
+    uint8_t pes[STREAMS][6700];
+    size_t pi_pes[STREAMS], pi_done[STREAMS];
+
+    for (unsigned i_frame = 0; i_frame < FRAMES; i_frame++)
+    {
+        if (i_frame % PSI_PERIOD == 0)
+            WritePSI(&w);
+
+        for (unsigned i = 0; i < STREAMS; i++)
+        {
+            pi_pes[i] = BuildPES(pes[i], i, i_frame);
+            pi_done[i] = 0;
+        }
+
+        /* Interleave the packets of all the streams */
+        for (bool b_pending = true; b_pending; )
+        {
+            b_pending = false;
+            for (unsigned i = 0; i < STREAMS; i++)
+            {
+                if (pi_done[i] == pi_pes[i])
+                    continue;
+
+                const uint16_t i_pid = programs[i / 2].pi_pid[i % 2];
+                const bool b_start = pi_done[i] == 0;
+                /* The PCR leads the timestamps of its program */
+                const int64_t i_pcr = (b_start && i % 2 == 0)
+                                    ? 90000 + (int64_t)i_frame * FRAME_TICKS
+                                    : -1;
+                pi_done[i] += WritePacket(&w, i_pid, b_start, i_pcr,
+                                          &pes[i][pi_done[i]],
+                                          pi_pes[i] - pi_done[i]);
+                b_pending = true;
+            }
+        }
+    }
+
+    *pi_size = w.i_size;
+    return w.p_data;
+}
+
+/*
+ * Recording es_out, called from the demux and the gathering threads
+ */
+#define MAX_ES     8
+#define MAX_BLOCKS (FRAMES + 16)
+#define MAX_PCRS   (FRAMES + 16)
+
+struct rec_block
+{
+    size_t i_size;
+    uint32_t i_hash;
+    vlc_tick_t i_dts;
+    vlc_tick_t i_pts;
+};
+
+struct rec_es
+{
+    int i_group;
+    int i_id;
+    size_t i_blocks;
+    struct rec_block blocks[MAX_BLOCKS];
+};
+
+struct rec_pcr
+{
+    vlc_tick_t i_pcr;
+    size_t pi_sent[MAX_ES]; /* blocks sent on each ES of the group */
+};
+
+struct rec_group
+{
+    int i_group;
+    size_t i_pcrs;
+    struct rec_pcr pcrs[MAX_PCRS];
+};
+
+struct recorder
+{
+    es_out_t out;
+    vlc_mutex_t lock;
+    size_t i_es;
+    struct rec_es es[MAX_ES];
+    size_t i_groups;
+    struct rec_group groups[PROGRAMS];
+};
+
+static uint32_t Hash(const uint8_t *p, size_t i_size)
+{
+    uint32_t i_hash = 2166136261u;
+
+    for (size_t i = 0; i < i_size; i++)
+        i_hash = (i_hash ^ p[i]) * 16777619u;
+    return i_hash;
+}
+
+static es_out_id_t *rec_Add(es_out_t *out, input_source_t *in,
+                            const es_format_t *fmt)
+{
+    struct recorder *rec = container_of(out, struct recorder, out);
+    VLC_UNUSED(in);
+
+    vlc_mutex_lock(&rec->lock);
+    for (size_t i = 0; i < rec->i_es; i++)
+        assert(rec->es[i].i_group != fmt->i_group ||
+               rec->es[i].i_id != fmt->i_id);
+    assert(rec->i_es < MAX_ES);
+
+    struct rec_es *es = &rec->es[rec->i_es++];
+    es->i_group = fmt->i_group;
+    es->i_id = fmt->i_id;
+    es->i_blocks = 0;
+    vlc_mutex_unlock(&rec->lock);
+
+    return (es_out_id_t *)es;
+}
+
+static int rec_Send(es_out_t *out, es_out_id_t *id, block_t *p_block)
+{
+    struct recorder *rec = container_of(out, struct recorder, out);
+    struct rec_es *es = (struct rec_es *)id;
+
+    vlc_mutex_lock(&rec->lock);
+    assert(es->i_blocks < MAX_BLOCKS);
+    es->blocks[es->i_blocks++] = (struct rec_block) {
+        .i_size = p_block->i_buffer,
+        .i_hash = Hash(p_block->p_buffer, p_block->i_buffer),
+        .i_dts = p_block->i_dts,
+        .i_pts = p_block->i_pts,
+    };
+    vlc_mutex_unlock(&rec->lock);
+
+    block_Release(p_block);
+    return VLC_SUCCESS;
+}
+
+static void rec_Del(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out);
+    VLC_UNUSED(id);
+}
+
+static void rec_SetGroupPCR(struct recorder *rec, int i_group, vlc_tick_t i_pcr)
+{
+    struct rec_group *group = NULL;
+
+    for (size_t i = 0; i < rec->i_groups; i++)
+        if (rec->groups[i].i_group == i_group)
+            group = &rec->groups[i];
+    if (group == NULL)
+    {
+        assert(rec->i_groups < PROGRAMS);
+        group = &rec->groups[rec->i_groups++];
+        group->i_group = i_group;
+        group->i_pcrs = 0;
+    }
+
+    assert(group->i_pcrs < MAX_PCRS);
+    struct rec_pcr *pcr = &group->pcrs[group->i_pcrs++];
+    pcr->i_pcr = i_pcr;
+    for (size_t i = 0; i < MAX_ES; i++)
+        pcr->pi_sent[i] = (i < rec->i_es && rec->es[i].i_group == i_group)
+                        ? rec->es[i].i_blocks : 0;
+}
+
+static int rec_Control(es_out_t *out, input_source_t *in, int i_query,
+                       va_list args)
+{
+    struct recorder *rec = container_of(out, struct recorder, out);
+    VLC_UNUSED(in);
+
+    switch (i_query)
+    {
+        case ES_OUT_SET_GROUP_PCR:
+        {
+            int i_group = va_arg(args, int);
+            vlc_tick_t i_pcr = va_arg(args, vlc_tick_t);
+
+            vlc_mutex_lock(&rec->lock);
+            rec_SetGroupPCR(rec, i_group, i_pcr);
+            vlc_mutex_unlock(&rec->lock);
+            return VLC_SUCCESS;
+        }
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void rec_Destroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks rec_cbs =
+{
+    .add = rec_Add,
+    .send = rec_Send,
+    .del = rec_Del,
+    .control = rec_Control,
+    .destroy = rec_Destroy,
+};
+
+static int Run(vlc_object_t *obj, const uint8_t *p_data, size_t i_size,
+               int64_t i_threads, struct recorder *rec)
+{
+    rec->out.cbs = &rec_cbs;
+    vlc_mutex_init(&rec->lock);
+    rec->i_es = 0;
+    rec->i_groups = 0;
+
+    var_SetInteger(obj, "ts-threads", i_threads);
+
+    stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *)p_data, i_size, true);
+    assert(s);
+
+    demux_t *demux = demux_New(obj, "ts", "test://", s, &rec->out);
+    if (demux == NULL)
+    {
+        vlc_stream_Delete(s);
+        return VLC_EGENERIC;
+    }
+
+    assert(demux_Control(demux, DEMUX_SET_GROUP_ALL) == VLC_SUCCESS);
+    while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+
+    demux_Delete(demux);
+    vlc_stream_Delete(s);
+    return VLC_SUCCESS;
+}
+
+static const struct rec_es *FindES(const struct recorder *rec,
+                                   int i_group, int i_id, size_t *pi_index)
+{
+    for (size_t i = 0; i < rec->i_es; i++)
+        if (rec->es[i].i_group == i_group && rec->es[i].i_id == i_id)
+        {
+            *pi_index = i;
+            return &rec->es[i];
+        }
+    return NULL;
+}
+
+static void Compare(const struct recorder *ref, const struct recorder *rec)
+{
+    size_t pi_map[MAX_ES];
+
+    /* Same blocks on each ES */
+    assert(rec->i_es == ref->i_es);
+    for (size_t i = 0; i < ref->i_es; i++)
+    {
+        const struct rec_es *a = &ref->es[i];
+        const struct rec_es *b = FindES(rec, a->i_group, a->i_id, &pi_map[i]);
+
+        assert(b != NULL);
+        assert(b->i_blocks == a->i_blocks);
+        for (size_t j = 0; j < a->i_blocks; j++)
+        {
+            assert(b->blocks[j].i_size == a->blocks[j].i_size);
+            assert(b->blocks[j].i_hash == a->blocks[j].i_hash);
+            assert(b->blocks[j].i_dts == a->blocks[j].i_dts);
+            assert(b->blocks[j].i_pts == a->blocks[j].i_pts);
+        }
+    }
+
+    /* Same PCR on each program, after the same blocks */
+    assert(rec->i_groups == ref->i_groups);
+    for (size_t i = 0; i < ref->i_groups; i++)
+    {
+        const struct rec_group *a = &ref->groups[i];
+        const struct rec_group *b = NULL;
+
+        for (size_t j = 0; j < rec->i_groups; j++)
+            if (rec->groups[j].i_group == a->i_group)
+                b = &rec->groups[j];
+        assert(b != NULL);
+        assert(b->i_pcrs == a->i_pcrs);
+
+        for (size_t j = 0; j < a->i_pcrs; j++)
+        {
+            assert(b->pcrs[j].i_pcr == a->pcrs[j].i_pcr);
+            for (size_t k = 0; k < ref->i_es; k++)
+                assert(b->pcrs[j].pi_sent[pi_map[k]] ==
+                       a->pcrs[j].pi_sent[k]);
+        }
+    }
+}
+
+static void CheckReference(const struct recorder *ref)
+{
+    /* Every ES was output, and the PCR of both programs was set */
+    assert(ref->i_es == STREAMS);
+    for (size_t i = 0; i < ref->i_es; i++)
+        assert(ref->es[i].i_blocks >= FRAMES - 2);
+    assert(ref->i_groups == PROGRAMS);
+    for (size_t i = 0; i < ref->i_groups; i++)
+    {
+        assert(ref->groups[i].i_pcrs >= FRAMES / 2);
+        for (size_t j = 1; j < ref->groups[i].i_pcrs; j++)
+            assert(ref->groups[i].pcrs[j].i_pcr >=
+                   ref->groups[i].pcrs[j - 1].i_pcr);
+    }
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    size_t i_size;
+    uint8_t *p_data = BuildStream(&i_size);
+
+    var_Create(obj, "ts-threads", VLC_VAR_INTEGER);
+
+    struct recorder *ref = malloc(sizeof(*ref));
+    struct recorder *rec = malloc(sizeof(*rec));
+    assert(ref && rec);
+
+    /* The TS demux needs libdvbpsi */
+    if (Run(obj, p_data, i_size, 0, ref) != VLC_SUCCESS)
+    {
+        free(rec);
+        free(ref);
+        free(p_data);
+        libvlc_release(vlc);
+        return 77;
+    }
+    CheckReference(ref);
+
+    static const int64_t threads[] = { 1, 2, 3, 8 };
+    for (size_t i = 0; i < ARRAY_SIZE(threads); i++)
+    {
+        assert(Run(obj, p_data, i_size, threads[i], rec) == VLC_SUCCESS);
+        Compare(ref, rec);
+    }
+
+    free(rec);
+    free(ref);
+    free(p_data);
+    libvlc_release(vlc);
+    return 0;
+}
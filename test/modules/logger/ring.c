@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * ring.c: ring buffer tracer tests and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_tracer.h>
+#include <vlc_fs.h>
+#include <vlc_memstream.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define TRACE_FILE "test_modules_logger_ring.json"
+#define RING_SIZE 16
+
+static void *TraceThread(void *data)
+{
+    struct vlc_tracer *tracer = data;
+
+    for (int64_t i = 0; i < 3 * RING_SIZE; i++)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "VIDEO"),
+                                 VLC_TRACE("id", "thread"),
+                                 VLC_TRACE("index", i),
+                                 VLC_TRACE_END);
+    return NULL;
+}
+
+static size_t CountOccurrences(const char *str, const char *pattern)
+{
+    size_t count = 0;
+
+    while ((str = strstr(str, pattern)) != NULL)
+    {
+        count++;
+        str += strlen(pattern);
+    }
+    return count;
+}
+
+static char *ReadFile(const char *path)
+{
+    FILE *stream = vlc_fopen(path, "rt");
+    assert(stream != NULL);
+
+    struct vlc_memstream ms;
+    vlc_memstream_open(&ms);
+    char buf[4096];
+    size_t len;
+    while ((len = fread(buf, 1, sizeof (buf), stream)) > 0)
+        vlc_memstream_write(&ms, buf, len);
+    fclose(stream);
+    assert(vlc_memstream_close(&ms) == 0);
+    return ms.ptr;
+}
+
+static void test_export(vlc_object_t *obj)
+{
+    struct vlc_tracer *tracer = vlc_tracer_Create(obj, "ring");
+    assert(tracer != NULL);
+
+    vlc_tracer_TraceEvent(tracer, "RENDER", "main", "flush");
+    vlc_tracer_TracePCR(tracer, "DEMUX", "main", VLC_TICK_FROM_MS(40));
+    vlc_tracer_Trace(tracer, VLC_TRACE("type", "\"quoted\"\n"),
+                             VLC_TRACE("very long key name to be truncated",
+                                       "a very long value that does not fit"),
+                             VLC_TRACE("ratio", 0.5),
+                             VLC_TRACE_END);
+    vlc_tracer_TraceSpanBegin(tracer, "DEC", "video/0", "decode",
+                              VLC_TICK_FROM_MS(40));
+    vlc_tracer_TraceSpanEnd(tracer, "DEC", "video/0", "decode",
+                            VLC_TICK_FROM_MS(40));
+
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, TraceThread, tracer);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+
+    vlc_tracer_Destroy(tracer);
+
+    char *json = ReadFile(TRACE_FILE);
+    assert(!strncmp(json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39));
+
+    /* Only the last records of the thread are kept */
+    assert(CountOccurrences(json, "\"ph\":") == 5 + RING_SIZE);
+    assert(CountOccurrences(json, "\"id\":\"thread\"") == RING_SIZE);
+    assert(strstr(json, "\"index\":47}") != NULL);
+    assert(strstr(json, "\"index\":31}") == NULL);
+
+    assert(strstr(json, "{\"name\":\"flush\",\"cat\":\"RENDER\"") != NULL);
+    assert(strstr(json, "\"pcr\":40000000") != NULL);
+    assert(strstr(json, "\"cat\":\"\\\"quoted\\\"\\u000a\"") != NULL);
+    assert(strstr(json, "\"very long key n\":\"a very long value that \"")
+           != NULL);
+    assert(strstr(json, "\"ratio\":0.5") != NULL);
+
+    /* Spans are matched by stream id and timestamp */
+    assert(strstr(json, "{\"name\":\"decode\",\"cat\":\"DEC\","
+                        "\"id\":\"video/0/40000000\",\"ph\":\"b\"") != NULL);
+    assert(strstr(json, "{\"name\":\"decode\",\"cat\":\"DEC\","
+                        "\"id\":\"video/0/40000000\",\"ph\":\"e\"") != NULL);
+    free(json);
+}
+
+static void *ShortThread(void *data)
+{
+    struct vlc_tracer *tracer = data;
+
+    for (int64_t i = 0; i < RING_SIZE / 2; i++)
+        vlc_tracer_Trace(tracer, VLC_TRACE("type", "VIDEO"),
+                                 VLC_TRACE("id", "short"),
+                                 VLC_TRACE("index", i),
+                                 VLC_TRACE_END);
+    return NULL;
+}
+
+static void test_exited_threads(vlc_object_t *obj)
+{
+    struct vlc_tracer *tracer = vlc_tracer_Create(obj, "ring");
+    assert(tracer != NULL);
+
+    for (int i = 0; i < 20; i++)
+    {
+        vlc_thread_t th;
+        int ret = vlc_clone(&th, ShortThread, tracer);
+        assert(ret == 0);
+        vlc_join(th, NULL);
+    }
+
+    vlc_tracer_Destroy(tracer);
+
+    /* Each thread took over the ring of the previous one: only the records
+     * of the last two threads are left */
+    char *json = ReadFile(TRACE_FILE);
+    assert(CountOccurrences(json, "\"id\":\"short\"") == RING_SIZE);
+    free(json);
+}
+
+int main(void)
+{
+    test_init();
+
+    static const char *args[] = {
+        "--ring-tracer-file="TRACE_FILE,
+        "--ring-tracer-size=16",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    test_export(obj);
+    test_exited_threads(obj);
+
+    remove(TRACE_FILE);
+    libvlc_release(vlc);
+    return 0;
+}
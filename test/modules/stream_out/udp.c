@@ -0,0 +1,270 @@
+/*****************************************************************************
+ * udp.c: test of the paced UDP stream output
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * SECONDS of a constant rate elementary stream are sent to the TS muxer as
+ * fast as possible. The received TS packets must be continuous, and carry
+ * the whole stream. Paced, no datagram may be received much earlier than
+ * its PCR, relative to the first datagram.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <poll.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+#include <vlc_network.h>
+#include <vlc_sout.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define SECONDS     2
+#define FRAME_SIZE  1500
+#define FRAME_RATE  250 /* 3 Mbit/s */
+#define FRAMES      (SECONDS * FRAME_RATE)
+
+static int fd;
+static struct
+{
+    int cc[8192]; /* last continuity counter per PID, -1 if none yet */
+    int es_pid;
+    size_t es_bytes; /* elementary stream bytes received */
+    vlc_tick_t first_date; /* reception date of the first datagram */
+    vlc_tick_t first_pcr;
+    vlc_tick_t earliness; /* largest advance of a PCR on the first datagram */
+} recv_log;
+
+static void CheckPayload(unsigned pid, bool start, const uint8_t *p,
+                         size_t len)
+{
+    if (start && len >= 9 && p[0] == 0 && p[1] == 0 && p[2] == 1
+     && p[3] == 0xc0)
+    {
+        /* PES header of the only elementary stream */
+        assert(recv_log.es_pid == -1 || recv_log.es_pid == (int)pid);
+        recv_log.es_pid = pid;
+        assert(len >= 9u + p[8]);
+        len -= 9 + p[8];
+        p += 9 + p[8];
+    }
+    else if (recv_log.es_pid != (int)pid)
+        return;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        size_t frame = recv_log.es_bytes++ / FRAME_SIZE;
+
+        assert(frame < FRAMES);
+        assert(p[i] == (uint8_t)frame);
+    }
+}
+
+/* Checks a TS packet and returns its PCR, if any */
+static vlc_tick_t CheckPacket(const uint8_t *p)
+{
+    vlc_tick_t pcr = VLC_TICK_INVALID;
+    unsigned pid = ((p[1] & 0x1f) << 8) | p[2];
+    unsigned afc = (p[3] >> 4) & 3;
+    size_t offset = 4;
+
+    assert(p[0] == 0x47);
+    assert(afc != 0);
+    if (pid == 0x1fff)
+        return VLC_TICK_INVALID;
+
+    if (afc & 2)
+    {
+        assert(p[4] <= 183);
+        if (p[4] >= 7 && (p[5] & 0x10))
+        {
+            uint64_t base = ((uint64_t)p[6] << 25) | (p[7] << 17)
+                          | (p[8] << 9) | (p[9] << 1) | (p[10] >> 7);
+            pcr = vlc_tick_from_samples(base, 90000);
+        }
+        offset += 1 + p[4];
+    }
+
+    if (afc & 1)
+    {
+        /* No datagram may be lost, nor reordered */
+        int cc = p[3] & 0xf;
+
+        assert(recv_log.cc[pid] == -1 || cc == ((recv_log.cc[pid] + 1) & 0xf));
+        recv_log.cc[pid] = cc;
+        CheckPayload(pid, p[1] & 0x40, p + offset, 188 - offset);
+    }
+    return pcr;
+}
+
+static void *Recv(void *data)
+{
+    uint8_t buf[65536];
+    (void) data;
+
+    for (;;)
+    {
+        struct pollfd ufd = { .fd = fd, .events = POLLIN };
+
+        /* the output is over after a second without datagrams */
+        if (poll(&ufd, 1, 1000) <= 0)
+            break;
+
+        ssize_t val = recv(fd, buf, sizeof (buf), 0);
+        vlc_tick_t now = vlc_tick_now();
+
+        assert(val > 0 && val % 188 == 0);
+        if (recv_log.first_date == VLC_TICK_INVALID)
+            recv_log.first_date = now;
+
+        for (ssize_t i = 0; i < val; i += 188)
+        {
+            vlc_tick_t pcr = CheckPacket(buf + i);
+
+            if (pcr == VLC_TICK_INVALID)
+                continue;
+            if (recv_log.first_pcr == VLC_TICK_INVALID)
+                recv_log.first_pcr = pcr;
+
+            vlc_tick_t early = (pcr - recv_log.first_pcr)
+                             - (now - recv_log.first_date);
+            recv_log.earliness = __MAX(recv_log.earliness, early);
+        }
+    }
+    return NULL;
+}
+
+/* Returns how much earlier than its PCR a datagram was received, at most */
+static vlc_tick_t Run(vlc_object_t *obj, unsigned port, unsigned caching)
+{
+    char chain[64];
+    sprintf(chain, "udp{dst=127.0.0.1:%u,caching=%u}", port, caching);
+
+    for (size_t i = 0; i < ARRAY_SIZE(recv_log.cc); i++)
+        recv_log.cc[i] = -1;
+    recv_log.es_pid = -1;
+    recv_log.es_bytes = 0;
+    recv_log.first_date = recv_log.first_pcr = VLC_TICK_INVALID;
+    recv_log.earliness = 0;
+
+    vlc_thread_t thread;
+    int ret = vlc_clone(&thread, Recv, NULL);
+    assert(ret == 0);
+
+    sout_stream_t *stream = sout_StreamChainNew(obj, chain, NULL);
+    assert(stream != NULL);
+
+    es_format_t fmt;
+    es_format_Init(&fmt, AUDIO_ES, VLC_CODEC_MPGA);
+    fmt.audio.i_rate = 48000;
+    fmt.audio.i_channels = 2;
+    fmt.i_bitrate = FRAME_SIZE * FRAME_RATE * 8;
+
+    void *id = sout_StreamIdAdd(stream, &fmt, "0");
+    assert(id != NULL);
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        block_t *block = block_Alloc(FRAME_SIZE);
+        assert(block != NULL);
+        memset(block->p_buffer, i, FRAME_SIZE);
+        block->i_dts = block->i_pts = VLC_TICK_0 + i * CLOCK_FREQ / FRAME_RATE;
+        block->i_length = CLOCK_FREQ / FRAME_RATE;
+        sout_StreamIdSend(stream, id, block);
+    }
+    sout_StreamIdDel(stream, id);
+    sout_StreamChainDelete(stream, NULL);
+    vlc_join(thread, NULL);
+
+    /* The whole stream was received, but for the end still buffered by the
+     * muxer when deleted */
+    assert(recv_log.es_pid != -1);
+    assert(recv_log.es_bytes >= (FRAMES - FRAME_RATE / 2) * FRAME_SIZE);
+    assert(recv_log.first_pcr != VLC_TICK_INVALID);
+    return recv_log.earliness;
+}
+int main(void)
+{
+    test_init();
+
+#ifndef ENABLE_SOUT
+    return 77;
+#endif
+
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd == -1)
+        return 77;
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addrlen = sizeof (addr);
+    int bufsize = 8 << 20;
+
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof (bufsize));
+    if (bind(fd, (struct sockaddr *)&addr, sizeof (addr))
+     || getsockname(fd, (struct sockaddr *)&addr, &addrlen))
+    {
+        net_Close(fd);
+        return 77;
+    }
+
+    const char * const args[] = {
+        "-v",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    unsigned port = ntohs(addr.sin_port);
+
+    /* The TS muxer needs libdvbpsi */
+    sout_stream_t *probe = sout_StreamChainNew(obj, "udp{dst=127.0.0.1:9}",
+                                               NULL);
+    if (probe == NULL)
+    {
+        libvlc_release(vlc);
+        net_Close(fd);
+        return 77;
+    }
+    sout_StreamChainDelete(probe, NULL);
+
+    /* Paced, a datagram may be early by the lateness of the first one, which
+     * is less than the caching, or the pacing would resynchronize */
+    vlc_tick_t early = Run(obj, port, 200);
+    assert(early < VLC_TICK_FROM_MS(200 + 300));
+    Run(obj, port, 0);
+
+    libvlc_release(vlc);
+    net_Close(fd);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*****************************************************************************
+ * lru.c: freetype LRU cache test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The glyph bitmaps and the shaped runs caches are LRUs bounded by entry
+ * count and by memory. Lookups must hit the inserted values and refresh
+ * them, and the least recently used entries must be released first, as soon
+ * as either bound is reached, but never the entry just inserted.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+
+#include <vlc_common.h>
+#include "../../../modules/text_renderer/freetype/lru.h"
+
+const char vlc_module_name[] = "lru";
+
+#define ENTRIES 16
+
+static unsigned released[ENTRIES + 1];
+
+static void Release(void *priv, void *value)
+{
+    assert(priv == released);
+    released[(uintptr_t)value]++;
+}
+
+static void *Value(unsigned i)
+{
+    return (void *)(uintptr_t)i;
+}
+
+static const char *Key(unsigned i)
+{
+    static char key[16];
+    snprintf(key, sizeof (key), "glyph#%u", i);
+    return key;
+}
+
+static void Reset(void)
+{
+    memset(released, 0, sizeof (released));
+}
+
+static void TestCount(void)
+{
+    vlc_lru *lru = vlc_lru_New(ENTRIES, Release, released);
+    assert(lru != NULL);
+    Reset();
+
+    for (unsigned i = 1; i < ENTRIES; i++)
+    {
+        assert(vlc_lru_Get(lru, Key(i)) == NULL);
+        vlc_lru_Insert(lru, Key(i), Value(i));
+    }
+
+    /* all hit, and 1 becomes the most recently used */
+    for (unsigned i = 1; i < ENTRIES; i++)
+        assert(vlc_lru_Get(lru, Key(i)) == Value(i));
+    assert(vlc_lru_Get(lru, Key(1)) == Value(1));
+
+    /* the count bound releases the least recently used, that is 2 */
+    vlc_lru_Insert(lru, Key(ENTRIES), Value(ENTRIES));
+    assert(released[2] == 1);
+    assert(!vlc_lru_HasKey(lru, Key(2)));
+    assert(vlc_lru_Get(lru, Key(2)) == NULL);
+    assert(vlc_lru_Get(lru, Key(1)) == Value(1));
+    assert(vlc_lru_Get(lru, Key(ENTRIES)) == Value(ENTRIES));
+    for (unsigned i = 1; i <= ENTRIES; i++)
+        assert(released[i] == (i == 2));
+
+    vlc_lru_Release(lru);
+    for (unsigned i = 1; i <= ENTRIES; i++)
+        assert(released[i] == 1);
+}
+
+static void TestSize(void)
+{
+    /* each entry also accounts for its key and bookkeeping */
+    const size_t size = 1000;
+    vlc_lru *lru = vlc_lru_New(ENTRIES * 2, Release, released);
+    assert(lru != NULL);
+    vlc_lru_SetMaxSize(lru, 4 * size + 3 * 100);
+    Reset();
+
+    for (unsigned i = 1; i <= 4; i++)
+        vlc_lru_InsertSized(lru, Key(i), Value(i), size);
+    for (unsigned i = 1; i <= 4; i++)
+        assert(vlc_lru_Get(lru, Key(i)) == Value(i));
+    for (unsigned i = 1; i <= ENTRIES; i++)
+        assert(released[i] == 0);
+
+    /* 1 is refreshed: the size bound releases 2 then 3 for a double entry */
+    assert(vlc_lru_Get(lru, Key(1)) == Value(1));
+    vlc_lru_InsertSized(lru, Key(5), Value(5), 2 * size);
+    assert(released[2] == 1 && released[3] == 1);
+    assert(vlc_lru_Get(lru, Key(1)) == Value(1));
+    assert(vlc_lru_Get(lru, Key(4)) == Value(4));
+    assert(vlc_lru_Get(lru, Key(5)) == Value(5));
+
+    /* an entry larger than the whole cache evicts all the others, but is
+     * kept until the next insertion */
+    vlc_lru_InsertSized(lru, Key(6), Value(6), 10 * size);
+    assert(released[1] == 1 && released[4] == 1 && released[5] == 1);
+    assert(vlc_lru_Get(lru, Key(6)) == Value(6));
+
+    vlc_lru_InsertSized(lru, Key(7), Value(7), size);
+    assert(released[6] == 1);
+    assert(vlc_lru_Get(lru, Key(7)) == Value(7));
+
+    vlc_lru_Release(lru);
+    for (unsigned i = 1; i <= 7; i++)
+        assert(released[i] == 1);
+}
+
+int main(void)
+{
+    TestCount();
+    TestSize();
+    return 0;
+}
@@ -0,0 +1,593 @@
+/*****************************************************************************
+ * bench.c: video converter and blending modules benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: test_modules_video_chroma_bench [-s WIDTHxHEIGHT]... [-n FRAMES]
+ *                                        [CASE]...
+ *
+ * where each CASE is "convert:MODULE:SRC:DST[:REF]" to run the "video
+ * converter" MODULE from the SRC to the DST chroma, or "blend:MODULE:SRC:DST"
+ * to blend a SRC picture onto a DST picture with the "video blending" MODULE.
+ * Without cases, a default set of the chroma and blend modules is run.
+ *
+ * A converter must give the same output as the REF converter module, usually
+ * the C version of a SIMD module, for the same seeded input. Without REF, the
+ * output is checked against the source samples when the chromas are 8-bit
+ * YUV ones. Blending is checked against a plain C reference. The program
+ * fails on any mismatch.
+ *
+ * Built with TEST_BENCH, as test_modules_video_chroma_bench, each case is
+ * then run FRAMES times and its speed is printed. The reported cycles are
+ * those of the time stamp counter, on x86 only. Otherwise, as run by "make
+ * check", FRAMES defaults to 0: the cases are only checked, silently.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_fourcc.h>
+#include <vlc_tick.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+# ifdef _MSC_VER
+#  include <intrin.h>
+# else
+#  include <x86intrin.h>
+# endif
+# define HAVE_TSC
+#endif
+
+#ifdef TEST_BENCH
+# define DEFAULT_FRAMES 10
+#else
+# define DEFAULT_FRAMES 0
+#endif
+
+static const char *const default_cases[] = {
+    "convert:yuy2_i420:YUY2:I420",
+    "convert:yuy2_i420:UYVY:I420",
+    "convert:yuy2_i420:YVYU:I420",
+    "convert:yuy2_i420_avx2:YUY2:I420:yuy2_i420",
+    "convert:yuy2_i420_avx2:UYVY:I420:yuy2_i420",
+    "convert:yuy2_i420_avx2:YVYU:I420:yuy2_i420",
+    "convert:yuy2_i422:YUY2:I422",
+    "convert:yuy2_i422:UYVY:I422",
+    "convert:yuy2_i422_avx2:YUY2:I422:yuy2_i422",
+    "convert:yuy2_i422_avx2:UYVY:I422:yuy2_i422",
+    "convert:i422_i420:I422:I420",
+    "convert:i422_i420:I422:YV12",
+    "convert:i420_nv12:I420:NV12",
+    "convert:i420_nv12:YV12:NV12",
+    "convert:i420_rgb:I420:RV32",
+    "blend:blend:YUVA:I420",
+    "blend:blend:YUVA:YV12",
+    "blend:blend:YUVA:NV12",
+    "blend:blend:YUVA:I422",
+    "blend:blend:YUVA:YUY2",
+    "blend:blend:YUVA:UYVY",
+    "blend:blend:RGBA:RGBA",
+    "blend:blend:RGBA:BGRA",
+    "blend:blend:RGBA:RGBX",
+    "blend:blend:RGBA:BGRX",
+};
+
+/* Location of an 8-bit sample in a picture */
+struct component
+{
+    int plane; /* -1 if the component does not exist */
+    unsigned offset; /* in bytes, from the start of the line */
+    unsigned step; /* in bytes, between two samples */
+    unsigned rx, ry; /* subsampling */
+};
+
+#define PLANAR(i, rx, ry) { i, 0, 1, rx, ry }
+#define PACKED(offset, step) { 0, offset, step, 1, 1 }
+#define NONE { -1, 0, 0, 1, 1 }
+
+static const struct
+{
+    vlc_fourcc_t chroma;
+    struct component c[4]; /* Y, U, V, A */
+} layouts[] = {
+    { VLC_CODEC_I420, { PLANAR(0, 1, 1), PLANAR(1, 2, 2), PLANAR(2, 2, 2), NONE } },
+    { VLC_CODEC_YV12, { PLANAR(0, 1, 1), PLANAR(2, 2, 2), PLANAR(1, 2, 2), NONE } },
+    { VLC_CODEC_I422, { PLANAR(0, 1, 1), PLANAR(1, 2, 1), PLANAR(2, 2, 1), NONE } },
+    { VLC_CODEC_I444, { PLANAR(0, 1, 1), PLANAR(1, 1, 1), PLANAR(2, 1, 1), NONE } },
+    { VLC_CODEC_I411, { PLANAR(0, 1, 1), PLANAR(1, 4, 1), PLANAR(2, 4, 1), NONE } },
+    { VLC_CODEC_I410, { PLANAR(0, 1, 1), PLANAR(1, 4, 4), PLANAR(2, 4, 4), NONE } },
+    { VLC_CODEC_YUVA, { PLANAR(0, 1, 1), PLANAR(1, 1, 1), PLANAR(2, 1, 1),
+                        PLANAR(3, 1, 1) } },
+    { VLC_CODEC_NV12, { PLANAR(0, 1, 1), { 1, 0, 2, 2, 2 }, { 1, 1, 2, 2, 2 }, NONE } },
+    { VLC_CODEC_NV21, { PLANAR(0, 1, 1), { 1, 1, 2, 2, 2 }, { 1, 0, 2, 2, 2 }, NONE } },
+    { VLC_CODEC_NV16, { PLANAR(0, 1, 1), { 1, 0, 2, 2, 1 }, { 1, 1, 2, 2, 1 }, NONE } },
+    { VLC_CODEC_YUYV, { { 0, 0, 2, 1, 1 }, { 0, 1, 4, 2, 1 }, { 0, 3, 4, 2, 1 }, NONE } },
+    { VLC_CODEC_YVYU, { { 0, 0, 2, 1, 1 }, { 0, 3, 4, 2, 1 }, { 0, 1, 4, 2, 1 }, NONE } },
+    { VLC_CODEC_UYVY, { { 0, 1, 2, 1, 1 }, { 0, 0, 4, 2, 1 }, { 0, 2, 4, 2, 1 }, NONE } },
+    { VLC_CODEC_VYUY, { { 0, 1, 2, 1, 1 }, { 0, 2, 4, 2, 1 }, { 0, 0, 4, 2, 1 }, NONE } },
+    /* R, G, B, A */
+    { VLC_CODEC_RGBA, { PACKED(0, 4), PACKED(1, 4), PACKED(2, 4), PACKED(3, 4) } },
+    { VLC_CODEC_ARGB, { PACKED(1, 4), PACKED(2, 4), PACKED(3, 4), PACKED(0, 4) } },
+    { VLC_CODEC_BGRA, { PACKED(2, 4), PACKED(1, 4), PACKED(0, 4), PACKED(3, 4) } },
+    { VLC_CODEC_ABGR, { PACKED(3, 4), PACKED(2, 4), PACKED(1, 4), PACKED(0, 4) } },
+    { VLC_CODEC_RGBX, { PACKED(0, 4), PACKED(1, 4), PACKED(2, 4), NONE } },
+    { VLC_CODEC_XRGB, { PACKED(1, 4), PACKED(2, 4), PACKED(3, 4), NONE } },
+    { VLC_CODEC_BGRX, { PACKED(2, 4), PACKED(1, 4), PACKED(0, 4), NONE } },
+    { VLC_CODEC_XBGR, { PACKED(3, 4), PACKED(2, 4), PACKED(1, 4), NONE } },
+};
+
+static const struct component *GetLayout(vlc_fourcc_t chroma)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(layouts); i++)
+        if (layouts[i].chroma == chroma)
+            return layouts[i].c;
+    return NULL;
+}
+
+static uint8_t *Sample(const picture_t *pic, const struct component *c,
+                       unsigned x, unsigned y)
+{
+    const plane_t *p = &pic->p[c->plane];
+    return &p->p_pixels[(y / c->ry) * p->i_pitch
+                        + (x / c->rx) * c->step + c->offset];
+}
+
+static bool IsFull(const struct component *c, unsigned x, unsigned y)
+{
+    return x % c->rx == 0 && y % c->ry == 0;
+}
+
+/* Checks that each sample of the converted picture either is one of the
+ * source samples it covers, or their rounded average: converters may pick
+ * any line or column when subsampling, or interpolate. */
+static bool CheckConvert(const picture_t *dst, const struct component *dl,
+                         const picture_t *src, const struct component *sl,
+                         unsigned width, unsigned height)
+{
+    for (unsigned i = 0; i < 3; i++)
+        for (unsigned y = 0; y < height; y += dl[i].ry)
+            for (unsigned x = 0; x < width; x += dl[i].rx)
+            {
+                const unsigned v = *Sample(dst, &dl[i], x, y);
+                unsigned sum = 0, count = 0;
+                bool found = false;
+
+                for (unsigned sy = y; sy < y + dl[i].ry && sy < height;
+                     sy += sl[i].ry)
+                    for (unsigned sx = x; sx < x + dl[i].rx && sx < width;
+                         sx += sl[i].rx)
+                    {
+                        const unsigned s = *Sample(src, &sl[i], sx, sy);
+                        found |= s == v;
+                        sum += s;
+                        count++;
+                    }
+
+                if (!found && v != (sum + count / 2) / count)
+                {
+                    fprintf(stderr, "component %u differs at %ux%u\n",
+                            i, x, y);
+                    return false;
+                }
+            }
+    return true;
+}
+
+/* Compares the visible lines of all the planes */
+static bool ComparePlanes(const picture_t *a, const picture_t *b)
+{
+    for (int i = 0; i < a->i_planes; i++)
+        for (int y = 0; y < a->p[i].i_visible_lines; y++)
+            if (memcmp(&a->p[i].p_pixels[y * a->p[i].i_pitch],
+                       &b->p[i].p_pixels[y * b->p[i].i_pitch],
+                       a->p[i].i_visible_pitch))
+            {
+                fprintf(stderr, "plane %d differs on line %d\n", i, y);
+                return false;
+            }
+    return true;
+}
+
+static bool Compare(const picture_t *a, const picture_t *b,
+                    const struct component *l, unsigned width, unsigned height)
+{
+    for (unsigned i = 0; i < 4 && l[i].plane >= 0; i++)
+        for (unsigned y = 0; y < height; y += l[i].ry)
+            for (unsigned x = 0; x < width; x += l[i].rx)
+                if (*Sample(a, &l[i], x, y) != *Sample(b, &l[i], x, y))
+                {
+                    fprintf(stderr, "component %u differs at %ux%u\n",
+                            i, x, y);
+                    return false;
+                }
+    return true;
+}
+
+static unsigned div255(unsigned v)
+{
+    return ((v >> 8) + v + 1) >> 8;
+}
+
+static void Merge(uint8_t *d, unsigned s, unsigned a)
+{
+    *d = div255((255 - a) * *d + s * a);
+}
+
+/* Blends a YUVA or RGBA picture at (x0, y0), merging the chroma of the
+ * top-left pixel of each subsampled block only */
+static void ReferenceBlend(picture_t *dst, const struct component *dl,
+                           const picture_t *src, const struct component *sl,
+                           unsigned x0, unsigned y0, unsigned width,
+                           unsigned height, unsigned alpha)
+{
+    /* 32-bit RGB with padding ignores the source alpha */
+    const bool opaque = dl[3].plane < 0 && dl[0].step == 4;
+
+    for (unsigned y = 0; y < height; y++)
+        for (unsigned x = 0; x < width; x++)
+        {
+            const unsigned a = div255(alpha * (opaque ? 255
+                                      : *Sample(src, &sl[3], x, y)));
+            if (a == 0)
+                continue;
+
+            uint8_t *da = NULL;
+            if (dl[3].plane >= 0)
+            {
+                /* merge first with the existing color as per its alpha */
+                da = Sample(dst, &dl[3], x0 + x, y0 + y);
+                for (unsigned i = 0; i < 3; i++)
+                    Merge(Sample(dst, &dl[i], x0 + x, y0 + y),
+                          *Sample(src, &sl[i], x, y), 255 - *da);
+            }
+
+            for (unsigned i = 0; i < 3; i++)
+            {
+                if (!IsFull(&dl[i], x0 + x, y0 + y))
+                    continue;
+                Merge(Sample(dst, &dl[i], x0 + x, y0 + y),
+                      *Sample(src, &sl[i], x, y), a);
+            }
+            if (da != NULL)
+                Merge(da, 255, a);
+        }
+}
+
+static void Fill(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+        for (int j = 0; j < pic->p[i].i_lines * pic->p[i].i_pitch; j++)
+            pic->p[i].p_pixels[j] = rand();
+}
+
+static picture_t *BufferNew(filter_t *filter)
+{
+    return picture_Hold(filter->owner.sys);
+}
+
+static const struct filter_video_callbacks video_cbs = {
+    .buffer_new = BufferNew,
+};
+
+struct bench
+{
+    vlc_tick_t time;
+    uint64_t cycles;
+};
+
+static void BenchStart(struct bench *bench)
+{
+#ifdef HAVE_TSC
+    bench->cycles = __rdtsc();
+#endif
+    bench->time = vlc_tick_now();
+}
+
+static void BenchStop(struct bench *bench, const char *name, double mpix)
+{
+    bench->time = vlc_tick_now() - bench->time;
+    printf("%s: %8.1f MPix/s", name,
+           mpix / secf_from_vlc_tick(bench->time ? bench->time : 1));
+#ifdef HAVE_TSC
+    bench->cycles = __rdtsc() - bench->cycles;
+    printf(", %6.2f cycles/px", bench->cycles / (mpix * 1000000.));
+#endif
+}
+
+static filter_t *CreateFilter(vlc_object_t *obj, const char *cap,
+                              const char *module, vlc_fourcc_t src,
+                              vlc_fourcc_t dst, unsigned width,
+                              unsigned height, unsigned src_width,
+                              unsigned src_height)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, src);
+    video_format_Setup(&filter->fmt_in.video, src, src_width, src_height,
+                       src_width, src_height, 1, 1);
+    es_format_Init(&filter->fmt_out, VIDEO_ES, dst);
+    video_format_Setup(&filter->fmt_out.video, dst, width, height,
+                       width, height, 1, 1);
+
+    if (vlc_filter_LoadModule(filter, cap, module, true) == NULL)
+    {
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+/* Runs a converter once, on a clone of the source */
+static void ConvertOnce(filter_t *filter, const picture_t *src)
+{
+    /* some converters modify the input picture planes in place */
+    picture_t *dst = filter->ops->filter_video(filter,
+                                               picture_Clone((picture_t *)src));
+    assert(dst == filter->owner.sys);
+    picture_Release(dst);
+}
+
+/* Returns 1 on mismatch, -1 if a module cannot be used */
+static int Convert(vlc_object_t *obj, const char *name, const char *module,
+                   const char *ref_module, vlc_fourcc_t src_chroma,
+                   vlc_fourcc_t dst_chroma, unsigned width, unsigned height,
+                   unsigned frames)
+{
+    filter_t *filter = CreateFilter(obj, "video converter", module,
+                                    src_chroma, dst_chroma, width, height,
+                                    width, height);
+    if (filter == NULL)
+        return -1;
+
+    filter_t *ref_filter = NULL;
+    if (ref_module != NULL)
+    {
+        ref_filter = CreateFilter(obj, "video converter", ref_module,
+                                  src_chroma, dst_chroma, width, height,
+                                  width, height);
+        if (ref_filter == NULL)
+        {
+            vlc_filter_Delete(filter);
+            return -1;
+        }
+    }
+
+    picture_t *src = picture_NewFromFormat(&filter->fmt_in.video);
+    picture_t *out = picture_NewFromFormat(&filter->fmt_out.video);
+    assert(src != NULL && out != NULL);
+    srand(width * height);
+    Fill(src);
+    filter->owner.video = &video_cbs;
+    filter->owner.sys = out;
+
+    int ret = 0;
+    const char *check;
+
+    ConvertOnce(filter, src);
+    if (ref_filter != NULL)
+    {
+        picture_t *ref = picture_NewFromFormat(&ref_filter->fmt_out.video);
+        assert(ref != NULL);
+        ref_filter->owner.video = &video_cbs;
+        ref_filter->owner.sys = ref;
+        ConvertOnce(ref_filter, src);
+        ret = !ComparePlanes(out, ref);
+        check = ret ? ", MISMATCH" : ", same as reference";
+        picture_Release(ref);
+        vlc_filter_Delete(ref_filter);
+    }
+    else
+    {
+        const struct component *sl = GetLayout(src_chroma);
+        const struct component *dl = GetLayout(dst_chroma);
+        if (sl != NULL && dl != NULL && vlc_fourcc_IsYUV(src_chroma)
+         && vlc_fourcc_IsYUV(dst_chroma))
+        {
+            ret = !CheckConvert(out, dl, src, sl, width, height);
+            check = ret ? ", MISMATCH" : ", ok";
+        }
+        else
+            check = ", no reference";
+    }
+
+    if (frames > 0)
+    {
+        struct bench bench;
+        BenchStart(&bench);
+        for (unsigned i = 0; i < frames; i++)
+            ConvertOnce(filter, src);
+        BenchStop(&bench, name, (double) width * height * frames / 1000000.);
+        puts(check);
+    }
+
+    picture_Release(out);
+    picture_Release(src);
+    vlc_filter_Delete(filter);
+    return ret;
+}
+
+static int Blend(vlc_object_t *obj, const char *name, const char *module,
+                 vlc_fourcc_t src_chroma, vlc_fourcc_t dst_chroma,
+                 unsigned width, unsigned height, unsigned frames)
+{
+    /* a centered picture with the half of the size, as a large subtitle */
+    const unsigned src_width = (width / 2) & ~1, src_height = (height / 2) & ~1;
+    const unsigned x0 = (width / 4) & ~3, y0 = (height / 4) & ~3;
+    const int alpha = 200;
+
+    filter_t *filter = CreateFilter(obj, "video blending", module,
+                                    src_chroma, dst_chroma, width, height,
+                                    src_width, src_height);
+    if (filter == NULL)
+        return -1;
+
+    picture_t *src = picture_NewFromFormat(&filter->fmt_in.video);
+    picture_t *dst = picture_NewFromFormat(&filter->fmt_out.video);
+    picture_t *ref = picture_NewFromFormat(&filter->fmt_out.video);
+    assert(src != NULL && dst != NULL && ref != NULL);
+    srand(width * height);
+    Fill(src);
+    Fill(dst);
+    picture_CopyPixels(ref, dst);
+
+    /* check first, as blending again changes the destination */
+    filter->ops->blend_video(filter, dst, src, x0, y0, alpha);
+
+    int ret = 0;
+    const struct component *sl = GetLayout(src_chroma);
+    const struct component *dl = GetLayout(dst_chroma);
+    bool checked = sl != NULL && sl[3].plane >= 0 && dl != NULL;
+    if (checked)
+    {
+        ReferenceBlend(ref, dl, src, sl, x0, y0, src_width, src_height, alpha);
+        ret = !Compare(dst, ref, dl, width, height);
+    }
+
+    if (frames > 0)
+    {
+        struct bench bench;
+        BenchStart(&bench);
+        for (unsigned i = 0; i < frames; i++)
+            filter->ops->blend_video(filter, dst, src, x0, y0, alpha);
+        BenchStop(&bench, name,
+                  (double) src_width * src_height * frames / 1000000.);
+        puts(!checked ? ", no reference" : ret ? ", MISMATCH" : ", ok");
+    }
+
+    picture_Release(ref);
+    picture_Release(dst);
+    picture_Release(src);
+    vlc_filter_Delete(filter);
+    return ret;
+}
+
+static int Run(vlc_object_t *obj, const char *spec, unsigned width,
+               unsigned height, unsigned frames, bool strict)
+{
+    char *dup = strdup(spec);
+    assert(dup != NULL);
+
+    char *save;
+    const char *type = strtok_r(dup, ":", &save);
+    const char *module = strtok_r(NULL, ":", &save);
+    const char *src = strtok_r(NULL, ":", &save);
+    const char *dst = strtok_r(NULL, ":", &save);
+    const char *ref = strtok_r(NULL, ":", &save);
+    if (dst == NULL)
+    {
+        fprintf(stderr, "invalid case %s\n", spec);
+        free(dup);
+        return 1;
+    }
+
+    vlc_fourcc_t src_chroma = vlc_fourcc_GetCodecFromString(VIDEO_ES, src);
+    vlc_fourcc_t dst_chroma = vlc_fourcc_GetCodecFromString(VIDEO_ES, dst);
+
+    char name[64];
+    snprintf(name, sizeof (name), "%-7s %-10s %4.4s -> %4.4s %4ux%-4u", type,
+             module, (const char *) &src_chroma, (const char *) &dst_chroma,
+             width, height);
+
+    int ret;
+    if (!strcmp(type, "convert"))
+        ret = Convert(obj, name, module, ref, src_chroma, dst_chroma,
+                      width, height, frames);
+    else if (!strcmp(type, "blend"))
+        ret = Blend(obj, name, module, src_chroma, dst_chroma,
+                    width, height, frames);
+    else
+        ret = -1;
+
+    if (ret < 0)
+    {
+        if (frames > 0)
+            printf("%s: not available\n", name);
+        /* modules of the default set may not be built */
+        ret = strict;
+    }
+    free(dup);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    struct { unsigned width, height; } sizes[8] = {
+        { 1920, 1080 }, { 718, 478 },
+    };
+    size_t size_count = 0;
+    unsigned frames = DEFAULT_FRAMES;
+    int i;
+
+    test_init();
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+        {
+            if (size_count < ARRAY_SIZE(sizes)
+             && sscanf(argv[++i], "%ux%u", &sizes[size_count].width,
+                       &sizes[size_count].height) == 2)
+                size_count++;
+        }
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            frames = strtoul(argv[++i], NULL, 10);
+        else
+            break;
+    }
+    if (size_count == 0)
+        size_count = 2;
+
+    const char *const *cases = default_cases;
+    size_t case_count = ARRAY_SIZE(default_cases);
+    const bool strict = i < argc;
+    if (strict)
+    {
+        cases = (const char *const *)&argv[i];
+        case_count = argc - i;
+    }
+
+    const char * const args[] = {
+        "-v",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    int ret = 0;
+    for (size_t j = 0; j < case_count; j++)
+        for (size_t k = 0; k < size_count; k++)
+            ret |= Run(obj, cases[j], sizes[k].width, sizes[k].height,
+                       frames, strict);
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * packed422.c: packed YUV 4:2:2 to planar converters test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+/* Byte offsets of Y0, U and V in a packed macropixel */
+static const struct
+{
+    vlc_fourcc_t chroma;
+    unsigned y, u, v;
+} sources[] = {
+    { VLC_CODEC_YUYV, 0, 1, 3 },
+    { VLC_CODEC_YVYU, 0, 3, 1 },
+    { VLC_CODEC_UYVY, 1, 0, 2 },
+};
+
+static const struct
+{
+    const char *module;
+    vlc_fourcc_t chroma;
+    bool optional; /* SIMD modules depend on the build and the CPU */
+} converters[] = {
+    { "yuy2_i420", VLC_CODEC_I420, false },
+    { "yuy2_i422", VLC_CODEC_I422, false },
+    { "yuy2_i420_avx2", VLC_CODEC_I420, true },
+    { "yuy2_i422_avx2", VLC_CODEC_I422, true },
+};
+
+static void Reference(picture_t *dst, const picture_t *src, unsigned width,
+                      unsigned height, unsigned i_src)
+{
+    const bool b_420 = dst->format.i_chroma == VLC_CODEC_I420;
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        const uint8_t *line = &src->p[0].p_pixels[y * src->p[0].i_pitch];
+        uint8_t *p_y = &dst->p[Y_PLANE].p_pixels[y * dst->p[Y_PLANE].i_pitch];
+        const unsigned cy = b_420 ? y / 2 : y;
+        uint8_t *p_u = &dst->p[U_PLANE].p_pixels[cy * dst->p[U_PLANE].i_pitch];
+        uint8_t *p_v = &dst->p[V_PLANE].p_pixels[cy * dst->p[V_PLANE].i_pitch];
+
+        for (unsigned x = 0; x + 1 < width; x += 2)
+        {
+            p_y[x] = line[2 * x + sources[i_src].y];
+            p_y[x + 1] = line[2 * x + sources[i_src].y + 2];
+            if (!b_420 || !(y & 1))
+            {
+                p_u[x / 2] = line[2 * x + sources[i_src].u];
+                p_v[x / 2] = line[2 * x + sources[i_src].v];
+            }
+        }
+    }
+}
+
+static bool Compare(const picture_t *a, const picture_t *b, unsigned width,
+                    unsigned height)
+{
+    for (int i = 0; i < a->i_planes; i++)
+    {
+        const unsigned w = i ? width / 2 : width;
+        const unsigned h = i && a->format.i_chroma == VLC_CODEC_I420
+                         ? height / 2 : height;
+
+        for (unsigned y = 0; y < h; y++)
+            if (memcmp(&a->p[i].p_pixels[y * a->p[i].i_pitch],
+                       &b->p[i].p_pixels[y * b->p[i].i_pitch], w))
+                return false;
+    }
+    return true;
+}
+
+static picture_t *BufferNew(filter_t *filter)
+{
+    return picture_Hold(filter->owner.sys);
+}
+
+static const struct filter_video_callbacks video_cbs = {
+    .buffer_new = BufferNew,
+};
+
+static void Test(vlc_object_t *obj, size_t i_conv, size_t i_src,
+                 unsigned width, unsigned height)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, sources[i_src].chroma);
+    video_format_Setup(&filter->fmt_in.video, sources[i_src].chroma,
+                       width, height, width, height, 1, 1);
+    es_format_Init(&filter->fmt_out, VIDEO_ES, converters[i_conv].chroma);
+    video_format_Setup(&filter->fmt_out.video, converters[i_conv].chroma,
+                       width, height, width, height, 1, 1);
+
+    module_t *module = vlc_filter_LoadModule(filter, "video converter",
+                                             converters[i_conv].module, true);
+    if (module == NULL)
+    {
+        assert(converters[i_conv].optional);
+        vlc_object_delete(filter);
+        return;
+    }
+
+    picture_t *src = picture_NewFromFormat(&filter->fmt_in.video);
+    picture_t *ref = picture_NewFromFormat(&filter->fmt_out.video);
+    picture_t *out = picture_NewFromFormat(&filter->fmt_out.video);
+    assert(src != NULL && ref != NULL && out != NULL);
+    filter->owner.video = &video_cbs;
+    filter->owner.sys = out;
+
+    uint8_t *p = src->p[0].p_pixels;
+    for (int i = 0; i < src->p[0].i_lines * src->p[0].i_pitch; i++)
+        p[i] = rand();
+
+    Reference(ref, src, width, height, i_src);
+
+    picture_t *dst = filter->ops->filter_video(filter, picture_Hold(src));
+    assert(dst == out);
+    picture_Release(dst);
+
+    assert(Compare(out, ref, width, height));
+
+    picture_Release(out);
+    picture_Release(ref);
+    picture_Release(src);
+    vlc_filter_Delete(filter);
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    for (size_t i = 0; i < ARRAY_SIZE(converters); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(sources); j++)
+        {
+            /* widths that are not a multiple of the vector size */
+            Test(obj, i, j, 1366, 768);
+            Test(obj, i, j, 34, 2);
+            Test(obj, i, j, 3840, 2160);
+        }
+
+    libvlc_release(vlc);
+    return 0;
+}
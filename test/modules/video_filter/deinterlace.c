@@ -0,0 +1,242 @@
+/*****************************************************************************
+ * deinterlace.c: deinterlace filter regression test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each mode deinterlaces the same synthetic 1080i sequence, on one thread and
+ * on 4 filter threads. The output must match, bit for bit, the hashes of
+ * the plain C single threaded implementation.
+ *
+ * Built with TEST_BENCH, it also prints the frame rate of each mode.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_fourcc.h>
+#include <vlc_modules.h>
+#include <vlc_tick.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define WIDTH  1920
+#define HEIGHT 1080
+#define FRAMES 8
+
+static const struct
+{
+    const char *mode;
+    vlc_fourcc_t chroma;
+    uint64_t hash;
+} cases[] = {
+    { "discard",  VLC_CODEC_I420, UINT64_C(0x22aaab328f754aeb) },
+    { "bob",      VLC_CODEC_I420, UINT64_C(0xe4e632c403400145) },
+    { "linear",   VLC_CODEC_I420, UINT64_C(0xbc4f0fb6afe08606) },
+    { "mean",     VLC_CODEC_I420, UINT64_C(0x2039c7c75b3ef0cb) },
+    { "blend",    VLC_CODEC_I420, UINT64_C(0x9da62cfa6c4150ca) },
+    { "yadif",    VLC_CODEC_I420, UINT64_C(0x46e7949bd8675214) },
+    { "yadif2x",  VLC_CODEC_I420, UINT64_C(0x6363d40a959279f2) },
+    { "x",        VLC_CODEC_I420, UINT64_C(0x599bf4f1e5aa9e0d) },
+    { "phosphor", VLC_CODEC_I420, UINT64_C(0x003859a3e600c514) },
+    { "ivtc",     VLC_CODEC_I420, UINT64_C(0x8d4a025035a1daa5) },
+    { "x",        VLC_CODEC_I422, UINT64_C(0x831a6fe04590bf19) },
+    { "phosphor", VLC_CODEC_I422, UINT64_C(0x304c2d632a714d90) },
+};
+
+static uint8_t Noise(unsigned x, unsigned y)
+{
+    uint32_t h = x * 0x9E3779B1u ^ y * 0x85EBCA77u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    return h >> 28;
+}
+
+/* A static textured background, a bright bar moving right and a dark bar
+ * moving down, at time t in fields */
+static uint8_t Scene(unsigned x, unsigned y, unsigned t, unsigned w)
+{
+    if ((x + 2 * w - 12 * t) % w < w / 8)
+        return 235 - Noise(x, y);
+    if ((y + 7 * t) % 300 < 40 && x > w / 2)
+        return 16 + Noise(x, y);
+    return 64 + ((x / 8 + y / 4) & 63) + Noise(x, y);
+}
+
+/* Top field first interlaced frame */
+static void FillFrame(picture_t *pic, unsigned frame)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+        const unsigned w = p->i_visible_pitch;
+
+        for (int y = 0; y < p->i_visible_lines; y++)
+        {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+            const unsigned t = 2 * frame + (y & 1);
+
+            for (unsigned x = 0; x < w; x++)
+                line[x] = i == 0 ? Scene(x, y, t, w)
+                                 : 128 + (Scene(x, y, t, w) - 128) / 4;
+        }
+    }
+    pic->date = VLC_TICK_0 + frame * VLC_TICK_FROM_MS(40);
+    pic->b_progressive = false;
+    pic->b_top_field_first = true;
+    pic->i_nb_fields = 2;
+}
+
+static uint64_t Hash(uint64_t hash, const picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_visible_lines; y++)
+        {
+            const uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            for (int x = 0; x < p->i_visible_pitch; x++)
+                hash = (hash ^ line[x]) * UINT64_C(0x100000001b3);
+        }
+    }
+    return (hash ^ (uint64_t)pic->date) * UINT64_C(0x100000001b3);
+}
+
+static picture_t *sources[FRAMES];
+
+static void MakeSources(const video_format_t *fmt)
+{
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        if (sources[i] != NULL)
+            picture_Release(sources[i]);
+        sources[i] = picture_NewFromFormat(fmt);
+        assert(sources[i] != NULL);
+        FillFrame(sources[i], i);
+    }
+}
+
+static uint64_t Run(vlc_object_t *obj, size_t index, unsigned threads)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    var_Create(filter, "filter-threads", VLC_VAR_INTEGER);
+    var_SetInteger(filter, "filter-threads", threads);
+    var_Create(filter, "sout-deinterlace-mode", VLC_VAR_STRING);
+    var_SetString(filter, "sout-deinterlace-mode", cases[index].mode);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, cases[index].chroma);
+    video_format_Setup(&filter->fmt_in.video, cases[index].chroma,
+                       WIDTH, HEIGHT, WIDTH, HEIGHT, 1, 1);
+    filter->fmt_in.video.i_frame_rate = 25;
+    filter->fmt_in.video.i_frame_rate_base = 1;
+    es_format_Copy(&filter->fmt_out, &filter->fmt_in);
+    filter->b_allow_fmt_out_change = true;
+
+    module_t *module = vlc_filter_LoadModule(filter, "video filter",
+                                             "deinterlace", true);
+    assert(module != NULL);
+
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    unsigned outputs = 0;
+    vlc_tick_t time = 0;
+
+    if (sources[0] == NULL
+     || sources[0]->format.i_chroma != cases[index].chroma)
+        MakeSources(&filter->fmt_in.video);
+
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        picture_t *in = picture_NewFromFormat(&filter->fmt_in.video);
+        assert(in != NULL);
+        picture_Copy(in, sources[i]);
+
+        vlc_tick_t start = vlc_tick_now();
+        picture_t *out = filter->ops->filter_video(filter, in);
+        time += vlc_tick_now() - start;
+
+        while (out != NULL)
+        {
+            picture_t *next = out->p_next;
+            hash = Hash(hash, out);
+            outputs++;
+            picture_Release(out);
+            out = next;
+        }
+    }
+    assert(outputs > 0);
+
+#ifdef TEST_BENCH
+    printf("%-8s %4.4s, %u thread(s): %6.1f fps\n", cases[index].mode,
+           (const char *)&cases[index].chroma, threads,
+           FRAMES / secf_from_vlc_tick(time ? time : 1));
+#else
+    VLC_UNUSED(time);
+#endif
+
+    vlc_filter_Delete(filter);
+    return hash;
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    if (!module_exists("deinterlace"))
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(cases); i++)
+    {
+        uint64_t single = Run(obj, i, 1);
+        uint64_t multi = Run(obj, i, 4);
+
+        assert(single == cases[i].hash);
+        assert(multi == cases[i].hash);
+    }
+
+    for (unsigned i = 0; i < FRAMES; i++)
+        picture_Release(sources[i]);
+
+    libvlc_release(vlc);
+    return 0;
+}
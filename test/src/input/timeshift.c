@@ -0,0 +1,279 @@
+/*****************************************************************************
+ * timeshift.c: timeshift es_out test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * A live source, that can neither pause nor control its pace, is paused for
+ * long enough to wrap the smallest timeshift file several times, then
+ * resumed. While paused, the oldest chunks are dropped and their slots are
+ * reused. On resume, the reader continues on the index from the oldest
+ * record left. Every block reaching the decoder must be intact, and in
+ * order.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/* Define a builtin module for mocked parts */
+#define MODULE_NAME test_src_input_timeshift
+#undef VLC_DYNAMIC_PLUGIN
+
+#undef NDEBUG
+#include <assert.h>
+#include <limits.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_demux.h>
+#include <vlc_codec.h>
+#include <vlc_threads.h>
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define CODEC       VLC_FOURCC('t','s','h','t')
+#define BLOCK_SIZE  (64 * 1024)
+#define PERIOD      VLC_TICK_FROM_MS(5) /* 12.8 MB/s */
+/* 3 chunks of 1 MiB, that is 48 blocks */
+#define RING_BLOCKS (3 * 1024 * 1024 / BLOCK_SIZE)
+
+static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+static vlc_cond_t wait = VLC_STATIC_COND;
+static struct
+{
+    uint64_t demuxed; /* blocks sent by the demux */
+    uint64_t decoded; /* blocks received by the decoder */
+    uint64_t next; /* next index expected by the decoder */
+    uint64_t gaps; /* number of skips in the decoded indexes */
+    /* Blocks demuxed long after pausing, that only the file can replay */
+    uint64_t stored_start, stored_end;
+    uint64_t replayed; /* blocks of the stored span decoded */
+} state;
+
+struct demux_sys
+{
+    es_out_id_t *es;
+    vlc_tick_t start;
+    uint64_t index;
+};
+
+static int Demux(demux_t *demux)
+{
+    struct demux_sys *sys = demux->p_sys;
+    const vlc_tick_t dts = VLC_TICK_0 + (vlc_tick_t)sys->index * PERIOD;
+
+    /* A live source: the blocks come in real time */
+    vlc_tick_wait(sys->start + (vlc_tick_t)sys->index * PERIOD);
+
+    block_t *block = block_Alloc(BLOCK_SIZE);
+    if (block == NULL)
+        return VLC_DEMUXER_EGENERIC;
+
+    SetQWLE(block->p_buffer, sys->index);
+    memset(block->p_buffer + 8, (uint8_t)sys->index, BLOCK_SIZE - 8);
+    block->i_dts = block->i_pts = dts;
+    block->i_length = PERIOD;
+
+    es_out_SetPCR(demux->out, dts);
+    es_out_Send(demux->out, sys->es, block);
+    sys->index++;
+
+    vlc_mutex_lock(&lock);
+    state.demuxed = sys->index;
+    vlc_cond_broadcast(&wait);
+    vlc_mutex_unlock(&lock);
+    return VLC_DEMUXER_SUCCESS;
+}
+
+static int Control(demux_t *demux, int query, va_list args)
+{
+    (void) demux;
+
+    switch (query)
+    {
+        case DEMUX_CAN_SEEK:
+        case DEMUX_CAN_PAUSE:
+        case DEMUX_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+        case DEMUX_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = VLC_TICK_FROM_MS(50);
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static int OpenDemux(vlc_object_t *obj)
+{
+    demux_t *demux = (demux_t *)obj;
+
+    if (demux->out == NULL)
+        return VLC_EGENERIC;
+
+    struct demux_sys *sys = vlc_obj_malloc(obj, sizeof (*sys));
+    if (sys == NULL)
+        return VLC_ENOMEM;
+
+    es_format_t fmt;
+    es_format_Init(&fmt, VIDEO_ES, CODEC);
+    fmt.video.i_width = fmt.video.i_visible_width = 16;
+    fmt.video.i_height = fmt.video.i_visible_height = 16;
+    sys->es = es_out_Add(demux->out, &fmt);
+    if (sys->es == NULL)
+        return VLC_EGENERIC;
+
+    sys->start = vlc_tick_now();
+    sys->index = 0;
+    demux->p_sys = sys;
+    demux->pf_demux = Demux;
+    demux->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static int Decode(decoder_t *dec, block_t *block)
+{
+    (void) dec;
+    if (block == NULL)
+        return VLCDEC_SUCCESS;
+
+    /* The record was read back whole, and at a record boundary */
+    assert(block->i_buffer == BLOCK_SIZE);
+    const uint64_t index = GetQWLE(block->p_buffer);
+    for (size_t i = 8; i < BLOCK_SIZE; i++)
+        assert(block->p_buffer[i] == (uint8_t)index);
+    assert(block->i_dts == VLC_TICK_0 + (vlc_tick_t)index * PERIOD);
+    assert(block->i_length == PERIOD);
+
+    vlc_mutex_lock(&lock);
+    /* Some blocks may be dropped, but never reordered */
+    assert(index >= state.next);
+    if (index > state.next && state.decoded > 0)
+        state.gaps++;
+    if (index >= state.stored_start && index < state.stored_end)
+        state.replayed++;
+    state.next = index + 1;
+    state.decoded++;
+    vlc_cond_broadcast(&wait);
+    vlc_mutex_unlock(&lock);
+
+    block_Release(block);
+    return VLCDEC_SUCCESS;
+}
+
+static int OpenDecoder(vlc_object_t *obj)
+{
+    decoder_t *dec = (decoder_t *)obj;
+
+    if (dec->fmt_in->i_codec != CODEC)
+        return VLC_EGENERIC;
+
+    dec->pf_decode = Decode;
+    return VLC_SUCCESS;
+}
+
+vlc_module_begin()
+    set_capability("access", 0)
+    set_callback(OpenDemux)
+    add_shortcut("timeshift")
+
+    add_submodule()
+        set_capability("video decoder", INT_MAX)
+        set_callback(OpenDecoder)
+vlc_module_end()
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+/* Waits for the decoder to receive the block of the given index, or later */
+static void WaitDecoded(uint64_t index)
+{
+    vlc_mutex_lock(&lock);
+    while (state.next <= index)
+        vlc_cond_wait(&wait, &lock);
+    vlc_mutex_unlock(&lock);
+}
+
+/* Waits for the demux to send the given number of blocks, and returns the
+ * number of blocks sent in total */
+static uint64_t WaitDemuxed(uint64_t count)
+{
+    vlc_mutex_lock(&lock);
+    const uint64_t end = state.demuxed + count;
+    while (state.demuxed < end)
+        vlc_cond_wait(&wait, &lock);
+    vlc_mutex_unlock(&lock);
+    return end;
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v",
+        "--no-audio",
+        "--input-timeshift-granularity=1048576",
+        "--input-timeshift-size=3",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    libvlc_media_t *media = libvlc_media_new_location("timeshift://");
+    assert(media != NULL);
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(vlc, media);
+    assert(mp != NULL);
+    libvlc_media_release(media);
+
+    state.stored_start = state.stored_end = UINT64_MAX;
+    libvlc_media_player_play(mp);
+    WaitDecoded(20);
+    assert(state.gaps == 0);
+
+    /* Paused, the timeshift file wraps several times */
+    libvlc_media_player_set_pause(mp, 1);
+    const uint64_t stored_start = WaitDemuxed(4 * RING_BLOCKS);
+    const uint64_t stored_end = WaitDemuxed(4 * RING_BLOCKS);
+
+    vlc_mutex_lock(&lock);
+    state.stored_start = stored_start;
+    state.stored_end = stored_end;
+    vlc_mutex_unlock(&lock);
+    libvlc_media_player_set_pause(mp, 0);
+
+    /* Playback resumes from the timeshift file, and continues past the
+     * resuming date through it */
+    WaitDecoded(stored_end + 4 * RING_BLOCKS);
+    libvlc_media_player_stop_async(mp);
+    libvlc_media_player_release(mp);
+    libvlc_release(vlc);
+
+    /* The stored blocks were played back after resuming, but the oldest
+     * ones were dropped */
+    assert(state.replayed > 0);
+    assert(state.replayed < stored_end - stored_start);
+    assert(state.gaps > 0);
+    return 0;
+}
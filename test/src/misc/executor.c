@@ -0,0 +1,145 @@
+/*****************************************************************************
+ * executor.c: executor modes test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Producer threads submit tasks to a single queue executor and to a work
+ * stealing one, and every task must run. Built with TEST_BENCH, the program
+ * also prints the throughput and the mean latency of each.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_threads.h>
+#include <vlc_executor.h>
+#include <vlc_tick.h>
+
+#include "../../libvlc/test.h"
+
+#define TASKS     20000
+#define PRODUCERS 4
+
+struct task
+{
+    struct vlc_runnable runnable;
+    vlc_tick_t submitted;
+    atomic_uint *done;
+    _Atomic vlc_tick_t *latency;
+};
+
+static void Run(void *userdata)
+{
+    struct task *task = userdata;
+
+    atomic_fetch_add_explicit(task->latency, vlc_tick_now() - task->submitted,
+                              memory_order_relaxed);
+    atomic_fetch_add_explicit(task->done, 1, memory_order_relaxed);
+}
+
+struct producer
+{
+    vlc_thread_t thread;
+    vlc_executor_t *executor;
+    struct task *tasks;
+    size_t count;
+};
+
+static void *Produce(void *data)
+{
+    struct producer *producer = data;
+
+    for (size_t i = 0; i < producer->count; ++i)
+    {
+        struct task *task = &producer->tasks[i];
+        task->submitted = vlc_tick_now();
+        vlc_executor_Submit(producer->executor, &task->runnable);
+    }
+    return NULL;
+}
+
+static void Bench(const char *name, vlc_executor_t *(*new)(unsigned),
+                  unsigned threads)
+{
+    vlc_executor_t *executor = new(threads);
+    assert(executor);
+
+    struct task *tasks = malloc(sizeof(*tasks) * TASKS);
+    assert(tasks);
+
+    atomic_uint done = 0;
+    _Atomic vlc_tick_t latency = 0;
+    for (size_t i = 0; i < TASKS; ++i)
+    {
+        tasks[i].runnable.run = Run;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].done = &done;
+        tasks[i].latency = &latency;
+    }
+
+    struct producer producers[PRODUCERS];
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t i = 0; i < PRODUCERS; ++i)
+    {
+        producers[i].executor = executor;
+        producers[i].tasks = &tasks[i * TASKS / PRODUCERS];
+        producers[i].count = TASKS / PRODUCERS;
+        int ret = vlc_clone(&producers[i].thread, Produce, &producers[i]);
+        assert(ret == 0);
+    }
+    for (size_t i = 0; i < PRODUCERS; ++i)
+        vlc_join(producers[i].thread, NULL);
+
+    vlc_executor_WaitIdle(executor);
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    assert(atomic_load(&done) == TASKS);
+
+#ifdef TEST_BENCH
+    printf("%-13s %2u threads: %9.0f tasks/s, %7.1f us mean latency\n",
+           name, threads, TASKS / secf_from_vlc_tick(duration ? duration : 1),
+           (double) US_FROM_VLC_TICK(atomic_load(&latency)) / TASKS);
+#else
+    VLC_UNUSED(name);
+    VLC_UNUSED(duration);
+#endif
+
+    vlc_executor_Delete(executor);
+    free(tasks);
+}
+
+int main(void)
+{
+    test_init();
+
+    static const unsigned threads[] = { 1, 2, 4, 8, 16 };
+    for (size_t i = 0; i < ARRAY_SIZE(threads); ++i)
+    {
+        Bench("single queue", vlc_executor_New, threads[i]);
+        Bench("work stealing", vlc_executor_NewWorkStealing, threads[i]);
+    }
+
+    return 0;
+}
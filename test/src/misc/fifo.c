@@ -0,0 +1,178 @@
+/*****************************************************************************
+ * fifo.c: frame FIFO tests and contention benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The lock-free FIFO must return the frames in order, single or chained,
+ * across its segments. A producer thread then streams frames through the
+ * locked and the lock-free FIFOs. Built with TEST_BENCH, the program also
+ * prints the throughput of each.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_frame.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include "../../libvlc/test.h"
+
+#define FRAMES 200000
+
+static void test_spsc_order(void)
+{
+    vlc_spsc_fifo_t *fifo = vlc_spsc_fifo_New();
+    assert(fifo);
+
+    assert(vlc_spsc_fifo_Pop(fifo) == NULL);
+    assert(vlc_spsc_fifo_PopAll(fifo) == NULL);
+    assert(vlc_spsc_fifo_Put(fifo, NULL) == VLC_SUCCESS);
+
+    /* Cross several segments, with single frames and chains */
+    vlc_frame_t *chain = NULL;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        vlc_frame_t *frame = vlc_frame_Alloc(0);
+        assert(frame);
+        frame->i_dts = i;
+        if (i < 300)
+            assert(vlc_spsc_fifo_Put(fifo, frame) == VLC_SUCCESS);
+        else
+            vlc_frame_ChainAppend(&chain, frame);
+    }
+    assert(vlc_spsc_fifo_Put(fifo, chain) == VLC_SUCCESS);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        vlc_frame_t *frame = vlc_spsc_fifo_Pop(fifo);
+        assert(frame);
+        assert(frame->p_next == NULL);
+        assert(frame->i_dts == (vlc_tick_t) i);
+        vlc_frame_Release(frame);
+    }
+
+    chain = vlc_spsc_fifo_PopAll(fifo);
+    size_t i = 10;
+    for (vlc_frame_t *frame = chain; frame != NULL; frame = frame->p_next)
+        assert(frame->i_dts == (vlc_tick_t) i++);
+    assert(i == 1000);
+    vlc_frame_ChainRelease(chain);
+    assert(vlc_spsc_fifo_Pop(fifo) == NULL);
+
+    /* Remaining frames are released on deletion */
+    vlc_spsc_fifo_Put(fifo, vlc_frame_Alloc(0));
+    vlc_spsc_fifo_Delete(fifo);
+}
+
+struct bench
+{
+    vlc_fifo_t *fifo;
+    vlc_spsc_fifo_t *spsc;
+    vlc_frame_t **frames;
+    size_t count;
+};
+
+static void *ProduceLocked(void *data)
+{
+    struct bench *bench = data;
+
+    for (size_t i = 0; i < bench->count; ++i)
+        vlc_fifo_Put(bench->fifo, bench->frames[i]);
+    return NULL;
+}
+
+static void *ProduceSpsc(void *data)
+{
+    struct bench *bench = data;
+
+    for (size_t i = 0; i < bench->count; ++i)
+        vlc_spsc_fifo_Put(bench->spsc, bench->frames[i]);
+    vlc_spsc_fifo_Close(bench->spsc);
+    return NULL;
+}
+
+static void Bench(bool spsc)
+{
+    struct bench bench = { .count = FRAMES };
+    bench.frames = malloc(sizeof (*bench.frames) * FRAMES);
+    assert(bench.frames);
+    for (size_t i = 0; i < FRAMES; ++i)
+    {
+        bench.frames[i] = vlc_frame_Alloc(0);
+        assert(bench.frames[i]);
+        bench.frames[i]->i_dts = i;
+    }
+
+    if (spsc)
+        bench.spsc = vlc_spsc_fifo_New();
+    else
+        bench.fifo = vlc_fifo_New();
+    assert(spsc ? bench.spsc != NULL : bench.fifo != NULL);
+
+    vlc_thread_t th;
+    vlc_tick_t start = vlc_tick_now();
+    int ret = vlc_clone(&th, spsc ? ProduceSpsc : ProduceLocked, &bench);
+    assert(ret == 0);
+
+    for (size_t i = 0; i < FRAMES; ++i)
+    {
+        vlc_frame_t *frame = spsc ? vlc_spsc_fifo_Get(bench.spsc)
+                                  : vlc_fifo_Get(bench.fifo);
+        assert(frame);
+        assert(frame->i_dts == (vlc_tick_t) i);
+        vlc_frame_Release(frame);
+    }
+    vlc_tick_t duration = vlc_tick_now() - start;
+    vlc_join(th, NULL);
+
+    if (spsc)
+    {
+        /* Closed and empty */
+        assert(vlc_spsc_fifo_Get(bench.spsc) == NULL);
+        vlc_spsc_fifo_Delete(bench.spsc);
+    }
+    else
+        vlc_fifo_Delete(bench.fifo);
+
+#ifdef TEST_BENCH
+    printf("%-12s %9.0f frames/s\n", spsc ? "lock-free" : "locked",
+           FRAMES / secf_from_vlc_tick(duration ? duration : 1));
+#else
+    VLC_UNUSED(duration);
+#endif
+    free(bench.frames);
+}
+
+int main(void)
+{
+    test_init();
+
+    test_spsc_order();
+
+    Bench(false);
+    Bench(true);
+
+    return 0;
+}
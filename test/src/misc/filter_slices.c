@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * filter_slices.c: test for the video filter slice threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_filter.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define LINES 2160
+
+struct lines
+{
+    atomic_uint count[LINES];
+    atomic_uint slices;
+    bool nested;
+};
+
+static void Slice(filter_t *filter, void *opaque, unsigned first, unsigned end)
+{
+    struct lines *lines = opaque;
+
+    assert(first < end && end <= LINES);
+    assert(first % 16 == 0);
+    atomic_fetch_add(&lines->slices, 1);
+
+    if (lines->nested)
+    {
+        /* run a whole picture from each slice */
+        struct lines *inner = malloc(sizeof (*inner));
+        assert(inner != NULL);
+        for (unsigned i = 0; i < LINES; i++)
+            atomic_init(&inner->count[i], 0);
+        atomic_init(&inner->slices, 0);
+        inner->nested = false;
+
+        vlc_filter_RunSlices(filter, LINES, Slice, inner);
+        for (unsigned i = 0; i < LINES; i++)
+            assert(atomic_load(&inner->count[i]) == 1);
+        free(inner);
+    }
+
+    for (unsigned i = first; i < end; i++)
+        atomic_fetch_add(&lines->count[i], 1);
+}
+
+static unsigned Run(vlc_object_t *obj, unsigned height, bool nested)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    struct lines *lines = malloc(sizeof (*lines));
+    assert(lines != NULL);
+    for (unsigned i = 0; i < LINES; i++)
+        atomic_init(&lines->count[i], 0);
+    atomic_init(&lines->slices, 0);
+    lines->nested = nested;
+
+    vlc_filter_RunSlices(filter, height, Slice, lines);
+
+    /* every line is processed exactly once */
+    for (unsigned i = 0; i < height; i++)
+        assert(atomic_load(&lines->count[i]) == 1);
+    for (unsigned i = height; i < LINES; i++)
+        assert(atomic_load(&lines->count[i]) == 0);
+
+    unsigned slices = atomic_load(&lines->slices);
+    free(lines);
+    vlc_object_delete(filter);
+    return slices;
+}
+
+static void Test(const char *threads, unsigned min_slices)
+{
+    const char * const args[] = {
+        "-v", "--filter-threads", threads,
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* too small to be split */
+    assert(Run(obj, 20, false) == 1);
+
+    assert(Run(obj, 1080, false) >= min_slices);
+    assert(Run(obj, 1079, false) >= min_slices);
+    assert(Run(obj, LINES, true) >= min_slices);
+
+    libvlc_release(vlc);
+}
+
+int main(void)
+{
+    test_init();
+
+    Test("1", 1);
+    Test("4", 4);
+    Test("16", 16);
+    return 0;
+}
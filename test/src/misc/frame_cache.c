@@ -0,0 +1,204 @@
+/*****************************************************************************
+ * frame_cache.c: frame cache tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_frame.h>
+#include <vlc_threads.h>
+
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+
+static libvlc_instance_t *NewInstance(const char *cache)
+{
+    const char *argv[] = { cache };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    return vlc;
+}
+
+static void *ExitingThread(void *data)
+{
+    (void) data;
+    vlc_frame_Release(vlc_frame_Alloc(100));
+    return NULL;
+}
+
+static void *ReleasingThread(void *data)
+{
+    vlc_frame_ChainRelease(data);
+    return NULL;
+}
+
+static void *AllocatingThread(void *data)
+{
+    (void) data;
+    return vlc_frame_Alloc(100);
+}
+
+static void test_cache(void)
+{
+    libvlc_instance_t *vlc = NewInstance("--frame-cache=64");
+    struct vlc_frame_cache_stats before, after;
+
+    vlc_frame_cache_GetStats(&before);
+
+    /* Recycled frames look brand new */
+    vlc_frame_t *frame = vlc_frame_Alloc(188);
+    assert(frame);
+    frame->i_pts = VLC_TICK_0;
+    frame->i_flags = VLC_FRAME_FLAG_DISCONTINUITY;
+    memset(frame->p_buffer, 0x47, frame->i_buffer);
+    vlc_frame_Release(frame);
+
+    frame = vlc_frame_Alloc(200);
+    assert(frame);
+    assert(frame->i_buffer == 200);
+    assert(frame->i_pts == VLC_TICK_INVALID);
+    assert(frame->i_flags == 0);
+    assert(((uintptr_t)frame->p_buffer % 32) == 0);
+    assert(frame->p_buffer - frame->p_start >= 32);
+
+    /* Reallocating within and beyond the size class */
+    frame = vlc_frame_Realloc(frame, 16, 250);
+    assert(frame && frame->i_buffer == 266);
+    frame = vlc_frame_Realloc(frame, 0, 10000);
+    assert(frame && frame->i_buffer == 10000);
+    vlc_frame_Release(frame);
+
+    vlc_frame_cache_GetStats(&after);
+    assert(after.hits >= before.hits + 1);
+    assert(after.cached_bytes > 0);
+
+    /* Large frames bypass the cache */
+    before = after;
+    frame = vlc_frame_Alloc(1 << 20);
+    assert(frame);
+    vlc_frame_Release(frame);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.hits == before.hits && after.misses == before.misses);
+
+    /* The cache limit is enforced */
+    vlc_frame_t *chain = NULL;
+    for (size_t i = 0; i < 100; i++)
+        vlc_frame_ChainAppend(&chain, vlc_frame_Alloc(1000));
+    vlc_frame_ChainRelease(chain);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.high_water <= 64 * 1024);
+
+    /* Caches of exiting threads are freed */
+    vlc_frame_cache_GetStats(&before);
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, ExitingThread, NULL);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.cached_bytes == before.cached_bytes);
+    assert(after.misses == before.misses + 1);
+
+    /* Frames released by another thread go back to the allocating thread */
+    chain = NULL;
+    for (size_t i = 0; i < 10; i++)
+        vlc_frame_ChainAppend(&chain, vlc_frame_Alloc(1000));
+    vlc_frame_cache_GetStats(&before);
+    ret = vlc_clone(&th, ReleasingThread, chain);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.cached_bytes == before.cached_bytes + 10 * 2048);
+
+    before = after;
+    chain = NULL;
+    for (size_t i = 0; i < 10; i++)
+        vlc_frame_ChainAppend(&chain, vlc_frame_Alloc(1000));
+    vlc_frame_cache_GetStats(&after);
+    assert(after.hits == before.hits + 10);
+    assert(after.misses == before.misses);
+    assert(after.cached_bytes == before.cached_bytes - 10 * 2048);
+    vlc_frame_ChainRelease(chain);
+
+    /* Frames can outlive the thread that allocated them */
+    vlc_frame_cache_GetStats(&before);
+    void *outlived;
+    ret = vlc_clone(&th, AllocatingThread, NULL);
+    assert(ret == 0);
+    vlc_join(th, &outlived);
+    assert(outlived != NULL);
+    vlc_frame_Release(outlived);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.cached_bytes == before.cached_bytes);
+
+    /* The cache of this thread goes away with the last instance */
+    libvlc_release(vlc);
+    vlc_frame_cache_GetStats(&after);
+    assert(after.cached_bytes == 0);
+}
+
+/* Allocates and releases a small frame, returns whether it was cached */
+static bool CachedAlloc(void)
+{
+    struct vlc_frame_cache_stats before, after;
+
+    vlc_frame_cache_GetStats(&before);
+    vlc_frame_Release(vlc_frame_Alloc(188));
+    vlc_frame_Release(vlc_frame_Alloc(188));
+    vlc_frame_cache_GetStats(&after);
+    return after.hits != before.hits;
+}
+
+static void test_instances(void)
+{
+    /* Disabled by default */
+    libvlc_instance_t *vlc0 = NewInstance("--frame-cache=0");
+    assert(!CachedAlloc());
+
+    /* The largest limit of the live instances applies */
+    libvlc_instance_t *vlc64 = NewInstance("--frame-cache=64");
+    assert(CachedAlloc());
+    libvlc_instance_t *vlc0b = NewInstance("--frame-cache=0");
+    assert(CachedAlloc());
+    libvlc_release(vlc0b);
+    assert(CachedAlloc());
+
+    /* and goes away with them */
+    libvlc_release(vlc64);
+    assert(!CachedAlloc());
+
+    libvlc_release(vlc0);
+}
+
+int main(void)
+{
+    test_init();
+
+    test_cache();
+
+    test_instances();
+
+    return 0;
+}
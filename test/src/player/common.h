@@ -229,6 +229,7 @@ struct media_params
 #define DISABLE_AUDIO        (1 << 3)
 #define AUDIO_INSTANT_DRAIN  (1 << 4)
 #define CLOCK_MASTER_MONOTONIC (1 << 5)
+#define AUDIO_FILTER_THREAD  (1 << 6)
 
 struct ctx
 {
@@ -1291,6 +1292,8 @@ ctx_init(struct ctx *ctx, int flags)
         "--text-renderer=tdummy,none",
         (flags & CLOCK_MASTER_MONOTONIC) ?
             "--clock-master=monotonic" : "--clock-master=auto",
+        (flags & AUDIO_FILTER_THREAD) ?
+            "--audio-filter-thread" : "--no-audio-filter-thread",
     };
     libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
     assert(vlc);
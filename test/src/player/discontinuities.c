@@ -46,5 +46,9 @@ main(void)
     ctx_init(&ctx, CLOCK_MASTER_MONOTONIC|AUDIO_INSTANT_DRAIN);
     test_clock_discontinuities(&ctx);
     ctx_destroy(&ctx);
+    /* Test with the audio filters running in their own thread */
+    ctx_init(&ctx, AUDIO_FILTER_THREAD|AUDIO_INSTANT_DRAIN);
+    test_clock_discontinuities(&ctx);
+    ctx_destroy(&ctx);
     return 0;
 }
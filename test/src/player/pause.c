@@ -163,5 +163,10 @@ main(void)
     test_pause(&ctx);
     test_pause_get_time_increase(&ctx);
     ctx_destroy(&ctx);
+
+    ctx_init(&ctx, AUDIO_FILTER_THREAD);
+    test_pause(&ctx);
+    test_pause_get_time_increase(&ctx);
+    ctx_destroy(&ctx);
     return 0;
 }
@@ -0,0 +1,156 @@
+/*****************************************************************************
+ * spu.c: test for the unchanged regions of the subpicture renders
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_spu.h>
+#include <vlc_subpicture.h>
+#include <vlc_vout_display.h>
+
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#define WIDTH  640
+#define HEIGHT 480
+
+static video_format_t fmt;
+
+static subpicture_region_t *Put(spu_t *spu, ssize_t channel, int x)
+{
+    static vlc_tick_t start = VLC_TICK_0 + 1;
+
+    subpicture_t *subpic = subpicture_New(NULL);
+    assert(subpic != NULL);
+    subpic->i_channel = channel;
+    /* a newer ephemer subpicture replaces the previous ones */
+    subpic->i_start = start++;
+    subpic->i_stop = VLC_TICK_INVALID;
+    subpic->b_ephemer = true;
+    subpic->i_original_picture_width = WIDTH;
+    subpic->i_original_picture_height = HEIGHT;
+
+    video_format_t region_fmt;
+    video_format_Init(&region_fmt, VLC_CODEC_RGBA);
+    region_fmt.i_width = region_fmt.i_visible_width = 64;
+    region_fmt.i_height = region_fmt.i_visible_height = 32;
+    region_fmt.i_sar_num = region_fmt.i_sar_den = 1;
+
+    subpicture_region_t *region = subpicture_region_New(&region_fmt);
+    assert(region != NULL);
+    region->i_x = x;
+    region->i_y = 16;
+    region->b_absolute = true;
+    region->i_align = SUBPICTURE_ALIGN_TOP | SUBPICTURE_ALIGN_LEFT;
+    vlc_spu_regions_push(&subpic->regions, region);
+
+    spu_PutSubpicture(spu, subpic);
+    /* still owned by the SPU, as long as no other subpicture is put */
+    return region;
+}
+
+/* Returns whether the single region of the render is unchanged */
+static bool Render(spu_t *spu, int x)
+{
+    static uint64_t last_serial;
+
+    vlc_tick_t now = vlc_tick_now();
+    vlc_render_subpicture *render = spu_Render(spu, NULL, &fmt, &fmt, false,
+                                               NULL, now, now, false);
+    assert(render != NULL);
+    assert(render->regions.size == 1);
+
+    const struct subpicture_region_rendered *r = render->regions.data[0];
+    assert(r->place.x == x && r->place.y == 16);
+    bool unchanged = r->b_unchanged;
+    /* only the region of the previous render can be unchanged */
+    assert(render->i_serial > last_serial);
+    assert(!unchanged || render->i_serial == last_serial + 1);
+    last_serial = render->i_serial;
+    vlc_render_subpicture_Delete(render);
+    return unchanged;
+}
+
+int main(void)
+{
+    test_init();
+
+    const char * const args[] = {
+        "-v",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    video_format_Init(&fmt, VLC_CODEC_RGBA);
+    fmt.i_width = fmt.i_visible_width = WIDTH;
+    fmt.i_height = fmt.i_visible_height = HEIGHT;
+    fmt.i_sar_num = fmt.i_sar_den = 1;
+
+    /* the SPU needs the text renderer and scaling modules */
+    spu_t *spu = spu_Create(obj, NULL);
+    if (spu == NULL)
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+    ssize_t channel = spu_RegisterChannel(spu);
+    assert(channel != VOUT_SPU_CHANNEL_INVALID);
+
+    subpicture_region_t *region = Put(spu, channel, 32);
+    assert(!Render(spu, 32));
+    assert(Render(spu, 32));
+    assert(Render(spu, 32));
+
+    /* a render without the region, before its start, breaks the chain */
+    vlc_render_subpicture *render = spu_Render(spu, NULL, &fmt, &fmt, false,
+                                               NULL, VLC_TICK_0, VLC_TICK_0,
+                                               false);
+    assert(render == NULL);
+    assert(!Render(spu, 32));
+    assert(Render(spu, 32));
+
+    /* an alpha change needs the region to be blended again */
+    region->i_alpha = 0x80;
+    assert(!Render(spu, 32));
+    assert(Render(spu, 32));
+
+    /* a new subpicture replaces the previous one, even at the same place */
+    Put(spu, channel, 32);
+    assert(!Render(spu, 32));
+    assert(Render(spu, 32));
+
+    Put(spu, channel, 100);
+    assert(!Render(spu, 100));
+    assert(Render(spu, 100));
+
+    spu_UnregisterChannel(spu, channel);
+    spu_Destroy(spu);
+    libvlc_release(vlc);
+    return 0;
+}